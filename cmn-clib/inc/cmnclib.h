@@ -16,6 +16,7 @@
 #include "cmnclib/CmnData.h"
 #include "cmnclib/CmnDllImport.h"
 #include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnJson.h"
 #include "cmnclib/CmnLog.h"
 #include "cmnclib/CmnNet.h"
 #include "cmnclib/CmnString.h"
@@ -29,6 +29,7 @@ D_EXTERN int CmnConf_GetEnv(char *buf, const char *envName);
 D_EXTERN CmnConfProperty *CmnConfProperty_Load(const char *file);
 D_EXTERN void CmnConfProperty_Free(CmnConfProperty *list);
 D_EXTERN char *CmnConfProperty_GetValue(const CmnConfProperty *list, const char *name );
+D_EXTERN int CmnConfProperty_GetIntValue(const CmnConfProperty *list, const char *name, long long *value);
 
 #endif /* CMNCLIB_CMN_CONF_H */
 
@@ -47,6 +47,23 @@ typedef struct _tag_CmnDataBuffer {
 	size_t size;		/**< 有効なデータのサイズ */
 } CmnDataBuffer;
 
+/** 128bitハッシュ値 */
+typedef struct _tag_CmnDataHash128 {
+	unsigned long long low;		/**< 下位64bit */
+	unsigned long long high;	/**< 上位64bit */
+} CmnDataHash128;
+
+/** 逐次ハッシュ計算の状態。メンバは内部的な処理で使うため使用不可。 */
+typedef struct _tag_CmnDataHash {
+	unsigned long long _seed[3];	/**< 系列ごとの中間値 */
+	unsigned char _buf[48];			/**< 未処理のデータ */
+	size_t _bufLen;					/**< 未処理のデータのバイト数 */
+	unsigned long long _totalLen;	/**< 追加したデータの総バイト数 */
+} CmnDataHash;
+
+/** アリーナ（一括解放メモリ領域）。内部構造は非公開。 */
+typedef struct _tag_CmnDataArena CmnDataArena;
+
 /* --- CmnDataList.c --- */
 D_EXTERN CmnDataList *CmnDataList_Create();
 D_EXTERN void CmnDataList_Free(CmnDataList *list, void *method);
@@ -63,8 +80,28 @@ D_EXTERN void* CmnDataStack_Pop(CmnDataStack *stack);
 D_EXTERN CmnDataBuffer* CmnDataBuffer_Create(size_t bufSize);
 D_EXTERN int CmnDataBuffer_Append(CmnDataBuffer *buf, const void *data, size_t len);
 D_EXTERN int CmnDataBuffer_Set(CmnDataBuffer *buf, const void *data, size_t len);
+D_EXTERN int CmnDataBuffer_Reserve(CmnDataBuffer *buf, size_t bufSize);
 D_EXTERN void CmnDataBuffer_Delete(CmnDataBuffer *buf, size_t len);
 D_EXTERN void CmnDataBuffer_Free(CmnDataBuffer *buf);
 
+/* --- CmnDataHash.c --- */
+D_EXTERN unsigned long long CmnData_Hash(const void *data, size_t len);
+D_EXTERN unsigned long long CmnData_HashSeed(const void *data, size_t len, unsigned long long seed);
+D_EXTERN void CmnData_Hash128(const void *data, size_t len, unsigned long long seed, CmnDataHash128 *result);
+D_EXTERN unsigned long long CmnData_HashRandomSeed(void);
+D_EXTERN void CmnDataHash_Init(CmnDataHash *state, unsigned long long seed);
+D_EXTERN void CmnDataHash_Update(CmnDataHash *state, const void *data, size_t len);
+D_EXTERN void CmnDataHash_UpdateBuffer(CmnDataHash *state, const CmnDataBuffer *buf);
+D_EXTERN unsigned long long CmnDataHash_Final(const CmnDataHash *state);
+D_EXTERN void CmnDataHash_Final128(const CmnDataHash *state, CmnDataHash128 *result);
+
+/* --- CmnDataArena.c --- */
+D_EXTERN CmnDataArena* CmnDataArena_Create(size_t chunkSize);
+D_EXTERN void* CmnDataArena_Alloc(CmnDataArena *arena, size_t size);
+D_EXTERN char* CmnDataArena_CopyString(CmnDataArena *arena, const char *str, size_t len);
+D_EXTERN void CmnDataArena_Reset(CmnDataArena *arena);
+D_EXTERN size_t CmnDataArena_GetTotalSize(const CmnDataArena *arena);
+D_EXTERN void CmnDataArena_Free(CmnDataArena *arena);
+
 #endif /* CMNCLIB_CMN_DATA_H */
 
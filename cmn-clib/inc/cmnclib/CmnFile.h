@@ -39,12 +39,12 @@ typedef enum {
 	#define CMN_FILE_MAX_FILE_NAME (1024)
 #endif
 
-/** ファイル情報構造体 */
+/** ファイル情報構造体（1件あたり5KB以上になるため、大量のファイルを扱う場合はCmnFileEntryListを使用すること） */
 typedef struct _tag_CmnFileInfo {
-	/* TODO : パス長を無制限にしたい。char[]からCmnStringBufferに差し替えたいがメモリ解放がネック。メモリマネージャを実装したら差し替えすること。 */
+	/* パス長に制限のないファイル情報はCmnFileEntry（CmnFileEntryList）を使用すること。 */
 	char parentDir[CMN_FILE_MAX_PATH];		/**< 親ディレクトリ */
 	char name[CMN_FILE_MAX_FILE_NAME];		/**< ファイル名/ディレクトリ名 */
-	size_t size;							/**< ファイルサイズ。ディレクトリの場合は常にゼロ */
+	long long size;							/**< ファイルサイズ（2GB以上のファイルも扱えるように64bit）。ディレクトリの場合は常にゼロ */
 	CmnTimeDateTime lastUpdateTime;			/**< 最終更新日時 */
 	unsigned int isDirectory: 1;			/**< 属性フラグ：ディレクトリの場合に1 */
 	unsigned int isFile: 1;				/**< 属性フラグ：ファイルの場合に1 */
@@ -53,6 +53,210 @@ typedef struct _tag_CmnFileInfo {
 	unsigned int isSymbolicLink: 1;		/**< 属性フラグ：シンボリックリンクの場合に1 */
 } CmnFileInfo;
 
+/** ファイルのメモリマップのアクセス方法：指定なし */
+#define CMN_FILE_MAP_NORMAL 0x00
+/** ファイルのメモリマップのアクセス方法：先頭から順に読む（先読みを増やす） */
+#define CMN_FILE_MAP_SEQUENTIAL 0x01
+/** ファイルのメモリマップのアクセス方法：ランダムに読む（先読みしない） */
+#define CMN_FILE_MAP_RANDOM 0x02
+/** ファイルのメモリマップのアクセス方法：すぐに全体を読む（マップ時に読み込みを開始する。他と組み合わせ可） */
+#define CMN_FILE_MAP_WILLNEED 0x04
+
+/** 位置指定読み書き用に開いたファイル（内部構造は非公開） */
+typedef struct _tag_CmnFileHandle CmnFileHandle;
+
+/** ファイルを開くオプション：読み込み */
+#define CMN_FILE_OPEN_READ 0x01
+/** ファイルを開くオプション：書き込み */
+#define CMN_FILE_OPEN_WRITE 0x02
+/** ファイルを開くオプション：ファイルがなければ作成する */
+#define CMN_FILE_OPEN_CREATE 0x04
+/** ファイルを開くオプション：ファイルサイズを0にする */
+#define CMN_FILE_OPEN_TRUNCATE 0x08
+
+/** 非同期ファイル入出力（内部構造は非公開） */
+typedef struct _tag_CmnFileAio CmnFileAio;
+
+/** 非同期ファイル入出力の種別：位置を指定して読み込む */
+#define CMN_FILE_AIO_READ 1
+/** 非同期ファイル入出力の種別：位置を指定して書き込む */
+#define CMN_FILE_AIO_WRITE 2
+/** 非同期ファイル入出力の種別：ディスクに同期する（先に投入した要求の完了後に実行し、後に投入した要求はこの完了まで待つ） */
+#define CMN_FILE_AIO_SYNC 3
+
+/** 非同期ファイル入出力のオプション：io_uringを使わずにスレッドプールで処理する */
+#define CMN_FILE_AIO_THREAD_POOL 0x01
+
+/** 非同期ファイル入出力の設定 */
+typedef struct _tag_CmnFileAioOption {
+	int queueDepth;						/**< 同時に処理できる要求の数（0の場合は128） */
+	int threadCount;					/**< スレッドプールのスレッド数（0の場合は4。io_uringを使う場合は不要） */
+	size_t bufferSize;					/**< バッファプールのバッファ1個のサイズ（0の場合は64KB） */
+	int bufferCount;					/**< バッファプールのバッファの数（0の場合はバッファプールを使わない） */
+	int flags;							/**< CMN_FILE_AIO_THREAD_POOL */
+} CmnFileAioOption;
+
+/** 非同期ファイル入出力の要求 */
+typedef struct _tag_CmnFileAioRequest {
+	int type;					/**< 種別（CMN_FILE_AIO_*） */
+	CmnFileHandle *file;		/**< 対象のファイル（完了まで閉じないこと） */
+	void *buf;					/**< 読み込む領域/書き込むデータ（完了まで解放しないこと） */
+	size_t len;					/**< 読み書きするバイト数 */
+	long long offset;			/**< 読み書きする位置 */
+	void *data;					/**< 任意のデータ（完了時のコールバック関数に渡す） */
+} CmnFileAioRequest;
+
+/** 非同期ファイル入出力の完了のコールバック関数（resultは読み書きしたバイト数、同期は0、エラーの場合は-1） */
+typedef void (*CmnFileAioCallback)(const CmnFileAioRequest *request, long long result, void *data);
+
+/** ファイルのコピー、移動のオプション：コピー先、移動先のファイルがあれば上書きする */
+#define CMN_FILE_COPY_OVERWRITE 0x01
+/** ファイルのコピーのオプション：パーミッション、更新日時、アクセス日時を保持する */
+#define CMN_FILE_COPY_PRESERVE 0x02
+
+/** 読み込み専用でマップしたファイル。_で始まるメンバは内部的な処理で使うため使用不可。 */
+typedef struct _tag_CmnFileMap {
+	const char *data;		/**< ファイルの内容（読み込み専用。'\0'で終端していない） */
+	size_t size;			/**< ファイルサイズ */
+	void *_addr;			/**< マップしたアドレス（マップできなかった場合は読み込んだ領域） */
+	int _isMapped;			/**< マップしたか（Falseの場合は読み込んだ領域） */
+} CmnFileMap;
+
+/** 行単位のファイル読み込み（内部構造は非公開） */
+typedef struct _tag_CmnFileReader CmnFileReader;
+
+/** 行単位のファイル読み込みのオプション：行の処理中に次のブロックを別スレッドで先読みする */
+#define CMN_FILE_READER_READ_AHEAD 0x01
+
+/** バッファ付きファイル書き込み（内部構造は非公開） */
+typedef struct _tag_CmnFileWriter CmnFileWriter;
+
+/** バッファ付きファイル書き込みのオプション：追記する（指定しない場合は新規作成） */
+#define CMN_FILE_WRITER_APPEND 0x01
+
+/** バッファ付きファイル書き込みの同期方法：同期しない（OSに任せる） */
+#define CMN_FILE_WRITER_SYNC_NONE 0
+/** バッファ付きファイル書き込みの同期方法：フラッシュのたびに同期する */
+#define CMN_FILE_WRITER_SYNC_FLUSH 1
+/** バッファ付きファイル書き込みの同期方法：コミット時に同期する（同時のコミットは1回の同期にまとめる） */
+#define CMN_FILE_WRITER_SYNC_GROUP 2
+
+/** バッファ付きファイル書き込みの設定 */
+typedef struct _tag_CmnFileWriterOption {
+	size_t bufferSize;				/**< バッファサイズ（0の場合は64KB） */
+	unsigned long flushInterval;	/**< バッファの内容を書き込む間隔（ミリ秒）。0の場合は時間では書き込まない */
+	int sync;						/**< 同期方法（CMN_FILE_WRITER_SYNC_*） */
+} CmnFileWriterOption;
+
+/** ファイルの種別：ファイル */
+#define CMN_FILE_TYPE_FILE 1
+/** ファイルの種別：ディレクトリ */
+#define CMN_FILE_TYPE_DIRECTORY 2
+/** ファイルの種別：シンボリックリンク */
+#define CMN_FILE_TYPE_SYMLINK 3
+/** ファイルの種別：その他（デバイス、パイプ、ソケットなど） */
+#define CMN_FILE_TYPE_OTHER 4
+
+/** ディレクトリの走査のオプション：サイズと最終更新日時を取得する（1件ごとにfstatatを呼び出す） */
+#define CMN_FILE_WALK_STAT 0x01
+/** ディレクトリの走査のオプション：シンボリックリンクをたどる */
+#define CMN_FILE_WALK_FOLLOW_LINKS 0x02
+
+/** ディレクトリの走査のコールバック関数の戻り値：走査を続ける */
+#define CMN_FILE_WALK_CONTINUE 0
+/** ディレクトリの走査のコールバック関数の戻り値：このディレクトリの配下を走査しない */
+#define CMN_FILE_WALK_PRUNE 1
+/** ディレクトリの走査のコールバック関数の戻り値：走査を中止する */
+#define CMN_FILE_WALK_STOP 2
+
+/** ディレクトリの走査で通知するファイル、ディレクトリ。コールバック関数の中でのみ有効。 */
+typedef struct _tag_CmnFileWalkEntry {
+	const char *path;			/**< パス（起点のディレクトリのパスからの連結） */
+	size_t pathLength;			/**< パスの長さ */
+	const char *name;			/**< ファイル名/ディレクトリ名（pathの末尾を指す） */
+	int depth;					/**< 深さ（起点のディレクトリ直下が1） */
+	int type;					/**< 種別（CMN_FILE_TYPE_*） */
+	long long size;				/**< ファイルサイズ（LinuxではCMN_FILE_WALK_STATを指定した場合のみ） */
+	time_t lastUpdateTime;		/**< 最終更新日時（同上） */
+} CmnFileWalkEntry;
+
+/** ディレクトリの走査のコールバック関数 */
+typedef int (*CmnFileWalkCallback)(const CmnFileWalkEntry *entry, void *data);
+
+/** ファイル、ディレクトリの監視（内部構造は非公開） */
+typedef struct _tag_CmnFileWatch CmnFileWatch;
+
+/** ファイル、ディレクトリの監視のオプション：配下のディレクトリも監視する */
+#define CMN_FILE_WATCH_RECURSIVE 0x01
+
+/** 監視のイベント：作成（監視内への移動を含む） */
+#define CMN_FILE_WATCH_CREATE 0x01
+/** 監視のイベント：削除（監視外への移動を含む） */
+#define CMN_FILE_WATCH_DELETE 0x02
+/** 監視のイベント：内容、属性の変更 */
+#define CMN_FILE_WATCH_MODIFY 0x04
+/** 監視のイベント：イベントが失われたため走査し直す必要がある（監視を開始したパスで通知する） */
+#define CMN_FILE_WATCH_RESCAN 0x08
+
+/** 監視のイベント。コールバック関数の中でのみ有効。 */
+typedef struct _tag_CmnFileWatchEvent {
+	const char *path;			/**< パス（監視を開始したパスからの連結） */
+	int events;					/**< 集約時間内に発生したイベント（CMN_FILE_WATCH_*の組み合わせ） */
+	int isDirectory;			/**< ディレクトリの場合はTrue（削除の場合は分からないことがある） */
+} CmnFileWatchEvent;
+
+/** 監視のイベントのコールバック関数 */
+typedef void (*CmnFileWatchCallback)(const CmnFileWatchEvent *event, void *data);
+
+/** ファイルの内容のキャッシュ（内部構造は非公開） */
+typedef struct _tag_CmnFileCache CmnFileCache;
+
+/** ファイルの内容のキャッシュのオプション：ファイルを読み込まずにマップする（置き換えずに書き換えられたファイルは参照中の内容も変わる） */
+#define CMN_FILE_CACHE_MAP 0x01
+
+/** ファイルの内容のキャッシュの設定 */
+typedef struct _tag_CmnFileCacheOption {
+	size_t maxSize;						/**< キャッシュする内容の合計サイズの上限（0の場合は64MB） */
+	unsigned long revalidateInterval;	/**< ファイルの変更を確認する間隔（ミリ秒）。0の場合は取得のたびに確認する */
+	int flags;							/**< CMN_FILE_CACHE_MAP */
+} CmnFileCacheOption;
+
+/** キャッシュしたファイルの内容。CmnFileCache_Releaseを呼び出すまで有効。 */
+typedef struct _tag_CmnFileCacheEntry {
+	const char *data;			/**< ファイルの内容（読み込み専用。'\0'で終端していない） */
+	size_t size;				/**< ファイルサイズ */
+	const char *path;			/**< 絶対パス */
+	time_t lastUpdateTime;		/**< 最終更新日時 */
+} CmnFileCacheEntry;
+
+/** ファイルの内容のキャッシュの統計情報 */
+typedef struct _tag_CmnFileCacheStats {
+	unsigned long long hits;		/**< キャッシュした内容を返した回数 */
+	unsigned long long misses;		/**< ファイルを読み込んだ回数 */
+	unsigned long long evictions;	/**< 合計サイズの上限を超えたため削除した回数 */
+	int count;						/**< キャッシュしているファイルの数 */
+	size_t size;					/**< キャッシュしている内容の合計サイズ */
+} CmnFileCacheStats;
+
+/** ファイル情報（コンパクト版）。CmnFileEntryListに格納する。 */
+typedef struct _tag_CmnFileEntry {
+	const char *name;					/**< ファイル名/ディレクトリ名（一覧のアリーナに格納） */
+	long long size;						/**< ファイルサイズ（CMN_FILE_WALK_STATを指定した場合のみ） */
+	time_t lastUpdateTime;				/**< 最終更新日時（同上） */
+	int parent;							/**< 親ディレクトリのエントリの番号（起点のディレクトリ直下は-1） */
+	unsigned int type: 3;				/**< 種別（CMN_FILE_TYPE_*） */
+	unsigned int isHiddenFile: 1;		/**< 隠しファイルの場合に1 */
+} CmnFileEntry;
+
+/** ファイル情報の一覧（コンパクト版）。_で始まるメンバは内部的な処理で使うため使用不可。 */
+typedef struct _tag_CmnFileEntryList {
+	CmnFileEntry *entries;				/**< エントリ */
+	int size;							/**< エントリの数 */
+	const char *root;					/**< 起点のディレクトリのパス */
+	int _capacity;
+	CmnDataArena *_arena;				/**< ファイル名を格納するアリーナ */
+} CmnFileEntryList;
+
 /* --- CmnFile.c --- */
 D_EXTERN CmnStringBuffer* CmnFile_ReadAllText(const char *filePath, CmnStringBuffer *buf);
 D_EXTERN CmnDataBuffer* CmnFile_ReadAll(const char *filePath, CmnDataBuffer *buf);
@@ -60,6 +264,8 @@ D_EXTERN int CmnFile_WriteNew(const char *filePath, void *data, size_t len);
 D_EXTERN int CmnFile_WriteHead(const char *filePath, void *data, size_t len);
 D_EXTERN int CmnFile_WriteTail(const char *filePath, void *data, size_t len);
 D_EXTERN int CmnFile_Remove(const char *path);
+D_EXTERN int CmnFile_Copy(const char *srcPath, const char *dstPath, int flags);
+D_EXTERN int CmnFile_Move(const char *srcPath, const char *dstPath, int flags);
 D_EXTERN CmnDataList* CmnFile_List(const char *path, CmnDataList *list, CHARSET pathCharset);
 D_EXTERN char* CmnFile_ToAbsolutePath(const char *path, char *buf, size_t buflen, CHARSET pathCharset);
 D_EXTERN char* CmnFile_GetCurrentDirectory(char *buf, size_t buflen);
@@ -67,6 +273,72 @@ D_EXTERN int CmnFile_Exists(const char *path);
 D_EXTERN CmnFileInfo* CmnFile_GetFileInfo(const char *path, CmnFileInfo *info);
 D_EXTERN char* CmnFileInfo_ToString(const CmnFileInfo *info, char *buf);
 
+/* --- CmnFileMap.c --- */
+D_EXTERN CmnFileMap* CmnFile_Map(const char *filePath, int flags);
+D_EXTERN CmnFileMap* CmnFile_MapStream(FILE *fp, int flags);
+D_EXTERN void CmnFile_Unmap(CmnFileMap *map);
+
+/* --- CmnFileHandle.c --- */
+D_EXTERN CmnFileHandle* CmnFile_Open(const char *path, int flags);
+D_EXTERN long long CmnFile_ReadAt(CmnFileHandle *file, void *buf, size_t len, long long offset);
+D_EXTERN int CmnFile_WriteAt(CmnFileHandle *file, const void *data, size_t len, long long offset);
+D_EXTERN long long CmnFile_GetSize(CmnFileHandle *file);
+D_EXTERN int CmnFile_Truncate(CmnFileHandle *file, long long size);
+D_EXTERN int CmnFile_Allocate(CmnFileHandle *file, long long offset, long long len);
+D_EXTERN int CmnFile_Sync(CmnFileHandle *file);
+D_EXTERN int CmnFile_Close(CmnFileHandle *file);
+#if IS_PRATFORM_LINUX()
+D_EXTERN int CmnFile_GetDescriptor(CmnFileHandle *file);
+#endif
+
+/* --- CmnFileReader.c --- */
+D_EXTERN CmnFileReader* CmnFileReader_Open(const char *filePath, size_t blockSize, int flags);
+D_EXTERN CmnFileReader* CmnFileReader_Create(FILE *fp, size_t blockSize, int flags);
+D_EXTERN int CmnFileReader_ReadLine(CmnFileReader *reader, CmnStringView *line);
+D_EXTERN void CmnFileReader_Free(CmnFileReader *reader);
+
+/* --- CmnFileWalk.c --- */
+D_EXTERN int CmnFile_Walk(const char *path, int maxDepth, int flags, CmnFileWalkCallback callback, void *data);
+D_EXTERN int CmnFile_WalkParallel(const char *path, int maxDepth, int flags, int threadCount, CmnFileWalkCallback callback, void *data);
+
+/* --- CmnFileAio.c --- */
+D_EXTERN CmnFileAio* CmnFileAio_Create(const CmnFileAioOption *option);
+D_EXTERN int CmnFileAio_Submit(CmnFileAio *aio, const CmnFileAioRequest *requests, int count);
+D_EXTERN int CmnFileAio_Poll(CmnFileAio *aio, int timeout, CmnFileAioCallback callback, void *data);
+D_EXTERN void* CmnFileAio_GetBuffer(CmnFileAio *aio);
+D_EXTERN void CmnFileAio_ReleaseBuffer(CmnFileAio *aio, void *buf);
+D_EXTERN int CmnFileAio_IsUring(CmnFileAio *aio);
+D_EXTERN void CmnFileAio_Free(CmnFileAio *aio);
+
+/* --- CmnFileCache.c --- */
+D_EXTERN CmnFileCache* CmnFileCache_Create(const CmnFileCacheOption *option);
+D_EXTERN const CmnFileCacheEntry* CmnFileCache_Get(CmnFileCache *cache, const char *path);
+D_EXTERN void CmnFileCache_Release(CmnFileCache *cache, const CmnFileCacheEntry *entry);
+D_EXTERN int CmnFileCache_Watch(CmnFileCache *cache, const char *dirPath);
+D_EXTERN CmnFileCacheStats* CmnFileCache_GetStats(CmnFileCache *cache, CmnFileCacheStats *stats);
+D_EXTERN void CmnFileCache_Free(CmnFileCache *cache);
+
+/* --- CmnFileEntryList.c --- */
+D_EXTERN CmnFileEntryList* CmnFileEntryList_Create(void);
+D_EXTERN CmnFileEntryList* CmnFile_ListEntries(const char *path, int maxDepth, int flags, CmnFileEntryList *list);
+D_EXTERN CmnStringBuffer* CmnFileEntryList_GetPath(const CmnFileEntryList *list, int index, CmnStringBuffer *buf);
+D_EXTERN CmnFileInfo* CmnFileEntryList_ToFileInfo(const CmnFileEntryList *list, int index, CmnFileInfo *info);
+D_EXTERN CmnStringBuffer* CmnFileEntryList_ToString(const CmnFileEntryList *list, int index, CmnStringBuffer *buf);
+D_EXTERN void CmnFileEntryList_Free(CmnFileEntryList *list);
+
+/* --- CmnFileWatch.c --- */
+D_EXTERN CmnFileWatch* CmnFileWatch_Open(const char *path, int flags, unsigned long latency);
+D_EXTERN int CmnFileWatch_Read(CmnFileWatch *watch, int timeout, CmnFileWatchCallback callback, void *data);
+D_EXTERN int CmnFileWatch_Start(CmnFileWatch *watch, CmnFileWatchCallback callback, void *data);
+D_EXTERN void CmnFileWatch_Close(CmnFileWatch *watch);
+
+/* --- CmnFileWriter.c --- */
+D_EXTERN CmnFileWriter* CmnFileWriter_Open(const char *filePath, int flags, const CmnFileWriterOption *option);
+D_EXTERN int CmnFileWriter_Write(CmnFileWriter *writer, const void *data, size_t len);
+D_EXTERN int CmnFileWriter_Flush(CmnFileWriter *writer);
+D_EXTERN int CmnFileWriter_Commit(CmnFileWriter *writer);
+D_EXTERN int CmnFileWriter_Close(CmnFileWriter *writer);
+
 
 
 #endif /* CMNCLIB_CMN_FILE_H */
@@ -0,0 +1,105 @@
+/** @file *********************************************************************
+ * @brief JSON 共通関数 I/Fヘッダファイル
+ *
+ *  JSON系共通関数を使用するためのI/Fヘッダファイル。<br>
+ *  JSON系の共通関数を使用する場合は、このヘッダファイルを読み込むこと
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+
+#ifndef CMNCLIB_CMN_JSON_H
+#define CMNCLIB_CMN_JSON_H
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnData.h"
+#include "cmnclib/CmnString.h"
+
+/** 配列、オブジェクトの入れ子の最大数 */
+#define CMN_JSON_MAX_DEPTH 1024
+
+/** JSONの値の種類 */
+typedef enum {
+	CMN_JSON_NULL = 0,		/**< null */
+	CMN_JSON_BOOL,			/**< true, false */
+	CMN_JSON_NUMBER,		/**< 数値 */
+	CMN_JSON_STRING,		/**< 文字列 */
+	CMN_JSON_ARRAY,			/**< 配列 */
+	CMN_JSON_OBJECT			/**< オブジェクト */
+} CmnJsonType;
+
+/** JSONパーサ（逐次解析）。内部構造は非公開。 */
+typedef struct _tag_CmnJsonParser CmnJsonParser;
+
+/**
+ * JSONパーサのイベントハンドラ。<br>
+ * 各関数はNULLを指定した場合は呼び出されない。0以外を返した場合は解析を中断する（Feedがエラーを返す）。<br>
+ * 文字列（str, len）は'\0'で終端しておらず、呼び出し中のみ有効。エスケープを含まない文字列は入力データを直接指す。
+ */
+typedef struct _tag_CmnJsonHandler {
+	int (*onNull)(void *ctx);											/**< null */
+	int (*onBool)(void *ctx, int value);								/**< true(True), false(False) */
+	int (*onNumber)(void *ctx, const char *str, size_t len);			/**< 数値（JSONの書式のままの文字列） */
+	int (*onString)(void *ctx, const char *str, size_t len);			/**< 文字列（エスケープ解除済み、UTF-8） */
+	int (*onKey)(void *ctx, const char *str, size_t len);				/**< オブジェクトのキー（エスケープ解除済み、UTF-8） */
+	int (*onStartObject)(void *ctx);									/**< オブジェクトの開始 */
+	int (*onEndObject)(void *ctx);										/**< オブジェクトの終了 */
+	int (*onStartArray)(void *ctx);										/**< 配列の開始 */
+	int (*onEndArray)(void *ctx);										/**< 配列の終了 */
+} CmnJsonHandler;
+
+/** JSONの値（DOM）。すべてアリーナ上に確保される。 */
+typedef struct _tag_CmnJsonValue {
+	CmnJsonType type;					/**< 値の種類 */
+	const char *key;					/**< オブジェクトのメンバの場合はキー（'\0'終端）、それ以外はNULL */
+	size_t keyLen;						/**< キーのバイト数 */
+	const char *str;					/**< 文字列の場合は値、数値の場合はJSONの書式のままの文字列（'\0'終端） */
+	size_t len;							/**< strのバイト数 */
+	double number;						/**< 数値の場合の値 */
+	int boolean;						/**< true, falseの場合の値（True, False） */
+	size_t count;						/**< 配列、オブジェクトの場合の要素数 */
+	struct _tag_CmnJsonValue *child;	/**< 配列、オブジェクトの場合の最初の要素 */
+	struct _tag_CmnJsonValue *next;		/**< 同じ配列、オブジェクト内の次の要素 */
+} CmnJsonValue;
+
+/** JSON書き込み。メンバは内部的な処理で使うため使用不可。 */
+typedef struct _tag_CmnJsonWriter {
+	CmnStringBuffer *_buf;						/**< 書き込み先 */
+	int _depth;									/**< 入れ子の深さ */
+	int _afterKey;								/**< キーの直後か */
+	int _error;									/**< エラーが発生したか */
+	unsigned char _first[CMN_JSON_MAX_DEPTH + 1];	/**< 各階層で最初の要素を書き込む前か */
+} CmnJsonWriter;
+
+/* --- CmnJsonParser.c --- */
+D_EXTERN CmnJsonParser* CmnJsonParser_Create(const CmnJsonHandler *handler, void *ctx);
+D_EXTERN CmnJsonParser* CmnJsonParser_CreateDom(CmnDataArena *arena);
+D_EXTERN int CmnJsonParser_Feed(CmnJsonParser *parser, const char *data, size_t len);
+D_EXTERN int CmnJsonParser_Finish(CmnJsonParser *parser);
+D_EXTERN CmnJsonValue* CmnJsonParser_GetRoot(CmnJsonParser *parser);
+D_EXTERN const char* CmnJsonParser_GetError(CmnJsonParser *parser, size_t *offset);
+D_EXTERN void CmnJsonParser_Reset(CmnJsonParser *parser);
+D_EXTERN void CmnJsonParser_Free(CmnJsonParser *parser);
+
+/* --- CmnJsonValue.c --- */
+D_EXTERN CmnJsonValue* CmnJson_Parse(const char *json, size_t len, CmnDataArena *arena);
+D_EXTERN CmnJsonValue* CmnJsonValue_Get(const CmnJsonValue *object, const char *key);
+D_EXTERN CmnJsonValue* CmnJsonValue_GetAt(const CmnJsonValue *array, size_t index);
+
+/* --- CmnJsonWriter.c --- */
+D_EXTERN void CmnJsonWriter_Init(CmnJsonWriter *writer, CmnStringBuffer *buf);
+D_EXTERN int CmnJsonWriter_StartObject(CmnJsonWriter *writer);
+D_EXTERN int CmnJsonWriter_EndObject(CmnJsonWriter *writer);
+D_EXTERN int CmnJsonWriter_StartArray(CmnJsonWriter *writer);
+D_EXTERN int CmnJsonWriter_EndArray(CmnJsonWriter *writer);
+D_EXTERN int CmnJsonWriter_Key(CmnJsonWriter *writer, const char *key);
+D_EXTERN int CmnJsonWriter_KeyN(CmnJsonWriter *writer, const char *key, size_t len);
+D_EXTERN int CmnJsonWriter_String(CmnJsonWriter *writer, const char *str);
+D_EXTERN int CmnJsonWriter_StringN(CmnJsonWriter *writer, const char *str, size_t len);
+D_EXTERN int CmnJsonWriter_Int(CmnJsonWriter *writer, long long value);
+D_EXTERN int CmnJsonWriter_Double(CmnJsonWriter *writer, double value);
+D_EXTERN int CmnJsonWriter_Bool(CmnJsonWriter *writer, int value);
+D_EXTERN int CmnJsonWriter_Null(CmnJsonWriter *writer);
+D_EXTERN int CmnJson_Write(const CmnJsonValue *value, CmnStringBuffer *buf);
+
+#endif /* CMNCLIB_CMN_JSON_H */
@@ -17,12 +17,14 @@
 
 #include "cmnclib/Common.h"
 #include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnString.h"
 
 
 /** ログメッセージ格納構造体 */
 typedef struct tag_CmnLogMessage {
 	char *code;							/**< メッセージコード */
 	char *msg;							/**< メッセージ文     */
+	CmnStringFormat *format;			/**< 事前解析済みのメッセージ文 */
 	struct tag_CmnLogMessage *next;	/**< Nextポインタ     */
 } CmnLogMessage;
 
@@ -51,7 +53,7 @@ D_EXTERN int CmnLog_Init(const char* logFile, CMN_LOG_LEVEL level, const char* m
 /* 標準ログ出力共通関数終了処理 */
 D_EXTERN void CmnLog_End();
 /* 標準ログ出力（メッセージ指定） */
-D_EXTERN void CmnLog_Put(int level, const char *msgCode, ...);
+D_EXTERN void CmnLog_Put(int level, const char *msgCode, ...) CMN_PRINTF_FORMAT(2, 3);
 /* 標準ログ出力（メッセージコード指定） */
 D_EXTERN void CmnLog_PutByCode(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msgCode, ...);
 /* cmn-clibの内部ログ出力設定 */
@@ -59,7 +61,7 @@ D_EXTERN void CmnLog_InitCmnClibLog(CmnLogEx *log, CMN_LOG_LEVEL level);
 /* cmn-clibの内部ログ出力終了 */
 D_EXTERN void CmnLog_EndCmnClibLog();
 /* cmn-clibの内部ログ出力 */
-D_EXTERN void CmnLog_PutCmnClibLog(CMN_LOG_LEVEL level, const char* msgCode, ...);
+D_EXTERN void CmnLog_PutCmnClibLog(CMN_LOG_LEVEL level, const char* msgCode, ...) CMN_PRINTF_FORMAT(2, 3);
 
 /* --- CmnLogEx.c --- */
 /* 拡張ログ出力関数初期化処理 */
@@ -67,11 +69,13 @@ D_EXTERN CmnLogEx* CmnLogEx_Create(const char* logFile, CMN_LOG_LEVEL level, con
 /* 拡張ログ出力共通関数終了処理 */
 D_EXTERN void CmnLogEx_Free(CmnLogEx *log);
 /* 拡張ログ出力（メッセージ指定） */
-D_EXTERN void CmnLogEx_Put(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, ...);
+D_EXTERN void CmnLogEx_Put(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, ...) CMN_PRINTF_FORMAT(3, 4);
 /* 拡張ログ出力（メッセージコード指定） */
 D_EXTERN void CmnLogEx_PutByCode(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msgCode, ...);
 /* 拡張ログ出力（ログ出力共通） */
 D_EXTERN void cmnLogEx_PutLog(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, va_list args);
+/* 拡張ログ出力（ログ出力共通。事前解析済みのメッセージ文） */
+D_EXTERN void cmnLogEx_PutLogFormat(CmnLogEx* log, CMN_LOG_LEVEL level, const CmnStringFormat* format, va_list args);
 
 /* --- CmnLogMessage.c --- */
 /* ログメッセージ定義ファイル読み込み */
@@ -87,7 +91,7 @@ D_EXTERN int CmnLogMessage_Get(CmnLogMessage* list, const char* msg_code, CmnLog
 	#define CMNLOG_TRACE_END()
 #else
 	#define CMNLOG_TRACE_START() clock_t cmnlogtrace_stclock=clock();CmnLog_PutCmnClibLog(CMN_LOG_LEVEL_TRACE, "START %s", __func__)
-	#define CMNLOG_TRACE_END() CmnLog_PutCmnClibLog(CMN_LOG_LEVEL_TRACE, "END %s(clocks=%d)", __func__, clock() - cmnlogtrace_stclock)
+	#define CMNLOG_TRACE_END() CmnLog_PutCmnClibLog(CMN_LOG_LEVEL_TRACE, "END %s(clocks=%ld)", __func__, (long)(clock() - cmnlogtrace_stclock))
 #endif
 #define CMNLOG_TRACE(msg, ...) CmnLog_PutCmnClibLog(CMN_LOG_LEVEL_TRACE, (msg), __VA_ARGS__)
 #define CMNLOG_DEBUG(msg, ...) CmnLog_PutCmnClibLog(CMN_LOG_LEVEL_DEBUG, (msg), __VA_ARGS__)
@@ -12,6 +12,9 @@
 #ifndef CMNCLIB_CMN_STRING_H
 #define CMNCLIB_CMN_STRING_H
 
+#include <stdarg.h>
+#include <stdio.h>
+
 #include "cmnclib/Common.h"
 #include "cmnclib/CmnData.h"
 
@@ -30,6 +33,72 @@ typedef struct _tag_CmnStringBuffer {
 	size_t length;			/**< 文字数 */
 } CmnStringBuffer;
 
+/** 文字列ビュー（文字列の一部を先頭位置と長さで表す。'\0'で終端していない） */
+typedef struct _tag_CmnStringView {
+	const char *str;		/**< 先頭位置 */
+	size_t len;				/**< バイト数 */
+} CmnStringView;
+
+/** 数値文字列変換の結果 */
+typedef enum {
+	CMN_STRING_PARSE_OK = 0,					/**< 正常 */
+	CMN_STRING_PARSE_ERROR_FORMAT = -1,		/**< 書式不正（空文字列、数字以外の文字を含むなど） */
+	CMN_STRING_PARSE_ERROR_OVERFLOW = -2		/**< 桁あふれ（型の範囲外） */
+} CmnStringParseResult;
+
+/** 整数を文字列に変換する際に必要なバッファサイズ（"-9223372036854775808" + '\0'） */
+#define CMN_STRING_INT_SIZE (20 + 1)
+/** 符号なし整数を文字列に変換する際に必要なバッファサイズ（"18446744073709551615" + '\0'） */
+#define CMN_STRING_UINT_SIZE (20 + 1)
+/** 浮動小数点数を文字列に変換する際に必要なバッファサイズ（"-1.2345678901234567e-308" + '\0'） */
+#define CMN_STRING_DOUBLE_SIZE (32)
+
+/** 正規表現のコンパイルオプション：英字の大文字小文字を区別しない */
+#define CMN_STRING_REGEX_IGNORE_CASE 0x01
+/** 正規表現のコンパイルオプション：1バイトを1文字として扱う（UTF-8として解釈しない。Shift_JIS等の場合に指定） */
+#define CMN_STRING_REGEX_BYTES 0x02
+
+/** コンパイル済み正規表現（内部構造は非公開） */
+typedef struct _tag_CmnStringRegex CmnStringRegex;
+
+/** ワイルドカードのオプション：英字の大文字小文字を区別しない */
+#define CMN_STRING_GLOB_IGNORE_CASE CMN_STRING_REGEX_IGNORE_CASE
+/** ワイルドカードのオプション：1バイトを1文字として扱う（UTF-8として解釈しない。Shift_JIS等の場合に指定） */
+#define CMN_STRING_GLOB_BYTES CMN_STRING_REGEX_BYTES
+/** ワイルドカードのオプション：*、?等をパスの区切り（'/'）に一致させない（区切りを越える場合は**を使用する） */
+#define CMN_STRING_GLOB_PATHNAME 0x100
+
+/** コンパイル済みワイルドカード（内部構造は非公開） */
+typedef struct _tag_CmnStringGlob CmnStringGlob;
+
+/** 事前解析済みの書式（内部構造は非公開） */
+typedef struct _tag_CmnStringFormat CmnStringFormat;
+
+/** CSVリーダー（内部構造は非公開） */
+typedef struct _tag_CmnStringCsv CmnStringCsv;
+
+/** Base64の種類：標準（RFC 4648。"+/"を使用し、'='でパディングする） */
+#define CMN_STRING_BASE64_STANDARD 0
+/** Base64の種類：URL、ファイル名用（RFC 4648。"-_"を使用し、パディングしない） */
+#define CMN_STRING_BASE64_URL 1
+/** パーセントエンコーディングの種類：URI（RFC 3986。非予約文字以外を%XXに変換する） */
+#define CMN_STRING_PERCENT_URI 0
+/** パーセントエンコーディングの種類：フォーム（application/x-www-form-urlencoded。空白を'+'に変換する） */
+#define CMN_STRING_PERCENT_FORM 1
+
+/** Base64逐次変換の状態。メンバは内部的な処理で使うため使用不可。 */
+typedef struct _tag_CmnStringBase64 {
+	int _mode;					/**< Base64の種類 */
+	unsigned char _rest[4];		/**< 変換していない端数 */
+	size_t _restLen;			/**< 端数のバイト数 */
+	size_t _padLen;				/**< 読み込んだパディングの数（逆変換時） */
+} CmnStringBase64;
+
+/** 文字コード変換で変換できない文字の代替文字（UTF-8出力時。U+FFFD） */
+#define CMN_STRING_REPLACEMENT_UTF8 "\xEF\xBF\xBD"
+/** 文字コード変換で変換できない文字の代替文字（Shift_JIS/ASCII出力時） */
+#define CMN_STRING_REPLACEMENT_CHAR '?'
+
 /* --- CmnString.c --- */
 D_EXTERN char *CmnString_RTrim(char *str);
 D_EXTERN char *CmnString_LTrim(char *str);
@@ -48,6 +117,8 @@ D_EXTERN int CmnString_StartWith(const char *str, const char *mark);
 D_EXTERN int CmnString_EndWith(const char *str, const char *mark);
 D_EXTERN int CmnString_IndexOf(const char *str, const char *mark);
 D_EXTERN int CmnString_LastIndexOf(const char *str, const char *mark);
+D_EXTERN unsigned long long CmnString_Hash(const char *str);
+D_EXTERN unsigned long long CmnString_HashSeed(const char *str, unsigned long long seed);
 
 /* --- CmnStringList.c --- */
 D_EXTERN CmnStringList *CmnStringList_Create();
@@ -55,9 +126,108 @@ D_EXTERN void CmnStringList_Free(CmnStringList *list);
 D_EXTERN void CmnStringList_Add(CmnStringList *list, const char *str);
 D_EXTERN char *CmnStringList_Get(CmnStringList *list, int index);
 
+/* --- CmnStringNumber.c --- */
+D_EXTERN size_t CmnString_FormatInt(long long value, char *buf);
+D_EXTERN size_t CmnString_FormatUInt(unsigned long long value, char *buf);
+D_EXTERN size_t CmnString_FormatUIntPad(unsigned long long value, size_t digit, char *buf);
+D_EXTERN size_t CmnString_FormatDouble(double value, char *buf);
+D_EXTERN CmnStringParseResult CmnString_ParseInt(const char *str, size_t len, long long *value);
+D_EXTERN CmnStringParseResult CmnString_ParseUInt(const char *str, size_t len, unsigned long long *value);
+D_EXTERN CmnStringParseResult CmnString_ParseDouble(const char *str, size_t len, double *value);
+D_EXTERN int CmnStringBuffer_AppendInt(CmnStringBuffer *buf, long long value);
+D_EXTERN int CmnStringBuffer_AppendDouble(CmnStringBuffer *buf, double value);
+
+/* --- CmnStringCase.c --- */
+D_EXTERN int CmnString_CompareIgnoreCase(const char *s1, const char *s2);
+D_EXTERN int CmnString_CompareIgnoreCaseN(const char *s1, size_t len1, const char *s2, size_t len2);
+D_EXTERN int CmnString_EqualsIgnoreCaseN(const char *s1, const char *s2, size_t len);
+D_EXTERN int CmnString_StartWithIgnoreCase(const char *str, const char *mark);
+D_EXTERN int CmnString_EndWithIgnoreCase(const char *str, const char *mark);
+D_EXTERN int CmnString_IndexOfIgnoreCase(const char *str, const char *mark);
+D_EXTERN const char* CmnString_FindIgnoreCase(const char *str, size_t len, const char *mark, size_t markLen);
+D_EXTERN unsigned long long CmnString_HashIgnoreCase(const char *str);
+D_EXTERN unsigned long long CmnString_HashIgnoreCaseN(const char *str, size_t len, unsigned long long seed);
+
+/* --- CmnStringCharset.c --- */
+D_EXTERN size_t CmnString_AsciiLength(const char *str, size_t len);
+D_EXTERN int CmnString_IsAscii(const char *str, size_t len);
+D_EXTERN size_t CmnString_Utf8ValidLength(const char *str, size_t len);
+D_EXTERN int CmnString_IsUtf8(const char *str, size_t len);
+D_EXTERN int CmnString_IsSjis(const char *str, size_t len);
+D_EXTERN CHARSET CmnString_DetectCharset(const char *str, size_t len);
+D_EXTERN int CmnStringBuffer_AppendSjisToUtf8(CmnStringBuffer *buf, const char *str, size_t len);
+D_EXTERN int CmnStringBuffer_AppendUtf8ToSjis(CmnStringBuffer *buf, const char *str, size_t len);
+D_EXTERN int CmnStringBuffer_AppendConvert(CmnStringBuffer *buf, const char *str, size_t len, CHARSET from, CHARSET to);
+
+/* --- CmnStringRegex.c --- */
+D_EXTERN CmnStringRegex* CmnStringRegex_Compile(const char *pattern, int flags);
+D_EXTERN CmnStringRegex* CmnStringRegex_CompileSet(const char *const *patterns, int count, int flags);
+D_EXTERN int CmnStringRegex_Search(CmnStringRegex *re, const char *str, size_t len);
+D_EXTERN int CmnStringRegex_Match(CmnStringRegex *re, const char *str, size_t len);
+D_EXTERN int CmnStringRegex_SearchId(CmnStringRegex *re, const char *str, size_t len);
+D_EXTERN int CmnStringRegex_MatchId(CmnStringRegex *re, const char *str, size_t len);
+D_EXTERN void CmnStringRegex_Free(CmnStringRegex *re);
+
+/* --- CmnStringView.c --- */
+D_EXTERN CmnStringView* CmnString_LTrimView(const char *str, size_t len, CmnStringView *view);
+D_EXTERN CmnStringView* CmnString_RTrimView(const char *str, size_t len, CmnStringView *view);
+D_EXTERN CmnStringView* CmnString_TrimView(const char *str, size_t len, CmnStringView *view);
+D_EXTERN int CmnString_SplitKeyValue(const char *str, size_t len, char delim, CmnStringView *key, CmnStringView *value);
+D_EXTERN size_t CmnString_LineView(const char *str, size_t len, CmnStringView *line);
+D_EXTERN char* CmnStringView_CopyNew(const CmnStringView *view);
+D_EXTERN int CmnStringView_Equals(const CmnStringView *view, const char *str);
+
+/* --- CmnStringCsv.c --- */
+D_EXTERN CmnStringCsv* CmnStringCsv_Create(const char *data, size_t len, char delim);
+D_EXTERN CmnStringCsv* CmnStringCsv_CreateFromFile(FILE *fp, char delim);
+D_EXTERN int CmnStringCsv_SetColumns(CmnStringCsv *csv, const int *columns, int count);
+D_EXTERN int CmnStringCsv_Next(CmnStringCsv *csv, const CmnStringView **fields);
+D_EXTERN void CmnStringCsv_Free(CmnStringCsv *csv);
+
+/* --- CmnStringGlob.c --- */
+D_EXTERN int CmnString_Glob(const char *pattern, const char *str, int flags);
+D_EXTERN CmnStringGlob* CmnStringGlob_Compile(const char *pattern, int flags);
+D_EXTERN CmnStringGlob* CmnStringGlob_CompileSet(const char *const *patterns, int count, int flags);
+D_EXTERN int CmnStringGlob_Match(CmnStringGlob *glob, const char *str);
+D_EXTERN int CmnStringGlob_MatchId(CmnStringGlob *glob, const char *str);
+D_EXTERN void CmnStringGlob_Free(CmnStringGlob *glob);
+
+/* --- CmnStringCodec.c --- */
+D_EXTERN size_t CmnString_HexEncode(const void *data, size_t len, int upper, char *buf);
+D_EXTERN int CmnString_HexDecode(const char *str, size_t len, void *buf, size_t *outLen);
+D_EXTERN size_t CmnString_Base64EncodedSize(size_t len, int mode);
+D_EXTERN size_t CmnString_Base64DecodedSize(const char *str, size_t len);
+D_EXTERN size_t CmnString_Base64Encode(const void *data, size_t len, int mode, char *buf);
+D_EXTERN int CmnString_Base64Decode(const char *str, size_t len, void *buf, size_t *outLen);
+D_EXTERN size_t CmnString_PercentEncodedSize(const char *str, size_t len, int mode);
+D_EXTERN size_t CmnString_PercentEncode(const char *str, size_t len, int mode, char *buf);
+D_EXTERN int CmnString_PercentDecode(const char *str, size_t len, int mode, char *buf, size_t *outLen);
+D_EXTERN int CmnStringBuffer_AppendHex(CmnStringBuffer *buf, const void *data, size_t len, int upper);
+D_EXTERN int CmnStringBuffer_AppendBase64(CmnStringBuffer *buf, const void *data, size_t len, int mode);
+D_EXTERN int CmnStringBuffer_AppendPercent(CmnStringBuffer *buf, const char *str, size_t len, int mode);
+D_EXTERN void CmnStringBase64_Init(CmnStringBase64 *state, int mode);
+D_EXTERN size_t CmnStringBase64_Encode(CmnStringBase64 *state, const void *data, size_t len, char *buf);
+D_EXTERN size_t CmnStringBase64_EncodeFinal(CmnStringBase64 *state, char *buf);
+D_EXTERN int CmnStringBase64_Decode(CmnStringBase64 *state, const char *str, size_t len, void *buf, size_t *outLen);
+D_EXTERN int CmnStringBase64_DecodeFinal(CmnStringBase64 *state, void *buf, size_t *outLen);
+
+/* --- CmnStringFormat.c --- */
+D_EXTERN size_t CmnString_Format(char *buf, size_t size, const char *format, ...) CMN_PRINTF_FORMAT(3, 4);
+D_EXTERN size_t CmnString_VFormat(char *buf, size_t size, const char *format, va_list args);
+D_EXTERN CmnStringFormat* CmnStringFormat_Compile(const char *format);
+D_EXTERN size_t CmnStringFormat_Format(const CmnStringFormat *fmt, char *buf, size_t size, ...);
+D_EXTERN size_t CmnStringFormat_VFormat(const CmnStringFormat *fmt, char *buf, size_t size, va_list args);
+D_EXTERN void CmnStringFormat_Free(CmnStringFormat *fmt);
+
 /* --- CmnStringBuffer.c --- */
 D_EXTERN CmnStringBuffer* CmnStringBuffer_Create(const char *str);
 D_EXTERN int CmnStringBuffer_Append(CmnStringBuffer *buf, const char *str);
+D_EXTERN int CmnStringBuffer_AppendN(CmnStringBuffer *buf, const char *str, size_t len);
+D_EXTERN int CmnStringBuffer_AppendFormat(CmnStringBuffer *buf, const char *format, ...) CMN_PRINTF_FORMAT(2, 3);
+D_EXTERN int CmnStringBuffer_AppendVFormat(CmnStringBuffer *buf, const char *format, va_list args);
+D_EXTERN int CmnStringBuffer_Insert(CmnStringBuffer *buf, size_t index, const char *str, size_t len);
+D_EXTERN void CmnStringBuffer_Erase(CmnStringBuffer *buf, size_t index, size_t len);
+D_EXTERN int CmnStringBuffer_Reserve(CmnStringBuffer *buf, size_t length);
 D_EXTERN int CmnStringBuffer_Set(CmnStringBuffer *buf, const char *str);
 D_EXTERN int CmnStringBuffer_SetByCmnDataBuffer(CmnStringBuffer *buf, const CmnDataBuffer *dat);
 D_EXTERN void CmnStringBuffer_Free(CmnStringBuffer *buf);
@@ -29,6 +29,25 @@ typedef struct tag_CmnThreadMutex {
 
 } CmnThreadMutex;
 
+/** 条件変数オブジェクト */
+typedef struct tag_CmnThreadCond {
+#if IS_PRATFORM_WINDOWS()
+	HANDLE semaphoreId;		/**< 待機中のスレッドを起こすセマフォ */
+	int waiters;			/**< 待機中のスレッド数（Mutexで保護） */
+#else
+	pthread_cond_t condId;	/**< cond id */
+#endif
+} CmnThreadCond;
+
+/** 一度だけ実行する処理の制御オブジェクト（CMN_THREAD_ONCE_INITで静的に初期化すること） */
+#if IS_PRATFORM_WINDOWS()
+typedef INIT_ONCE CmnThreadOnce;
+#define CMN_THREAD_ONCE_INIT INIT_ONCE_STATIC_INIT
+#else
+typedef pthread_once_t CmnThreadOnce;
+#define CMN_THREAD_ONCE_INIT PTHREAD_ONCE_INIT
+#endif
+
 /** スレッドオブジェクト */
 typedef struct tag_CmnThread {
 #if IS_PRATFORM_WINDOWS()
@@ -51,4 +70,12 @@ D_EXTERN void CmnThreadMutex_Lock(CmnThreadMutex *mutex);
 D_EXTERN void CmnThreadMutex_UnLock(CmnThreadMutex *mutex);
 D_EXTERN void CmnThreadMutex_Free(CmnThreadMutex *mutex);
 
+D_EXTERN CmnThreadCond* CmnThreadCond_Create();
+D_EXTERN int CmnThreadCond_Wait(CmnThreadCond *cond, CmnThreadMutex *mutex, long timeout);
+D_EXTERN void CmnThreadCond_Signal(CmnThreadCond *cond);
+D_EXTERN void CmnThreadCond_Broadcast(CmnThreadCond *cond);
+D_EXTERN void CmnThreadCond_Free(CmnThreadCond *cond);
+
+D_EXTERN void CmnThread_Once(CmnThreadOnce *once, void (*func)(void));
+
 #endif /* CMNCLIB_CMN_THREAD_H_ */
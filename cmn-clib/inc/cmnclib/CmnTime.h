@@ -69,6 +69,8 @@ D_EXTERN char* CmnTimeDateTime_ToString(const CmnTimeDateTime *datetime, char *b
 D_EXTERN char* CmnTime_Format(const CmnTimeDateTime *datetime, const CmnTimeFormatType type, char *buf);
 /* 指定ミリ秒スリープする */
 D_EXTERN void CmnTime_Sleep(unsigned long long msec);
+/* 経過時間（ミリ秒）を取得する */
+D_EXTERN unsigned long long CmnTime_GetTickCount(void);
 
 #endif /* CMNCLIB_CMN_TIME_H */
 
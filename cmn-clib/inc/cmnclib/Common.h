@@ -24,6 +24,13 @@
   #endif
 #endif
 
+/* SIMD命令の使用可否（コンパイラがSSE2を有効にしている場合のみ使用する）。CMN_CLIB_NO_SIMDを定義すると使用しない。 */
+#ifndef CMN_CLIB_NO_SIMD
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CMN_CLIB_USE_SSE2 1
+  #endif
+#endif
+
 /* 真偽値 */
 #ifndef True
   #define True      1  /**< 真 */
@@ -61,6 +68,13 @@ typedef enum enmCHARSET {
   #define _WINSOCKAPI_ /* Prevent includsion of winsock.h in windows.h */
 #endif
 
+/** printf形式の書式と可変引数の型をコンパイル時に検査する（GCC、Clangのみ。fmtは書式、argsは可変引数の引数位置） */
+#if defined(__GNUC__)
+  #define CMN_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+  #define CMN_PRINTF_FORMAT(fmt, args)
+#endif
+
 /* DLL使用かLIB使用かによるプロトタイプ切り替え */
 #ifdef _USRDLL
   /* DLL作成 */
@@ -0,0 +1,45 @@
+/** @file *********************************************************************
+ * @brief ビット操作 内部ヘッダファイル
+ *
+ *  ライブラリ内部で共有するビット操作の関数（公開ヘッダではないため、ライブラリの外から使用しないこと）。<br>
+ *  SIMD命令で16バイトを比較した結果のマスク（_mm_movemask_epi8）から、一致した位置を求めるのに使う。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+
+#ifndef CMNCLIB_CMN_BIT_H_
+#define CMNCLIB_CMN_BIT_H_
+
+#ifdef _MSC_VER
+  #include<intrin.h>
+  #define CMN_BIT_INLINE __inline
+#else
+  #define CMN_BIT_INLINE inline
+#endif
+
+/** 最下位の1のビット位置（maskは0以外であること） */
+static CMN_BIT_INLINE int firstBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanForward(&bit, mask);
+	return (int)bit;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+/** 最上位の1のビット位置（maskは0以外であること） */
+static CMN_BIT_INLINE int lastBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanReverse(&bit, mask);
+	return (int)bit;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+#endif /* CMNCLIB_CMN_BIT_H_ */
@@ -14,7 +14,7 @@
  *      　　"   Name         = Value        "<BR>
  *      　ただし、以下の表現の場合は、空白は空白として認識される。<BR>
  *      　　"Na me=V a l u e"<BR>
- *      ・タブは使用不可<BR>
+ *      ・Name、Valueの前後のタブ、改行も空白と同様に無視される<BR>
  *      ・プロパティ定義は、必ず1行で完結すること。<BR>
  *      　複数行にまたがる定義はみとめない。<BR>
  *      ・無効な書式での定義は無視される。（プロパティとして読み込まない）<BR>
@@ -37,12 +37,6 @@
 #define PROP_BUF_SIZE  4096		/* プロパティファイル１行の最大文字数  */
 #define COMMENT_CHAR   '#'		/* コメント識別文字                    */
 #define PAUSE_CHAR     '='		/* プロパティ名と値の区切り文字        */
-/* 改行文字（Win32の場合は"\r\n"となるので、'\r'を改行文字として扱う） */
-#ifdef WIN32
-	#define RETURN_CHAR  '\r'
-#else
-	#define RETURN_CHAR  '\n'
-#endif
 
 /**
  * @brief プロパティリスト取得
@@ -54,19 +48,20 @@
  *
  * @param file      (I)プロパティ定義ファイル（フルパスで指定すること）
  * @return 取得したプロパティリスト(CmnConf_PropertyList)へのポインタ。<BR>
- *         プロパティの取得に失敗した場合はNULLを返す。
+ *         プロパティの取得に失敗した場合（メモリ不足の場合を含む）はNULLを返す。
  * @author H.Kumagai
  */
 CmnConfProperty *CmnConfProperty_Load(const char *file)
 {
 	char  buf[PROP_BUF_SIZE + 1];
-	char *comment_pos;
-	char *name_pos;
-	char *name_buf;
-	char *value_pos;
-	char *value_buf;
+	const char *comment_pos;
+	size_t len;
+	CmnStringView line;
+	CmnStringView name;
+	CmnStringView value;
 	FILE *prop_fp;
 	CmnConfProperty *list = NULL;
+	CmnConfProperty *tail = NULL;
 	CmnConfProperty *tmp;
 	CMNLOG_TRACE_START();
 
@@ -77,59 +72,51 @@ CmnConfProperty *CmnConfProperty_Load(const char *file)
 	}
 
 	while (fgets(buf, PROP_BUF_SIZE, prop_fp)) {
-		/* 行頭、行末の空白を除去 */
-		memmove(buf, CmnString_Trim(buf), strlen(CmnString_Trim(buf)) + 1);
+		/* 行頭、行末の空白と改行コードを除去 */
+		len = strlen(buf);
+		CmnString_TrimView(buf, len, &line);
 
 		/* 行頭からのコメントもしくは空行であれば無視 */
-		if (buf[0] == RETURN_CHAR || buf[0] == COMMENT_CHAR) {
+		if (line.len == 0 || line.str[0] == COMMENT_CHAR) {
 			continue ;
 		}
-		/* 改行コードを除去 */
-		if (buf[strlen(buf) - 1] == RETURN_CHAR) {
-			buf[strlen(buf) - 1] = '\0';
-		}
 		/* コメントを除去 */
-		comment_pos = strchr(buf, COMMENT_CHAR);
+		comment_pos = memchr(line.str, COMMENT_CHAR, line.len);
 		if (comment_pos != NULL) {
-			*comment_pos = '\0';
+			line.len = comment_pos - line.str;
 		}
 
-		/* NameとValueへのポインタを取得（同時に'='を'\0'に変換） */
-		value_pos = strchr( buf, PAUSE_CHAR );
-		if (value_pos == NULL) {
+		/* NameとValueを取得（前後の空白は除去済み） */
+		if (CmnString_SplitKeyValue(line.str, line.len, PAUSE_CHAR, &name, &value) != 0) {
 			continue ;
 		}
-		*value_pos = '\0';
-		value_pos++ ;
-		name_pos = buf;
-
-		/* コードとメッセージの領域を確保 */
-		name_buf = malloc(strlen(CmnString_Trim(name_pos)) + 1);
-		strcpy(name_buf, CmnString_Trim(name_pos));
-		value_buf = malloc(strlen(CmnString_Trim(value_pos)) + 1);
-		strcpy(value_buf, CmnString_Trim(value_pos));
 
-		/* 最初のリストを作成 */
-		if (list == NULL) {
-			list = (CmnConfProperty *)calloc(1, sizeof(CmnConfProperty));
-			if (list == NULL) {
-				return NULL;
+		/* リストの末尾に追加 */
+		tmp = (CmnConfProperty *)calloc(1, sizeof(CmnConfProperty));
+		if (tmp != NULL) {
+			tmp->name  = CmnStringView_CopyNew(&name);
+			tmp->value = CmnStringView_CopyNew(&value);
+			tmp->next  = NULL;
+		}
+		if (tmp == NULL || tmp->name == NULL || tmp->value == NULL) {
+			/* メモリ不足の場合は途中までのリストを返さない */
+			if (tmp != NULL) {
+				free(tmp->name);
+				free(tmp->value);
+				free(tmp);
 			}
-			list->name  = name_buf;
-			list->value = value_buf;
-			list->next  = NULL;
+			CmnConfProperty_Free(list);
+			fclose(prop_fp);
+			CMNLOG_TRACE_END();
+			return NULL;
+		}
+		if (list == NULL) {
+			list = tmp;
 		}
-		/* 2番目以降のリストを作成 */
 		else {
-			tmp = list;
-			while (tmp->next != NULL) {
-				tmp = tmp->next;
-			}
-			tmp->next = (CmnConfProperty *)calloc(1, sizeof(CmnConfProperty));
-			tmp->next->name  = name_buf;
-			tmp->next->value = value_buf;
-			tmp->next->next  = NULL;
+			tail->next = tmp;
 		}
+		tail = tmp;
 	}
 	fclose(prop_fp);
 
@@ -191,3 +178,30 @@ char *CmnConfProperty_GetValue(const CmnConfProperty *list, const char *name )
 	return NULL;
 }
 
+
+/**
+ * @brief プロパティ値取得（整数）
+ *
+ *   nameに指定されたプロパティ値をlistから取得し、整数に変換する。<BR>
+ *   atoiと異なり、数値以外の文字を含む値や範囲外の値はエラーとする。
+ *
+ * @param list      (I)   プロパティリスト（CmnConf_GetPropertyList関数の戻り値）
+ * @param name      (I)   取得するプロパティ名
+ * @param value     (O)   変換後の値。エラーの場合は変更しない。
+ * @return 正常:0、nameに該当が無い場合や値が整数でない場合:-1
+ */
+int CmnConfProperty_GetIntValue(const CmnConfProperty *list, const char *name, long long *value)
+{
+	char *str;
+	CMNLOG_TRACE_START();
+
+	str = CmnConfProperty_GetValue(list, name);
+	if (str == NULL || CmnString_ParseInt(str, strlen(str), value) != CMN_STRING_PARSE_OK) {
+		CMNLOG_DEBUG("Invalid integer property, name=%s", name);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
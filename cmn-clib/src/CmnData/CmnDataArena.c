@@ -0,0 +1,201 @@
+/** @file *********************************************************************
+ * @brief アリーナ（一括解放メモリ領域） 共通関数
+ *
+ *  小さな領域を大量に確保し、最後にまとめて解放する用途（構文木、JSONのDOM等）のためのメモリ領域。<br>
+ *  大きめの領域（チャンク）から先頭順に切り出すため、個々の確保はポインタの加算のみで行える。
+ *  個々の領域の解放はできず、CmnDataArena_Reset/CmnDataArena_Freeで全体を解放する。<br>
+ *  CmnDataArena_Alloc等は呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/CmnData.h"
+#include "cmnclib/CmnLog.h"
+
+/** チャンクのデフォルトサイズ */
+#define DEFAULT_CHUNK_SIZE (64 * 1024)
+/** 確保する領域の境界（double、ポインタを格納できる境界） */
+#define ARENA_ALIGN 16
+
+/** チャンク */
+typedef struct _tag_Chunk {
+	struct _tag_Chunk *next;	/**< 次のチャンク（先に確保したもの） */
+	size_t size;				/**< dataのサイズ */
+	size_t used;				/**< 使用済みのサイズ */
+	/* この後にデータ領域が続く */
+} Chunk;
+
+/** アリーナ */
+struct _tag_CmnDataArena {
+	Chunk *current;				/**< 切り出し中のチャンク（先頭） */
+	size_t chunkSize;			/**< チャンクのサイズ */
+	size_t totalSize;			/**< 確保したチャンクの合計サイズ */
+};
+
+/** チャンクのヘッダのサイズ（データ領域の先頭を境界に合わせる） */
+#define CHUNK_HEADER_SIZE ((sizeof(Chunk) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+/** チャンクのデータ領域 */
+#define CHUNK_DATA(chunk) ((char *)(chunk) + CHUNK_HEADER_SIZE)
+
+static Chunk* newChunk(CmnDataArena *arena, size_t size);
+
+/**
+ * @brief アリーナ作成
+ *
+ * @param chunkSize 一度に確保するチャンクのサイズ。0を指定した場合はデフォルト（64KB）が適用される。
+ * @return 作成したアリーナ。作成に失敗した場合はNULL。使用後はCmnDataArena_Freeで解放すること。
+ */
+CmnDataArena* CmnDataArena_Create(size_t chunkSize)
+{
+	CmnDataArena *arena;
+	CMNLOG_TRACE_START();
+
+	arena = calloc(1, sizeof(CmnDataArena));
+	if (arena != NULL) {
+		arena->chunkSize = (chunkSize == 0) ? DEFAULT_CHUNK_SIZE : chunkSize;
+	}
+
+	CMNLOG_TRACE_END();
+	return arena;
+}
+
+/**
+ * @brief 領域の確保
+ *
+ *  アリーナから領域を確保する。領域は16バイト境界に配置され、内容は不定。
+ *
+ * @param arena アリーナ
+ * @param size 確保するサイズ
+ * @return 確保した領域。メモリ不足の場合はNULL。
+ */
+void* CmnDataArena_Alloc(CmnDataArena *arena, size_t size)
+{
+	Chunk *chunk = arena->current;
+	size_t aligned = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	void *p;
+
+	if (aligned < size) {
+		return NULL;
+	}
+	if (chunk == NULL || chunk->size - chunk->used < aligned) {
+		if (aligned > arena->chunkSize / 4) {
+			/* 大きな領域は専用のチャンクとし、切り出し中のチャンクの後ろにつなぐ */
+			Chunk *large = newChunk(arena, aligned);
+			if (large == NULL) {
+				return NULL;
+			}
+			large->used = aligned;
+			if (chunk != NULL) {
+				large->next = chunk->next;
+				chunk->next = large;
+			}
+			else {
+				arena->current = large;
+			}
+			return CHUNK_DATA(large);
+		}
+		chunk = newChunk(arena, arena->chunkSize);
+		if (chunk == NULL) {
+			return NULL;
+		}
+		chunk->next = arena->current;
+		arena->current = chunk;
+	}
+
+	p = CHUNK_DATA(chunk) + chunk->used;
+	chunk->used += aligned;
+	return p;
+}
+
+/**
+ * @brief 文字列の複写
+ *
+ *  アリーナに文字列を複写し、'\0'で終端する。
+ *
+ * @param arena アリーナ
+ * @param str 複写する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 複写した文字列。メモリ不足の場合はNULL。
+ */
+char* CmnDataArena_CopyString(CmnDataArena *arena, const char *str, size_t len)
+{
+	char *p = CmnDataArena_Alloc(arena, len + 1);
+	if (p != NULL) {
+		memcpy(p, str, len);
+		p[len] = '\0';
+	}
+	return p;
+}
+
+/**
+ * @brief 全領域の解放（再利用）
+ *
+ *  確保したすべての領域を解放する。最後に確保したチャンクは解放せずに再利用する。
+ *
+ * @param arena アリーナ
+ */
+void CmnDataArena_Reset(CmnDataArena *arena)
+{
+	Chunk *chunk, *next;
+	CMNLOG_TRACE_START();
+
+	if (arena->current != NULL) {
+		for (chunk = arena->current->next; chunk != NULL; chunk = next) {
+			next = chunk->next;
+			free(chunk);
+		}
+		arena->current->next = NULL;
+		arena->current->used = 0;
+		arena->totalSize = arena->current->size;
+	}
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief 確保したチャンクの合計サイズ
+ *
+ * @param arena アリーナ
+ * @return 確保したチャンクの合計サイズ（バイト）
+ */
+size_t CmnDataArena_GetTotalSize(const CmnDataArena *arena)
+{
+	return arena->totalSize;
+}
+
+/**
+ * @brief アリーナの解放
+ *
+ * @param arena アリーナ
+ */
+void CmnDataArena_Free(CmnDataArena *arena)
+{
+	Chunk *chunk, *next;
+	CMNLOG_TRACE_START();
+
+	if (arena != NULL) {
+		for (chunk = arena->current; chunk != NULL; chunk = next) {
+			next = chunk->next;
+			free(chunk);
+		}
+		free(arena);
+	}
+
+	CMNLOG_TRACE_END();
+}
+
+/** チャンクの確保 */
+static Chunk* newChunk(CmnDataArena *arena, size_t size)
+{
+	Chunk *chunk = malloc(CHUNK_HEADER_SIZE + size);
+	if (chunk != NULL) {
+		chunk->next = NULL;
+		chunk->size = size;
+		chunk->used = 0;
+		arena->totalSize += size;
+	}
+	return chunk;
+}
@@ -140,6 +140,38 @@ int CmnDataBuffer_Set(CmnDataBuffer *buf, const void *data, size_t len)
 	return 0;
 }
 
+/**
+ * @brief 自動領域拡張バッファの領域予約
+ *
+ *  バッファ領域がbufSize以上になるよう、あらかじめ領域を拡張する。<br>
+ *  すでに十分な領域がある場合は何もしない。有効なデータは変更しない。
+ *
+ * @param buf 自動拡張バッファ
+ * @param bufSize 予約するバッファ領域のサイズ
+ * @return 正常:0, エラー:-1
+ */
+int CmnDataBuffer_Reserve(CmnDataBuffer *buf, size_t bufSize)
+{
+	void *buftmp;
+	CMNLOG_TRACE_START();
+
+	if (bufSize <= buf->bufSize) {
+		CMNLOG_TRACE_END();
+		return 0;
+	}
+
+	buftmp = realloc(buf->data, bufSize);
+	if (buftmp == NULL) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	buf->data = buftmp;
+	buf->bufSize = bufSize;
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
 /**
  * @brief 自動領域拡張バッファのデータ削除
  *
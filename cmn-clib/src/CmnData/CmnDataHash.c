@@ -0,0 +1,364 @@
+/** @file *********************************************************************
+ * @brief ハッシュ関数 共通関数
+ *
+ *  マップ、キャッシュ、重複排除などで共通に使用する非暗号学的ハッシュ関数。<br>
+ *  wyhash方式（64bit乗算の128bit結果の上位と下位をXORして混ぜる）で、48バイト単位に3系列を並行して処理する。<br>
+ *  一括計算（CmnData_Hash）と逐次計算（CmnDataHash_Update）は同じデータに対して同じ値を返す。<br>
+ *  外部からの入力をキーにする場合は、CmnData_HashRandomSeedで得たシードを使用することでハッシュ衝突攻撃を防ぐこと。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#if defined(_WIN32) && !defined(_CRT_RAND_S)
+  #define _CRT_RAND_S
+#endif
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnData.h"
+#include"cmnclib/CmnLog.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+  #include<intrin.h>
+#endif
+
+/* 混合用の定数 */
+#define P0 0xa0761d6478bd642fULL
+#define P1 0xe7037ed1a0b428dbULL
+#define P2 0x8ebc6af09c88c6dbULL
+#define P3 0x589965cc75374cc3ULL
+
+/** 1度に処理するブロックのバイト数 */
+#define BLOCK_SIZE 48
+
+static void mum(unsigned long long *a, unsigned long long *b);
+static unsigned long long mix(unsigned long long a, unsigned long long b);
+static unsigned long long read8(const unsigned char *p);
+static unsigned long long read4(const unsigned char *p);
+static void processBlock(CmnDataHash *state, const unsigned char *p);
+static void finalize(const CmnDataHash *state, CmnDataHash128 *result);
+
+/**
+ * @brief ハッシュ値計算
+ *
+ *  データの64bitハッシュ値を計算する（シード0）。
+ *
+ * @param data データ
+ * @param len dataのバイト数
+ * @return ハッシュ値
+ */
+unsigned long long CmnData_Hash(const void *data, size_t len)
+{
+	return CmnData_HashSeed(data, len, 0);
+}
+
+/**
+ * @brief シード指定ハッシュ値計算
+ *
+ *  シードを指定してデータの64bitハッシュ値を計算する。<br>
+ *  シードが異なると同じデータでも異なるハッシュ値になる。
+ *
+ * @param data データ
+ * @param len dataのバイト数
+ * @param seed シード
+ * @return ハッシュ値
+ */
+unsigned long long CmnData_HashSeed(const void *data, size_t len, unsigned long long seed)
+{
+	CmnDataHash128 result;
+	CmnData_Hash128(data, len, seed, &result);
+	return result.low;
+}
+
+/**
+ * @brief 128bitハッシュ値計算
+ *
+ *  シードを指定してデータの128bitハッシュ値を計算する。<br>
+ *  下位64bitはCmnData_HashSeedと同じ値になる。<br>
+ *  計算途中の状態は系列ごとに64bitで、上位と下位はその状態から導出するため、衝突への耐性は64bitハッシュ値と同程度
+ *  （約2^32件で衝突が起こり得る）。
+ *  衝突しないことを前提にする用途（内容の同一性の判定など）には使用しないこと。
+ *
+ * @param data データ
+ * @param len dataのバイト数
+ * @param seed シード
+ * @param result (O) ハッシュ値
+ */
+void CmnData_Hash128(const void *data, size_t len, unsigned long long seed, CmnDataHash128 *result)
+{
+	const unsigned char *p = data;
+	CmnDataHash state;
+
+	CmnDataHash_Init(&state, seed);
+	state._totalLen = len;
+
+	/* 最後のブロック（1～48バイト）は終了処理で扱う */
+	while (len > BLOCK_SIZE) {
+		processBlock(&state, p);
+		p += BLOCK_SIZE;
+		len -= BLOCK_SIZE;
+	}
+	memcpy(state._buf, p, len);
+	state._bufLen = len;
+
+	finalize(&state, result);
+}
+
+/**
+ * @brief ランダムなシードの取得
+ *
+ *  ハッシュ衝突攻撃を防ぐための予測困難なシードを取得する。<br>
+ *  プロセス起動時などに1回だけ取得し、以降は同じシードを使い続けること。
+ *
+ * @return シード
+ */
+unsigned long long CmnData_HashRandomSeed(void)
+{
+	unsigned long long seed = 0;
+	static unsigned long long counter = 0;
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	{
+		unsigned int r1, r2;
+		if (rand_s(&r1) == 0 && rand_s(&r2) == 0) {
+			seed = ((unsigned long long)r1 << 32) | r2;
+		}
+	}
+#else
+	{
+		FILE *fp = fopen("/dev/urandom", "rb");
+		if (fp != NULL) {
+			if (fread(&seed, sizeof(seed), 1, fp) != 1) {
+				seed = 0;
+			}
+			fclose(fp);
+		}
+	}
+#endif
+
+	/* 乱数が取得できない場合は時刻とアドレスから生成 */
+	if (seed == 0) {
+		seed = mix((unsigned long long)time(NULL) ^ P0, (unsigned long long)clock() ^ P1);
+		seed = mix(seed ^ (unsigned long long)(size_t)&seed, (++counter) ^ P2);
+	}
+
+	CMNLOG_TRACE_END();
+	return seed;
+}
+
+/**
+ * @brief 逐次ハッシュ計算の初期化
+ *
+ *  データを分割して与えるハッシュ計算を開始する。<br>
+ *  CmnDataHash_Updateでデータを与え、CmnDataHash_Finalでハッシュ値を取得する。
+ *
+ * @param state (O) 計算状態
+ * @param seed シード
+ */
+void CmnDataHash_Init(CmnDataHash *state, unsigned long long seed)
+{
+	seed ^= mix(seed ^ P0, P1);
+	state->_seed[0] = seed;
+	state->_seed[1] = seed;
+	state->_seed[2] = seed;
+	state->_bufLen = 0;
+	state->_totalLen = 0;
+}
+
+/**
+ * @brief 逐次ハッシュ計算へのデータ追加
+ *
+ *  ハッシュ計算の対象データを追加する。分割位置によらず、一括計算と同じハッシュ値になる。
+ *
+ * @param state 計算状態
+ * @param data 追加するデータ
+ * @param len dataのバイト数
+ */
+void CmnDataHash_Update(CmnDataHash *state, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	size_t fill;
+
+	state->_totalLen += len;
+
+	/* 保留中のデータに追加しても1ブロックを超えない場合は保留するのみ */
+	if (state->_bufLen + len <= BLOCK_SIZE) {
+		memcpy(state->_buf + state->_bufLen, p, len);
+		state->_bufLen += len;
+		return;
+	}
+
+	/* 保留中のデータでブロックを完成させて処理 */
+	if (state->_bufLen > 0) {
+		fill = BLOCK_SIZE - state->_bufLen;
+		memcpy(state->_buf + state->_bufLen, p, fill);
+		processBlock(state, state->_buf);
+		p += fill;
+		len -= fill;
+	}
+
+	/* 最後の1～48バイトは終了処理のために保留 */
+	while (len > BLOCK_SIZE) {
+		processBlock(state, p);
+		p += BLOCK_SIZE;
+		len -= BLOCK_SIZE;
+	}
+	memcpy(state->_buf, p, len);
+	state->_bufLen = len;
+}
+
+/**
+ * @brief 逐次ハッシュ計算へのバッファ内容追加
+ *
+ *  自動領域拡張バッファの有効なデータ（size分）をハッシュ計算の対象に追加する。
+ *
+ * @param state 計算状態
+ * @param buf 追加するデータを保持するバッファ
+ */
+void CmnDataHash_UpdateBuffer(CmnDataHash *state, const CmnDataBuffer *buf)
+{
+	CmnDataHash_Update(state, buf->data, buf->size);
+}
+
+/**
+ * @brief 逐次ハッシュ計算の終了
+ *
+ *  それまでに追加したデータの64bitハッシュ値を返す。stateは変更しないため、続けてデータを追加することもできる。
+ *
+ * @param state 計算状態
+ * @return ハッシュ値
+ */
+unsigned long long CmnDataHash_Final(const CmnDataHash *state)
+{
+	CmnDataHash128 result;
+	finalize(state, &result);
+	return result.low;
+}
+
+/**
+ * @brief 逐次ハッシュ計算の終了（128bit）
+ *
+ *  それまでに追加したデータの128bitハッシュ値を返す（衝突への耐性はCmnData_Hash128と同じく64bit相当）。
+ *
+ * @param state 計算状態
+ * @param result (O) ハッシュ値
+ */
+void CmnDataHash_Final128(const CmnDataHash *state, CmnDataHash128 *result)
+{
+	finalize(state, result);
+}
+
+/**
+ * @brief 64bit乗算
+ *
+ *  a×bの128bitの結果の下位64bitをa、上位64bitをbに格納する。
+ */
+static void mum(unsigned long long *a, unsigned long long *b)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = (unsigned __int128)*a * *b;
+	*a = (unsigned long long)r;
+	*b = (unsigned long long)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	*a = _umul128(*a, *b, b);
+#else
+	unsigned long long ha = *a >> 32, hb = *b >> 32, la = (unsigned int)*a, lb = (unsigned int)*b;
+	unsigned long long rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	unsigned long long t = rl + (rm0 << 32);
+	unsigned long long c = t < rl;
+	unsigned long long lo = t + (rm1 << 32);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/**
+ * @brief 乗算による混合
+ *
+ *  a×bの128bitの結果の上位64bitと下位64bitのXORを返す。
+ */
+static unsigned long long mix(unsigned long long a, unsigned long long b)
+{
+	mum(&a, &b);
+	return a ^ b;
+}
+
+/** 8バイト読み込み（リトルエンディアン） */
+static unsigned long long read8(const unsigned char *p)
+{
+	unsigned long long v;
+	memcpy(&v, p, 8);
+	return v;
+}
+
+/** 4バイト読み込み（リトルエンディアン） */
+static unsigned long long read4(const unsigned char *p)
+{
+	unsigned int v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+/**
+ * @brief 1ブロック（48バイト）の処理
+ *
+ *  3系列を独立に混合し、乗算の待ち時間を隠蔽する。<br>
+ *  乗算の両方の項にシードを混ぜる（片方の項だけの場合、入力でその項をゼロにするとシードが消え、
+ *  シードによらない衝突を作れてしまう）。
+ */
+static void processBlock(CmnDataHash *state, const unsigned char *p)
+{
+	state->_seed[0] = mix(read8(p) ^ P1 ^ state->_seed[0], read8(p + 8) ^ state->_seed[0]);
+	state->_seed[1] = mix(read8(p + 16) ^ P2 ^ state->_seed[1], read8(p + 24) ^ state->_seed[1]);
+	state->_seed[2] = mix(read8(p + 32) ^ P3 ^ state->_seed[2], read8(p + 40) ^ state->_seed[2]);
+}
+
+/**
+ * @brief 終了処理
+ *
+ *  保留中の最後のブロック（0～48バイト）と全体のバイト数を混合してハッシュ値を求める。
+ */
+static void finalize(const CmnDataHash *state, CmnDataHash128 *result)
+{
+	const unsigned char *p = state->_buf;
+	size_t n = state->_bufLen;
+	unsigned long long seed = state->_seed[0] ^ state->_seed[1] ^ state->_seed[2];
+	unsigned long long len = state->_totalLen;
+	unsigned long long a, b;
+
+	if (n <= 16) {
+		if (n >= 4) {
+			a = (read4(p) << 32) | read4(p + ((n >> 3) << 2));
+			b = (read4(p + n - 4) << 32) | read4(p + n - 4 - ((n >> 3) << 2));
+		}
+		else if (n > 0) {
+			a = ((unsigned long long)p[0] << 16) | ((unsigned long long)p[n >> 1] << 8) | p[n - 1];
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		while (n > 16) {
+			seed = mix(read8(p) ^ P1 ^ seed, read8(p + 8) ^ seed);
+			p += 16;
+			n -= 16;
+		}
+		/* 最後の16バイト（直前の16バイトと重なる場合がある） */
+		a = read8(p + n - 16);
+		b = read8(p + n - 8);
+	}
+
+	a ^= P1 ^ seed;
+	b ^= seed;
+	mum(&a, &b);
+	result->low = mix(a ^ P0 ^ len, b ^ P1);
+	result->high = mix(a ^ P2, b ^ P3 ^ len);
+}
@@ -16,16 +16,42 @@
 
 #if IS_PRATFORM_WINDOWS()
 #include <windows.h>
+#include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #else
 #include <dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <limits.h>
+#include <errno.h>
 #endif
 
 #define BUF_SIZE 4096
 #define MAX_PATH_SIZE 2048
+/** ファイルのコピーで1回にコピーするサイズ */
+#define COPY_SIZE (1024 * 1024)
+/** 残りのサイズ（負の値は終端まで）に対して1回にコピーするサイズ */
+#define COPY_CHUNK(len) (((len) < 0 || (len) > COPY_SIZE) ? (size_t)COPY_SIZE : (size_t)(len))
+
+#if !IS_PRATFORM_WINDOWS()
+/* _GNU_SOURCEなしでは定義されないため、Linuxの値を定義する */
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#ifndef SEEK_DATA
+#define SEEK_DATA 3
+#define SEEK_HOLE 4
+#endif
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE 1
+#endif
+#endif
 
 #if IS_PRATFORM_WINDOWS()
 static CmnDataList* ListForWindows(const char *path, CmnDataList *list, CHARSET pathCharset);
@@ -36,80 +62,87 @@ static void FileStatToCmnFileInfo(CmnFileInfo *info, struct stat *stat);
 #endif
 
 static int WriteDataToFile(const char *path, void *data, size_t len, const char *mode);
+static int PrependDataToFile(const char *path, void *data, size_t len);
+#if !IS_PRATFORM_WINDOWS()
+static int WriteDataToFd(int fd, const char *data, size_t len);
+static int CopyFileData(int in, int out, long long len);
+static int CopySparseFileData(int in, int out, off_t size);
+static void SyncParentDirectory(const char *path);
+static int CopyRegularFile(const char *srcPath, const char *dstPath, int flags);
+static int MoveRegularFile(const char *srcPath, const char *dstPath, int flags);
+static int OpenTempFile(const char *path, mode_t mode, char *tmpPath, size_t tmpPathSize);
+#endif
+static FILE* OpenFileToRead(const char *path);
+static int ReadFileToBuffer(FILE *fp, const char *path, CmnDataBuffer *buf, size_t reserve);
+static size_t GetOpenFileSize(FILE *fp);
 
 /**
  * @brief ファイルをテキストデータとして全て読み込む
  *
- *  ファイルから読み込んだデータをbufにコピーして返却する。<br>
+ *  ファイルから読み込んだデータをbufに格納して返却する（bufの元の内容は置き換える）。<br>
+ *  ファイルサイズ分（と終端の'\0'）の領域を一度だけ確保し、文字列バッファに直接読み込む。<br>
  *  ファイルはバイナリモードで読み込む。改行コードの変換が必要であれば呼び出し側で行うこと。
  *
  * @param filePath ファイルパス
  * @param buf 読み込んだデータを格納する文字列バッファ
- * @return 読み込みに成功した場合はbufを返す。失敗した場合はNULLを返却する。
+ * @return 読み込みに成功した場合はbufを返す。失敗した場合はNULLを返却する
+ *         （ファイルを開けない場合はbufの内容は変更しない。読み込みの途中で失敗した場合、bufは空文字列になる）。
  */
 CmnStringBuffer* CmnFile_ReadAllText(const char *filePath, CmnStringBuffer *buf)
 {
-	CmnStringBuffer *ret;
-	CmnDataBuffer *dat;
+	FILE *fp;
+	int ret;
 	CMNLOG_TRACE_START();
 
-	dat = CmnDataBuffer_Create(0);
-	if (dat == NULL) {
+	if ((fp = OpenFileToRead(filePath)) == NULL) {
 		CMNLOG_TRACE_END();
 		return NULL;
 	}
 
-	if (CmnFile_ReadAll(filePath, dat) == NULL) {
-		CmnDataBuffer_Free(dat);
-		CMNLOG_TRACE_END();
-		return NULL;
-	}
+	/* 文字列バッファの領域に、終端の'\0'の1バイトを残して直接読み込む（元の内容は上書きする） */
+	buf->_buf->size = 0;
+	ret = ReadFileToBuffer(fp, filePath, buf->_buf, 1);
+	fclose(fp);
 
-	ret = NULL;
-	if (CmnStringBuffer_SetByCmnDataBuffer(buf, dat) == 0) {
-		/* 処理正常 */
-		ret = buf;
+	/* 失敗した場合は元の内容が残っていないため空文字列にする。領域を拡張した場合はアドレスが変わるため、いずれの場合も更新する */
+	if (ret != 0) {
+		buf->_buf->size = 0;
 	}
-	CmnDataBuffer_Free(dat);
+	buf->string = buf->_buf->data;
+	buf->length = buf->_buf->size;
+	buf->string[buf->length] = '\0';
+	buf->_buf->size = buf->length + 1;
 
 	CMNLOG_TRACE_END();
-	return ret;
+	return (ret == 0) ? buf : NULL;
 }
 
 /**
  * @brief ファイルを全て読み込む
  *
- *  ファイルから読み込んだデータをコピーして返却する。<br>
- *  返却したポインタは呼び出し側でCmnDataBuffer_Freeで解放すること。<br>
+ *  ファイルから読み込んだデータをbufの末尾に追加して返却する。<br>
+ *  ファイルサイズ分の領域を一度だけ確保し、バッファに直接読み込む。
+ *  読み込み中にファイルが伸びた場合は、終端まで読み込む。<br>
  *
  * @param filePath ファイルパス
  * @param buf 読み込んだデータを格納するバッファ
- * @return 読み込んだデータ。読み込みに失敗した場合はNULLを返却する。
+ * @return 読み込んだデータ（buf）。読み込みに失敗した場合はNULLを返却する（bufの内容は変更しない）。
  */
 CmnDataBuffer* CmnFile_ReadAll(const char *filePath, CmnDataBuffer *buf)
 {
 	FILE *fp;
-	char tmp[BUF_SIZE];
-	size_t readLen;
+	int ret;
 	CMNLOG_TRACE_START();
 
-	if ((fp = fopen(filePath, "rb")) == NULL) {
+	if ((fp = OpenFileToRead(filePath)) == NULL) {
 		CMNLOG_TRACE_END();
 		return NULL;
 	}
-
-	while ((readLen = fread(tmp, sizeof(tmp[0]), BUF_SIZE, fp)) > 0) {
-		if (CmnDataBuffer_Append(buf, tmp, readLen) != 0) {
-			CmnDataBuffer_Free(buf);
-			fclose(fp);
-			CMNLOG_TRACE_END();
-			return NULL;
-		}
-	}
-
+	ret = ReadFileToBuffer(fp, filePath, buf, 0);
 	fclose(fp);
+
 	CMNLOG_TRACE_END();
-	return buf;
+	return (ret == 0) ? buf : NULL;
 }
 
 /**
@@ -131,6 +164,14 @@ int CmnFile_WriteNew(const char *filePath, void *data, size_t len)
 
 /**
  * @brief データをファイルの先頭に追加する。ファイルがなければ新規作成。
+ *
+ *  同じディレクトリの一時ファイルにデータと元の内容を書き込み、ディスクに同期してから元のファイルと置き換える。<br>
+ *  元の内容はカーネル内でコピーする（copy_file_range、sendfile）ため、ファイルサイズに関わらず使用するメモリは一定。<br>
+ *  途中で失敗した場合（プロセスが異常終了した場合も）、元のファイルは変更されない。<br>
+ *  ファイルパスがシンボリックリンクの場合は、リンクはそのままでリンク先のファイルを置き換える。<br>
+ *  置き換えるため、ハードリンク（他のパスからは元の内容のまま）と所有者（実行したユーザになる）は引き継がない。
+ *  引き継ぐのはパーミッションだけ。
+ *
  * @param filePath ファイルパス
  * @param data 書き込むデータ
  * @return 0:正常終了、-1:書き込み失敗
@@ -138,26 +179,9 @@ int CmnFile_WriteNew(const char *filePath, void *data, size_t len)
 int CmnFile_WriteHead(const char *filePath, void *data, size_t len)
 {
 	int ret;
-	CmnDataBuffer *buf;
 	CMNLOG_TRACE_START();
 
-	if ((buf = CmnDataBuffer_Create(0)) == NULL) {
-		CMNLOG_TRACE_END();
-		return -1;
-	}
-	if (CmnFile_ReadAll(filePath, buf) < 0) {
-		CmnDataBuffer_Free(buf);
-		CMNLOG_TRACE_END();
-		return -1;
-	}
-
-	/* 先頭にデータを書き出し */
-	ret = CmnFile_WriteNew(filePath, data, len);
-	if (ret == 0) {
-		/* 元のデータを後ろに追加 */
-		ret = CmnFile_WriteTail(filePath, buf->data, buf->size);
-	}
-	CmnDataBuffer_Free(buf);
+	ret = PrependDataToFile(filePath, data, len);
 
 	CMNLOG_TRACE_END();
 	return ret;
@@ -213,6 +237,498 @@ static int WriteDataToFile(const char *path, void *data, size_t len, const char
 	return ret;
 }
 
+/**
+ * @brief ファイルの先頭にデータを追加する（一時ファイルに書き込んで置き換える）
+ * @return 0:正常終了、-1:書き込み失敗
+ */
+#if IS_PRATFORM_WINDOWS()
+static int PrependDataToFile(const char *path, void *data, size_t len)
+{
+	char realPath[MAX_PATH_SIZE], tmpPath[MAX_PATH_SIZE];
+	FILE *in, *out;
+	char *buf;
+	size_t n;
+	DWORD pathLength;
+	int ret = 0;
+
+	if ((in = fopen(path, "rb")) == NULL) {
+		/* ファイルがなければ新規作成 */
+		return WriteDataToFile(path, data, len, "wb");
+	}
+	/* シンボリックリンクを置き換えないように、リンク先のパスで一時ファイルを作成して置き換える */
+	pathLength = GetFinalPathNameByHandleA((HANDLE)_get_osfhandle(_fileno(in)), realPath, sizeof(realPath), FILE_NAME_NORMALIZED);
+	if (pathLength == 0 || pathLength >= sizeof(realPath)) {
+		CMNLOG_DEBUG("Failed to real path, path=%s", path);
+		fclose(in);
+		return -1;
+	}
+	path = realPath;
+	if (snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path) >= (int)sizeof(tmpPath)
+			|| (buf = malloc(COPY_SIZE)) == NULL) {
+		fclose(in);
+		return -1;
+	}
+	if ((out = fopen(tmpPath, "wb")) == NULL) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", tmpPath);
+		free(buf);
+		fclose(in);
+		return -1;
+	}
+
+	/* 一時ファイルにデータと元の内容を書き込み、ディスクに同期する */
+	if (len > 0 && fwrite(data, len, 1, out) != 1) {
+		ret = -1;
+	}
+	while (ret == 0 && (n = fread(buf, 1, COPY_SIZE, in)) > 0) {
+		if (fwrite(buf, n, 1, out) != 1) {
+			ret = -1;
+		}
+	}
+	if (ret == 0 && (ferror(in) || fflush(out) != 0 || _commit(_fileno(out)) != 0)) {
+		ret = -1;
+	}
+	fclose(in);
+	if (fclose(out) != 0) {
+		ret = -1;
+	}
+	free(buf);
+
+	/* 元のファイルと置き換える */
+	if (ret == 0 && !MoveFileExA(tmpPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		ret = -1;
+	}
+	if (ret != 0) {
+		CMNLOG_DEBUG("Failed to write data, path=%s", path);
+		remove(tmpPath);
+	}
+	return ret;
+}
+#else
+static int PrependDataToFile(const char *path, void *data, size_t len)
+{
+	char realPath[PATH_MAX], tmpPath[MAX_PATH_SIZE];
+	struct stat st;
+	int in, out;
+
+	if ((in = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+		/* ファイルがなければ新規作成 */
+		if (errno == ENOENT) {
+			return WriteDataToFile(path, data, len, "wb");
+		}
+		CMNLOG_DEBUG("Failed to open file, path=%s", path);
+		return -1;
+	}
+	/* シンボリックリンクを置き換えないように、リンク先のパスで一時ファイルを作成して置き換える */
+	if (realpath(path, realPath) == NULL) {
+		CMNLOG_DEBUG("Failed to real path, path=%s", path);
+		close(in);
+		return -1;
+	}
+	path = realPath;
+	if (fstat(in, &st) != 0 || snprintf(tmpPath, sizeof(tmpPath), "%s.XXXXXX", path) >= (int)sizeof(tmpPath)) {
+		close(in);
+		return -1;
+	}
+	if ((out = mkstemp(tmpPath)) < 0) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", tmpPath);
+		close(in);
+		return -1;
+	}
+
+	/* 一時ファイルにデータと元の内容を書き込み、ディスクに同期する（パーミッションは元のファイルに合わせる） */
+	if (fchmod(out, st.st_mode & 07777) != 0
+			|| WriteDataToFd(out, data, len) != 0
+			|| CopyFileData(in, out, -1) != 0
+			|| fsync(out) != 0) {
+		CMNLOG_DEBUG("Failed to write data, path=%s", tmpPath);
+		close(in);
+		close(out);
+		unlink(tmpPath);
+		return -1;
+	}
+	close(in);
+
+	/* 元のファイルと置き換え、置き換えたことをディスクに同期する */
+	if (close(out) != 0 || rename(tmpPath, path) != 0) {
+		CMNLOG_DEBUG("Failed to replace file, path=%s", path);
+		unlink(tmpPath);
+		return -1;
+	}
+	SyncParentDirectory(path);
+	return 0;
+}
+
+/**
+ * @brief データを全て書き込む（途中までしか書き込めなかった場合は続きを書き込む）
+ * @return 0:正常終了、-1:書き込み失敗
+ */
+static int WriteDataToFd(int fd, const char *data, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = write(fd, data, len)) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		data += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief ファイルの現在位置からlenバイトを、もう一方のファイルの現在位置にコピーする
+ *
+ *  copy_file_range（ファイルシステムが対応していればデータを共有）、sendfileの順にカーネル内でのコピーを試し、
+ *  どちらも使えない場合はread/writeでコピーする。シグナルで中断された（EINTR）場合は続きからコピーする。
+ *
+ * @param len コピーするバイト数（負の値の場合は終端まで。途中で終端に達した場合はそこまで）
+ * @return 0:正常終了、-1:失敗
+ */
+static int CopyFileData(int in, int out, long long len)
+{
+	char *buf;
+	ssize_t n = 0;
+
+#ifdef SYS_copy_file_range
+	while (len != 0 && ((n = syscall(SYS_copy_file_range, in, NULL, out, NULL, COPY_CHUNK(len), 0)) > 0 || (n < 0 && errno == EINTR))) {
+		len -= (len > 0 && n > 0) ? n : 0;
+	}
+	if (len == 0 || n == 0) {
+		return 0;
+	}
+	if (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP) {
+		return -1;
+	}
+#endif
+
+	/* copy_file_rangeが使えない場合（途中まででもファイルの位置は進んでいるため、続きからコピーする） */
+	while (len != 0 && ((n = sendfile(out, in, NULL, COPY_CHUNK(len))) > 0 || (n < 0 && errno == EINTR))) {
+		len -= (len > 0 && n > 0) ? n : 0;
+	}
+	if (len == 0 || n == 0) {
+		return 0;
+	}
+	if (errno != ENOSYS && errno != EINVAL) {
+		return -1;
+	}
+
+	if ((buf = malloc(COPY_SIZE)) == NULL) {
+		return -1;
+	}
+	while (len != 0 && ((n = read(in, buf, COPY_CHUNK(len))) > 0 || (n < 0 && errno == EINTR))) {
+		if (n < 0) {
+			continue;
+		}
+		if (WriteDataToFd(out, buf, n) != 0) {
+			n = -1;
+			break;
+		}
+		len -= (len > 0) ? n : 0;
+	}
+	free(buf);
+	return (len == 0 || n == 0) ? 0 : -1;
+}
+
+/**
+ * @brief 疎なファイルのデータのある範囲だけをコピーする（穴は穴のまま）
+ *
+ *  SEEK_DATA/SEEK_HOLEでデータのある範囲を探し、同じ位置にコピーする。末尾の穴はサイズを合わせて作る。
+ *
+ * @param size ファイルサイズ
+ * @return 0:正常終了、-1:失敗、1:ファイルシステムがSEEK_DATAに対応していない（何もしていない）
+ */
+static int CopySparseFileData(int in, int out, off_t size)
+{
+	off_t data = 0, hole;
+
+	for (;;) {
+		if ((data = lseek(in, data, SEEK_DATA)) < 0) {
+			if (errno == ENXIO) {
+				/* 以降にデータがない */
+				break;
+			}
+			if (errno == EINVAL && lseek(in, 0, SEEK_SET) == 0 && lseek(out, 0, SEEK_SET) == 0) {
+				return 1;
+			}
+			return -1;
+		}
+		if ((hole = lseek(in, data, SEEK_HOLE)) < 0
+				|| lseek(in, data, SEEK_SET) < 0
+				|| lseek(out, data, SEEK_SET) < 0
+				|| CopyFileData(in, out, hole - data) != 0) {
+			return -1;
+		}
+		data = hole;
+	}
+	return (ftruncate(out, size) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief ファイルのあるディレクトリをディスクに同期する（ファイルの作成、置き換えを確定する）
+ */
+static void SyncParentDirectory(const char *path)
+{
+	char dirPath[MAX_PATH_SIZE];
+	const char *slash = strrchr(path, '/');
+	int fd;
+
+	if (slash == NULL) {
+		strcpy(dirPath, ".");
+	}
+	else if (slash == path) {
+		strcpy(dirPath, "/");
+	}
+	else {
+		snprintf(dirPath, sizeof(dirPath), "%.*s", (int)(slash - path), path);
+	}
+	if ((fd = open(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) >= 0) {
+		fsync(fd);
+		close(fd);
+	}
+}
+
+/**
+ * @brief ファイルをコピーする
+ *
+ *  reflink（FICLONE。データブロックを共有するためコピーしない）を試し、使えない場合は
+ *  疎なファイルはデータのある範囲だけを、それ以外は全体をCopyFileDataでコピーする。
+ *
+ * @return 0:正常終了、-1:失敗
+ */
+static int CopyRegularFile(const char *srcPath, const char *dstPath, int flags)
+{
+	char tmpPath[MAX_PATH_SIZE];
+	struct stat st, dstSt;
+	struct timespec times[2];
+	int in, out, ret = 1;
+	int overwrite = (flags & CMN_FILE_COPY_OVERWRITE) ? True : False;
+	int keepMode = False;
+
+	if ((in = open(srcPath, O_RDONLY | O_CLOEXEC)) < 0) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", srcPath);
+		return -1;
+	}
+	if (fstat(in, &st) != 0 || !S_ISREG(st.st_mode)) {
+		CMNLOG_DEBUG("Not a regular file, path=%s", srcPath);
+		close(in);
+		return -1;
+	}
+
+	/* 上書きする場合は一時ファイルにコピーしてから置き換える（途中で失敗しても元のファイルは変更されない）。
+	 * パーミッションはcpと同じく、コピー先のファイルがあればそのパーミッション、なければコピー元のパーミッションにumaskを適用したもの */
+	if (overwrite) {
+		keepMode = (stat(dstPath, &dstSt) == 0) ? True : False;
+		out = OpenTempFile(dstPath, (keepMode ? dstSt.st_mode : st.st_mode) & 0777, tmpPath, sizeof(tmpPath));
+		if (out >= 0 && keepMode && fchmod(out, dstSt.st_mode & 07777) != 0) {
+			close(out);
+			unlink(tmpPath);
+			out = -1;
+		}
+	} else {
+		out = open(dstPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 0777);
+	}
+	if (out < 0) {
+		CMNLOG_DEBUG("Failed to create file, path=%s", dstPath);
+		close(in);
+		return -1;
+	}
+
+	if (ioctl(out, FICLONE, in) == 0) {
+		ret = 0;
+	} else if ((long long)st.st_blocks * 512 < (long long)st.st_size) {
+		/* 割り当て済みのブロックがサイズより少ない（穴がある） */
+		ret = CopySparseFileData(in, out, st.st_size);
+	}
+	if (ret == 1) {
+		ret = CopyFileData(in, out, -1);
+	}
+	if (ret == 0 && (flags & CMN_FILE_COPY_PRESERVE)) {
+		times[0] = st.st_atim;
+		times[1] = st.st_mtim;
+		if (fchmod(out, st.st_mode & 07777) != 0 || futimens(out, times) != 0) {
+			ret = -1;
+		}
+	}
+	close(in);
+	if (close(out) != 0) {
+		ret = -1;
+	}
+	if (ret == 0 && overwrite && rename(tmpPath, dstPath) != 0) {
+		ret = -1;
+	}
+	if (ret != 0) {
+		CMNLOG_DEBUG("Failed to copy file, path=%s", dstPath);
+		unlink(overwrite ? tmpPath : dstPath);
+	}
+	return ret;
+}
+
+/**
+ * @brief ファイルを移動する
+ *
+ *  同じファイルシステム内はrename（上書きしない場合はRENAME_NOREPLACE、使えない場合はlink/unlink）で移動する。
+ *  別のファイルシステムへはコピー（更新日時とパーミッションを保持）してから元のファイルを削除する。
+ *
+ * @return 0:正常終了、-1:失敗
+ */
+static int MoveRegularFile(const char *srcPath, const char *dstPath, int flags)
+{
+	int ret;
+
+	if (flags & CMN_FILE_COPY_OVERWRITE) {
+		ret = rename(srcPath, dstPath);
+	} else {
+		ret = -1;
+		errno = ENOSYS;
+#ifdef SYS_renameat2
+		ret = syscall(SYS_renameat2, AT_FDCWD, srcPath, AT_FDCWD, dstPath, RENAME_NOREPLACE);
+#endif
+		if (ret != 0 && (errno == ENOSYS || errno == EINVAL) && (ret = link(srcPath, dstPath)) == 0) {
+			unlink(srcPath);
+		}
+	}
+	if (ret == 0) {
+		return 0;
+	}
+	if (errno != EXDEV) {
+		CMNLOG_DEBUG("Failed to move file, path=%s", srcPath);
+		return -1;
+	}
+
+	if (CopyRegularFile(srcPath, dstPath, flags | CMN_FILE_COPY_PRESERVE) != 0) {
+		return -1;
+	}
+	if (unlink(srcPath) != 0) {
+		CMNLOG_DEBUG("Failed to remove file, path=%s", srcPath);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief 同じディレクトリに一時ファイルを作成する（パーミッションを指定するためmkstempは使わない）
+ * @param tmpPath 作成した一時ファイルのパスを格納するバッファ
+ * @return ファイルディスクリプタ。作成できない場合は-1。
+ */
+static int OpenTempFile(const char *path, mode_t mode, char *tmpPath, size_t tmpPathSize)
+{
+	static int counter = 0;
+	int fd, i;
+
+	for (i = 0; i < 100; i++) {
+		/* 複数のスレッドから同時に呼び出されても同じ名前にならないように、カウンタはアトミックに加算する */
+		if (snprintf(tmpPath, tmpPathSize, "%s.%d.%d.tmp", path, (int)getpid(), __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED)) >= (int)tmpPathSize) {
+			return -1;
+		}
+		if ((fd = open(tmpPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode)) >= 0 || errno != EEXIST) {
+			return fd;
+		}
+	}
+	return -1;
+}
+#endif
+
+/**
+ * @brief 読み込み用にファイルを開く
+ *
+ *  ReadFileToBufferで読み込み先に直接読み込むため、stdioのバッファは使用しない。
+ *
+ * @param path ファイルパス
+ * @return ファイル。開けない場合はNULL。
+ */
+static FILE* OpenFileToRead(const char *path)
+{
+	FILE *fp;
+
+	if ((fp = fopen(path, "rb")) == NULL) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", path);
+		return NULL;
+	}
+	setvbuf(fp, NULL, _IONBF, 0);
+	return fp;
+}
+
+/**
+ * @brief ファイルの内容をバッファの末尾に直接読み込む
+ *
+ *  ファイルサイズを取得して領域を一度だけ確保し、stdioのバッファを介さずに読み込む。<br>
+ *  領域が埋まった場合は終端かどうかを小さな一時領域で確認し、
+ *  ファイルが伸びていた場合（サイズが取得できない場合を含む）のみ領域を拡張して読み込みを続ける。
+ *
+ * @param fp OpenFileToReadで開いたファイル（閉じるのは呼び出し元）
+ * @param path ファイルパス（ログ出力用）
+ * @param buf 読み込み先のバッファ（buf->sizeの位置から追加する）
+ * @param reserve 読み込んだデータの後ろに空けておくバイト数（文字列の終端用など）
+ * @return 0:正常、-1:エラー（buf->sizeは変更しない。領域を拡張した場合はbuf->dataのアドレスが変わる）
+ */
+static int ReadFileToBuffer(FILE *fp, const char *path, CmnDataBuffer *buf, size_t reserve)
+{
+	char probe[BUF_SIZE];
+	size_t oldSize = buf->size;
+	size_t spare;
+	size_t readLen;
+
+	if (CmnDataBuffer_Reserve(buf, buf->size + GetOpenFileSize(fp) + reserve) != 0) {
+		return -1;
+	}
+
+	for (;;) {
+		spare = buf->bufSize - buf->size - reserve;
+		if (spare > 0) {
+			readLen = fread((char *)buf->data + buf->size, 1, spare, fp);
+			buf->size += readLen;
+			if (readLen < spare) {
+				break;
+			}
+			continue;
+		}
+
+		/* 領域が埋まった場合は終端か確認し、続きがあれば領域を拡張して追加する */
+		if ((readLen = fread(probe, 1, sizeof(probe), fp)) == 0) {
+			break;
+		}
+		if (CmnDataBuffer_Reserve(buf, buf->bufSize * 2 + readLen) != 0) {
+			buf->size = oldSize;
+			return -1;
+		}
+		memcpy((char *)buf->data + buf->size, probe, readLen);
+		buf->size += readLen;
+	}
+
+	if (ferror(fp)) {
+		CMNLOG_DEBUG("Failed to read file, path=%s", path);
+		buf->size = oldSize;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 開いているファイルのサイズを取得する
+ * @param fp ファイル
+ * @return ファイルサイズ。通常のファイル以外や、取得できない場合は0。
+ */
+static size_t GetOpenFileSize(FILE *fp)
+{
+#if IS_PRATFORM_WINDOWS()
+	struct _stati64 st;
+	if (_fstati64(_fileno(fp), &st) != 0 || !(st.st_mode & _S_IFREG) || (unsigned long long)st.st_size > (size_t)-1) {
+		return 0;
+	}
+#else
+	struct stat st;
+	if (fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode) || (unsigned long long)st.st_size > (size_t)-1) {
+		return 0;
+	}
+#endif
+	return (size_t)st.st_size;
+}
+
 /**
  * @brief ファイルを削除する
  * @param filePath 削除するファイル
@@ -243,6 +759,67 @@ int CmnFile_Remove(const char *path)
 	return ret;
 }
 
+/**
+ * @brief ファイルをコピーする
+ *
+ *  内容はカーネル内でコピーするため、ファイルサイズに関わらず使用するメモリは一定で、CPUもほとんど使わない。<br>
+ *  Linuxでは次の順に試す。<br>
+ *  ・reflink（FICLONE）：Btrfs、XFSなどでデータブロックを共有する（サイズに関わらず一瞬で終わる）<br>
+ *  ・copy_file_range：カーネル内でコピーする（NFS、SMBなどではサーバ内でコピーする）<br>
+ *  ・sendfile<br>
+ *  ・read/write（1MBのバッファ）<br>
+ *  疎なファイルはデータのある範囲だけをコピーし、穴は穴のままにする。
+ *  上書きする場合は一時ファイルにコピーしてから置き換えるため、途中で失敗しても元のファイルは変更されない。
+ *  CMN_FILE_COPY_PRESERVEを指定しない場合、上書きしたファイルのパーミッションは元のコピー先のまま。<br>
+ *  WindowsではCopyFileでコピーする（更新日時は常に保持する）。
+ *
+ * @param srcPath コピー元のファイルのパス
+ * @param dstPath コピー先のファイルのパス
+ * @param flags CMN_FILE_COPY_OVERWRITE（コピー先のファイルがあれば上書きする）、
+ *              CMN_FILE_COPY_PRESERVE（パーミッション、更新日時、アクセス日時を保持する）の組み合わせ
+ * @return 0:正常終了、-1:失敗（コピー元が通常のファイルでない場合、上書きしない場合にコピー先のファイルがある場合を含む）
+ */
+int CmnFile_Copy(const char *srcPath, const char *dstPath, int flags)
+{
+	int ret;
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	ret = CopyFileA(srcPath, dstPath, (flags & CMN_FILE_COPY_OVERWRITE) ? FALSE : TRUE) ? 0 : -1;
+#else
+	ret = CopyRegularFile(srcPath, dstPath, flags);
+#endif
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief ファイルを移動する
+ *
+ *  同じファイルシステム内は名前の変更だけで移動する。
+ *  別のファイルシステムへは、CmnFile_Copyでコピー（パーミッションと日時は常に保持する）してから元のファイルを削除する。
+ *
+ * @param srcPath 移動元のファイルのパス
+ * @param dstPath 移動先のファイルのパス
+ * @param flags CMN_FILE_COPY_OVERWRITE（移動先のファイルがあれば上書きする）
+ * @return 0:正常終了、-1:失敗
+ */
+int CmnFile_Move(const char *srcPath, const char *dstPath, int flags)
+{
+	int ret;
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	ret = MoveFileExA(srcPath, dstPath, MOVEFILE_COPY_ALLOWED | ((flags & CMN_FILE_COPY_OVERWRITE) ? MOVEFILE_REPLACE_EXISTING : 0)) ? 0 : -1;
+#else
+	ret = MoveRegularFile(srcPath, dstPath, flags);
+#endif
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
 /**
  * @brief path直下のファイル/ディレクトリ一覧を取得する。
  * @param path ファイル/ディレクトリ一覧を取得するパス
@@ -481,7 +1058,7 @@ char* CmnFileInfo_ToString(const CmnFileInfo *info, char *buf)
 	CMNLOG_TRACE_START();
 
 	*buf = '\0';
-	sprintf(buf, "parentDir=%s, name=%s, size=%I64d, lastUpdateTime=[%s], isDirectory=%d, isFile=%d, isHiddenFile=%d, isSystemFile=%d, isSymbolicLink=%d",
+	sprintf(buf, "parentDir=%s, name=%s, size=%lld, lastUpdateTime=[%s], isDirectory=%d, isFile=%d, isHiddenFile=%d, isSystemFile=%d, isSymbolicLink=%d",
 			info->parentDir,
 			info->name,
 			info->size,
@@ -574,7 +1151,7 @@ static void Win32FileAttributeToCmnFileInfo(CmnFileInfo *info, DWORD sizeHigh, D
 	CmnTimeDateTime cmnTime;
 
 	/* ファイルサイズ */
-	info->size = (sizeHigh * (MAXDWORD + 1)) + sizeLow;
+	info->size = ((long long)sizeHigh << 32) | sizeLow;
 
 	/* 最終更新日時  XXX:タイムゾーンがゼロ（グリニッジ標準時）の時刻が取れるため、日本なら＋9時間してやる必要がある。 */
 	FileTimeToSystemTime(lastUpdateTime, &win32time);
@@ -616,7 +1193,8 @@ static CmnDataList* ListForLinux(const char *path, CmnDataList *list)
 		path = newpath;
 	}
 
-	/* TODO:readdirはスレッドセーフではない。readdir_rがスレッドセーフだが最新のgccでは非推奨となっているためmutexによる排他制御を行うこと。 */
+	/* readdirは同じDIRストリームを複数のスレッドで同時に読む場合のみスレッドセーフではない。
+	 * ここで開いたDIRストリームはこの関数だけが読むため、排他制御は不要（readdir_rは非推奨）。 */
 
 	dir = opendir(path);
 	if (dir == NULL) {
@@ -628,7 +1206,6 @@ static CmnDataList* ListForLinux(const char *path, CmnDataList *list)
 	dp = readdir(dir);
 	while (dp != NULL) {
 		struct stat childStat;
-		char childPath[CMN_FILE_MAX_PATH + CMN_FILE_MAX_FILE_NAME] = "";
 		CmnFileInfo *info;
 
 		/* 「.」と「..」はスキップ */
@@ -637,12 +1214,9 @@ static CmnDataList* ListForLinux(const char *path, CmnDataList *list)
 			continue;
 		}
 
-		/* ファイル属性を取得 */
-		strcat(childPath, path);
-		strcat(childPath, CMN_FILE_PATH_DELIMITER);
-		strcat(childPath, dp->d_name);
-		if (stat(childPath, &childStat) < 0) {
-			CMNLOG_DEBUG("get stat failed, path=%s", childPath);
+		/* ファイル属性を取得（パスを連結せず、ディレクトリからの相対パスで取得） */
+		if (fstatat(dirfd(dir), dp->d_name, &childStat, 0) < 0) {
+			CMNLOG_DEBUG("get stat failed, path=%s/%s", path, dp->d_name);
 			dp = readdir(dir);
 			continue;
 		}
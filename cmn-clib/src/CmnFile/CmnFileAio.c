@@ -0,0 +1,883 @@
+/** @file *********************************************************************
+ * @brief 非同期ファイル入出力 共通関数
+ *
+ *  ファイルの読み込み、書き込み、ディスクへの同期を投入して、呼び出し元をブロックせずに処理する共通関数。<br>
+ *  複数の要求をまとめて投入（CmnFileAio_Submit）し、完了はCmnFileAio_Pollでコールバック関数により受け取る。<br>
+ *  <br>
+ *  処理の方法は以下の通り。<br>
+ *  ・Linux（io_uringに対応したカーネル（5.6以降））: io_uring。まとめて投入した要求は1回のシステムコールで渡す<br>
+ *  ・上記以外、またはCMN_FILE_AIO_THREAD_POOLを指定した場合: 固定数のスレッドプールでCmnFile_ReadAt/CmnFile_WriteAtを実行する<br>
+ *  <br>
+ *  バッファプール（CmnFileAioOption.bufferCount）を指定した場合、作成時に確保したバッファを
+ *  CmnFileAio_GetBuffer、CmnFileAio_ReleaseBufferで使い回せる（要求ごとのメモリ確保がない）。
+ *  io_uringではバッファプールをカーネルに登録し、バッファプールのバッファへの読み書きは登録済みバッファとして処理する
+ *  （要求ごとのページの固定が不要になる）。<br>
+ *  要求の情報は作成時に確保したスロットにコピーするため、投入と完了でもメモリを確保しない。<br>
+ *  <br>
+ *  読み込みは、lenバイトかファイルの終端までを読み込む（CmnFile_ReadAtと同じ）。書き込みはlenバイト全てを書き込む。<br>
+ *  1つのCmnFileAioを複数のスレッドで共有できる（内部でロックする）。
+ *  CmnFileAio_Submit、CmnFileAio_Poll、CmnFileAio_GetBuffer、CmnFileAio_ReleaseBufferは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileAioOption option = { 64, 0, 64 * 1024, 64, 0 };<BR>
+ *  CmnFileAio *aio = CmnFileAio_Create(&option);<BR>
+ *  CmnFileAioRequest request = { CMN_FILE_AIO_READ, file, CmnFileAio_GetBuffer(aio), 64 * 1024, 0, NULL };<BR>
+ *  CmnFileAio_Submit(aio, &request, 1);<BR>
+ *  while (CmnFileAio_Poll(aio, -1, callback, NULL) > 0) {}<BR>
+ *  CmnFileAio_Free(aio);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnTime.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <malloc.h>
+#else
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(SYS_io_uring_setup)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+/** io_uringを使えるか（ヘッダとシステムコール番号があるか。カーネルが対応しているかは作成時に確認する） */
+#define USE_IO_URING
+#endif
+#endif
+#endif
+
+/** 同時に処理できる要求の数の既定値 */
+#define DEFAULT_QUEUE_DEPTH 128
+/** スレッドプールのスレッド数の既定値 */
+#define DEFAULT_THREAD_COUNT 4
+/** スレッドプールのスレッド数の上限 */
+#define MAX_THREADS 64
+/** バッファプールのバッファ1個のサイズの既定値 */
+#define DEFAULT_BUFFER_SIZE (64 * 1024)
+/** バッファプールのアラインメント（O_DIRECTでも使えるようにページ境界に合わせる） */
+#define BUFFER_ALIGNMENT 4096
+/** 1回の読み書きの最大バイト数（io_uringの長さは32bitのため） */
+#define MAX_IO_SIZE 0x40000000
+/** 完了を一度に取り出す数 */
+#define POLL_BATCH 64
+/**
+ * io_uringへの投入に失敗した要求がSQに残っている場合に、再投入を試みる間隔（ミリ秒）。
+ * カーネルに渡っていない要求は完了が来ないため、完了を待つ時間をこの間隔で区切る。
+ */
+#define URING_RETRY_WAIT 1
+
+/** 処理中の要求 */
+typedef struct {
+	CmnFileAioRequest request;		/**< 投入された要求のコピー */
+	size_t done;					/**< 読み書きしたバイト数（io_uringで一部だけ読み書きした場合の続きの位置） */
+	long long result;				/**< 結果（スレッドプールの場合） */
+	int next;						/**< 次の空きスロット */
+} Slot;
+
+/** 完了した要求（コールバック関数の呼び出し用） */
+typedef struct {
+	CmnFileAioRequest request;
+	long long result;
+} Completion;
+
+#ifdef USE_IO_URING
+/** io_uringのリング */
+typedef struct {
+	int fd;
+	void *ringMem;					/**< SQとCQのリング（IORING_FEAT_SINGLE_MMAPで1つにマップ） */
+	size_t ringSize;
+	struct io_uring_sqe *sqes;
+	size_t sqesSize;
+	unsigned *sqHead;
+	unsigned *sqTail;
+	unsigned *sqArray;
+	unsigned sqMask;
+	unsigned *cqHead;
+	unsigned *cqTail;
+	unsigned cqMask;
+	struct io_uring_cqe *cqes;
+	int isBufferRegistered;			/**< バッファプールを登録したか */
+	int wakeFd;						/**< 処理中の要求がなくなったことの通知（eventfd。リングと一緒に待つCmnFileAio_Pollを起こす） */
+} Uring;
+#endif
+
+/** 非同期ファイル入出力 */
+struct _tag_CmnFileAio {
+	int useUring;					/**< io_uringで処理するか */
+	CmnThreadMutex *mutex;			/**< 以下のメンバのロック */
+	Slot *slots;
+	int queueDepth;
+	int freeSlot;					/**< 空きスロットの先頭（-1の場合は空きなし） */
+	int inFlight;					/**< 処理中（完了を受け取っていない）の要求の数 */
+
+	/* バッファプール */
+	char *buffers;
+	size_t bufferSize;
+	int bufferCount;
+	int *freeBuffers;				/**< 空きバッファの番号のスタック */
+	int freeBufferCount;
+
+#ifdef USE_IO_URING
+	Uring ring;
+#endif
+
+	/* スレッドプール */
+	int *queue;						/**< 実行待ちのスロットの番号（FIFOのリングバッファ） */
+	int queueHead;
+	int queueCount;
+	int *completed;					/**< 完了したスロットの番号（FIFOのリングバッファ） */
+	int completedHead;
+	int completedCount;
+	int running;					/**< 実行中の要求の数 */
+	int isSyncRunning;				/**< 同期を実行中か（実行中は他の要求を開始しない） */
+	CmnThreadCond *workCond;		/**< 開始できる要求が増えたことの通知（スレッドが待つ） */
+	CmnThreadCond *completeCond;	/**< 完了が増えたか、処理中の要求がなくなったことの通知（CmnFileAio_Pollが待つ） */
+	CmnThread threads[MAX_THREADS];
+	int threadCount;
+	int stop;						/**< スレッドの終了要求 */
+};
+
+static void destroyAio(CmnFileAio *aio);
+static int getBufferIndex(const CmnFileAio *aio, const void *buf, size_t len);
+static void completeSlot(CmnFileAio *aio, int slot, long long result, Completion *completion);
+static int isValidRequest(const CmnFileAioRequest *request);
+#ifdef USE_IO_URING
+static int openUring(CmnFileAio *aio);
+static void closeUring(CmnFileAio *aio);
+static void prepareUring(CmnFileAio *aio, int slot);
+static int submitUring(CmnFileAio *aio);
+static int reapUring(CmnFileAio *aio, Completion *completions, int max);
+#endif
+static int reapPool(CmnFileAio *aio, Completion *completions, int max);
+static int takeRequest(CmnFileAio *aio);
+static long long executeRequest(const CmnFileAioRequest *request);
+static void workerMethod(CmnThread *thread);
+
+/**
+ * @brief 非同期ファイル入出力の作成
+ * @param option 設定（NULLの場合は既定値）
+ * @return 非同期ファイル入出力。メモリ不足やスレッドを開始できない場合はNULL。
+ */
+CmnFileAio* CmnFileAio_Create(const CmnFileAioOption *option)
+{
+	CmnFileAio *aio;
+	int i;
+	CMNLOG_TRACE_START();
+
+	if ((aio = calloc(1, sizeof(CmnFileAio))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+#ifdef USE_IO_URING
+	aio->ring.fd = -1;
+	aio->ring.wakeFd = -1;
+#endif
+	aio->queueDepth = (option != NULL && option->queueDepth > 0) ? option->queueDepth : DEFAULT_QUEUE_DEPTH;
+	aio->threadCount = (option != NULL && option->threadCount > 0) ? option->threadCount : DEFAULT_THREAD_COUNT;
+	if (aio->threadCount > MAX_THREADS) {
+		aio->threadCount = MAX_THREADS;
+	}
+	aio->bufferSize = (option != NULL && option->bufferSize > 0) ? option->bufferSize : DEFAULT_BUFFER_SIZE;
+	aio->bufferCount = (option != NULL && option->bufferCount > 0) ? option->bufferCount : 0;
+
+	if ((aio->mutex = CmnThreadMutex_Create()) == NULL || (aio->slots = malloc(sizeof(Slot) * aio->queueDepth)) == NULL) {
+		destroyAio(aio);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	for (i = 0; i < aio->queueDepth; i++) {
+		aio->slots[i].next = (i + 1 < aio->queueDepth) ? i + 1 : -1;
+	}
+	aio->freeSlot = 0;
+
+	/* バッファプール（番号の小さいバッファから返すように逆順に積む） */
+	if (aio->bufferCount > 0) {
+		aio->bufferSize = (aio->bufferSize + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+#if IS_PRATFORM_WINDOWS()
+		aio->buffers = _aligned_malloc(aio->bufferSize * aio->bufferCount, BUFFER_ALIGNMENT);
+#else
+		if (posix_memalign((void **)&aio->buffers, BUFFER_ALIGNMENT, aio->bufferSize * aio->bufferCount) != 0) {
+			aio->buffers = NULL;
+		}
+#endif
+		if (aio->buffers == NULL || (aio->freeBuffers = malloc(sizeof(int) * aio->bufferCount)) == NULL) {
+			destroyAio(aio);
+			CMNLOG_TRACE_END();
+			return NULL;
+		}
+		for (i = 0; i < aio->bufferCount; i++) {
+			aio->freeBuffers[i] = aio->bufferCount - 1 - i;
+		}
+		aio->freeBufferCount = aio->bufferCount;
+	}
+
+#ifdef USE_IO_URING
+	if ((option == NULL || !(option->flags & CMN_FILE_AIO_THREAD_POOL)) && openUring(aio) == 0) {
+		aio->useUring = True;
+		CMNLOG_TRACE_END();
+		return aio;
+	}
+#endif
+
+	/* io_uringを使えない場合はスレッドプール */
+	if ((aio->queue = malloc(sizeof(int) * aio->queueDepth)) == NULL || (aio->completed = malloc(sizeof(int) * aio->queueDepth)) == NULL
+			|| (aio->workCond = CmnThreadCond_Create()) == NULL || (aio->completeCond = CmnThreadCond_Create()) == NULL) {
+		destroyAio(aio);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	for (i = 0; i < aio->threadCount; i++) {
+		CmnThread_Init(&aio->threads[i], workerMethod, aio, NULL);
+		if (CmnThread_Start(&aio->threads[i]) != 0) {
+			CMNLOG_DEBUG("Failed to start asynchronous file I/O thread, index=%d", i);
+			aio->threadCount = i;
+			destroyAio(aio);
+			CMNLOG_TRACE_END();
+			return NULL;
+		}
+	}
+
+	CMNLOG_TRACE_END();
+	return aio;
+}
+
+/**
+ * @brief 要求の投入
+ *
+ *  要求の内容はコピーするため、requestsは呼び出し後に解放してよい（bufは完了まで解放しないこと）。<br>
+ *  処理中の要求の数がCmnFileAioOption.queueDepthに達した場合は、投入できた数までを返す。
+ *  残りはCmnFileAio_Pollで完了を受け取った後に投入すること。
+ *
+ * @param aio 非同期ファイル入出力
+ * @param requests 要求の配列
+ * @param count 要求の数
+ * @return 投入した要求の数（先頭から順に投入する）。requestsの先頭が不正な要求の場合は-1（不正な要求の手前までは投入する）。
+ */
+int CmnFileAio_Submit(CmnFileAio *aio, const CmnFileAioRequest *requests, int count)
+{
+	int i, slot, isInvalid = False;
+
+	CmnThreadMutex_Lock(aio->mutex);
+	for (i = 0; i < count && aio->freeSlot >= 0; i++) {
+		if (!isValidRequest(&requests[i])) {
+			CMNLOG_DEBUG("Invalid asynchronous file I/O request, type=%d", requests[i].type);
+			isInvalid = True;
+			break;
+		}
+		slot = aio->freeSlot;
+		aio->freeSlot = aio->slots[slot].next;
+		aio->slots[slot].request = requests[i];
+		aio->slots[slot].done = 0;
+		aio->slots[slot].result = 0;
+#ifdef USE_IO_URING
+		if (aio->useUring && aio->inFlight == 0) {
+			/* 前回、処理中の要求がなくなった時の通知を取り消す（待っているCmnFileAio_Pollは新しい要求の完了を待てばよい） */
+			eventfd_t value;
+			eventfd_read(aio->ring.wakeFd, &value);
+		}
+#endif
+		aio->inFlight++;
+#ifdef USE_IO_URING
+		if (aio->useUring) {
+			prepareUring(aio, slot);
+			continue;
+		}
+#endif
+		aio->queue[(aio->queueHead + aio->queueCount) % aio->queueDepth] = slot;
+		aio->queueCount++;
+	}
+	if (!aio->useUring && i > 0) {
+		CmnThreadCond_Broadcast(aio->workCond);
+	}
+#ifdef USE_IO_URING
+	/* 投入に失敗した要求はリングに残り、次の投入か完了の確認の時に再度投入する */
+	if (aio->useUring && i > 0) {
+		submitUring(aio);
+	}
+#endif
+	CmnThreadMutex_UnLock(aio->mutex);
+
+	return (i == 0 && isInvalid) ? -1 : i;
+}
+
+/**
+ * @brief 完了の確認
+ *
+ *  完了した要求ごとにコールバック関数を呼び出す（呼び出し元のスレッドで実行する）。<br>
+ *  完了した要求がない場合はtimeoutまで待つ。処理中の要求がない場合は待たずに0を返すため、
+ *  「while (CmnFileAio_Poll(aio, -1, callback, data) > 0) {}」で全ての要求の完了を待てる。
+ *
+ * @param aio 非同期ファイル入出力
+ * @param timeout 待つ時間（ミリ秒）。0の場合は待たない、-1の場合は完了するまで待つ
+ * @param callback 完了のコールバック関数（NULLの場合は完了を受け取るだけ）
+ * @param data コールバック関数に渡す任意のデータ
+ * @return 完了した要求の数（待つ時間が過ぎた場合と、処理中の要求がない場合は0）
+ */
+int CmnFileAio_Poll(CmnFileAio *aio, int timeout, CmnFileAioCallback callback, void *data)
+{
+	Completion completions[POLL_BATCH];
+	unsigned long long start = CmnTime_GetTickCount(), elapsed;
+	int i, n, total = 0;
+#ifdef USE_IO_URING
+	struct pollfd pfd[2];
+	int wait;
+#endif
+
+	CmnThreadMutex_Lock(aio->mutex);
+	while (aio->inFlight > 0) {
+#ifdef USE_IO_URING
+		n = aio->useUring ? reapUring(aio, completions, POLL_BATCH) : reapPool(aio, completions, POLL_BATCH);
+#else
+		n = reapPool(aio, completions, POLL_BATCH);
+#endif
+		if (n > 0 && callback != NULL) {
+			/* コールバック関数から投入できるようにロックを外して呼び出す */
+			CmnThreadMutex_UnLock(aio->mutex);
+			for (i = 0; i < n; i++) {
+				callback(&completions[i].request, completions[i].result, data);
+			}
+			CmnThreadMutex_Lock(aio->mutex);
+		}
+		total += n;
+		if (n == POLL_BATCH) {
+			continue;
+		}
+		if (total > 0 || timeout == 0) {
+			break;
+		}
+
+		elapsed = CmnTime_GetTickCount() - start;
+		if (timeout > 0 && elapsed >= (unsigned long long)timeout) {
+			break;
+		}
+#ifdef USE_IO_URING
+		if (aio->useUring) {
+			/* リングのファイルディスクリプタはCQに完了があると読み込み可能になる。
+			 * 待っている間に他のスレッドが最後の完了を取り出した場合は、リングに完了が来ないためwakeFdで起こされる */
+			wait = (timeout < 0) ? -1 : (int)(timeout - elapsed);
+			if (*aio->ring.sqTail != __atomic_load_n(aio->ring.sqHead, __ATOMIC_ACQUIRE) && (wait < 0 || wait > URING_RETRY_WAIT)) {
+				wait = URING_RETRY_WAIT;
+			}
+			pfd[0].fd = aio->ring.fd;
+			pfd[1].fd = aio->ring.wakeFd;
+			pfd[0].events = pfd[1].events = POLLIN;
+			pfd[0].revents = pfd[1].revents = 0;
+			CmnThreadMutex_UnLock(aio->mutex);
+			poll(pfd, 2, wait);
+			CmnThreadMutex_Lock(aio->mutex);
+			continue;
+		}
+#endif
+		/* スレッドプールは完了した時と、他のスレッドが最後の完了を取り出した時に通知される */
+		CmnThreadCond_Wait(aio->completeCond, aio->mutex, (timeout < 0) ? -1 : (long)(timeout - elapsed));
+	}
+	CmnThreadMutex_UnLock(aio->mutex);
+
+	return total;
+}
+
+/**
+ * @brief バッファプールからバッファを取得する
+ *
+ *  取得したバッファはCmnFileAioOption.bufferSizeバイト（ページ境界に揃える）。使い終わったらCmnFileAio_ReleaseBufferで返すこと。
+ *
+ * @param aio 非同期ファイル入出力
+ * @return バッファ。空きがない場合とバッファプールがない場合はNULL。
+ */
+void* CmnFileAio_GetBuffer(CmnFileAio *aio)
+{
+	void *buf = NULL;
+
+	CmnThreadMutex_Lock(aio->mutex);
+	if (aio->freeBufferCount > 0) {
+		aio->freeBufferCount--;
+		buf = aio->buffers + aio->bufferSize * aio->freeBuffers[aio->freeBufferCount];
+	}
+	CmnThreadMutex_UnLock(aio->mutex);
+
+	return buf;
+}
+
+/**
+ * @brief バッファプールにバッファを返す
+ * @param aio 非同期ファイル入出力
+ * @param buf CmnFileAio_GetBufferで取得したバッファ（NULLの場合は何もしない）
+ */
+void CmnFileAio_ReleaseBuffer(CmnFileAio *aio, void *buf)
+{
+	int index;
+
+	if (buf == NULL || (index = getBufferIndex(aio, buf, 0)) < 0) {
+		return;
+	}
+	CmnThreadMutex_Lock(aio->mutex);
+	if (aio->freeBufferCount < aio->bufferCount) {
+		aio->freeBuffers[aio->freeBufferCount++] = index;
+	}
+	CmnThreadMutex_UnLock(aio->mutex);
+}
+
+/**
+ * @brief io_uringで処理しているかの確認
+ * @param aio 非同期ファイル入出力
+ * @return io_uringの場合はTrue、スレッドプールの場合はFalse
+ */
+int CmnFileAio_IsUring(CmnFileAio *aio)
+{
+	return aio->useUring;
+}
+
+/**
+ * @brief 非同期ファイル入出力の解放
+ *
+ *  処理中の要求がある場合は完了を待ってから解放する（完了のコールバック関数は呼び出さない）。
+ *
+ * @param aio 非同期ファイル入出力（NULLの場合は何もしない）
+ */
+void CmnFileAio_Free(CmnFileAio *aio)
+{
+	CMNLOG_TRACE_START();
+
+	if (aio != NULL) {
+		while (CmnFileAio_Poll(aio, -1, NULL, NULL) > 0) {}
+		destroyAio(aio);
+	}
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief スレッドを止めて全てのメモリを解放する（作成途中の場合も可）
+ * @param aio 非同期ファイル入出力
+ */
+static void destroyAio(CmnFileAio *aio)
+{
+	int i;
+
+	if (aio->completeCond != NULL) {
+		CmnThreadMutex_Lock(aio->mutex);
+		aio->stop = True;
+		CmnThreadCond_Broadcast(aio->workCond);
+		CmnThreadMutex_UnLock(aio->mutex);
+		for (i = 0; i < aio->threadCount; i++) {
+			CmnThread_Join(&aio->threads[i]);
+		}
+		CmnThreadCond_Free(aio->completeCond);
+	}
+	if (aio->workCond != NULL) {
+		CmnThreadCond_Free(aio->workCond);
+	}
+#ifdef USE_IO_URING
+	closeUring(aio);
+#endif
+#if IS_PRATFORM_WINDOWS()
+	_aligned_free(aio->buffers);
+#else
+	free(aio->buffers);
+#endif
+	free(aio->freeBuffers);
+	free(aio->queue);
+	free(aio->completed);
+	free(aio->slots);
+	if (aio->mutex != NULL) {
+		CmnThreadMutex_Free(aio->mutex);
+	}
+	free(aio);
+}
+
+/**
+ * @brief 範囲がバッファプールの1つのバッファに収まっている場合にバッファの番号を返す
+ * @param aio 非同期ファイル入出力
+ * @param buf 範囲の先頭
+ * @param len 範囲のバイト数
+ * @return バッファの番号。バッファプールの外の場合は-1。
+ */
+static int getBufferIndex(const CmnFileAio *aio, const void *buf, size_t len)
+{
+	size_t pos;
+	int index;
+
+	if (aio->buffers == NULL || (const char *)buf < aio->buffers || (const char *)buf >= aio->buffers + aio->bufferSize * aio->bufferCount) {
+		return -1;
+	}
+	pos = (const char *)buf - aio->buffers;
+	index = (int)(pos / aio->bufferSize);
+	return (pos % aio->bufferSize + len <= aio->bufferSize) ? index : -1;
+}
+
+/**
+ * @brief スロットの要求を完了として取り出し、スロットを空ける（要ロック）
+ * @param aio 非同期ファイル入出力
+ * @param slot スロットの番号
+ * @param result 結果
+ * @param completion 完了した要求の格納先
+ */
+static void completeSlot(CmnFileAio *aio, int slot, long long result, Completion *completion)
+{
+	completion->request = aio->slots[slot].request;
+	completion->result = result;
+	aio->slots[slot].next = aio->freeSlot;
+	aio->freeSlot = slot;
+	aio->inFlight--;
+	if (aio->inFlight == 0 && aio->completeCond != NULL) {
+		CmnThreadCond_Broadcast(aio->completeCond);
+	}
+#ifdef USE_IO_URING
+	/* リングを待っている他のCmnFileAio_Pollを起こす（次の投入まで通知したままにする） */
+	if (aio->inFlight == 0 && aio->useUring) {
+		eventfd_write(aio->ring.wakeFd, 1);
+	}
+#endif
+}
+
+/**
+ * @brief 要求の内容の確認
+ * @param request 要求
+ * @return 正しい場合はTrue
+ */
+static int isValidRequest(const CmnFileAioRequest *request)
+{
+	if (request->file == NULL) {
+		return False;
+	}
+	if (request->type == CMN_FILE_AIO_SYNC) {
+		return True;
+	}
+	return (request->type == CMN_FILE_AIO_READ || request->type == CMN_FILE_AIO_WRITE) && (request->buf != NULL || request->len == 0);
+}
+
+#ifdef USE_IO_URING
+/**
+ * @brief io_uringのリングを作成する
+ *
+ *  IORING_OP_READ/IORING_OP_WRITEに対応していないカーネル（5.6より前）や、io_uringが無効なシステムでは失敗する。
+ *  バッファプールの登録に失敗した場合（ロックできるメモリの上限など）は、登録せずに使う。
+ *
+ * @param aio 非同期ファイル入出力
+ * @return 0:正常終了、-1:io_uringを使えない
+ */
+static int openUring(CmnFileAio *aio)
+{
+	struct io_uring_params params;
+	struct iovec *iovecs;
+	Uring *ring = &aio->ring;
+	size_t sqSize, cqSize;
+	char *mem;
+	int i;
+
+	memset(&params, 0, sizeof(params));
+	if ((ring->fd = (int)syscall(SYS_io_uring_setup, (unsigned)aio->queueDepth, &params)) < 0) {
+		CMNLOG_DEBUG("io_uring is not available, errno=%d", errno);
+		return -1;
+	}
+	if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_RW_CUR_POS)) {
+		CMNLOG_DEBUG("io_uring is too old, features=%u", params.features);
+		closeUring(aio);
+		return -1;
+	}
+	if ((ring->wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0) {
+		CMNLOG_DEBUG("Failed to create eventfd, errno=%d", errno);
+		closeUring(aio);
+		return -1;
+	}
+
+	sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->ringSize = (sqSize > cqSize) ? sqSize : cqSize;
+	ring->ringMem = mmap(NULL, ring->ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (ring->ringMem == MAP_FAILED) {
+		ring->ringMem = NULL;
+		closeUring(aio);
+		return -1;
+	}
+	ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		ring->sqes = NULL;
+		closeUring(aio);
+		return -1;
+	}
+
+	mem = ring->ringMem;
+	ring->sqHead = (unsigned *)(mem + params.sq_off.head);
+	ring->sqTail = (unsigned *)(mem + params.sq_off.tail);
+	ring->sqArray = (unsigned *)(mem + params.sq_off.array);
+	ring->sqMask = *(unsigned *)(mem + params.sq_off.ring_mask);
+	ring->cqHead = (unsigned *)(mem + params.cq_off.head);
+	ring->cqTail = (unsigned *)(mem + params.cq_off.tail);
+	ring->cqMask = *(unsigned *)(mem + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(mem + params.cq_off.cqes);
+
+	/* バッファプールの登録 */
+	if (aio->bufferCount > 0 && (iovecs = malloc(sizeof(struct iovec) * aio->bufferCount)) != NULL) {
+		for (i = 0; i < aio->bufferCount; i++) {
+			iovecs[i].iov_base = aio->buffers + aio->bufferSize * i;
+			iovecs[i].iov_len = aio->bufferSize;
+		}
+		if (syscall(SYS_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, iovecs, (unsigned)aio->bufferCount) == 0) {
+			ring->isBufferRegistered = True;
+		} else {
+			CMNLOG_DEBUG("Failed to register io_uring buffers, errno=%d", errno);
+		}
+		free(iovecs);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief io_uringのリングを閉じる（作成途中の場合も可）
+ * @param aio 非同期ファイル入出力
+ */
+static void closeUring(CmnFileAio *aio)
+{
+	Uring *ring = &aio->ring;
+
+	if (ring->sqes != NULL) {
+		munmap(ring->sqes, ring->sqesSize);
+	}
+	if (ring->ringMem != NULL) {
+		munmap(ring->ringMem, ring->ringSize);
+	}
+	if (ring->fd >= 0) {
+		close(ring->fd);
+	}
+	if (ring->wakeFd >= 0) {
+		close(ring->wakeFd);
+	}
+	memset(ring, 0, sizeof(Uring));
+	ring->fd = -1;
+	ring->wakeFd = -1;
+}
+
+/**
+ * @brief スロットの要求（の残り）をSQに追加する（要ロック）
+ *
+ *  処理中の要求の数はSQのエントリ数以下のため、SQが一杯になることはない。
+ *
+ * @param aio 非同期ファイル入出力
+ * @param slot スロットの番号
+ */
+static void prepareUring(CmnFileAio *aio, int slot)
+{
+	Uring *ring = &aio->ring;
+	Slot *s = &aio->slots[slot];
+	unsigned tail = *ring->sqTail, index = tail & ring->sqMask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	size_t len = s->request.len - s->done;
+	int bufIndex;
+
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->fd = CmnFile_GetDescriptor(s->request.file);
+	sqe->user_data = (unsigned long long)slot;
+	if (s->request.type == CMN_FILE_AIO_SYNC) {
+		/* 先に投入した要求の完了後に実行し、後に投入した要求はこの完了まで待たせる */
+		sqe->opcode = IORING_OP_FSYNC;
+		sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+		sqe->flags = IOSQE_IO_DRAIN;
+	} else {
+		if (len > MAX_IO_SIZE) {
+			len = MAX_IO_SIZE;
+		}
+		sqe->opcode = (s->request.type == CMN_FILE_AIO_READ) ? IORING_OP_READ : IORING_OP_WRITE;
+		sqe->addr = (unsigned long long)(uintptr_t)((char *)s->request.buf + s->done);
+		sqe->len = (unsigned)len;
+		sqe->off = (unsigned long long)(s->request.offset + s->done);
+		if (ring->isBufferRegistered && (bufIndex = getBufferIndex(aio, (char *)s->request.buf + s->done, len)) >= 0) {
+			sqe->opcode = (s->request.type == CMN_FILE_AIO_READ) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+			sqe->buf_index = (unsigned short)bufIndex;
+		}
+	}
+	ring->sqArray[index] = index;
+	__atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief SQに追加した要求をカーネルに渡す（要ロック）
+ * @param aio 非同期ファイル入出力
+ * @return 0:正常終了、-1:失敗（SQに残った要求は次回に渡す）
+ */
+static int submitUring(CmnFileAio *aio)
+{
+	Uring *ring = &aio->ring;
+	unsigned pending;
+	long ret;
+
+	while ((pending = *ring->sqTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE)) > 0) {
+		if ((ret = syscall(SYS_io_uring_enter, ring->fd, pending, 0, 0, NULL, 0)) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			CMNLOG_DEBUG("Failed to submit io_uring requests, errno=%d", errno);
+			return -1;
+		}
+		if (ret == 0) {
+			break;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief CQから完了を取り出す（要ロック）
+ *
+ *  一部だけ読み書きした要求は、完了にせずに残りを再度投入する（読み込みでファイルの終端に達した場合は完了にする）。
+ *
+ * @param aio 非同期ファイル入出力
+ * @param completions 完了した要求の格納先
+ * @param max 取り出す最大数
+ * @return 完了した要求の数
+ */
+static int reapUring(CmnFileAio *aio, Completion *completions, int max)
+{
+	Uring *ring = &aio->ring;
+	unsigned head = *ring->cqHead, tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+	struct io_uring_cqe *cqe;
+	Slot *s;
+	int n = 0, slot, res, isResubmitted = False;
+
+	while (head != tail && n < max) {
+		cqe = &ring->cqes[head & ring->cqMask];
+		slot = (int)cqe->user_data;
+		res = cqe->res;
+		head++;
+		s = &aio->slots[slot];
+		if (res < 0) {
+			CMNLOG_DEBUG("Failed to asynchronous file I/O, type=%d, error=%d", s->request.type, -res);
+			completeSlot(aio, slot, -1, &completions[n++]);
+		} else if (s->request.type == CMN_FILE_AIO_SYNC) {
+			completeSlot(aio, slot, 0, &completions[n++]);
+		} else if (res > 0 && s->done + res < s->request.len) {
+			s->done += res;
+			prepareUring(aio, slot);
+			isResubmitted = True;
+		} else {
+			completeSlot(aio, slot, (long long)(s->done + res), &completions[n++]);
+		}
+	}
+	__atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+	/* 残りの投入と、以前に投入に失敗した要求の再投入 */
+	if (isResubmitted || *ring->sqTail != __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE)) {
+		submitUring(aio);
+	}
+	return n;
+}
+#endif
+
+/**
+ * @brief スレッドプールで完了した要求を取り出す（要ロック）
+ * @param aio 非同期ファイル入出力
+ * @param completions 完了した要求の格納先
+ * @param max 取り出す最大数
+ * @return 完了した要求の数
+ */
+static int reapPool(CmnFileAio *aio, Completion *completions, int max)
+{
+	int n = 0, slot;
+
+	while (aio->completedCount > 0 && n < max) {
+		slot = aio->completed[aio->completedHead];
+		aio->completedHead = (aio->completedHead + 1) % aio->queueDepth;
+		aio->completedCount--;
+		completeSlot(aio, slot, aio->slots[slot].result, &completions[n++]);
+	}
+	return n;
+}
+
+/**
+ * @brief 実行待ちの先頭の要求を取り出す（要ロック）
+ *
+ *  同期は実行中の要求がなくなってから開始し、同期の実行中は他の要求を開始しない（io_uringのIOSQE_IO_DRAINと同じ順序）。
+ *
+ * @param aio 非同期ファイル入出力
+ * @return スロットの番号。開始できる要求がない場合は-1。
+ */
+static int takeRequest(CmnFileAio *aio)
+{
+	int slot;
+
+	if (aio->queueCount == 0 || aio->isSyncRunning) {
+		return -1;
+	}
+	slot = aio->queue[aio->queueHead];
+	if (aio->slots[slot].request.type == CMN_FILE_AIO_SYNC) {
+		if (aio->running > 0) {
+			return -1;
+		}
+		aio->isSyncRunning = True;
+	}
+	aio->queueHead = (aio->queueHead + 1) % aio->queueDepth;
+	aio->queueCount--;
+	aio->running++;
+	return slot;
+}
+
+/**
+ * @brief 要求をブロックして実行する
+ * @param request 要求
+ * @return 読み書きしたバイト数、同期は0、エラーの場合は-1
+ */
+static long long executeRequest(const CmnFileAioRequest *request)
+{
+	switch (request->type) {
+	case CMN_FILE_AIO_READ:
+		return CmnFile_ReadAt(request->file, request->buf, request->len, request->offset);
+	case CMN_FILE_AIO_WRITE:
+		return (CmnFile_WriteAt(request->file, request->buf, request->len, request->offset) == 0) ? (long long)request->len : -1;
+	default:
+		return (CmnFile_Sync(request->file) == 0) ? 0 : -1;
+	}
+}
+
+/**
+ * @brief スレッドプールのスレッド処理
+ * @param thread スレッド（dataは非同期ファイル入出力）
+ */
+static void workerMethod(CmnThread *thread)
+{
+	CmnFileAio *aio = thread->data;
+	long long result;
+	int slot;
+
+	CmnThreadMutex_Lock(aio->mutex);
+	for (;;) {
+		while (!aio->stop && (slot = takeRequest(aio)) < 0) {
+			CmnThreadCond_Wait(aio->workCond, aio->mutex, -1);
+		}
+		if (aio->stop) {
+			break;
+		}
+		CmnThreadMutex_UnLock(aio->mutex);
+
+		result = executeRequest(&aio->slots[slot].request);
+
+		CmnThreadMutex_Lock(aio->mutex);
+		aio->slots[slot].result = result;
+		aio->running--;
+		if (aio->slots[slot].request.type == CMN_FILE_AIO_SYNC) {
+			aio->isSyncRunning = False;
+		}
+		aio->completed[(aio->completedHead + aio->completedCount) % aio->queueDepth] = slot;
+		aio->completedCount++;
+		CmnThreadCond_Broadcast(aio->completeCond);
+		/* 同期の終了や実行中の要求の減少で、待っていた要求を開始できるようになる場合がある */
+		if (aio->queueCount > 0) {
+			CmnThreadCond_Broadcast(aio->workCond);
+		}
+	}
+	CmnThreadMutex_UnLock(aio->mutex);
+}
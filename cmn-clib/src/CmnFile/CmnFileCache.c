@@ -0,0 +1,852 @@
+/** @file *********************************************************************
+ * @brief ファイルの内容のキャッシュ 共通関数
+ *
+ *  テンプレートや静的ファイルなど、同じファイルを繰り返し読み込む処理向けのキャッシュ。<br>
+ *  ファイルの内容は読み込んで（CMN_FILE_CACHE_MAPの場合はCmnFile_Mapでマップして）絶対パスをキーに保持し、
+ *  CmnFileCache_Getは参照数を加えた内容をそのまま返す（コピーしない）。参照はCmnFileCache_Releaseで解放する。<br>
+ *  読み込んだ内容は参照中にファイルが書き換えられても変わらない。マップした内容は、ファイルを置き換えずに書き換えると
+ *  参照中の内容も変わる（切り詰められた場合はアクセスで異常終了する）ため、リネームで置き換えるファイルにだけ使用すること。<br>
+ *  <br>
+ *  キャッシュした内容は、最終更新日時、サイズ、iノードでファイルが変更されていないことを確認してから返す。
+ *  確認はrevalidateIntervalの間隔でだけ行う（間隔内の変更は検出しない）。
+ *  CmnFileCache_Watchで監視したディレクトリ配下のファイルは、確認の代わりに監視のイベントで無効にする。
+ *  ただし、シンボリックリンクやハードリンクのあるファイルは監視していないパスから変更される可能性があるため、一定間隔で確認する。<br>
+ *  <br>
+ *  キャッシュした内容の合計サイズがmaxSizeを超えた場合は、最も長く使われていないもの（LRU）から取り除く。
+ *  参照中の内容は取り除かない。取り除いた、もしくは無効にした内容も、参照中であれば解放されるまで有効。<br>
+ *  maxSizeより大きいファイルはキャッシュせずに、その呼び出し元だけに返す。<br>
+ *  相対パスはCmnFileCache_Createを呼び出した時のカレントディレクトリからのパスとして扱う。
+ *  パスは正規化（Linuxではシンボリックリンクも解決）してキーにするため、同じファイルを指す異なるパスは同じ内容を共有する。
+ *  正規化の結果は指定されたパスごとに保持し、revalidateIntervalの間隔でだけ正規化し直す
+ *  （間隔内のシンボリックリンクの変更は検出しない）。<br>
+ *  CmnFileCache_Get、CmnFileCache_Releaseは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileCache *cache = CmnFileCache_Create(NULL);<BR>
+ *  const CmnFileCacheEntry *entry = CmnFileCache_Get(cache, "templates/index.html");<BR>
+ *  if (entry != NULL) {<BR>
+ *      fwrite(entry->data, 1, entry->size, stdout);<BR>
+ *      CmnFileCache_Release(cache, entry);<BR>
+ *  }<BR>
+ *  CmnFileCache_Free(cache);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnData.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnTime.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** キャッシュするファイルの内容の合計サイズの上限の既定値 */
+#define DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+/** ファイルの変更を確認する間隔の既定値（ミリ秒） */
+#define DEFAULT_REVALIDATE_INTERVAL 1000
+/** ハッシュ表の初期サイズ */
+#define INITIAL_BUCKET_COUNT 256
+/** 監視するディレクトリの数の上限 */
+#define MAX_WATCHES 16
+/** 正規化の結果のハッシュ表のサイズ */
+#define ALIAS_BUCKET_COUNT 1024
+/** 正規化の結果を保持する数の上限（超えたら全て破棄する） */
+#define MAX_ALIASES 4096
+
+/** ファイルの同一性の確認に使う情報 */
+typedef struct {
+	long long size;
+	long long mtime;				/**< 最終更新日時（ナノ秒） */
+	unsigned long long ino;			/**< iノード（Windowsでは0） */
+	unsigned long long dev;
+} FileId;
+
+typedef struct _tag_CacheItem CacheItem;
+
+/** キャッシュした内容 */
+struct _tag_CacheItem {
+	CmnFileCacheEntry entry;		/**< 呼び出し元に返す内容（先頭に置くこと） */
+	CmnFileMap *map;				/**< マップした内容（CMN_FILE_CACHE_MAPの場合） */
+	CmnDataBuffer *buf;				/**< 読み込んだ内容 */
+	int refCount;					/**< 参照数（キャッシュに登録している間は1を加える） */
+	int isCached;					/**< キャッシュに登録しているか */
+	int isWatched;					/**< 監視のイベントで無効にするか（Falseの場合は一定間隔で確認する） */
+	FileId id;
+	unsigned long long checkedTime;	/**< 最後に確認した時間（CmnTime_GetTickCount） */
+	unsigned long long hash;		/**< パスのハッシュ値 */
+	size_t pathLength;
+	CacheItem *hashNext;			/**< ハッシュ表の同じバケットの次の内容 */
+	CacheItem *prev;				/**< LRUの前（より最近使われた）の内容 */
+	CacheItem *next;				/**< LRUの次（より長く使われていない）の内容 */
+};
+
+typedef struct _tag_PathAlias PathAlias;
+
+/** 指定されたパスと正規化したパス（キー）の対応。構造体の後ろに指定されたパス、キーの順に格納する。 */
+struct _tag_PathAlias {
+	PathAlias *next;				/**< ハッシュ表の同じバケットの次の対応 */
+	unsigned long long hash;		/**< 指定されたパスのハッシュ値 */
+	unsigned long long keyHash;		/**< キーのハッシュ値 */
+	unsigned long long checkedTime;	/**< 正規化した時間（CmnTime_GetTickCount） */
+	size_t pathLength;
+	size_t keyLength;
+};
+
+/** 監視するディレクトリ */
+typedef struct {
+	CmnFileWatch *watch;
+	char *path;						/**< 絶対パス */
+	size_t pathLength;
+} WatchDir;
+
+/** ファイルの内容のキャッシュ */
+struct _tag_CmnFileCache {
+	size_t maxSize;
+	unsigned long revalidateInterval;
+	int flags;						/**< CMN_FILE_CACHE_MAP */
+	char *currentDir;				/**< 作成時のカレントディレクトリ（相対パスの起点） */
+	CmnThreadMutex *mutex;			/**< 以下のメンバのロック */
+	CacheItem **buckets;			/**< パスのハッシュ表 */
+	int bucketCount;
+	CacheItem *head;				/**< LRUの先頭（最も最近使われた内容） */
+	CacheItem *tail;				/**< LRUの末尾（最も長く使われていない内容） */
+	CmnFileCacheStats stats;
+	unsigned long long generation;	/**< 監視のイベントで無効にした回数（読み込み中の変更の検出用） */
+	PathAlias *aliases[ALIAS_BUCKET_COUNT];	/**< 指定されたパスのハッシュ表 */
+	int aliasCount;
+	WatchDir watches[MAX_WATCHES];
+	int watchCount;
+};
+
+static char* toAbsolutePath(const CmnFileCache *cache, const char *path, char *buf, size_t bufSize);
+static const char* resolvePath(CmnFileCache *cache, const char *path, unsigned long long now, char *key, size_t *keyLength, unsigned long long *hash);
+static void setAlias(CmnFileCache *cache, const char *path, size_t pathLength, unsigned long long hash,
+		const char *key, size_t keyLength, unsigned long long keyHash, unsigned long long now);
+static void clearAliases(CmnFileCache *cache);
+static int getFileId(const char *path, FileId *id);
+static int getOpenFileId(FILE *fp, FileId *id);
+static int isSameFile(const FileId *a, const FileId *b);
+static int isPlainFile(const char *path);
+static int isWatchedPath(const CmnFileCache *cache, const char *path, size_t pathLength);
+static CacheItem* loadItem(const CmnFileCache *cache, const char *path, size_t pathLength, unsigned long long hash);
+static CacheItem* lookupItem(const CmnFileCache *cache, const char *path, size_t pathLength, unsigned long long hash);
+static int attachItem(CmnFileCache *cache, CacheItem *item);
+static void detachItem(CmnFileCache *cache, CacheItem *item);
+static void releaseItem(CacheItem *item);
+static void touchItem(CmnFileCache *cache, CacheItem *item);
+static void evictItems(CmnFileCache *cache);
+static void detachItemsUnder(CmnFileCache *cache, const char *path, size_t pathLength, int onlyWatched);
+static void watchCallback(const CmnFileWatchEvent *event, void *data);
+
+/**
+ * @brief ファイルの内容のキャッシュの作成
+ * @param option 設定（NULLの場合は既定値）
+ * @return ファイルの内容のキャッシュ。メモリ不足の場合はNULL。
+ */
+CmnFileCache* CmnFileCache_Create(const CmnFileCacheOption *option)
+{
+	CmnFileCache *cache;
+	char currentDir[CMN_FILE_MAX_PATH];
+	CMNLOG_TRACE_START();
+
+	if ((cache = calloc(1, sizeof(CmnFileCache))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	cache->maxSize = (option != NULL && option->maxSize > 0) ? option->maxSize : DEFAULT_MAX_SIZE;
+	cache->revalidateInterval = (option != NULL) ? option->revalidateInterval : DEFAULT_REVALIDATE_INTERVAL;
+	cache->flags = (option != NULL) ? option->flags : 0;
+	cache->bucketCount = INITIAL_BUCKET_COUNT;
+	if (CmnFile_GetCurrentDirectory(currentDir, sizeof(currentDir)) == NULL) {
+		currentDir[0] = '\0';
+	}
+	if ((cache->currentDir = malloc(strlen(currentDir) + 1)) == NULL
+			|| (cache->buckets = calloc(cache->bucketCount, sizeof(CacheItem *))) == NULL
+			|| (cache->mutex = CmnThreadMutex_Create()) == NULL) {
+		free(cache->buckets);
+		free(cache->currentDir);
+		free(cache);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	strcpy(cache->currentDir, currentDir);
+
+	CMNLOG_TRACE_END();
+	return cache;
+}
+
+/**
+ * @brief ファイルの内容の取得
+ *
+ *  キャッシュした内容が変更されていなければそれを返し、なければ（変更されていれば）ファイルを読み込んでキャッシュする。<br>
+ *  返した内容はCmnFileCache_Releaseを呼び出すまで有効（その間にファイルが変更、キャッシュから削除されても変わらない）。
+ *
+ * @param cache ファイルの内容のキャッシュ
+ * @param path ファイルのパス
+ * @return ファイルの内容。ファイルが存在しない場合、通常のファイルでない場合、読み込めない場合はNULL。
+ */
+const CmnFileCacheEntry* CmnFileCache_Get(CmnFileCache *cache, const char *path)
+{
+	char key[CMN_FILE_MAX_PATH];
+	size_t keyLength;
+	unsigned long long hash, now, generation;
+	CacheItem *item, *loaded;
+	FileId id;
+	int isValid;
+
+	now = CmnTime_GetTickCount();
+	CmnThreadMutex_Lock(cache->mutex);
+	if (resolvePath(cache, path, now, key, &keyLength, &hash) == NULL) {
+		CmnThreadMutex_UnLock(cache->mutex);
+		return NULL;
+	}
+	if ((item = lookupItem(cache, key, keyLength, hash)) != NULL) {
+		isValid = (item->isWatched || now - item->checkedTime < cache->revalidateInterval) ? True : False;
+		if (!isValid && getFileId(key, &id) == 0 && isSameFile(&item->id, &id)) {
+			item->checkedTime = now;
+			isValid = True;
+		}
+		if (isValid) {
+			item->refCount++;
+			touchItem(cache, item);
+			cache->stats.hits++;
+			CmnThreadMutex_UnLock(cache->mutex);
+			return &item->entry;
+		}
+		/* 変更、削除されている */
+		detachItem(cache, item);
+	}
+	cache->stats.misses++;
+	generation = cache->generation;
+	CmnThreadMutex_UnLock(cache->mutex);
+
+	/* 読み込みは他のスレッドを待たせないようにロックの外で行う */
+	if ((loaded = loadItem(cache, key, keyLength, hash)) == NULL) {
+		return NULL;
+	}
+	loaded->checkedTime = now;
+
+	CmnThreadMutex_Lock(cache->mutex);
+	if ((item = lookupItem(cache, key, keyLength, hash)) != NULL) {
+		if (isSameFile(&item->id, &loaded->id)) {
+			/* 他のスレッドが先に読み込んだ内容を使う */
+			item->refCount++;
+			touchItem(cache, item);
+			CmnThreadMutex_UnLock(cache->mutex);
+			releaseItem(loaded);
+			return &item->entry;
+		}
+		detachItem(cache, item);
+	}
+	/* 読み込み中に監視のイベントがあった場合は、変更前の内容の可能性があるため一定間隔で確認する */
+	loaded->isWatched = (generation == cache->generation && isWatchedPath(cache, key, keyLength) && isPlainFile(key)) ? True : False;
+	if (loaded->entry.size <= cache->maxSize && attachItem(cache, loaded) == 0) {
+		evictItems(cache);
+	}
+	CmnThreadMutex_UnLock(cache->mutex);
+
+	return &loaded->entry;
+}
+
+/**
+ * @brief ファイルの内容の参照を解放する
+ * @param cache ファイルの内容のキャッシュ
+ * @param entry CmnFileCache_Getで取得したファイルの内容（NULLの場合は何もしない）
+ */
+void CmnFileCache_Release(CmnFileCache *cache, const CmnFileCacheEntry *entry)
+{
+	if (entry == NULL) {
+		return;
+	}
+	CmnThreadMutex_Lock(cache->mutex);
+	releaseItem((CacheItem *)entry);
+	CmnThreadMutex_UnLock(cache->mutex);
+}
+
+/**
+ * @brief ディレクトリを監視して、配下のファイルの変更でキャッシュを無効にする
+ *
+ *  監視したディレクトリ配下のファイルは、一定間隔での変更の確認を行わない（ファイルの変更から無効にするまでの間は変更前の内容を返す）。
+ *  ディレクトリのパスも正規化するため、シンボリックリンクを経由して指定した場合も実体のパスで判定する。
+ *
+ * @param cache ファイルの内容のキャッシュ
+ * @param dirPath 監視するディレクトリのパス（配下のディレクトリも監視する）
+ * @return 成功した場合は0、監視を開始できなかった場合は-1。
+ */
+int CmnFileCache_Watch(CmnFileCache *cache, const char *dirPath)
+{
+	char path[CMN_FILE_MAX_PATH];
+	size_t pathLength;
+	CmnFileWatch *watch;
+	WatchDir *watchDir;
+	CMNLOG_TRACE_START();
+
+	if (cache->watchCount >= MAX_WATCHES || toAbsolutePath(cache, dirPath, path, sizeof(path)) == NULL) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	pathLength = strlen(path);
+	while (pathLength > 1 && (path[pathLength - 1] == '/' || path[pathLength - 1] == '\\')) {
+		path[--pathLength] = '\0';
+	}
+	if ((watch = CmnFileWatch_Open(path, CMN_FILE_WATCH_RECURSIVE, 0)) == NULL) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	/* 監視を開始できてから登録する（登録した配下のファイルはイベントが来る前提で確認を省くため） */
+	if (CmnFileWatch_Start(watch, watchCallback, cache) != 0) {
+		CmnFileWatch_Close(watch);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+
+	CmnThreadMutex_Lock(cache->mutex);
+	watchDir = &cache->watches[cache->watchCount];
+	if ((watchDir->path = malloc(pathLength + 1)) == NULL) {
+		CmnThreadMutex_UnLock(cache->mutex);
+		CmnFileWatch_Close(watch);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	strcpy(watchDir->path, path);
+	watchDir->pathLength = pathLength;
+	watchDir->watch = watch;
+	cache->watchCount++;
+	CmnThreadMutex_UnLock(cache->mutex);
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
+/**
+ * @brief 統計情報の取得
+ * @param cache ファイルの内容のキャッシュ
+ * @param stats 統計情報を格納する領域
+ * @return statsを返す。
+ */
+CmnFileCacheStats* CmnFileCache_GetStats(CmnFileCache *cache, CmnFileCacheStats *stats)
+{
+	CmnThreadMutex_Lock(cache->mutex);
+	*stats = cache->stats;
+	CmnThreadMutex_UnLock(cache->mutex);
+	return stats;
+}
+
+/**
+ * @brief ファイルの内容のキャッシュの解放
+ *
+ *  CmnFileCache_Getで取得した内容は、全てCmnFileCache_Releaseで解放してから呼び出すこと。
+ *
+ * @param cache ファイルの内容のキャッシュ（NULLの場合は何もしない）
+ */
+void CmnFileCache_Free(CmnFileCache *cache)
+{
+	int i;
+	CMNLOG_TRACE_START();
+
+	if (cache == NULL) {
+		CMNLOG_TRACE_END();
+		return;
+	}
+	for (i = 0; i < cache->watchCount; i++) {
+		CmnFileWatch_Close(cache->watches[i].watch);
+		free(cache->watches[i].path);
+	}
+	while (cache->head != NULL) {
+		detachItem(cache, cache->head);
+	}
+	clearAliases(cache);
+	CmnThreadMutex_Free(cache->mutex);
+	free(cache->buckets);
+	free(cache->currentDir);
+	free(cache);
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief 指定されたパスをキー（正規化した絶対パス）に変換する
+ *
+ *  revalidateIntervalの間隔内に変換したパスは、保持している結果を使う（realpathを呼び出さない）。
+ *  変換し直す場合は、他のスレッドを待たせないようにロックを外して変換する。
+ *  ロックした状態で呼び出すこと（戻った時もロックした状態）。
+ *
+ * @param key キーを格納する領域（CMN_FILE_MAX_PATH以上）
+ * @param keyLength キーの長さを格納する領域
+ * @param hash キーのハッシュ値を格納する領域
+ * @return keyを返す。パスが長すぎる場合、存在しない場合はNULL。
+ */
+static const char* resolvePath(CmnFileCache *cache, const char *path, unsigned long long now, char *key, size_t *keyLength, unsigned long long *hash)
+{
+	size_t pathLength = strlen(path);
+	unsigned long long pathHash = CmnData_Hash(path, pathLength);
+	PathAlias *alias;
+
+	for (alias = cache->aliases[pathHash & (ALIAS_BUCKET_COUNT - 1)]; alias != NULL; alias = alias->next) {
+		if (alias->hash == pathHash && alias->pathLength == pathLength && memcmp(alias + 1, path, pathLength) == 0) {
+			break;
+		}
+	}
+	if (alias != NULL && now - alias->checkedTime < cache->revalidateInterval) {
+		*keyLength = alias->keyLength;
+		*hash = alias->keyHash;
+		memcpy(key, (char *)(alias + 1) + pathLength + 1, alias->keyLength + 1);
+		return key;
+	}
+
+	CmnThreadMutex_UnLock(cache->mutex);
+	if (toAbsolutePath(cache, path, key, CMN_FILE_MAX_PATH) == NULL) {
+		CmnThreadMutex_Lock(cache->mutex);
+		return NULL;
+	}
+	*keyLength = strlen(key);
+	*hash = CmnData_Hash(key, *keyLength);
+	CmnThreadMutex_Lock(cache->mutex);
+
+	setAlias(cache, path, pathLength, pathHash, key, *keyLength, *hash, now);
+	return key;
+}
+
+/**
+ * @brief 指定されたパスとキーの対応を登録する（登録済みの場合は置き換える）
+ *
+ *  メモリ不足の場合は登録しない（次回も正規化する）。
+ */
+static void setAlias(CmnFileCache *cache, const char *path, size_t pathLength, unsigned long long hash,
+		const char *key, size_t keyLength, unsigned long long keyHash, unsigned long long now)
+{
+	PathAlias **p = &cache->aliases[hash & (ALIAS_BUCKET_COUNT - 1)];
+	PathAlias *alias;
+	char *str;
+
+	for (; *p != NULL; p = &(*p)->next) {
+		if ((*p)->hash == hash && (*p)->pathLength == pathLength && memcmp(*p + 1, path, pathLength) == 0) {
+			alias = *p;
+			*p = alias->next;
+			free(alias);
+			cache->aliasCount--;
+			break;
+		}
+	}
+	if (cache->aliasCount >= MAX_ALIASES) {
+		clearAliases(cache);
+	}
+	if ((alias = malloc(sizeof(PathAlias) + pathLength + keyLength + 2)) == NULL) {
+		return;
+	}
+	str = (char *)(alias + 1);
+	memcpy(str, path, pathLength + 1);
+	memcpy(str + pathLength + 1, key, keyLength + 1);
+	alias->hash = hash;
+	alias->keyHash = keyHash;
+	alias->checkedTime = now;
+	alias->pathLength = pathLength;
+	alias->keyLength = keyLength;
+	alias->next = cache->aliases[hash & (ALIAS_BUCKET_COUNT - 1)];
+	cache->aliases[hash & (ALIAS_BUCKET_COUNT - 1)] = alias;
+	cache->aliasCount++;
+}
+
+/**
+ * @brief 指定されたパスとキーの対応を全て破棄する
+ */
+static void clearAliases(CmnFileCache *cache)
+{
+	PathAlias *alias, *next;
+	int i;
+
+	for (i = 0; i < ALIAS_BUCKET_COUNT; i++) {
+		for (alias = cache->aliases[i]; alias != NULL; alias = next) {
+			next = alias->next;
+			free(alias);
+		}
+		cache->aliases[i] = NULL;
+	}
+	cache->aliasCount = 0;
+}
+
+/**
+ * @brief 正規化した絶対パスに変換する（相対パスは作成時のカレントディレクトリに連結する）
+ *
+ *  「.」「..」、重複した区切り文字を取り除き、Linuxではシンボリックリンクも解決する。
+ *
+ * @return bufを返す。パスが長すぎる場合、存在しない場合はNULL。
+ */
+static char* toAbsolutePath(const CmnFileCache *cache, const char *path, char *buf, size_t bufSize)
+{
+	char absPath[CMN_FILE_MAX_PATH];
+	int len;
+#if !IS_PRATFORM_WINDOWS()
+	char resolved[PATH_MAX];
+#endif
+
+#if IS_PRATFORM_WINDOWS()
+	if (path[0] == '\\' || path[0] == '/' || (path[0] != '\0' && path[1] == ':')) {
+#else
+	if (path[0] == '/') {
+#endif
+		len = snprintf(absPath, sizeof(absPath), "%s", path);
+	} else {
+		len = snprintf(absPath, sizeof(absPath), "%s%s%s", cache->currentDir, CMN_FILE_PATH_DELIMITER, path);
+	}
+	if (len < 0 || (size_t)len >= sizeof(absPath)) {
+		return NULL;
+	}
+#if IS_PRATFORM_WINDOWS()
+	return _fullpath(buf, absPath, bufSize);
+#else
+	if (realpath(absPath, resolved) == NULL || strlen(resolved) >= bufSize) {
+		return NULL;
+	}
+	strcpy(buf, resolved);
+	return buf;
+#endif
+}
+
+/**
+ * @brief ファイルの同一性の確認に使う情報の取得
+ * @return 成功した場合は0、ファイルが存在しない場合、通常のファイルでない場合は-1。
+ */
+static int getFileId(const char *path, FileId *id)
+{
+#if IS_PRATFORM_WINDOWS()
+	struct _stati64 st;
+	if (_stati64(path, &st) != 0 || !(st.st_mode & _S_IFREG)) {
+		return -1;
+	}
+	id->mtime = (long long)st.st_mtime * 1000000000;
+	id->ino = 0;
+#else
+	struct stat st;
+	if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+		return -1;
+	}
+	id->mtime = (long long)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	id->ino = st.st_ino;
+#endif
+	id->size = st.st_size;
+	id->dev = st.st_dev;
+	return 0;
+}
+
+/**
+ * @brief 開いているファイルの同一性の確認に使う情報の取得（読み込む内容と同じファイルの情報になる）
+ * @return 成功した場合は0、通常のファイルでない場合は-1。
+ */
+static int getOpenFileId(FILE *fp, FileId *id)
+{
+#if IS_PRATFORM_WINDOWS()
+	struct _stati64 st;
+	if (_fstati64(_fileno(fp), &st) != 0 || !(st.st_mode & _S_IFREG)) {
+		return -1;
+	}
+	id->mtime = (long long)st.st_mtime * 1000000000;
+	id->ino = 0;
+#else
+	struct stat st;
+	if (fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode)) {
+		return -1;
+	}
+	id->mtime = (long long)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	id->ino = st.st_ino;
+#endif
+	id->size = st.st_size;
+	id->dev = st.st_dev;
+	return 0;
+}
+
+/**
+ * @brief 同じ内容のファイルか
+ */
+static int isSameFile(const FileId *a, const FileId *b)
+{
+	return (a->size == b->size && a->mtime == b->mtime && a->ino == b->ino && a->dev == b->dev) ? True : False;
+}
+
+/**
+ * @brief 監視のイベントで変更を検出できるファイルか
+ *
+ *  シンボリックリンクでない通常のファイルで、ハードリンクが1つだけの場合にTrueを返す
+ *  （リンク先やほかのハードリンクのパスから変更された場合、監視しているディレクトリのイベントにならない）。
+ */
+static int isPlainFile(const char *path)
+{
+#if IS_PRATFORM_WINDOWS()
+	DWORD attr = GetFileAttributesA(path);
+	return (attr != INVALID_FILE_ATTRIBUTES && !(attr & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_REPARSE_POINT))) ? True : False;
+#else
+	struct stat st;
+	return (lstat(path, &st) == 0 && S_ISREG(st.st_mode) && st.st_nlink == 1) ? True : False;
+#endif
+}
+
+/**
+ * @brief 監視しているディレクトリ配下のパスか
+ */
+static int isWatchedPath(const CmnFileCache *cache, const char *path, size_t pathLength)
+{
+	int i;
+
+	for (i = 0; i < cache->watchCount; i++) {
+		const WatchDir *dir = &cache->watches[i];
+		if (pathLength > dir->pathLength && strncmp(path, dir->path, dir->pathLength) == 0
+				&& (path[dir->pathLength] == '/' || path[dir->pathLength] == '\\')) {
+			return True;
+		}
+	}
+	return False;
+}
+
+/**
+ * @brief ファイルを読み込む
+ *
+ *  開いたファイルから同一性の確認に使う情報を取得し、同じファイルから読み込む
+ *  （パスで取得してから開くと、その間に置き換えられた場合に新しい内容を古い情報で登録してしまう）。
+ *
+ * @return 読み込んだ内容（参照数は1）。読み込めない場合はNULL。
+ */
+static CacheItem* loadItem(const CmnFileCache *cache, const char *path, size_t pathLength, unsigned long long hash)
+{
+	CacheItem *item;
+	char *itemPath;
+	FILE *fp;
+	FileId id;
+	size_t readLen;
+
+	if ((fp = fopen(path, "rb")) == NULL) {
+		return NULL;
+	}
+	if (getOpenFileId(fp, &id) != 0 || (item = calloc(1, sizeof(CacheItem) + pathLength + 1)) == NULL) {
+		fclose(fp);
+		return NULL;
+	}
+	if (cache->flags & CMN_FILE_CACHE_MAP) {
+		if ((item->map = CmnFile_MapStream(fp, 0)) == NULL) {
+			CMNLOG_DEBUG("Failed to map file, path=%s", path);
+			fclose(fp);
+			free(item);
+			return NULL;
+		}
+		item->entry.data = item->map->data;
+		item->entry.size = item->map->size;
+	} else {
+		/* 取得した情報のサイズまで読み込む（読み込み中に書き換えられた場合は更新日時が変わるため、次の確認で読み込み直す） */
+		if ((item->buf = CmnDataBuffer_Create((size_t)id.size)) == NULL
+				|| ((readLen = fread(item->buf->data, 1, (size_t)id.size, fp)) < (size_t)id.size && ferror(fp))) {
+			CMNLOG_DEBUG("Failed to load file, path=%s", path);
+			if (item->buf != NULL) {
+				CmnDataBuffer_Free(item->buf);
+			}
+			fclose(fp);
+			free(item);
+			return NULL;
+		}
+		item->buf->size = readLen;
+		item->entry.data = item->buf->data;
+		item->entry.size = item->buf->size;
+	}
+	fclose(fp);
+	itemPath = (char *)(item + 1);
+	memcpy(itemPath, path, pathLength + 1);
+
+	item->entry.path = itemPath;
+	item->entry.lastUpdateTime = (time_t)(id.mtime / 1000000000);
+	item->refCount = 1;
+	item->id = id;
+	item->hash = hash;
+	item->pathLength = pathLength;
+	return item;
+}
+
+/**
+ * @brief キャッシュした内容を探す
+ */
+static CacheItem* lookupItem(const CmnFileCache *cache, const char *path, size_t pathLength, unsigned long long hash)
+{
+	CacheItem *item;
+
+	for (item = cache->buckets[hash & (cache->bucketCount - 1)]; item != NULL; item = item->hashNext) {
+		if (item->hash == hash && item->pathLength == pathLength && memcmp(item->entry.path, path, pathLength) == 0) {
+			return item;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief キャッシュに登録する（LRUの先頭に加える）
+ * @return 成功した場合は0、メモリ不足の場合は-1。
+ */
+static int attachItem(CmnFileCache *cache, CacheItem *item)
+{
+	CacheItem **bucket;
+
+	/* 登録数がバケット数を超えたらハッシュ表を拡張する */
+	if (cache->stats.count >= cache->bucketCount) {
+		int newCount = cache->bucketCount * 2, i;
+		CacheItem **buckets = calloc(newCount, sizeof(CacheItem *));
+		if (buckets == NULL) {
+			return -1;
+		}
+		for (i = 0; i < cache->bucketCount; i++) {
+			CacheItem *p = cache->buckets[i], *next;
+			for (; p != NULL; p = next) {
+				next = p->hashNext;
+				p->hashNext = buckets[p->hash & (newCount - 1)];
+				buckets[p->hash & (newCount - 1)] = p;
+			}
+		}
+		free(cache->buckets);
+		cache->buckets = buckets;
+		cache->bucketCount = newCount;
+	}
+
+	bucket = &cache->buckets[item->hash & (cache->bucketCount - 1)];
+	item->hashNext = *bucket;
+	*bucket = item;
+	item->prev = NULL;
+	item->next = cache->head;
+	if (cache->head != NULL) {
+		cache->head->prev = item;
+	} else {
+		cache->tail = item;
+	}
+	cache->head = item;
+
+	item->isCached = True;
+	item->refCount++;
+	cache->stats.count++;
+	cache->stats.size += item->entry.size;
+	return 0;
+}
+
+/**
+ * @brief キャッシュから削除する（参照中でなければ解放する）
+ */
+static void detachItem(CmnFileCache *cache, CacheItem *item)
+{
+	CacheItem **p;
+
+	for (p = &cache->buckets[item->hash & (cache->bucketCount - 1)]; *p != item; p = &(*p)->hashNext);
+	*p = item->hashNext;
+	if (item->prev != NULL) {
+		item->prev->next = item->next;
+	} else {
+		cache->head = item->next;
+	}
+	if (item->next != NULL) {
+		item->next->prev = item->prev;
+	} else {
+		cache->tail = item->prev;
+	}
+
+	item->isCached = False;
+	cache->stats.count--;
+	cache->stats.size -= item->entry.size;
+	releaseItem(item);
+}
+
+/**
+ * @brief 参照数を減らし、0になったら解放する
+ */
+static void releaseItem(CacheItem *item)
+{
+	if (--item->refCount > 0) {
+		return;
+	}
+	if (item->map != NULL) {
+		CmnFile_Unmap(item->map);
+	}
+	if (item->buf != NULL) {
+		CmnDataBuffer_Free(item->buf);
+	}
+	free(item);
+}
+
+/**
+ * @brief LRUの先頭に移動する
+ */
+static void touchItem(CmnFileCache *cache, CacheItem *item)
+{
+	if (!item->isCached || cache->head == item) {
+		return;
+	}
+	item->prev->next = item->next;
+	if (item->next != NULL) {
+		item->next->prev = item->prev;
+	} else {
+		cache->tail = item->prev;
+	}
+	item->prev = NULL;
+	item->next = cache->head;
+	cache->head->prev = item;
+	cache->head = item;
+}
+
+/**
+ * @brief 合計サイズが上限以下になるまで、参照中でない内容をLRUの末尾から削除する
+ */
+static void evictItems(CmnFileCache *cache)
+{
+	CacheItem *item, *prev;
+
+	for (item = cache->tail; item != NULL && cache->stats.size > cache->maxSize; item = prev) {
+		prev = item->prev;
+		if (item->refCount == 1) {
+			detachItem(cache, item);
+			cache->stats.evictions++;
+		}
+	}
+}
+
+/**
+ * @brief パス（ディレクトリの場合は配下も）の内容をキャッシュから削除する
+ * @param onlyWatched 監視のイベントで無効にする内容だけを削除するか
+ */
+static void detachItemsUnder(CmnFileCache *cache, const char *path, size_t pathLength, int onlyWatched)
+{
+	CacheItem *item, *next;
+
+	for (item = cache->head; item != NULL; item = next) {
+		next = item->next;
+		if ((!onlyWatched || item->isWatched) && item->pathLength >= pathLength && strncmp(item->entry.path, path, pathLength) == 0
+				&& (item->pathLength == pathLength || item->entry.path[pathLength] == '/' || item->entry.path[pathLength] == '\\')) {
+			detachItem(cache, item);
+		}
+	}
+}
+
+/**
+ * @brief 監視のイベントのコールバック関数（変更されたファイルの内容をキャッシュから削除する）
+ */
+static void watchCallback(const CmnFileWatchEvent *event, void *data)
+{
+	CmnFileCache *cache = data;
+	size_t pathLength = strlen(event->path);
+	CacheItem *item;
+
+	CmnThreadMutex_Lock(cache->mutex);
+	cache->generation++;
+	if ((event->events & CMN_FILE_WATCH_RESCAN) || event->isDirectory) {
+		/* イベントが失われた、ディレクトリごと削除、移動された場合は配下を全て削除する */
+		detachItemsUnder(cache, event->path, pathLength, True);
+	} else if ((item = lookupItem(cache, event->path, pathLength, CmnData_Hash(event->path, pathLength))) != NULL) {
+		detachItem(cache, item);
+	}
+	CmnThreadMutex_UnLock(cache->mutex);
+}
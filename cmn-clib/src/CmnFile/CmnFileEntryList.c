@@ -0,0 +1,323 @@
+/** @file *********************************************************************
+ * @brief ファイル情報の一覧（コンパクト版） 共通関数
+ *
+ *  大量のファイル情報を少ないメモリで保持するための一覧。<br>
+ *  CmnFileInfoは親ディレクトリのパスとファイル名を固定長の配列で持つため1件あたり5KB以上になるが、
+ *  CmnFileEntryは親ディレクトリをエントリの番号で参照し、ファイル名は一覧のアリーナに格納するため、
+ *  1件あたり32バイト＋ファイル名の長さで済む。パスの長さの制限もない。<br>
+ *  パスが必要な場合はCmnFileEntryList_GetPathで親ディレクトリをたどって組み立てる。
+ *  既存のCmnFileInfoを使う処理向けに、CmnFileEntryList_ToFileInfo、CmnFileEntryList_ToStringで変換できる。<br>
+ *  エントリの参照は呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileEntryList *list = CmnFileEntryList_Create();<BR>
+ *  CmnStringBuffer *path = CmnStringBuffer_Create("");<BR>
+ *  CmnFile_ListEntries("/var/log", 0, CMN_FILE_WALK_STAT, list);<BR>
+ *  for (i = 0; i < list->size; i++) {<BR>
+ *      printf("%s %lld\n", CmnFileEntryList_GetPath(list, i, path)->string, list->entries[i].size);<BR>
+ *  }<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnData.h"
+#include "cmnclib/CmnString.h"
+#include "cmnclib/CmnTime.h"
+#include "cmnclib/CmnLog.h"
+
+/** 一覧の初期サイズ */
+#define INITIAL_CAPACITY 256
+
+/** 一覧の作成中の状態 */
+typedef struct {
+	CmnFileEntryList *list;
+	int *dirs;					/**< 深さごとの走査中のディレクトリのエントリ番号 */
+	int dirsSize;
+	int error;
+} ListContext;
+
+static int addEntry(CmnFileEntryList *list, const char *name, size_t nameLen, int parent, int type, long long size, time_t lastUpdateTime);
+static int listCallback(const CmnFileWalkEntry *entry, void *data);
+static int appendPath(const CmnFileEntryList *list, int index, CmnStringBuffer *buf);
+
+/**
+ * @brief ファイル情報の一覧の作成
+ * @return ファイル情報の一覧。メモリ不足の場合はNULL。
+ */
+CmnFileEntryList* CmnFileEntryList_Create(void)
+{
+	CmnFileEntryList *list;
+	CMNLOG_TRACE_START();
+
+	if ((list = calloc(1, sizeof(CmnFileEntryList))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	if ((list->_arena = CmnDataArena_Create(0)) == NULL) {
+		free(list);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	list->root = "";
+
+	CMNLOG_TRACE_END();
+	return list;
+}
+
+/**
+ * @brief ディレクトリ配下のファイル情報を一覧に格納する
+ *
+ *  CmnFile_Walkでディレクトリ配下を再帰的に走査し、ファイル、ディレクトリごとにエントリを追加する（一覧の元の内容は消去する）。<br>
+ *  ディレクトリのエントリは配下のエントリよりも前に格納する。
+ *
+ * @param path 起点のディレクトリのパス
+ * @param maxDepth 走査する深さ（1は起点のディレクトリ直下のみ）。0の場合は無制限。
+ * @param flags CmnFile_Walkのフラグ（サイズ、最終更新日時が必要な場合はCMN_FILE_WALK_STATを指定する）
+ * @param list ファイル情報を格納する一覧
+ * @return listを返す。起点のディレクトリが開けない場合、メモリ不足の場合はNULL。
+ */
+CmnFileEntryList* CmnFile_ListEntries(const char *path, int maxDepth, int flags, CmnFileEntryList *list)
+{
+	ListContext context;
+	size_t pathLen = strlen(path);
+	char *root;
+	CMNLOG_TRACE_START();
+
+	list->size = 0;
+	CmnDataArena_Reset(list->_arena);
+
+	/* 起点のディレクトリのパス（最後のパス区切りは除去） */
+	while (pathLen > 1 && (path[pathLen - 1] == '/' || path[pathLen - 1] == '\\')) {
+		pathLen--;
+	}
+	if ((root = CmnDataArena_CopyString(list->_arena, path, pathLen)) == NULL) {
+		list->root = "";
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	list->root = root;
+
+	memset(&context, 0, sizeof(context));
+	context.list = list;
+	if (CmnFile_Walk(path, maxDepth, flags, listCallback, &context) != 0
+			|| context.error) {
+		free(context.dirs);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	free(context.dirs);
+
+	CMNLOG_TRACE_END();
+	return list;
+}
+
+/**
+ * @brief エントリのパスの取得
+ *
+ *  起点のディレクトリのパスから親ディレクトリをたどってパスを組み立てる。
+ *
+ * @param list ファイル情報の一覧
+ * @param index エントリの番号
+ * @param buf パスを格納する文字列バッファ（元の内容は置き換える）
+ * @return bufを返す。メモリ不足の場合はNULL。
+ */
+CmnStringBuffer* CmnFileEntryList_GetPath(const CmnFileEntryList *list, int index, CmnStringBuffer *buf)
+{
+	CmnStringBuffer_Set(buf, "");
+	if (appendPath(list, index, buf) != 0) {
+		return NULL;
+	}
+	return buf;
+}
+
+/**
+ * @brief エントリをCmnFileInfoに変換する
+ *
+ *  CmnFile_GetFileInfo、CmnFile_Listの結果を使う既存の処理に渡すための変換。
+ *
+ * @param list ファイル情報の一覧
+ * @param index エントリの番号
+ * @param info 変換したファイル情報を格納する領域
+ * @return infoを返す。親ディレクトリのパス、ファイル名がCmnFileInfoに収まらない場合、メモリ不足の場合はNULL。
+ */
+CmnFileInfo* CmnFileEntryList_ToFileInfo(const CmnFileEntryList *list, int index, CmnFileInfo *info)
+{
+	const CmnFileEntry *entry = &list->entries[index];
+	CmnStringBuffer *parent;
+	CMNLOG_TRACE_START();
+
+	if (strlen(entry->name) >= sizeof(info->name) || (parent = CmnStringBuffer_Create("")) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	if ((entry->parent < 0 ? CmnStringBuffer_Set(parent, list->root) : appendPath(list, entry->parent, parent)) != 0
+			|| parent->length >= sizeof(info->parentDir)) {
+		CmnStringBuffer_Free(parent);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+	memset(info, 0, sizeof(CmnFileInfo));
+	memcpy(info->parentDir, parent->string, parent->length + 1);
+	strcpy(info->name, entry->name);
+	info->size = entry->size;
+	CmnTimeDateTime_SetBySerial(&info->lastUpdateTime, entry->lastUpdateTime);
+	info->isDirectory = (entry->type == CMN_FILE_TYPE_DIRECTORY) ? True : False;
+	info->isFile = (entry->type != CMN_FILE_TYPE_DIRECTORY) ? True : False;
+	info->isHiddenFile = entry->isHiddenFile;
+	info->isSystemFile = (entry->type == CMN_FILE_TYPE_OTHER) ? True : False;
+	info->isSymbolicLink = (entry->type == CMN_FILE_TYPE_SYMLINK) ? True : False;
+	CmnStringBuffer_Free(parent);
+
+	CMNLOG_TRACE_END();
+	return info;
+}
+
+/**
+ * @brief エントリの文字列表現の取得
+ *
+ *  CmnFileInfo_ToStringと同じ形式（parentDirは親ディレクトリのパス）で、パスの長さの制限はない。
+ *
+ * @param list ファイル情報の一覧
+ * @param index エントリの番号
+ * @param buf 文字列を格納する文字列バッファ（元の内容は置き換える）
+ * @return bufを返す。メモリ不足の場合はNULL。
+ */
+CmnStringBuffer* CmnFileEntryList_ToString(const CmnFileEntryList *list, int index, CmnStringBuffer *buf)
+{
+	const CmnFileEntry *entry = &list->entries[index];
+	CmnTimeDateTime time;
+	char timeBuf[160];
+	int ret;
+	CMNLOG_TRACE_START();
+
+	CmnStringBuffer_Set(buf, "parentDir=");
+	ret = (entry->parent < 0) ? CmnStringBuffer_Append(buf, list->root) : appendPath(list, entry->parent, buf);
+	CmnTimeDateTime_SetBySerial(&time, entry->lastUpdateTime);
+	if (ret != 0 || CmnStringBuffer_AppendFormat(buf,
+			", name=%s, size=%lld, lastUpdateTime=[%s], isDirectory=%d, isFile=%d, isHiddenFile=%d, isSystemFile=%d, isSymbolicLink=%d",
+			entry->name,
+			entry->size,
+			CmnTime_Format(&time, CMN_TIME_FORMAT_ALL, timeBuf),
+			entry->type == CMN_FILE_TYPE_DIRECTORY,
+			entry->type != CMN_FILE_TYPE_DIRECTORY,
+			entry->isHiddenFile,
+			entry->type == CMN_FILE_TYPE_OTHER,
+			entry->type == CMN_FILE_TYPE_SYMLINK) != 0) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+	CMNLOG_TRACE_END();
+	return buf;
+}
+
+/**
+ * @brief ファイル情報の一覧の解放
+ * @param list ファイル情報の一覧（NULLの場合は何もしない）
+ */
+void CmnFileEntryList_Free(CmnFileEntryList *list)
+{
+	CMNLOG_TRACE_START();
+
+	if (list != NULL) {
+		CmnDataArena_Free(list->_arena);
+		free(list->entries);
+		free(list);
+	}
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief エントリの追加
+ * @return 追加したエントリの番号。メモリ不足の場合は-1。
+ */
+static int addEntry(CmnFileEntryList *list, const char *name, size_t nameLen, int parent, int type, long long size, time_t lastUpdateTime)
+{
+	CmnFileEntry *entry;
+
+	if (list->size == list->_capacity) {
+		int newCapacity = (list->_capacity == 0) ? INITIAL_CAPACITY : list->_capacity * 2;
+		CmnFileEntry *tmp = realloc(list->entries, newCapacity * sizeof(CmnFileEntry));
+		if (tmp == NULL) {
+			return -1;
+		}
+		list->entries = tmp;
+		list->_capacity = newCapacity;
+	}
+
+	entry = &list->entries[list->size];
+	if ((entry->name = CmnDataArena_CopyString(list->_arena, name, nameLen)) == NULL) {
+		return -1;
+	}
+	entry->size = size;
+	entry->lastUpdateTime = lastUpdateTime;
+	entry->parent = parent;
+	entry->type = type;
+	entry->isHiddenFile = (name[0] == '.') ? True : False;
+	return list->size++;
+}
+
+/**
+ * @brief 走査のコールバック関数（1件ごとにエントリを追加）
+ *
+ *  CmnFile_Walkはディレクトリを通知した直後にその配下を走査するため、
+ *  深さごとに直前に通知されたディレクトリが親ディレクトリになる。
+ */
+static int listCallback(const CmnFileWalkEntry *entry, void *data)
+{
+	ListContext *context = data;
+	int parent = (entry->depth > 1) ? context->dirs[entry->depth - 1] : -1;
+	int index;
+
+	index = addEntry(context->list, entry->name, entry->pathLength - (entry->name - entry->path),
+			parent, entry->type, entry->size, entry->lastUpdateTime);
+	if (index < 0) {
+		context->error = True;
+		return CMN_FILE_WALK_STOP;
+	}
+
+	if (entry->type == CMN_FILE_TYPE_DIRECTORY) {
+		if (entry->depth >= context->dirsSize) {
+			int newSize = (context->dirsSize == 0) ? 64 : context->dirsSize * 2;
+			int *tmp = realloc(context->dirs, newSize * sizeof(int));
+			if (tmp == NULL) {
+				context->error = True;
+				return CMN_FILE_WALK_STOP;
+			}
+			context->dirs = tmp;
+			context->dirsSize = newSize;
+		}
+		context->dirs[entry->depth] = index;
+	}
+	return CMN_FILE_WALK_CONTINUE;
+}
+
+/**
+ * @brief エントリのパスを文字列バッファに追加（親ディレクトリのパスから順に追加）
+ * @return 正常:0, メモリ不足:-1
+ */
+static int appendPath(const CmnFileEntryList *list, int index, CmnStringBuffer *buf)
+{
+	const CmnFileEntry *entry = &list->entries[index];
+	int ret;
+
+	ret = (entry->parent < 0) ? CmnStringBuffer_Append(buf, list->root) : appendPath(list, entry->parent, buf);
+	if (ret != 0) {
+		return -1;
+	}
+	/* 起点がルートディレクトリの場合はパス区切りを重ねない */
+	if (buf->length == 0 || (buf->string[buf->length - 1] != '/' && buf->string[buf->length - 1] != '\\')) {
+		if (CmnStringBuffer_Append(buf, CMN_FILE_PATH_DELIMITER) != 0) {
+			return -1;
+		}
+	}
+	return CmnStringBuffer_Append(buf, entry->name);
+}
@@ -0,0 +1,340 @@
+/** @file *********************************************************************
+ * @brief ファイルの位置指定読み書き 共通関数
+ *
+ *  開いたファイルの任意の位置を読み書きする共通関数。インデックスやレコード単位のファイルのように、
+ *  ファイル全体を書き直さずに一部だけを更新する処理向け。<br>
+ *  読み書きはファイルの現在位置を使わない（Linuxではpread/pwrite）ため、
+ *  同じハンドルに複数のスレッドから同時に読み書きしてもよい（同じ範囲への同時の書き込みの結果は不定）。<br>
+ *  位置とサイズは64bit（long long）で扱い、2GB以上のファイルも扱える（32bit環境では_FILE_OFFSET_BITS=64でビルドすること）。<br>
+ *  CmnFile_ReadAt、CmnFile_WriteAtは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileHandle *file = CmnFile_Open("records.dat", CMN_FILE_OPEN_READ | CMN_FILE_OPEN_WRITE | CMN_FILE_OPEN_CREATE);<BR>
+ *  CmnFile_Allocate(file, 0, 100 * RECORD_SIZE);<BR>
+ *  CmnFile_WriteAt(file, &record, RECORD_SIZE, (long long)index * RECORD_SIZE);<BR>
+ *  CmnFile_ReadAt(file, &record, RECORD_SIZE, (long long)index * RECORD_SIZE);<BR>
+ *  CmnFile_Close(file);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/** 位置指定読み書き用に開いたファイル */
+struct _tag_CmnFileHandle {
+#if IS_PRATFORM_WINDOWS()
+	HANDLE handle;
+#else
+	int fd;
+#endif
+};
+
+/**
+ * @brief 位置指定読み書き用にファイルを開く
+ * @param path ファイルパス
+ * @param flags CMN_FILE_OPEN_READ（読み込み）、CMN_FILE_OPEN_WRITE（書き込み）、
+ *              CMN_FILE_OPEN_CREATE（ファイルがなければ作成）、CMN_FILE_OPEN_TRUNCATE（サイズを0にする）の組み合わせ
+ * @return 開いたファイル。開けない場合はNULL。
+ */
+CmnFileHandle* CmnFile_Open(const char *path, int flags)
+{
+	CmnFileHandle *file;
+#if IS_PRATFORM_WINDOWS()
+	DWORD access = 0, disposition;
+#else
+	int openFlags;
+#endif
+	CMNLOG_TRACE_START();
+
+	if ((file = malloc(sizeof(CmnFileHandle))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	if (flags & CMN_FILE_OPEN_READ) access |= GENERIC_READ;
+	if (flags & CMN_FILE_OPEN_WRITE) access |= GENERIC_WRITE;
+	if (flags & CMN_FILE_OPEN_CREATE) {
+		disposition = (flags & CMN_FILE_OPEN_TRUNCATE) ? CREATE_ALWAYS : OPEN_ALWAYS;
+	} else {
+		disposition = (flags & CMN_FILE_OPEN_TRUNCATE) ? TRUNCATE_EXISTING : OPEN_EXISTING;
+	}
+	file->handle = CreateFileA(path, access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, disposition, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file->handle == INVALID_HANDLE_VALUE) {
+#else
+	if ((flags & CMN_FILE_OPEN_READ) && (flags & CMN_FILE_OPEN_WRITE)) {
+		openFlags = O_RDWR;
+	} else {
+		openFlags = (flags & CMN_FILE_OPEN_WRITE) ? O_WRONLY : O_RDONLY;
+	}
+	if (flags & CMN_FILE_OPEN_CREATE) openFlags |= O_CREAT;
+	if (flags & CMN_FILE_OPEN_TRUNCATE) openFlags |= O_TRUNC;
+	if ((file->fd = open(path, openFlags | O_CLOEXEC, 0666)) < 0) {
+#endif
+		CMNLOG_DEBUG("Failed to open file, path=%s", path);
+		free(file);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+	CMNLOG_TRACE_END();
+	return file;
+}
+
+/**
+ * @brief 位置を指定して読み込む
+ *
+ *  lenバイト読み込むか、ファイルの終端に達するまで読み込む（ファイルの現在位置は使わない）。
+ *
+ * @param file 開いたファイル
+ * @param buf 読み込んだデータを格納する領域
+ * @param len 読み込むバイト数
+ * @param offset 読み込む位置（ファイルの先頭からのバイト数）
+ * @return 読み込んだバイト数（終端に達した場合はlenより少ない。終端以降の位置の場合は0）。エラーの場合は-1。
+ */
+long long CmnFile_ReadAt(CmnFileHandle *file, void *buf, size_t len, long long offset)
+{
+	size_t total = 0;
+#if IS_PRATFORM_WINDOWS()
+	OVERLAPPED overlapped;
+	DWORD n;
+
+	while (total < len) {
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = (DWORD)(offset + total);
+		overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+		if (!ReadFile(file->handle, (char *)buf + total, (DWORD)((len - total > 0x40000000) ? 0x40000000 : len - total), &n, &overlapped)) {
+			if (GetLastError() == ERROR_HANDLE_EOF) {
+				break;
+			}
+			CMNLOG_DEBUG("Failed to read file, offset=%lld", offset);
+			return -1;
+		}
+#else
+	ssize_t n;
+
+	while (total < len) {
+		if ((n = pread(file->fd, (char *)buf + total, len - total, (off_t)(offset + total))) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			CMNLOG_DEBUG("Failed to read file, offset=%lld", offset);
+			return -1;
+		}
+#endif
+		if (n == 0) {
+			break;
+		}
+		total += n;
+	}
+	return (long long)total;
+}
+
+/**
+ * @brief 位置を指定して書き込む
+ *
+ *  lenバイト全てを書き込む（ファイルの現在位置は使わない）。終端より後ろの位置に書き込んだ場合、間はゼロで埋まる。
+ *
+ * @param file 開いたファイル
+ * @param data 書き込むデータ
+ * @param len 書き込むバイト数
+ * @param offset 書き込む位置（ファイルの先頭からのバイト数）
+ * @return 0:正常終了、-1:書き込み失敗
+ */
+int CmnFile_WriteAt(CmnFileHandle *file, const void *data, size_t len, long long offset)
+{
+	size_t total = 0;
+#if IS_PRATFORM_WINDOWS()
+	OVERLAPPED overlapped;
+	DWORD n;
+
+	while (total < len) {
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = (DWORD)(offset + total);
+		overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+		if (!WriteFile(file->handle, (const char *)data + total, (DWORD)((len - total > 0x40000000) ? 0x40000000 : len - total), &n, &overlapped)) {
+			CMNLOG_DEBUG("Failed to write file, offset=%lld", offset);
+			return -1;
+		}
+#else
+	ssize_t n;
+
+	while (total < len) {
+		if ((n = pwrite(file->fd, (const char *)data + total, len - total, (off_t)(offset + total))) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			CMNLOG_DEBUG("Failed to write file, offset=%lld", offset);
+			return -1;
+		}
+#endif
+		total += n;
+	}
+	return 0;
+}
+
+/**
+ * @brief ファイルサイズの取得
+ * @param file 開いたファイル
+ * @return ファイルサイズ。取得できない場合は-1。
+ */
+long long CmnFile_GetSize(CmnFileHandle *file)
+{
+	long long size;
+#if IS_PRATFORM_WINDOWS()
+	LARGE_INTEGER li;
+#else
+	struct stat st;
+#endif
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	size = GetFileSizeEx(file->handle, &li) ? (long long)li.QuadPart : -1;
+#else
+	size = (fstat(file->fd, &st) == 0) ? (long long)st.st_size : -1;
+#endif
+
+	CMNLOG_TRACE_END();
+	return size;
+}
+
+/**
+ * @brief ファイルサイズを変更する
+ *
+ *  sizeより後ろの内容は削除する。sizeが現在のサイズより大きい場合、増えた部分はゼロで埋まる（Linuxでは領域を割り当てない）。
+ *
+ * @param file 開いたファイル（書き込み可能であること）
+ * @param size 変更後のファイルサイズ
+ * @return 0:正常終了、-1:失敗
+ */
+int CmnFile_Truncate(CmnFileHandle *file, long long size)
+{
+	int ret;
+#if IS_PRATFORM_WINDOWS()
+	FILE_END_OF_FILE_INFO info;
+#endif
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	info.EndOfFile.QuadPart = size;
+	ret = SetFileInformationByHandle(file->handle, FileEndOfFileInfo, &info, sizeof(info)) ? 0 : -1;
+#else
+	while ((ret = ftruncate(file->fd, (off_t)size)) != 0 && errno == EINTR) {}
+#endif
+	if (ret != 0) {
+		CMNLOG_DEBUG("Failed to truncate file, size=%lld", size);
+	}
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief ディスクの領域を事前に割り当てる
+ *
+ *  offsetからlenバイトの領域を割り当て、後で書き込む時にディスク容量不足にならないようにする
+ *  （追記を繰り返すよりも断片化しにくい）。終端より後ろまで割り当てた場合はファイルサイズも大きくなる（増えた部分はゼロ）。<br>
+ *  Linuxではposix_fallocate（ファイルシステムが対応していない場合はglibcがゼロを書き込む）、
+ *  Windowsではファイルサイズの変更で割り当てる。
+ *
+ * @param file 開いたファイル（書き込み可能であること）
+ * @param offset 割り当てる位置
+ * @param len 割り当てるバイト数
+ * @return 0:正常終了、-1:失敗（ディスク容量不足を含む）
+ */
+int CmnFile_Allocate(CmnFileHandle *file, long long offset, long long len)
+{
+	int ret;
+#if IS_PRATFORM_WINDOWS()
+	long long size;
+#endif
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	size = CmnFile_GetSize(file);
+	ret = (size < 0) ? -1 : (offset + len > size) ? CmnFile_Truncate(file, offset + len) : 0;
+#else
+	ret = (posix_fallocate(file->fd, (off_t)offset, (off_t)len) == 0) ? 0 : -1;
+#endif
+	if (ret != 0) {
+		CMNLOG_DEBUG("Failed to allocate file, offset=%lld, len=%lld", offset, len);
+	}
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 書き込んだ内容をディスクに同期する
+ * @param file 開いたファイル
+ * @return 0:正常終了、-1:失敗
+ */
+int CmnFile_Sync(CmnFileHandle *file)
+{
+	int ret;
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	ret = FlushFileBuffers(file->handle) ? 0 : -1;
+#else
+	ret = fdatasync(file->fd);
+#endif
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+#if IS_PRATFORM_LINUX()
+/**
+ * @brief ファイルディスクリプタの取得
+ *
+ *  posix_fadviseやio_uringなど、CmnFileHandleの関数にない操作に使う（閉じないこと）。
+ *
+ * @param file 開いたファイル
+ * @return ファイルディスクリプタ
+ */
+int CmnFile_GetDescriptor(CmnFileHandle *file)
+{
+	return file->fd;
+}
+#endif
+
+/**
+ * @brief ファイルを閉じる
+ * @param file 開いたファイル（NULLの場合は何もしない）
+ * @return 0:正常終了、-1:失敗（書き込みエラーが閉じる時に分かった場合を含む）
+ */
+int CmnFile_Close(CmnFileHandle *file)
+{
+	int ret = 0;
+	CMNLOG_TRACE_START();
+
+	if (file != NULL) {
+#if IS_PRATFORM_WINDOWS()
+		ret = CloseHandle(file->handle) ? 0 : -1;
+#else
+		ret = close(file->fd);
+#endif
+		free(file);
+	}
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
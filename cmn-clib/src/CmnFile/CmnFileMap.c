@@ -0,0 +1,441 @@
+/** @file *********************************************************************
+ * @brief ファイルのメモリマップ 共通関数
+ *
+ *  ファイルを読み込み専用でメモリにマップし、コピーせずに内容を参照するための共通関数。<br>
+ *  大きなファイルを読み込む場合も、読み込み用バッファへのコピーや領域の再確保が発生しない。<br>
+ *  アクセス方法のヒント（先頭から順に読む、ランダムに読む、直ちに読み込む）をOSに伝えることができる。<br>
+ *  Linuxでは2MB以上のファイルをヒュージページ境界にマップし、ヒュージページの使用を要求する
+ *  （カーネルが対応していない場合は通常のページが使われる）。<br>
+ *  パイプや/procのファイルなどマップできない場合は、ファイルサイズ分の領域を確保して一度に読み込む。<br>
+ *  開いているファイル（CmnFile_MapStream）もマップできる。マップした内容とfstatなどで取得した情報が同じファイルのものであることが必要な場合に使う。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileMap *map = CmnFile_Map("data.txt", CMN_FILE_MAP_SEQUENTIAL);<BR>
+ *  if (map == NULL) return;<BR>
+ *  fwrite(map->data, 1, map->size, stdout);<BR>
+ *  CmnFile_Unmap(map);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/** マップできないファイル（サイズ不明）を読み込む際の初期バッファサイズ */
+#define READ_BUF_SIZE (64 * 1024)
+/** ヒュージページのサイズ（この境界にマップする） */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#if IS_PRATFORM_WINDOWS()
+static int mapForWindows(const char *filePath, int flags, CmnFileMap *map);
+static int mapHandle(HANDLE file, CmnFileMap *map);
+#else
+static int mapForLinux(const char *filePath, int flags, CmnFileMap *map);
+static int mapDescriptor(int fd, int flags, CmnFileMap *map);
+static void* mapAligned(int fd, size_t size);
+static int readAll(int fd, size_t size, CmnFileMap *map);
+#endif
+
+/**
+ * @brief ファイルのメモリマップ
+ *
+ *  ファイル全体を読み込み専用でメモリにマップする。<br>
+ *  マップできない場合は、ファイル全体を読み込んだ領域を返す（map->dataの使い方は同じ）。<br>
+ *  使用後はCmnFile_Unmapで解放すること。
+ *
+ * @param filePath ファイルパス（UTF-8）
+ * @param flags アクセス方法のヒント（CMN_FILE_MAP_NORMAL、CMN_FILE_MAP_SEQUENTIAL、CMN_FILE_MAP_RANDOM、
+ *              CMN_FILE_MAP_WILLNEEDの組み合わせ）
+ * @return マップしたファイル。ファイルが開けない場合、メモリ不足の場合はNULL。
+ */
+CmnFileMap* CmnFile_Map(const char *filePath, int flags)
+{
+	CmnFileMap *map;
+	int ret;
+	CMNLOG_TRACE_START();
+
+	if ((map = calloc(1, sizeof(CmnFileMap))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	ret = mapForWindows(filePath, flags, map);
+#else
+	ret = mapForLinux(filePath, flags, map);
+#endif
+	if (ret != 0) {
+		free(map);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+	/* 空のファイルもdataはNULLにしない */
+	if (map->size == 0) {
+		map->data = "";
+	}
+
+	CMNLOG_TRACE_END();
+	return map;
+}
+
+/**
+ * @brief 開いているファイルのメモリマップ
+ *
+ *  CmnFile_Mapと同じく、ファイル全体を読み込み専用でマップする（マップできない場合は読み込む）。<br>
+ *  パスを開き直さないため、fstatなどで取得した情報と同じファイルの内容になる。
+ *  ファイルの現在位置は使わず、先頭からマップする（読み込んだ場合、呼び出し後の現在位置は不定）。<br>
+ *  ファイルは閉じないため、呼び出し元で閉じること（マップした内容は閉じた後も参照できる）。
+ *  Windowsではアクセス方法のヒントは無視する（ファイルを開く時にだけ指定できるため）。
+ *
+ * @param fp 読み込み用に開いたファイル
+ * @param flags アクセス方法のヒント（CmnFile_Mapと同じ）
+ * @return マップしたファイル。メモリ不足の場合、読み込めない場合はNULL。
+ */
+CmnFileMap* CmnFile_MapStream(FILE *fp, int flags)
+{
+	CmnFileMap *map;
+	int ret;
+	CMNLOG_TRACE_START();
+
+	if ((map = calloc(1, sizeof(CmnFileMap))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	ret = mapHandle((HANDLE)_get_osfhandle(_fileno(fp)), map);
+#else
+	ret = mapDescriptor(fileno(fp), flags, map);
+#endif
+	if (ret != 0) {
+		free(map);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+	/* 空のファイルもdataはNULLにしない */
+	if (map->size == 0) {
+		map->data = "";
+	}
+
+	CMNLOG_TRACE_END();
+	return map;
+}
+
+/**
+ * @brief ファイルのメモリマップの解放
+ *
+ * @param map CmnFile_Mapでマップしたファイル（NULLの場合は何もしない）
+ */
+void CmnFile_Unmap(CmnFileMap *map)
+{
+	CMNLOG_TRACE_START();
+
+	if (map == NULL) {
+		CMNLOG_TRACE_END();
+		return;
+	}
+
+	if (map->_isMapped) {
+#if IS_PRATFORM_WINDOWS()
+		UnmapViewOfFile(map->_addr);
+#else
+		munmap(map->_addr, map->size);
+#endif
+	}
+	else {
+		free(map->_addr);
+	}
+	free(map);
+
+	CMNLOG_TRACE_END();
+}
+
+
+#if IS_PRATFORM_WINDOWS()
+/* ============================================================================
+ *    Only Windows code
+ * ========================================================================= */
+
+/**
+ * @brief ファイルのマップ（Windows）
+ * @param filePath ファイルパス（UTF-8）
+ * @param flags アクセス方法のヒント
+ * @param map マップ結果
+ * @return 0:正常、-1:エラー
+ */
+static int mapForWindows(const char *filePath, int flags, CmnFileMap *map)
+{
+	WCHAR pathWide[CMN_FILE_MAX_PATH];
+	HANDLE file;
+	DWORD attributes = FILE_ATTRIBUTE_NORMAL;
+	int ret;
+
+	MultiByteToWideChar(CP_UTF8, MB_PRECOMPOSED, filePath, -1, pathWide, ARRAY_LENGTH(pathWide));
+
+	/* アクセス方法のヒントはキャッシュマネージャに伝える */
+	if (flags & CMN_FILE_MAP_SEQUENTIAL) {
+		attributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+	}
+	else if (flags & CMN_FILE_MAP_RANDOM) {
+		attributes |= FILE_FLAG_RANDOM_ACCESS;
+	}
+	file = CreateFileW(pathWide, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, attributes, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", filePath);
+		return -1;
+	}
+	ret = mapHandle(file, map);
+	CloseHandle(file);
+	return ret;
+}
+
+/**
+ * @brief 開いているファイルのマップ（Windows）
+ * @param file 読み込み用に開いたファイル（閉じるのは呼び出し元）
+ * @param map マップ結果
+ * @return 0:正常、-1:エラー
+ */
+static int mapHandle(HANDLE file, CmnFileMap *map)
+{
+	HANDLE mapping;
+	LARGE_INTEGER size;
+	LARGE_INTEGER offset;
+	DWORD readLen;
+	size_t total;
+
+	if (!GetFileSizeEx(file, &size) || (unsigned long long)size.QuadPart > (size_t)-1) {
+		CMNLOG_DEBUG("Failed to get file size");
+		return -1;
+	}
+	map->size = (size_t)size.QuadPart;
+	if (map->size == 0) {
+		return 0;
+	}
+
+	/* マップ（ビューがマッピングオブジェクトを参照するため、ハンドルはすぐに閉じてよい） */
+	mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL) {
+		map->_addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (map->_addr != NULL) {
+			map->data = map->_addr;
+			map->_isMapped = True;
+			return 0;
+		}
+	}
+
+	/* マップできない場合はファイルサイズ分を一度に読み込む */
+	if ((map->_addr = malloc(map->size)) == NULL) {
+		return -1;
+	}
+	offset.QuadPart = 0;
+	SetFilePointerEx(file, offset, NULL, FILE_BEGIN);
+	for (total = 0; total < map->size; total += readLen) {
+		DWORD request = (map->size - total > 0x40000000) ? 0x40000000 : (DWORD)(map->size - total);
+		if (!ReadFile(file, (char *)map->_addr + total, request, &readLen, NULL) || readLen == 0) {
+			break;
+		}
+	}
+	map->size = total;
+	map->data = map->_addr;
+	return 0;
+}
+
+#else
+/* ============================================================================
+ *    Only Linux code
+ * ========================================================================= */
+
+/**
+ * @brief ファイルのマップ（Linux）
+ * @param filePath ファイルパス
+ * @param flags アクセス方法のヒント
+ * @param map マップ結果
+ * @return 0:正常、-1:エラー
+ */
+static int mapForLinux(const char *filePath, int flags, CmnFileMap *map)
+{
+	int fd;
+	int ret;
+
+	fd = open(filePath, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", filePath);
+		return -1;
+	}
+	ret = mapDescriptor(fd, flags, map);
+	/* マップした領域はファイルを閉じても参照できる */
+	close(fd);
+	return ret;
+}
+
+/**
+ * @brief 開いているファイルのマップ（Linux）
+ * @param fd ファイルディスクリプタ（閉じるのは呼び出し元）
+ * @param flags アクセス方法のヒント
+ * @param map マップ結果
+ * @return 0:正常、-1:エラー
+ */
+static int mapDescriptor(int fd, int flags, CmnFileMap *map)
+{
+	struct stat st;
+	void *addr;
+
+	if (fstat(fd, &st) < 0 || (unsigned long long)st.st_size > (size_t)-1) {
+		CMNLOG_DEBUG("Failed to get file size, fd=%d", fd);
+		return -1;
+	}
+
+	/* 通常のファイル以外と、サイズ0のファイル（/procなど実際のサイズが不明なものを含む）は読み込む */
+	if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+		if (S_ISREG(st.st_mode)) {
+			lseek(fd, 0, SEEK_SET);
+		}
+		return readAll(fd, 0, map);
+	}
+
+	addr = mapAligned(fd, (size_t)st.st_size);
+	if (addr == MAP_FAILED) {
+		CMNLOG_DEBUG("Failed to map file, read instead. fd=%d, errno=%d", fd, errno);
+		lseek(fd, 0, SEEK_SET);
+		return readAll(fd, (size_t)st.st_size, map);
+	}
+
+	map->_addr = addr;
+	map->_isMapped = True;
+	map->data = addr;
+	map->size = (size_t)st.st_size;
+
+	/* アクセス方法のヒント */
+	if (flags & CMN_FILE_MAP_SEQUENTIAL) {
+		madvise(addr, map->size, MADV_SEQUENTIAL);
+	}
+	else if (flags & CMN_FILE_MAP_RANDOM) {
+		madvise(addr, map->size, MADV_RANDOM);
+	}
+	if (flags & CMN_FILE_MAP_WILLNEED) {
+		madvise(addr, map->size, MADV_WILLNEED);
+	}
+	return 0;
+}
+
+/**
+ * @brief ヒュージページ境界へのマップ
+ *
+ *  ヒュージページ以上のサイズの場合は、境界を合わせるために1ページ分大きく領域を予約し、
+ *  境界の位置にファイルをマップして前後の余りを解放する。
+ *
+ * @param fd ファイルディスクリプタ
+ * @param size マップするサイズ
+ * @return マップしたアドレス。失敗した場合はMAP_FAILED。
+ */
+static void* mapAligned(int fd, size_t size)
+{
+	char *reserved;
+	char *aligned;
+	char *mapEnd;
+	void *addr;
+	size_t pageSize;
+
+	if (size >= HUGE_PAGE_SIZE && size <= (size_t)-1 - HUGE_PAGE_SIZE) {
+		reserved = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (reserved != MAP_FAILED) {
+			aligned = (char *)(((uintptr_t)reserved + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+			addr = mmap(aligned, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+			if (addr != MAP_FAILED) {
+				pageSize = (size_t)sysconf(_SC_PAGESIZE);
+				mapEnd = aligned + (size + pageSize - 1) / pageSize * pageSize;
+				if (aligned > reserved) {
+					munmap(reserved, aligned - reserved);
+				}
+				if (mapEnd < reserved + size + HUGE_PAGE_SIZE) {
+					munmap(mapEnd, reserved + size + HUGE_PAGE_SIZE - mapEnd);
+				}
+#ifdef MADV_HUGEPAGE
+				madvise(addr, size, MADV_HUGEPAGE);
+#endif
+				return addr;
+			}
+			munmap(reserved, size + HUGE_PAGE_SIZE);
+		}
+	}
+	return mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+}
+
+/**
+ * @brief ファイル全体の読み込み（マップできない場合）
+ *
+ *  サイズがわかっている場合はその領域を一度に確保して読み込む。
+ *  サイズが不明な場合は、領域を倍々に拡張しながら終端まで読み込む。
+ *
+ * @param fd ファイルディスクリプタ
+ * @param size ファイルサイズ（不明な場合は0）
+ * @param map 読み込み結果
+ * @return 0:正常、-1:エラー
+ */
+static int readAll(int fd, size_t size, CmnFileMap *map)
+{
+	char *buf;
+	char *tmp;
+	size_t bufSize = (size > 0) ? size : READ_BUF_SIZE;
+	size_t total = 0;
+	ssize_t readLen;
+
+	if ((buf = malloc(bufSize)) == NULL) {
+		return -1;
+	}
+	for (;;) {
+		if (total == bufSize) {
+			/* サイズ指定時はファイルが伸びていても指定サイズまでとする */
+			if (size > 0) {
+				break;
+			}
+			if ((tmp = realloc(buf, bufSize * 2)) == NULL) {
+				free(buf);
+				return -1;
+			}
+			buf = tmp;
+			bufSize *= 2;
+		}
+		readLen = read(fd, buf + total, bufSize - total);
+		if (readLen < 0 && errno == EINTR) {
+			continue;
+		}
+		if (readLen < 0) {
+			free(buf);
+			return -1;
+		}
+		if (readLen == 0) {
+			break;
+		}
+		total += (size_t)readLen;
+	}
+
+	map->_addr = buf;
+	map->_isMapped = False;
+	map->data = buf;
+	map->size = total;
+	return 0;
+}
+
+#endif
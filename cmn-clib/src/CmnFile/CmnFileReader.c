@@ -0,0 +1,422 @@
+/** @file *********************************************************************
+ * @brief 行単位のファイル読み込み 共通関数
+ *
+ *  ファイルを大きなブロック単位（64KB～1MB）で読み込み、1行ずつ返す共通関数。<br>
+ *  行はバッファ内を指すビューとして返すため、行ごとのメモリ確保は発生しない。
+ *  使用するメモリはブロックサイズ（ブロックより長い行がある場合はその行の長さ）で一定であり、
+ *  ファイルサイズには依存しない。<br>
+ *  改行コードはCmnString_StrEolと同じく、CRLF、LF、CRのいずれも1つの改行として扱う。
+ *  返す行に改行コードは含まない。最後の行が改行で終わっていない場合もその行を返す。<br>
+ *  CMN_FILE_READER_READ_AHEADを指定すると、行の処理中に次のブロックを別スレッドで読み込む。<br>
+ *  パイプや端末（tail -fの出力等）からの読み込みでは、ブロックが埋まるのを待たずに届いた分だけで行を返す。<br>
+ *  1行ずつの読み込みは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileReader *reader = CmnFileReader_Open("data.txt", 0, CMN_FILE_READER_READ_AHEAD);<BR>
+ *  CmnStringView line;<BR>
+ *  while (CmnFileReader_ReadLine(reader, &line) == 1) {<BR>
+ *      fwrite(line.str, 1, line.len, stdout);<BR>
+ *  }<BR>
+ *  CmnFileReader_Free(reader);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnLog.h"
+#include "../CmnBit.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#ifdef CMN_CLIB_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/** ブロックサイズの既定値 */
+#define DEFAULT_BLOCK_SIZE (256 * 1024)
+/** ブロックサイズの最小値 */
+#define MIN_BLOCK_SIZE (64 * 1024)
+/** ブロックサイズの最大値 */
+#define MAX_BLOCK_SIZE (1024 * 1024)
+
+/** 行単位のファイル読み込み */
+struct _tag_CmnFileReader {
+	FILE *fp;					/**< 読み込み元 */
+	int closeFile;				/**< Free時にfpを閉じるか */
+	size_t blockSize;			/**< 1回に読み込むサイズ */
+	char *buf;					/**< 読み込んだデータ */
+	size_t bufSize;
+	const char *data;			/**< 未読のデータの先頭 */
+	const char *end;			/**< データの末尾 */
+	int eof;					/**< ファイルの終端まで読み込んだか */
+	int partialRead;			/**< 届いた分だけ読み込むか（通常のファイル以外） */
+	int error;					/**< 読み込みエラーが発生したか */
+
+	/* 先読み */
+	int readAhead;				/**< 先読みするか */
+	int aheadRunning;			/**< 先読みスレッドが実行中か */
+	CmnThread aheadThread;		/**< 先読みスレッド */
+	char *aheadBuf;				/**< 先読みしたデータ（blockSize） */
+	long long aheadLen;			/**< 先読みしたバイト数 */
+	int aheadError;				/**< 先読みでエラーが発生したか */
+};
+
+static CmnFileReader* create(FILE *fp, int closeFile, size_t blockSize, int flags);
+static int fill(CmnFileReader *reader);
+static long long readBlock(CmnFileReader *reader, char *buf, size_t len);
+static int isRegularFile(FILE *fp);
+static void readAheadMethod(CmnThread *thread);
+static void startReadAhead(CmnFileReader *reader);
+static const char* findEol(const char *p, const char *end);
+
+/**
+ * @brief ファイルを開いて行単位の読み込みを開始する
+ *
+ * @param filePath ファイルパス
+ * @param blockSize 1回に読み込むサイズ。0の場合は既定値（256KB）。64KB～1MBの範囲に補正する。
+ * @param flags CMN_FILE_READER_READ_AHEAD（先読みする）もしくは0
+ * @return 行単位のファイル読み込み。ファイルが開けない場合、メモリ不足の場合はNULL。
+ */
+CmnFileReader* CmnFileReader_Open(const char *filePath, size_t blockSize, int flags)
+{
+	CmnFileReader *reader;
+	FILE *fp;
+	CMNLOG_TRACE_START();
+
+	if ((fp = fopen(filePath, "rb")) == NULL) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", filePath);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	reader = create(fp, True, blockSize, flags);
+	if (reader == NULL) {
+		fclose(fp);
+	}
+
+	CMNLOG_TRACE_END();
+	return reader;
+}
+
+/**
+ * @brief 開いているファイルの行単位の読み込みを開始する
+ *
+ *  標準入力など、呼び出し側で開いたファイルを読み込む。fpはCmnFileReader_Freeで閉じない。
+ *  読み込み中は呼び出し側でfpを操作しないこと。<br>
+ *  fpがパイプや端末の場合は届いた分だけ読み込むため、書き込まれた行をすぐに返す。
+ *
+ * @param fp 読み込むファイル
+ * @param blockSize 1回に読み込むサイズ。0の場合は既定値（256KB）。64KB～1MBの範囲に補正する。
+ * @param flags CMN_FILE_READER_READ_AHEAD（先読みする）もしくは0
+ * @return 行単位のファイル読み込み。メモリ不足の場合はNULL。
+ */
+CmnFileReader* CmnFileReader_Create(FILE *fp, size_t blockSize, int flags)
+{
+	CmnFileReader *reader;
+	CMNLOG_TRACE_START();
+
+	reader = create(fp, False, blockSize, flags);
+
+	CMNLOG_TRACE_END();
+	return reader;
+}
+
+/**
+ * @brief 1行読み込む
+ *
+ *  次の1行を改行コードを除いたビューとして返す。<br>
+ *  ビューは読み込み用のバッファを指すため、次にCmnFileReader_ReadLineを呼び出すまでの間だけ有効。
+ *
+ * @param reader 行単位のファイル読み込み
+ * @param line (O) 読み込んだ行（'\0'で終端していない）
+ * @return 1行読み込んだ:1, 終端:0, エラー（読み込みエラー、メモリ不足）:-1
+ */
+int CmnFileReader_ReadLine(CmnFileReader *reader, CmnStringView *line)
+{
+	const char *eol;
+	size_t scanned = 0;
+
+	for (;;) {
+		eol = findEol(reader->data + scanned, reader->end);
+
+		/* 改行コードあり（データ末尾のCRは次がLFかわからないため、続きを読み込んでから判定する） */
+		if (eol < reader->end && (*eol == '\n' || eol + 1 < reader->end || reader->eof)) {
+			line->str = reader->data;
+			line->len = eol - reader->data;
+			reader->data = (*eol == '\r' && eol + 1 < reader->end && eol[1] == '\n') ? eol + 2 : eol + 1;
+			return 1;
+		}
+
+		/* 終端（改行で終わっていない最後の行） */
+		if (reader->eof) {
+			if (reader->data == reader->end) {
+				return 0;
+			}
+			line->str = reader->data;
+			line->len = reader->end - reader->data;
+			reader->data = reader->end;
+			return 1;
+		}
+
+		/* 続きを読み込む（検索済みの範囲は再検索しない） */
+		scanned = eol - reader->data;
+		if (fill(reader) != 0) {
+			return -1;
+		}
+	}
+}
+
+/**
+ * @brief 行単位のファイル読み込みの終了
+ *
+ *  先読み中の場合は完了を待ち、CmnFileReader_Openで開いたファイルを閉じる。
+ *
+ * @param reader 行単位のファイル読み込み（NULLの場合は何もしない）
+ */
+void CmnFileReader_Free(CmnFileReader *reader)
+{
+	CMNLOG_TRACE_START();
+
+	if (reader == NULL) {
+		CMNLOG_TRACE_END();
+		return;
+	}
+	if (reader->aheadRunning) {
+		CmnThread_Join(&reader->aheadThread);
+	}
+	if (reader->closeFile) {
+		fclose(reader->fp);
+	}
+	free(reader->aheadBuf);
+	free(reader->buf);
+	free(reader);
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief 行単位のファイル読み込みの作成
+ */
+static CmnFileReader* create(FILE *fp, int closeFile, size_t blockSize, int flags)
+{
+	CmnFileReader *reader;
+
+	if (blockSize == 0) {
+		blockSize = DEFAULT_BLOCK_SIZE;
+	}
+	else if (blockSize < MIN_BLOCK_SIZE) {
+		blockSize = MIN_BLOCK_SIZE;
+	}
+	else if (blockSize > MAX_BLOCK_SIZE) {
+		blockSize = MAX_BLOCK_SIZE;
+	}
+
+	if ((reader = calloc(1, sizeof(CmnFileReader))) == NULL) {
+		return NULL;
+	}
+	reader->fp = fp;
+	reader->closeFile = closeFile;
+	reader->blockSize = blockSize;
+	reader->bufSize = blockSize;
+	reader->buf = malloc(reader->bufSize);
+	if (reader->buf == NULL) {
+		free(reader);
+		return NULL;
+	}
+	reader->data = reader->buf;
+	reader->end = reader->buf;
+	reader->partialRead = !isRegularFile(fp);
+
+	/* ブロック単位で直接読み込むため、stdioのバッファは使用しない */
+	setvbuf(fp, NULL, _IONBF, 0);
+
+	/* 先読みは最初のブロックから開始する */
+	if (flags & CMN_FILE_READER_READ_AHEAD) {
+		reader->aheadBuf = malloc(blockSize);
+		if (reader->aheadBuf != NULL) {
+			reader->readAhead = True;
+			startReadAhead(reader);
+		}
+	}
+	return reader;
+}
+
+/**
+ * @brief 続きの読み込み
+ *
+ *  未読のデータをバッファの先頭に移動し、空いた領域に続きを読み込む。
+ *  未読のデータでバッファが埋まっている場合（1行がバッファより長い場合）はバッファを拡張する。<br>
+ *  先読みしている場合は、先読みの完了を待って先読みしたデータを追加し、次の先読みを開始する。
+ *
+ * @return 正常:0, エラー（読み込みエラー、メモリ不足）:-1
+ */
+static int fill(CmnFileReader *reader)
+{
+	size_t remain = reader->end - reader->data;
+	size_t need;
+	long long readLen;
+	char *tmp;
+
+	if (reader->error) {
+		return -1;
+	}
+
+	if (reader->data != reader->buf) {
+		memmove(reader->buf, reader->data, remain);
+	}
+	reader->data = reader->buf;
+	reader->end = reader->buf + remain;
+
+	/* 先読みしない場合（もしくは先読みを開始できなかった場合）の読み込み量は空き領域全体 */
+	need = (reader->aheadRunning) ? remain + reader->blockSize : remain + 1;
+	if (need > reader->bufSize) {
+		size_t newSize = reader->bufSize * 2;
+		if (newSize < need) {
+			newSize = need;
+		}
+		if ((tmp = realloc(reader->buf, newSize)) == NULL) {
+			reader->error = True;
+			return -1;
+		}
+		reader->buf = tmp;
+		reader->bufSize = newSize;
+		reader->data = reader->buf;
+		reader->end = reader->buf + remain;
+	}
+
+	if (reader->aheadRunning) {
+		CmnThread_Join(&reader->aheadThread);
+		reader->aheadRunning = False;
+		if (reader->aheadError) {
+			CMNLOG_WARN("file read error. read ahead, block=%zu", reader->blockSize);
+			reader->error = True;
+			return -1;
+		}
+		readLen = reader->aheadLen;
+		memcpy(reader->buf + remain, reader->aheadBuf, (size_t)readLen);
+		if (readLen > 0) {
+			startReadAhead(reader);
+		}
+	}
+	else {
+		readLen = readBlock(reader, reader->buf + remain, reader->bufSize - remain);
+		if (readLen < 0) {
+			CMNLOG_WARN("file read error. block=%zu", reader->blockSize);
+			reader->error = True;
+			return -1;
+		}
+	}
+
+	if (readLen == 0) {
+		reader->eof = True;
+	}
+	reader->end = reader->buf + remain + readLen;
+	return 0;
+}
+
+/**
+ * @brief 1ブロックの読み込み
+ *
+ *  通常のファイルは指定サイズまで読み込む。
+ *  パイプや端末は届いた分だけ読み込んで戻る（1バイト以上届くか終端になるまでは待つ）。
+ *
+ * @return 読み込んだバイト数（終端:0, エラー:-1）
+ */
+static long long readBlock(CmnFileReader *reader, char *buf, size_t len)
+{
+	size_t readLen;
+
+	if (reader->partialRead) {
+#if IS_PRATFORM_WINDOWS()
+		return _read(_fileno(reader->fp), buf, (unsigned int)len);
+#else
+		ssize_t ret;
+		while ((ret = read(fileno(reader->fp), buf, len)) < 0 && errno == EINTR) {}
+		return ret;
+#endif
+	}
+	readLen = fread(buf, 1, len, reader->fp);
+	return (readLen == 0 && ferror(reader->fp)) ? -1 : (long long)readLen;
+}
+
+/**
+ * @brief 通常のファイルか
+ * @return 通常のファイル:True, パイプ・端末等:False
+ */
+static int isRegularFile(FILE *fp)
+{
+#if IS_PRATFORM_WINDOWS()
+	struct _stati64 st;
+	return (_fstati64(_fileno(fp), &st) == 0 && (st.st_mode & _S_IFREG)) ? True : False;
+#else
+	struct stat st;
+	return (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode)) ? True : False;
+#endif
+}
+
+/**
+ * @brief 先読みの開始
+ *
+ *  スレッドを開始できない場合は先読みをやめ、以降は呼び出し元のスレッドで読み込む。
+ */
+static void startReadAhead(CmnFileReader *reader)
+{
+	CmnThread_Init(&reader->aheadThread, readAheadMethod, reader, NULL);
+	if (CmnThread_Start(&reader->aheadThread) == 0) {
+		reader->aheadRunning = True;
+	}
+	else {
+		reader->readAhead = False;
+	}
+}
+
+/**
+ * @brief 先読みスレッドの処理（1ブロック読み込む）
+ */
+static void readAheadMethod(CmnThread *thread)
+{
+	CmnFileReader *reader = thread->data;
+
+	reader->aheadLen = readBlock(reader, reader->aheadBuf, reader->blockSize);
+	reader->aheadError = (reader->aheadLen < 0) ? True : False;
+}
+
+/**
+ * @brief 改行コード（CRもしくはLF）の検索
+ * @return 最初に出現したCRもしくはLFの位置。出現しない場合はend。
+ */
+static const char* findEol(const char *p, const char *end)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+		if (mask != 0) {
+			return p + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	for (; p < end; p++) {
+		if (*p == '\r' || *p == '\n') {
+			break;
+		}
+	}
+	return p;
+}
@@ -0,0 +1,858 @@
+/** @file *********************************************************************
+ * @brief ディレクトリの再帰的な走査 共通関数
+ *
+ *  ディレクトリ配下のファイル、ディレクトリを再帰的に走査し、1件ごとにコールバック関数を呼び出す共通関数。<br>
+ *  Linuxではディレクトリをopenat/fdopendirで開き、ファイル属性はディレクトリからの相対パスでfstatatにより取得する。
+ *  readdirの結果（d_type）で種別が分かる場合はfstatatも呼び出さないため、
+ *  1件あたりのシステムコールは多くても1回（fstatat、もしくはディレクトリのopenat）で済む。<br>
+ *  <br>
+ *  コールバック関数の戻り値で走査を制御する。<br>
+ *  ・CMN_FILE_WALK_CONTINUE : 走査を続ける<br>
+ *  ・CMN_FILE_WALK_PRUNE    : ディレクトリの場合、その配下を走査しない<br>
+ *  ・CMN_FILE_WALK_STOP     : 走査を中止する<br>
+ *  <br>
+ *  シンボリックリンクは、CMN_FILE_WALK_FOLLOW_LINKSを指定しない場合はリンク自体（CMN_FILE_TYPE_SYMLINK）として通知し、リンク先は走査しない。
+ *  指定した場合はリンク先の種別で通知し、リンク先のディレクトリも走査する（親ディレクトリへのリンクによる循環は検出して走査しない）。<br>
+ *  <br>
+ *  CmnFile_WalkParallelは複数のスレッドで走査する（メタデータの取得待ちが長いNFSなどの大きなツリー向け）。
+ *  スレッドごとに走査待ちのディレクトリのキューを持ち、自分のキューが空になったスレッドは他のスレッドのキューから
+ *  ディレクトリを奪って走査する（ワークスティーリング）。
+ *  全てのキューが空になったスレッドは、ディレクトリが追加されるか走査が終わるまで条件変数で待つ。
+ *  1つのディレクトリ（DIRストリーム）は1つのスレッドだけが読むため、readdirを複数のスレッドで同時に使用しても問題ない。<br>
+ *  1件ごとの処理は呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/** パスのバッファの初期サイズ */
+#define INITIAL_PATH_SIZE 1024
+/** 並列走査のスレッド数の上限 */
+#define MAX_THREADS 64
+
+/** 中止要求の参照、設定（並列走査では他のスレッドが処理中に設定するため、アトミックに読み書きする） */
+#if IS_PRATFORM_WINDOWS()
+#define LOAD_STOP(stop) InterlockedCompareExchange((volatile LONG *)(stop), 0, 0)
+#define STORE_STOP(stop) InterlockedExchange((volatile LONG *)(stop), True)
+#else
+#define LOAD_STOP(stop) __atomic_load_n(stop, __ATOMIC_RELAXED)
+#define STORE_STOP(stop) __atomic_store_n(stop, True, __ATOMIC_RELAXED)
+#endif
+
+/** ディレクトリの識別子（シンボリックリンクの循環検出用） */
+typedef struct {
+#if IS_PRATFORM_WINDOWS()
+	int dummy;
+#else
+	dev_t dev;
+	ino_t ino;
+#endif
+} DirId;
+
+typedef struct _tag_Walker Walker;
+typedef struct _tag_WalkPool WalkPool;
+
+/** 走査の状態（並列走査ではスレッドごと） */
+struct _tag_Walker {
+	char *path;						/**< 走査中のパス */
+	size_t pathSize;
+	int maxDepth;					/**< 走査する深さ（0は無制限） */
+	int flags;						/**< CMN_FILE_WALK_* */
+	CmnFileWalkCallback callback;	/**< コールバック関数 */
+	void *data;						/**< コールバック関数に渡すデータ */
+	int *stop;						/**< 走査の中止要求（LOAD_STOPで参照する） */
+	/** 配下のディレクトリの走査（逐次走査は再帰、並列走査はキューに追加）。dirFdは親ディレクトリ（Linuxのみ） */
+	int (*enterDir)(Walker *walker, int dirFd, const CmnFileWalkEntry *entry);
+	DirId *ancestors;				/**< 走査中のディレクトリ（逐次走査の循環検出用） */
+	int ancestorCount;
+	int ancestorSize;
+	WalkPool *pool;					/**< 並列走査の情報（逐次走査はNULL） */
+	int id;							/**< 並列走査のスレッド番号 */
+};
+
+/** 並列走査の走査待ちのディレクトリ */
+typedef struct {
+	int depth;						/**< ディレクトリ配下の深さ */
+	int isRoot;						/**< 起点のディレクトリか */
+	size_t pathLength;
+	char path[1];					/**< パス（可変長） */
+} WalkTask;
+
+/** 並列走査のスレッドごとのキュー（持ち主は末尾から、他のスレッドは先頭から取り出す） */
+typedef struct {
+	WalkTask **tasks;
+	int head;
+	int tail;
+	int size;
+	CmnThreadMutex *mutex;
+} WalkDeque;
+
+/** 並列走査の情報 */
+struct _tag_WalkPool {
+	int threadCount;
+	Walker walkers[MAX_THREADS];
+	WalkDeque deques[MAX_THREADS];
+	CmnThread threads[MAX_THREADS];
+	CmnThreadMutex *mutex;			/**< pending、idleCount、result、visitedのロック */
+	CmnThreadCond *cond;			/**< ディレクトリの追加、走査の終了、中止の通知 */
+	long long pending;				/**< キューに追加して走査が終わっていないディレクトリの数 */
+	int idleCount;					/**< condで待っているスレッドの数 */
+	int stop;						/**< 中止要求（LOAD_STOP、STORE_STOPで読み書きする） */
+	int result;						/**< 結果（0:全て走査, 1:中止, -1:メモリ不足） */
+	DirId *visited;					/**< 走査したディレクトリ（シンボリックリンクをたどる場合の循環検出用。オープンアドレス法） */
+	size_t visitedCount;
+	size_t visitedSize;
+};
+
+#if IS_PRATFORM_WINDOWS()
+static int walkDir(Walker *walker, size_t pathLen, int depth);
+#else
+static int walkDir(Walker *walker, int fd, size_t pathLen, int depth);
+static int pushAncestor(Walker *walker, int fd);
+static int addVisited(WalkPool *pool, int fd);
+#endif
+static int enterDirRecursive(Walker *walker, int dirFd, const CmnFileWalkEntry *entry);
+static int enterDirParallel(Walker *walker, int dirFd, const CmnFileWalkEntry *entry);
+static int pushTask(WalkPool *pool, int id, const char *path, size_t pathLen, int depth, int isRoot);
+static WalkTask* takeTask(WalkPool *pool, int id);
+static int runTask(Walker *walker, WalkTask *task);
+static void workerMethod(CmnThread *thread);
+static void stopWorkers(WalkPool *pool, int result);
+static int reservePath(Walker *walker, size_t size);
+
+/**
+ * @brief ディレクトリ配下を再帰的に走査する
+ *
+ *  起点のディレクトリ配下のファイル、ディレクトリごとにコールバック関数を呼び出す（起点のディレクトリ自体は通知しない）。<br>
+ *  ディレクトリは配下よりも先に通知する。同じディレクトリ内の順序は不定。<br>
+ *  配下のディレクトリが開けない場合は、そのディレクトリの配下を走査せずに続ける。
+ *
+ * @param path 起点のディレクトリのパス
+ * @param maxDepth 走査する深さ（1は起点のディレクトリ直下のみ）。0の場合は無制限。
+ * @param flags CMN_FILE_WALK_STAT（サイズ、最終更新日時を取得する）、CMN_FILE_WALK_FOLLOW_LINKS（シンボリックリンクをたどる）の組み合わせ
+ * @param callback 1件ごとに呼び出すコールバック関数。戻り値はCMN_FILE_WALK_CONTINUE/PRUNE/STOP。
+ * @param data コールバック関数に渡す任意のデータ
+ * @return 全て走査した:0, コールバック関数が中止した:1, 起点のディレクトリが開けない、メモリ不足:-1
+ */
+int CmnFile_Walk(const char *path, int maxDepth, int flags, CmnFileWalkCallback callback, void *data)
+{
+	Walker walker;
+	size_t pathLen = strlen(path);
+	int stop = False;
+	int ret;
+#if IS_PRATFORM_WINDOWS()
+	DWORD attributes;
+#else
+	int fd;
+#endif
+	CMNLOG_TRACE_START();
+
+	memset(&walker, 0, sizeof(walker));
+	walker.maxDepth = maxDepth;
+	walker.flags = flags;
+	walker.callback = callback;
+	walker.data = data;
+	walker.stop = &stop;
+	walker.enterDir = enterDirRecursive;
+
+	/* 最後の文字がパス区切りなら除去（ルートディレクトリは除く） */
+	while (pathLen > 1 && (path[pathLen - 1] == '/' || path[pathLen - 1] == '\\')) {
+		pathLen--;
+	}
+	if (reservePath(&walker, pathLen + INITIAL_PATH_SIZE) != 0) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	memcpy(walker.path, path, pathLen);
+	walker.path[pathLen] = '\0';
+	if (pathLen == 1 && (path[0] == '/' || path[0] == '\\')) {
+		pathLen = 0;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	attributes = GetFileAttributesA(walker.path);
+	if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		CMNLOG_DEBUG("Failed to open directory, path=%s", walker.path);
+		free(walker.path);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	ret = walkDir(&walker, pathLen, 1);
+#else
+	if ((fd = open(walker.path, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+		CMNLOG_DEBUG("Failed to open directory, path=%s", walker.path);
+		free(walker.path);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	if ((flags & CMN_FILE_WALK_FOLLOW_LINKS) && pushAncestor(&walker, fd) != 0) {
+		close(fd);
+		free(walker.path);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	ret = walkDir(&walker, fd, pathLen, 1);
+	free(walker.ancestors);
+#endif
+	free(walker.path);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief ディレクトリ配下を複数のスレッドで再帰的に走査する
+ *
+ *  CmnFile_Walkと同じくファイル、ディレクトリごとにコールバック関数を呼び出すが、
+ *  コールバック関数は複数のスレッドから同時に呼び出される（結果の集計など、コールバック関数の中の処理は呼び出し側で排他制御すること）。<br>
+ *  通知する順序は不定（ディレクトリは配下よりも先に通知する）。
+ *  CMN_FILE_WALK_STOPを返した場合、他のスレッドが処理中のエントリを通知してから中止する。<br>
+ *  CMN_FILE_WALK_FOLLOW_LINKSを指定した場合、同じディレクトリは（別のリンクからたどれる場合も）1回だけ走査する。
+ *
+ * @param path 起点のディレクトリのパス
+ * @param maxDepth 走査する深さ（1は起点のディレクトリ直下のみ）。0の場合は無制限。
+ * @param flags CMN_FILE_WALK_STAT、CMN_FILE_WALK_FOLLOW_LINKSの組み合わせ
+ * @param threadCount スレッド数（1～64）。1の場合は呼び出し元のスレッドで走査する。
+ * @param callback 1件ごとに呼び出すコールバック関数（スレッドセーフであること）
+ * @param data コールバック関数に渡す任意のデータ
+ * @return 全て走査した:0, コールバック関数が中止した:1, 起点のディレクトリが開けない、メモリ不足:-1
+ */
+int CmnFile_WalkParallel(const char *path, int maxDepth, int flags, int threadCount, CmnFileWalkCallback callback, void *data)
+{
+	WalkPool *pool;
+	size_t pathLen = strlen(path);
+	int i, started = 0, ret;
+	CMNLOG_TRACE_START();
+
+	if (threadCount <= 1) {
+		ret = CmnFile_Walk(path, maxDepth, flags, callback, data);
+		CMNLOG_TRACE_END();
+		return ret;
+	}
+	if (threadCount > MAX_THREADS) {
+		threadCount = MAX_THREADS;
+	}
+	if ((pool = calloc(1, sizeof(WalkPool))) == NULL || (pool->mutex = CmnThreadMutex_Create()) == NULL
+			|| (pool->cond = CmnThreadCond_Create()) == NULL) {
+		if (pool != NULL && pool->mutex != NULL) {
+			CmnThreadMutex_Free(pool->mutex);
+		}
+		free(pool);
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	pool->threadCount = threadCount;
+	for (i = 0; i < threadCount; i++) {
+		pool->walkers[i].maxDepth = maxDepth;
+		pool->walkers[i].flags = flags;
+		pool->walkers[i].callback = callback;
+		pool->walkers[i].data = data;
+		pool->walkers[i].stop = &pool->stop;
+		pool->walkers[i].enterDir = enterDirParallel;
+		pool->walkers[i].pool = pool;
+		pool->walkers[i].id = i;
+		if ((pool->deques[i].mutex = CmnThreadMutex_Create()) == NULL) {
+			pool->result = -1;
+		}
+	}
+
+	/* 最後の文字がパス区切りなら除去（ルートディレクトリは除く） */
+	while (pathLen > 1 && (path[pathLen - 1] == '/' || path[pathLen - 1] == '\\')) {
+		pathLen--;
+	}
+
+	/* 起点のディレクトリを走査してから、配下のディレクトリを各スレッドで走査 */
+	if (pool->result == 0 && pushTask(pool, 0, path, pathLen, 1, True) == 0) {
+		ret = runTask(&pool->walkers[0], takeTask(pool, 0));
+		if (ret < 0 && pool->pending == 0) {
+			/* 起点のディレクトリが開けない */
+			pool->result = -1;
+		}
+		else {
+			if (ret != 0) {
+				STORE_STOP(&pool->stop);
+				pool->result = ret;
+			}
+			for (i = 0; i < threadCount; i++) {
+				CmnThread_Init(&pool->threads[i], workerMethod, &pool->walkers[i], NULL);
+				if (CmnThread_Start(&pool->threads[i]) != 0) {
+					break;
+				}
+				started++;
+			}
+			/* スレッドを開始できない場合も、開始できたスレッドだけで全て走査する */
+			if (started == 0) {
+				workerMethod(&pool->threads[0]);
+			}
+			for (i = 0; i < started; i++) {
+				CmnThread_Join(&pool->threads[i]);
+			}
+		}
+	}
+	else {
+		pool->result = -1;
+	}
+	ret = pool->result;
+
+	/* 中止した場合に残ったディレクトリを破棄（スレッドは終了済みのため、ロックせずに各キューを直接空にする） */
+	for (i = 0; i < threadCount; i++) {
+		WalkDeque *deque = &pool->deques[i];
+		while (deque->tail > deque->head) {
+			free(deque->tasks[--deque->tail]);
+		}
+	}
+	for (i = 0; i < threadCount; i++) {
+		free(pool->deques[i].tasks);
+		if (pool->deques[i].mutex != NULL) {
+			CmnThreadMutex_Free(pool->deques[i].mutex);
+		}
+		free(pool->walkers[i].path);
+	}
+	CmnThreadCond_Free(pool->cond);
+	CmnThreadMutex_Free(pool->mutex);
+	free(pool->visited);
+	free(pool);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+#if IS_PRATFORM_WINDOWS()
+/**
+ * @brief ディレクトリの走査（Windows）
+ *
+ *  FindFirstFileExの結果に種別、サイズ、最終更新日時が含まれるため、ファイル属性の取得は不要。
+ *
+ * @param pathLen 走査するディレクトリのパスの長さ（walker->pathの先頭から）
+ * @return 全て走査した:0, 中止:1, メモリ不足:-1
+ */
+static int walkDir(Walker *walker, size_t pathLen, int depth)
+{
+	WIN32_FIND_DATAA findData;
+	HANDLE handle;
+	CmnFileWalkEntry entry;
+	size_t nameLen;
+	int action, ret = 0;
+
+	if (reservePath(walker, pathLen + 3) != 0) {
+		return -1;
+	}
+	memcpy(walker->path + pathLen, "\\*", 3);
+	handle = FindFirstFileExA(walker->path, FindExInfoBasic, &findData, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+	if (handle == INVALID_HANDLE_VALUE) {
+		walker->path[pathLen] = '\0';
+		CMNLOG_DEBUG("Failed to open directory, path=%s", walker->path);
+		return 0;
+	}
+
+	do {
+		/* 「.」と「..」はスキップ */
+		if (strcmp(findData.cFileName, ".") == 0 || strcmp(findData.cFileName, "..") == 0) {
+			continue;
+		}
+
+		nameLen = strlen(findData.cFileName);
+		if (reservePath(walker, pathLen + nameLen + 2) != 0) {
+			ret = -1;
+			break;
+		}
+		walker->path[pathLen] = '\\';
+		memcpy(walker->path + pathLen + 1, findData.cFileName, nameLen + 1);
+
+		entry.path = walker->path;
+		entry.pathLength = pathLen + 1 + nameLen;
+		entry.name = walker->path + pathLen + 1;
+		entry.depth = depth;
+		if ((findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) && !(walker->flags & CMN_FILE_WALK_FOLLOW_LINKS)) {
+			entry.type = CMN_FILE_TYPE_SYMLINK;
+		}
+		else if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			entry.type = CMN_FILE_TYPE_DIRECTORY;
+		}
+		else {
+			entry.type = CMN_FILE_TYPE_FILE;
+		}
+		entry.size = ((long long)findData.nFileSizeHigh << 32) | findData.nFileSizeLow;
+		entry.lastUpdateTime = (time_t)(((((unsigned long long)findData.ftLastWriteTime.dwHighDateTime) << 32)
+				| findData.ftLastWriteTime.dwLowDateTime) / 10000000ULL - 11644473600ULL);
+
+		action = walker->callback(&entry, walker->data);
+		if (action == CMN_FILE_WALK_STOP || LOAD_STOP(walker->stop)) {
+			ret = 1;
+			break;
+		}
+
+		/* 配下のディレクトリを走査 */
+		if (entry.type == CMN_FILE_TYPE_DIRECTORY && action != CMN_FILE_WALK_PRUNE
+				&& (walker->maxDepth <= 0 || depth < walker->maxDepth)) {
+			if ((ret = walker->enterDir(walker, -1, &entry)) != 0) {
+				break;
+			}
+		}
+	} while (FindNextFileA(handle, &findData));
+
+	FindClose(handle);
+	return ret;
+}
+#else
+/**
+ * @brief ディレクトリの走査（Linux）
+ *
+ *  d_typeで種別が分かる場合はファイル属性を取得しない。
+ *  取得が必要な場合（CMN_FILE_WALK_STAT指定時、d_typeが不明な場合、シンボリックリンクをたどる場合）はfstatatで取得する。
+ *
+ * @param fd 走査するディレクトリのファイルディスクリプタ（この関数で閉じる）
+ * @param pathLen 走査するディレクトリのパスの長さ（walker->pathの先頭から）
+ * @return 全て走査した:0, 中止:1, メモリ不足:-1
+ */
+static int walkDir(Walker *walker, int fd, size_t pathLen, int depth)
+{
+	DIR *dp;
+	struct dirent *ent;
+	struct stat st;
+	CmnFileWalkEntry entry;
+	size_t nameLen;
+	int dirFd, action, ret = 0;
+	int follow = (walker->flags & CMN_FILE_WALK_FOLLOW_LINKS) ? True : False;
+
+	if ((dp = fdopendir(fd)) == NULL) {
+		close(fd);
+		return 0;
+	}
+	dirFd = dirfd(dp);
+
+	while ((ent = readdir(dp)) != NULL) {
+		/* 「.」と「..」はスキップ */
+		if (ent->d_name[0] == '.' && (ent->d_name[1] == '\0' || (ent->d_name[1] == '.' && ent->d_name[2] == '\0'))) {
+			continue;
+		}
+
+		nameLen = strlen(ent->d_name);
+		if (reservePath(walker, pathLen + nameLen + 2) != 0) {
+			ret = -1;
+			break;
+		}
+		walker->path[pathLen] = '/';
+		memcpy(walker->path + pathLen + 1, ent->d_name, nameLen + 1);
+
+		entry.path = walker->path;
+		entry.pathLength = pathLen + 1 + nameLen;
+		entry.name = walker->path + pathLen + 1;
+		entry.depth = depth;
+		entry.size = 0;
+		entry.lastUpdateTime = 0;
+		switch (ent->d_type) {
+		case DT_REG: entry.type = CMN_FILE_TYPE_FILE; break;
+		case DT_DIR: entry.type = CMN_FILE_TYPE_DIRECTORY; break;
+		case DT_LNK: entry.type = CMN_FILE_TYPE_SYMLINK; break;
+		case DT_UNKNOWN: entry.type = 0; break;
+		default: entry.type = CMN_FILE_TYPE_OTHER; break;
+		}
+
+		/* d_typeで足りない場合のみファイル属性を取得 */
+		if ((walker->flags & CMN_FILE_WALK_STAT) || entry.type == 0 || (follow && entry.type == CMN_FILE_TYPE_SYMLINK)) {
+			if (fstatat(dirFd, ent->d_name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) != 0
+					&& (!follow || fstatat(dirFd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)) {
+				/* リンク切れのシンボリックリンクはリンク自体の属性を使う。それ以外は取得できなければスキップ */
+				CMNLOG_DEBUG("get stat failed, path=%s", walker->path);
+				continue;
+			}
+			entry.type = S_ISREG(st.st_mode) ? CMN_FILE_TYPE_FILE
+					: S_ISDIR(st.st_mode) ? CMN_FILE_TYPE_DIRECTORY
+					: S_ISLNK(st.st_mode) ? CMN_FILE_TYPE_SYMLINK
+					: CMN_FILE_TYPE_OTHER;
+			entry.size = st.st_size;
+			entry.lastUpdateTime = st.st_mtime;
+		}
+
+		action = walker->callback(&entry, walker->data);
+		if (action == CMN_FILE_WALK_STOP || LOAD_STOP(walker->stop)) {
+			ret = 1;
+			break;
+		}
+
+		/* 配下のディレクトリを走査 */
+		if (entry.type == CMN_FILE_TYPE_DIRECTORY && action != CMN_FILE_WALK_PRUNE
+				&& (walker->maxDepth <= 0 || depth < walker->maxDepth)) {
+			if ((ret = walker->enterDir(walker, dirFd, &entry)) != 0) {
+				break;
+			}
+		}
+	}
+
+	closedir(dp);
+	return ret;
+}
+
+/**
+ * @brief 走査中のディレクトリを追加（シンボリックリンクの循環検出用）
+ * @return 追加した:0, 走査中のディレクトリと同じ（循環している）:1, メモリ不足:-1
+ */
+static int pushAncestor(Walker *walker, int fd)
+{
+	struct stat st;
+	int i;
+
+	if (fstat(fd, &st) != 0) {
+		return 1;
+	}
+	for (i = 0; i < walker->ancestorCount; i++) {
+		if (walker->ancestors[i].dev == st.st_dev && walker->ancestors[i].ino == st.st_ino) {
+			return 1;
+		}
+	}
+	if (walker->ancestorCount == walker->ancestorSize) {
+		int newSize = (walker->ancestorSize == 0) ? 16 : walker->ancestorSize * 2;
+		void *tmp = realloc(walker->ancestors, newSize * sizeof(walker->ancestors[0]));
+		if (tmp == NULL) {
+			return -1;
+		}
+		walker->ancestors = tmp;
+		walker->ancestorSize = newSize;
+	}
+	walker->ancestors[walker->ancestorCount].dev = st.st_dev;
+	walker->ancestors[walker->ancestorCount].ino = st.st_ino;
+	walker->ancestorCount++;
+	return 0;
+}
+#endif
+
+/**
+ * @brief 配下のディレクトリの走査（逐次走査：再帰的に走査する）
+ * @return 全て走査した:0, 中止:1, メモリ不足:-1
+ */
+static int enterDirRecursive(Walker *walker, int dirFd, const CmnFileWalkEntry *entry)
+{
+#if IS_PRATFORM_WINDOWS()
+	return walkDir(walker, entry->pathLength, entry->depth + 1);
+#else
+	int follow = (walker->flags & CMN_FILE_WALK_FOLLOW_LINKS) ? True : False;
+	int fd, loop, ret;
+
+	/* シンボリックリンクをたどらない場合、走査中にリンクに置き換えられても開かない */
+	fd = openat(dirFd, entry->name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | (follow ? 0 : O_NOFOLLOW));
+	if (fd < 0) {
+		CMNLOG_DEBUG("Failed to open directory, path=%s", entry->path);
+		return 0;
+	}
+	if (follow) {
+		if ((loop = pushAncestor(walker, fd)) != 0) {
+			close(fd);
+			if (loop < 0) {
+				return -1;
+			}
+			CMNLOG_DEBUG("Directory loop detected, path=%s", entry->path);
+			return 0;
+		}
+	}
+	ret = walkDir(walker, fd, entry->pathLength, entry->depth + 1);
+	if (follow) {
+		walker->ancestorCount--;
+	}
+	return ret;
+#endif
+}
+
+/**
+ * @brief 配下のディレクトリの走査（並列走査：自分のキューに追加する）
+ * @return 正常:0, メモリ不足:-1
+ */
+static int enterDirParallel(Walker *walker, int dirFd, const CmnFileWalkEntry *entry)
+{
+	return pushTask(walker->pool, walker->id, entry->path, entry->pathLength, entry->depth + 1, False);
+}
+
+/**
+ * @brief 走査待ちのディレクトリをスレッドのキューの末尾に追加する
+ * @return 正常:0, メモリ不足:-1
+ */
+static int pushTask(WalkPool *pool, int id, const char *path, size_t pathLen, int depth, int isRoot)
+{
+	WalkDeque *deque = &pool->deques[id];
+	WalkTask *task;
+	WalkTask **tmp;
+	int count;
+
+	if ((task = malloc(sizeof(WalkTask) + pathLen)) == NULL) {
+		return -1;
+	}
+	task->depth = depth;
+	task->isRoot = isRoot;
+	task->pathLength = pathLen;
+	memcpy(task->path, path, pathLen);
+	task->path[pathLen] = '\0';
+
+	CmnThreadMutex_Lock(pool->mutex);
+	pool->pending++;
+	CmnThreadMutex_UnLock(pool->mutex);
+
+	CmnThreadMutex_Lock(deque->mutex);
+	if (deque->tail == deque->size) {
+		/* 先頭の空きを詰めても足りなければ拡張 */
+		count = deque->tail - deque->head;
+		if (deque->head > 0 && count < deque->size / 2) {
+			memmove(deque->tasks, deque->tasks + deque->head, count * sizeof(WalkTask *));
+		}
+		else {
+			int newSize = (deque->size == 0) ? 64 : deque->size * 2;
+			if ((tmp = realloc(deque->tasks, newSize * sizeof(WalkTask *))) == NULL) {
+				CmnThreadMutex_UnLock(deque->mutex);
+				CmnThreadMutex_Lock(pool->mutex);
+				pool->pending--;
+				CmnThreadMutex_UnLock(pool->mutex);
+				free(task);
+				return -1;
+			}
+			deque->tasks = tmp;
+			deque->size = newSize;
+			memmove(deque->tasks, deque->tasks + deque->head, count * sizeof(WalkTask *));
+		}
+		deque->head = 0;
+		deque->tail = count;
+	}
+	deque->tasks[deque->tail++] = task;
+	CmnThreadMutex_UnLock(deque->mutex);
+
+	/* 待っているスレッドがあれば起こす */
+	CmnThreadMutex_Lock(pool->mutex);
+	if (pool->idleCount > 0) {
+		CmnThreadCond_Signal(pool->cond);
+	}
+	CmnThreadMutex_UnLock(pool->mutex);
+	return 0;
+}
+
+/**
+ * @brief 走査待ちのディレクトリを取り出す
+ *
+ *  自分のキューの末尾（最後に追加した、直前に走査したディレクトリの配下）から取り出す。
+ *  自分のキューが空の場合は、他のスレッドのキューの先頭（より上位の、配下が多いディレクトリ）から奪う。
+ *
+ * @return 走査待ちのディレクトリ。全てのキューが空の場合はNULL。
+ */
+static WalkTask* takeTask(WalkPool *pool, int id)
+{
+	WalkDeque *deque = &pool->deques[id];
+	WalkTask *task = NULL;
+	int i;
+
+	CmnThreadMutex_Lock(deque->mutex);
+	if (deque->tail > deque->head) {
+		task = deque->tasks[--deque->tail];
+	}
+	CmnThreadMutex_UnLock(deque->mutex);
+
+	for (i = 1; task == NULL && i < pool->threadCount; i++) {
+		deque = &pool->deques[(id + i) % pool->threadCount];
+		CmnThreadMutex_Lock(deque->mutex);
+		if (deque->tail > deque->head) {
+			task = deque->tasks[deque->head++];
+		}
+		CmnThreadMutex_UnLock(deque->mutex);
+	}
+	return task;
+}
+
+/**
+ * @brief 走査待ちのディレクトリを走査する（走査が終わったらtaskを解放する）
+ * @return 全て走査した:0, 中止:1, メモリ不足、起点のディレクトリが開けない:-1
+ */
+static int runTask(Walker *walker, WalkTask *task)
+{
+	int ret = 0;
+#if IS_PRATFORM_WINDOWS()
+	DWORD attributes;
+#else
+	int fd, follow = (walker->flags & CMN_FILE_WALK_FOLLOW_LINKS) ? True : False;
+#endif
+
+	if (reservePath(walker, task->pathLength + INITIAL_PATH_SIZE) != 0) {
+		ret = -1;
+	}
+	else {
+		memcpy(walker->path, task->path, task->pathLength + 1);
+#if IS_PRATFORM_WINDOWS()
+		attributes = GetFileAttributesA(walker->path);
+		if (task->isRoot && (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY))) {
+			CMNLOG_DEBUG("Failed to open directory, path=%s", walker->path);
+			ret = -1;
+		}
+		else {
+			ret = walkDir(walker, (task->pathLength == 1 && task->isRoot) ? 0 : task->pathLength, task->depth);
+		}
+#else
+		/* 起点のディレクトリ以外は、シンボリックリンクをたどらない場合は開かない */
+		fd = open(walker->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC | ((follow || task->isRoot) ? 0 : O_NOFOLLOW));
+		if (fd < 0) {
+			CMNLOG_DEBUG("Failed to open directory, path=%s", walker->path);
+			ret = task->isRoot ? -1 : 0;
+		}
+		else if (follow && (ret = addVisited(walker->pool, fd)) != 0) {
+			close(fd);
+			if (ret > 0) {
+				CMNLOG_DEBUG("Directory loop detected, path=%s", walker->path);
+				ret = 0;
+			}
+		}
+		else {
+			ret = walkDir(walker, fd, (task->pathLength == 1 && task->isRoot && task->path[0] == '/') ? 0 : task->pathLength, task->depth);
+		}
+#endif
+	}
+	free(task);
+
+	/* 最後のディレクトリの走査が終わったら、待っているスレッドを全て終了させる */
+	CmnThreadMutex_Lock(walker->pool->mutex);
+	if (--walker->pool->pending == 0 && walker->pool->idleCount > 0) {
+		CmnThreadCond_Broadcast(walker->pool->cond);
+	}
+	CmnThreadMutex_UnLock(walker->pool->mutex);
+	return ret;
+}
+
+/**
+ * @brief 並列走査のスレッドの処理
+ *
+ *  全てのキューが空で、走査中のディレクトリもなくなるまで（もしくは中止されるまで）走査する。
+ *  キューが空の間は、pushTaskの追加、最後のディレクトリの走査の終了、中止の通知を待つ。
+ */
+static void workerMethod(CmnThread *thread)
+{
+	Walker *walker = thread->data;
+	WalkPool *pool = walker->pool;
+	WalkTask *task;
+	int ret;
+
+	while (!LOAD_STOP(&pool->stop)) {
+		if ((task = takeTask(pool, walker->id)) == NULL) {
+			/* 他のスレッドが走査中であれば、配下のディレクトリが追加されるのを待つ。
+			 * 追加の通知を取りこぼさないように、pool->mutexをロックしてからキューを確認し直す */
+			CmnThreadMutex_Lock(pool->mutex);
+			while (!LOAD_STOP(&pool->stop) && pool->pending > 0 && (task = takeTask(pool, walker->id)) == NULL) {
+				pool->idleCount++;
+				CmnThreadCond_Wait(pool->cond, pool->mutex, -1);
+				pool->idleCount--;
+			}
+			CmnThreadMutex_UnLock(pool->mutex);
+			if (task == NULL) {
+				break;
+			}
+		}
+
+		if ((ret = runTask(walker, task)) != 0) {
+			stopWorkers(pool, ret);
+		}
+	}
+}
+
+/**
+ * @brief 走査を中止する（待っているスレッドも起こして終了させる）
+ * @param result 結果（最初に中止したスレッドの結果だけを使う）
+ */
+static void stopWorkers(WalkPool *pool, int result)
+{
+	CmnThreadMutex_Lock(pool->mutex);
+	if (pool->result == 0) {
+		pool->result = result;
+	}
+	STORE_STOP(&pool->stop);
+	CmnThreadCond_Broadcast(pool->cond);
+	CmnThreadMutex_UnLock(pool->mutex);
+}
+
+#if !IS_PRATFORM_WINDOWS()
+/**
+ * @brief 走査したディレクトリの登録（並列走査でシンボリックリンクをたどる場合の循環検出用）
+ * @return 登録した:0, 走査済み:1, メモリ不足:-1
+ */
+static int addVisited(WalkPool *pool, int fd)
+{
+	struct stat st;
+	DirId *table, *oldTable;
+	size_t i, j, oldSize;
+	int ret = 0;
+
+	if (fstat(fd, &st) != 0) {
+		return 1;
+	}
+
+	CmnThreadMutex_Lock(pool->mutex);
+
+	/* 使用率が1/2を超えたら拡張（ino=0を空きとして扱う） */
+	if ((pool->visitedCount + 1) * 2 > pool->visitedSize) {
+		oldTable = pool->visited;
+		oldSize = pool->visitedSize;
+		pool->visitedSize = (oldSize == 0) ? 1024 : oldSize * 2;
+		if ((table = calloc(pool->visitedSize, sizeof(DirId))) == NULL) {
+			pool->visitedSize = oldSize;
+			CmnThreadMutex_UnLock(pool->mutex);
+			return -1;
+		}
+		for (i = 0; i < oldSize; i++) {
+			if (oldTable[i].ino != 0) {
+				for (j = (size_t)(oldTable[i].ino ^ oldTable[i].dev) % pool->visitedSize; table[j].ino != 0; j = (j + 1) % pool->visitedSize) {}
+				table[j] = oldTable[i];
+			}
+		}
+		free(oldTable);
+		pool->visited = table;
+	}
+
+	for (i = (size_t)(st.st_ino ^ st.st_dev) % pool->visitedSize; pool->visited[i].ino != 0; i = (i + 1) % pool->visitedSize) {
+		if (pool->visited[i].ino == st.st_ino && pool->visited[i].dev == st.st_dev) {
+			ret = 1;
+			break;
+		}
+	}
+	if (ret == 0) {
+		pool->visited[i].dev = st.st_dev;
+		pool->visited[i].ino = st.st_ino;
+		pool->visitedCount++;
+	}
+
+	CmnThreadMutex_UnLock(pool->mutex);
+	return ret;
+}
+#endif
+
+/**
+ * @brief パスのバッファの確保
+ * @return 正常:0, メモリ不足:-1
+ */
+static int reservePath(Walker *walker, size_t size)
+{
+	char *tmp;
+	size_t newSize;
+
+	if (size <= walker->pathSize) {
+		return 0;
+	}
+	newSize = (walker->pathSize == 0) ? INITIAL_PATH_SIZE : walker->pathSize * 2;
+	if (newSize < size) {
+		newSize = size;
+	}
+	if ((tmp = realloc(walker->path, newSize)) == NULL) {
+		return -1;
+	}
+	walker->path = tmp;
+	walker->pathSize = newSize;
+	return 0;
+}
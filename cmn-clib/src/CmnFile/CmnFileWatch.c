@@ -0,0 +1,791 @@
+/** @file *********************************************************************
+ * @brief ファイル、ディレクトリの監視 共通関数
+ *
+ *  ファイル、ディレクトリの変更をOSの通知機能で監視する共通関数。<br>
+ *  CmnFile_GetFileInfoを一定間隔で呼び出して変更を検出する方法と比べ、変更がない間はCPUを使わず、
+ *  検出までの遅れもポーリング間隔ではなく集約時間（latency）だけになる。<br>
+ *  LinuxではinotifyをCMN_FILE_WATCH_RECURSIVEの場合はディレクトリごとに登録し、
+ *  作成、移動されたディレクトリも監視対象に加える（監視の登録前に作成された配下のファイルは作成イベントとして通知する）。
+ *  WindowsではReadDirectoryChangesWを使用する。<br>
+ *  <br>
+ *  イベントはCmnFileWatch_Readで呼び出し元のスレッドに取り出すか、
+ *  CmnFileWatch_Startで専用のスレッドからコールバック関数に通知する（同じ監視で両方を使うことはできない）。<br>
+ *  集約時間内に同じパスで発生したイベントは1件にまとめ、発生したイベントの組み合わせ（CMN_FILE_WATCH_*）で通知する。
+ *  エディタの保存のように短時間に変更が続く場合でも1回の通知で済む。<br>
+ *  OSのイベントキューがあふれてイベントが失われた場合は、監視を開始したパスでCMN_FILE_WATCH_RESCANを通知する
+ *  （呼び出し元はディレクトリを走査し直すこと）。配下のディレクトリの監視も登録し直す。
+ *  作成されたディレクトリの監視を登録できなかった場合（inotifyの監視数の上限など）も、同様にCMN_FILE_WATCH_RESCANを通知する。<br>
+ *  ファイルを指定した場合は親ディレクトリを監視してそのファイルのイベントだけを通知するため、
+ *  一時ファイルに書き込んでリネームで置き換える保存方法でも監視が外れない。
+ *
+ *  ＜使用例＞<BR>
+ *  static void onChange(const CmnFileWatchEvent *event, void *data) {<BR>
+ *      printf("%s %d\n", event->path, event->events);<BR>
+ *  }<BR>
+ *  CmnFileWatch *watch = CmnFileWatch_Open("conf/app.conf", 0, 200);<BR>
+ *  CmnFileWatch_Start(watch, onChange, NULL);<BR>
+ *  ...<BR>
+ *  CmnFileWatch_Close(watch);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnData.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnTime.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/** イベントを読み込むバッファのサイズ */
+#define EVENT_BUFFER_SIZE (64 * 1024)
+/** 専用スレッドが終了要求を確認する間隔（ミリ秒） */
+#define STOP_CHECK_INTERVAL 100
+/** 集約中のイベントの一覧の初期サイズ */
+#define INITIAL_PENDING_SIZE 64
+
+#if !IS_PRATFORM_WINDOWS()
+/** inotifyで監視するイベント */
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+#endif
+
+/** 集約中のイベント */
+typedef struct {
+	const char *path;				/**< パス（アリーナに格納） */
+	int events;						/**< CMN_FILE_WATCH_*の組み合わせ */
+	int isDirectory;
+} PendingEvent;
+
+/** ファイル、ディレクトリの監視 */
+struct _tag_CmnFileWatch {
+	char *path;						/**< 監視を開始したパス（最後のパス区切りは除去） */
+	char *dir;						/**< 監視するディレクトリ（ファイルを指定した場合は親ディレクトリ） */
+	const char *fileName;			/**< ファイルを指定した場合のファイル名（ディレクトリの場合はNULL） */
+	int flags;						/**< CMN_FILE_WATCH_RECURSIVE */
+	unsigned long latency;			/**< イベントを集約する時間（ミリ秒） */
+	char *buffer;					/**< イベントを読み込むバッファ */
+	PendingEvent *pending;			/**< 集約中のイベント（発生順） */
+	int pendingCount;
+	int pendingSize;
+	int *slots;						/**< 集約中のイベントのパスのハッシュ表（pendingの番号+1。0は空き） */
+	int slotSize;
+	CmnDataArena *arena;			/**< 集約中のイベントのパス */
+	CmnThread thread;				/**< 通知用スレッド */
+	int threadRunning;
+	volatile int stop;				/**< 通知用スレッドの終了要求 */
+	CmnFileWatchCallback callback;	/**< 通知用スレッドから呼び出すコールバック関数 */
+	void *data;
+#if IS_PRATFORM_WINDOWS()
+	HANDLE handle;					/**< 監視するディレクトリのハンドル */
+	OVERLAPPED overlapped;
+	int reading;					/**< ReadDirectoryChangesWの完了待ちか */
+#else
+	int fd;							/**< inotifyのファイルディスクリプタ */
+	char **dirs;					/**< 監視ディスクリプタごとのディレクトリのパス */
+	int dirsSize;
+#endif
+};
+
+static int readEvents(CmnFileWatch *watch, int timeout);
+static int addEvent(CmnFileWatch *watch, const char *dir, const char *name, int events, int isDirectory);
+static int growSlots(CmnFileWatch *watch);
+static int deliverEvents(CmnFileWatch *watch, CmnFileWatchCallback callback, void *data);
+static void watchMethod(CmnThread *thread);
+#if IS_PRATFORM_WINDOWS()
+static int startRead(CmnFileWatch *watch);
+static int processEvents(CmnFileWatch *watch, DWORD size);
+#else
+static int addWatch(CmnFileWatch *watch, const char *dir);
+static int addWatchTree(CmnFileWatch *watch, const char *dir, int notifyCreate);
+static int addWatchCallback(const CmnFileWalkEntry *entry, void *data);
+static void removeWatchTree(CmnFileWatch *watch, const char *dir);
+static int processEvent(CmnFileWatch *watch, const struct inotify_event *event);
+#endif
+
+/**
+ * @brief ファイル、ディレクトリの監視を開始する
+ *
+ *  ファイルを指定した場合は、そのファイルの作成、変更、削除を監視する（CMN_FILE_WATCH_RECURSIVEは無視する）。<br>
+ *  ディレクトリを指定した場合は、直下（CMN_FILE_WATCH_RECURSIVEの場合は配下全て）のファイル、ディレクトリの作成、変更、削除を監視する。<br>
+ *  イベントはCmnFileWatch_Read、もしくはCmnFileWatch_Startで受け取る。
+ *
+ * @param path 監視するファイル、ディレクトリのパス（ファイルの場合は親ディレクトリが存在すること）
+ * @param flags CMN_FILE_WATCH_RECURSIVE（配下のディレクトリも監視する）
+ * @param latency イベントを集約する時間（ミリ秒）。最初のイベントからこの時間内に発生したイベントをまとめて通知する。
+ * @return 監視。パス（ファイルの場合は親ディレクトリ）が存在しない場合、監視の登録に失敗した場合はNULL。
+ */
+CmnFileWatch* CmnFileWatch_Open(const char *path, int flags, unsigned long latency)
+{
+	CmnFileWatch *watch;
+	size_t pathLen = strlen(path);
+	char *delimiter;
+	int isDirectory;
+#if IS_PRATFORM_WINDOWS()
+	DWORD attributes;
+#else
+	struct stat st;
+#endif
+	CMNLOG_TRACE_START();
+
+	if ((watch = calloc(1, sizeof(CmnFileWatch))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	watch->flags = flags;
+	watch->latency = latency;
+#if IS_PRATFORM_WINDOWS()
+	watch->handle = INVALID_HANDLE_VALUE;
+#else
+	watch->fd = -1;
+#endif
+
+	/* 監視を開始したパス（最後のパス区切りは除去） */
+	while (pathLen > 1 && (path[pathLen - 1] == '/' || path[pathLen - 1] == '\\')) {
+		pathLen--;
+	}
+	if ((watch->path = malloc(pathLen + 1)) == NULL
+			|| (watch->buffer = malloc(EVENT_BUFFER_SIZE)) == NULL
+			|| (watch->arena = CmnDataArena_Create(0)) == NULL) {
+		CmnFileWatch_Close(watch);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	memcpy(watch->path, path, pathLen);
+	watch->path[pathLen] = '\0';
+
+	/* ファイルの場合は親ディレクトリを監視する */
+#if IS_PRATFORM_WINDOWS()
+	attributes = GetFileAttributesA(watch->path);
+	isDirectory = (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY)) ? True : False;
+#else
+	isDirectory = (stat(watch->path, &st) == 0 && S_ISDIR(st.st_mode)) ? True : False;
+#endif
+	if ((watch->dir = malloc(pathLen + 2)) == NULL) {
+		CmnFileWatch_Close(watch);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	strcpy(watch->dir, watch->path);
+	if (!isDirectory) {
+		delimiter = strrchr(watch->dir, '/');
+#if IS_PRATFORM_WINDOWS()
+		if (strrchr(watch->dir, '\\') > delimiter) {
+			delimiter = strrchr(watch->dir, '\\');
+		}
+#endif
+		if (delimiter == NULL) {
+			strcpy(watch->dir, ".");
+			watch->fileName = watch->path;
+		} else {
+			*delimiter = '\0';
+			watch->fileName = watch->path + (delimiter - watch->dir) + 1;
+			if (delimiter == watch->dir) {
+				strcpy(watch->dir, "/");
+			}
+		}
+		watch->flags &= ~CMN_FILE_WATCH_RECURSIVE;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	watch->handle = CreateFileA(watch->dir, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	watch->overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (watch->handle == INVALID_HANDLE_VALUE || watch->overlapped.hEvent == NULL || startRead(watch) != 0) {
+		CMNLOG_DEBUG("Failed to watch directory, path=%s", watch->dir);
+		CmnFileWatch_Close(watch);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+#else
+	if ((watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0 || addWatchTree(watch, watch->dir, False) != 0) {
+		CMNLOG_DEBUG("Failed to watch directory, path=%s", watch->dir);
+		CmnFileWatch_Close(watch);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+#endif
+
+	CMNLOG_TRACE_END();
+	return watch;
+}
+
+/**
+ * @brief イベントを取り出す
+ *
+ *  イベントが発生するまで最大timeoutミリ秒待ち、最初のイベントから集約時間が経過するまでイベントを集約してから、
+ *  1件ずつ呼び出し元のスレッドでコールバック関数に通知する。
+ *
+ * @param watch 監視
+ * @param timeout イベントを待つ時間（ミリ秒）。負の値の場合は無期限に待つ。
+ * @param callback コールバック関数
+ * @param data コールバック関数に渡す任意のデータ
+ * @return 通知したイベントの数。タイムアウトした場合は0、エラーの場合は-1。
+ */
+int CmnFileWatch_Read(CmnFileWatch *watch, int timeout, CmnFileWatchCallback callback, void *data)
+{
+	unsigned long long deadline, now;
+	int ret;
+	CMNLOG_TRACE_START();
+
+	if ((ret = readEvents(watch, timeout)) > 0) {
+		/* 集約時間が経過するまで続けて読み込む */
+		deadline = CmnTime_GetTickCount() + watch->latency;
+		while (ret > 0 && (now = CmnTime_GetTickCount()) < deadline) {
+			ret = readEvents(watch, (int)(deadline - now));
+		}
+	}
+	if (ret < 0) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	ret = deliverEvents(watch, callback, data);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 専用のスレッドでイベントの通知を開始する
+ *
+ *  CmnFileWatch_Closeまで、イベントを集約してコールバック関数に通知し続ける。
+ *  コールバック関数は通知用のスレッドから呼び出す。
+ *
+ * @param watch 監視
+ * @param callback コールバック関数
+ * @param data コールバック関数に渡す任意のデータ
+ * @return 成功した場合は0、スレッドを開始できなかった場合、既に開始している場合は-1。
+ */
+int CmnFileWatch_Start(CmnFileWatch *watch, CmnFileWatchCallback callback, void *data)
+{
+	CMNLOG_TRACE_START();
+
+	if (watch->threadRunning) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	watch->callback = callback;
+	watch->data = data;
+	watch->stop = False;
+	CmnThread_Init(&watch->thread, watchMethod, watch, NULL);
+	if (CmnThread_Start(&watch->thread) != 0) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	watch->threadRunning = True;
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
+/**
+ * @brief 監視を終了する
+ *
+ *  通知用スレッドを開始している場合は、スレッドの終了を待つ（通知中のコールバック関数の終了を待つ）。
+ *
+ * @param watch 監視（NULLの場合は何もしない）
+ */
+void CmnFileWatch_Close(CmnFileWatch *watch)
+{
+#if !IS_PRATFORM_WINDOWS()
+	int i;
+#endif
+	CMNLOG_TRACE_START();
+
+	if (watch == NULL) {
+		CMNLOG_TRACE_END();
+		return;
+	}
+	if (watch->threadRunning) {
+		watch->stop = True;
+		CmnThread_Join(&watch->thread);
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	if (watch->handle != INVALID_HANDLE_VALUE) {
+		if (watch->reading) {
+			CancelIo(watch->handle);
+			WaitForSingleObject(watch->overlapped.hEvent, INFINITE);
+		}
+		CloseHandle(watch->handle);
+	}
+	if (watch->overlapped.hEvent != NULL) {
+		CloseHandle(watch->overlapped.hEvent);
+	}
+#else
+	if (watch->fd >= 0) {
+		close(watch->fd);
+	}
+	for (i = 0; i < watch->dirsSize; i++) {
+		free(watch->dirs[i]);
+	}
+	free(watch->dirs);
+#endif
+	CmnDataArena_Free(watch->arena);
+	free(watch->slots);
+	free(watch->pending);
+	free(watch->buffer);
+	free(watch->dir);
+	free(watch->path);
+	free(watch);
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief 通知用スレッドの処理
+ */
+static void watchMethod(CmnThread *thread)
+{
+	CmnFileWatch *watch = thread->data;
+
+	while (!watch->stop) {
+		if (CmnFileWatch_Read(watch, STOP_CHECK_INTERVAL, watch->callback, watch->data) < 0) {
+			CMNLOG_WARN("Failed to read file watch events, path=%s", watch->path);
+			CmnTime_Sleep(STOP_CHECK_INTERVAL);
+		}
+	}
+}
+
+/**
+ * @brief 集約中のイベントを通知する
+ * @return 通知したイベントの数
+ */
+static int deliverEvents(CmnFileWatch *watch, CmnFileWatchCallback callback, void *data)
+{
+	CmnFileWatchEvent event;
+	int i, count = watch->pendingCount;
+
+	for (i = 0; i < count; i++) {
+		event.path = watch->pending[i].path;
+		event.events = watch->pending[i].events;
+		event.isDirectory = watch->pending[i].isDirectory;
+		callback(&event, data);
+	}
+
+	watch->pendingCount = 0;
+	if (watch->slots != NULL) {
+		memset(watch->slots, 0, watch->slotSize * sizeof(int));
+	}
+	CmnDataArena_Reset(watch->arena);
+	return count;
+}
+
+/**
+ * @brief イベントを集約中のイベントに加える（同じパスのイベントがあればまとめる）
+ * @param dir ディレクトリのパス
+ * @param name ファイル名（ディレクトリ自体のイベントの場合はNULL）
+ * @return 成功した場合は0、メモリ不足の場合は-1。
+ */
+static int addEvent(CmnFileWatch *watch, const char *dir, const char *name, int events, int isDirectory)
+{
+	size_t dirLen = strlen(dir), nameLen = (name != NULL) ? strlen(name) : 0, pathLen;
+	char *path;
+	unsigned long long hash;
+	int slot;
+
+	/* ファイルを指定した場合は、そのファイル以外のイベントは通知しない（パスは指定されたパス） */
+	if (watch->fileName != NULL && name != NULL) {
+		if (strcmp(name, watch->fileName) != 0) {
+			return 0;
+		}
+		dir = watch->path;
+		dirLen = strlen(dir);
+		name = NULL;
+		nameLen = 0;
+	}
+
+	if ((path = CmnDataArena_Alloc(watch->arena, dirLen + nameLen + 2)) == NULL) {
+		return -1;
+	}
+	memcpy(path, dir, dirLen);
+	pathLen = dirLen;
+	if (name != NULL) {
+		if (dirLen > 0 && dir[dirLen - 1] != '/' && dir[dirLen - 1] != '\\') {
+			path[pathLen++] = CMN_FILE_PATH_DELIMITER[0];
+		}
+		memcpy(path + pathLen, name, nameLen);
+		pathLen += nameLen;
+	}
+	path[pathLen] = '\0';
+
+	/* 同じパスのイベントを探す */
+	if (watch->pendingCount * 2 >= watch->slotSize && growSlots(watch) != 0) {
+		return -1;
+	}
+	hash = CmnData_Hash(path, pathLen);
+	for (slot = (int)(hash & (watch->slotSize - 1)); watch->slots[slot] != 0; slot = (slot + 1) & (watch->slotSize - 1)) {
+		PendingEvent *pending = &watch->pending[watch->slots[slot] - 1];
+		if (strcmp(pending->path, path) == 0) {
+			pending->events |= events;
+			pending->isDirectory |= isDirectory;
+			return 0;
+		}
+	}
+
+	if (watch->pendingCount == watch->pendingSize) {
+		int newSize = (watch->pendingSize == 0) ? INITIAL_PENDING_SIZE : watch->pendingSize * 2;
+		PendingEvent *tmp = realloc(watch->pending, newSize * sizeof(PendingEvent));
+		if (tmp == NULL) {
+			return -1;
+		}
+		watch->pending = tmp;
+		watch->pendingSize = newSize;
+	}
+	watch->pending[watch->pendingCount].path = path;
+	watch->pending[watch->pendingCount].events = events;
+	watch->pending[watch->pendingCount].isDirectory = isDirectory;
+	watch->slots[slot] = ++watch->pendingCount;
+	return 0;
+}
+
+/**
+ * @brief 集約中のイベントのハッシュ表を拡張する
+ * @return 成功した場合は0、メモリ不足の場合は-1。
+ */
+static int growSlots(CmnFileWatch *watch)
+{
+	int newSize = (watch->slotSize == 0) ? INITIAL_PENDING_SIZE * 2 : watch->slotSize * 2;
+	int *slots = calloc(newSize, sizeof(int));
+	int i, slot;
+
+	if (slots == NULL) {
+		return -1;
+	}
+	for (i = 0; i < watch->pendingCount; i++) {
+		const char *path = watch->pending[i].path;
+		for (slot = (int)(CmnData_Hash(path, strlen(path)) & (newSize - 1)); slots[slot] != 0; slot = (slot + 1) & (newSize - 1));
+		slots[slot] = i + 1;
+	}
+	free(watch->slots);
+	watch->slots = slots;
+	watch->slotSize = newSize;
+	return 0;
+}
+
+#if IS_PRATFORM_WINDOWS()
+
+/**
+ * @brief ReadDirectoryChangesWの要求を出す
+ * @return 成功した場合は0、失敗した場合は-1。
+ */
+static int startRead(CmnFileWatch *watch)
+{
+	ResetEvent(watch->overlapped.hEvent);
+	if (!ReadDirectoryChangesW(watch->handle, watch->buffer, EVENT_BUFFER_SIZE,
+			(watch->flags & CMN_FILE_WATCH_RECURSIVE) ? TRUE : FALSE,
+			FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES
+				| FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE,
+			NULL, &watch->overlapped, NULL)) {
+		return -1;
+	}
+	watch->reading = True;
+	return 0;
+}
+
+/**
+ * @brief イベントを待って読み込み、集約中のイベントに加える
+ * @param timeout イベントを待つ時間（ミリ秒）。負の値の場合は無期限に待つ。
+ * @return 読み込んだ場合は1、タイムアウトした場合は0、エラーの場合は-1。
+ */
+static int readEvents(CmnFileWatch *watch, int timeout)
+{
+	DWORD size;
+
+	if (!watch->reading && startRead(watch) != 0) {
+		return -1;
+	}
+	if (WaitForSingleObject(watch->overlapped.hEvent, (timeout < 0) ? INFINITE : (DWORD)timeout) != WAIT_OBJECT_0) {
+		return 0;
+	}
+	watch->reading = False;
+	if (!GetOverlappedResult(watch->handle, &watch->overlapped, &size, FALSE)) {
+		return -1;
+	}
+	if (processEvents(watch, size) != 0) {
+		return -1;
+	}
+	/* 次のイベントを取りこぼさないようにすぐに要求を出す */
+	startRead(watch);
+	return 1;
+}
+
+/**
+ * @brief ReadDirectoryChangesWの結果を集約中のイベントに加える
+ * @return 成功した場合は0、メモリ不足の場合は-1。
+ */
+static int processEvents(CmnFileWatch *watch, DWORD size)
+{
+	FILE_NOTIFY_INFORMATION *info = (FILE_NOTIFY_INFORMATION *)watch->buffer;
+	char name[CMN_FILE_MAX_PATH], path[CMN_FILE_MAX_PATH * 2];
+	int events, len, isDirectory;
+	DWORD attributes;
+
+	/* バッファがあふれた場合はサイズが0になる */
+	if (size == 0) {
+		return addEvent(watch, watch->path, NULL, CMN_FILE_WATCH_RESCAN, watch->fileName == NULL);
+	}
+
+	for (;;) {
+		len = WideCharToMultiByte(CP_ACP, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), name, sizeof(name) - 1, NULL, NULL);
+		name[len] = '\0';
+		switch (info->Action) {
+		case FILE_ACTION_ADDED:
+		case FILE_ACTION_RENAMED_NEW_NAME:
+			events = CMN_FILE_WATCH_CREATE;
+			break;
+		case FILE_ACTION_REMOVED:
+		case FILE_ACTION_RENAMED_OLD_NAME:
+			events = CMN_FILE_WATCH_DELETE;
+			break;
+		default:
+			events = CMN_FILE_WATCH_MODIFY;
+			break;
+		}
+		isDirectory = False;
+		if (!(events & CMN_FILE_WATCH_DELETE)) {
+			sprintf(path, "%s\\%s", watch->dir, name);
+			attributes = GetFileAttributesA(path);
+			isDirectory = (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY)) ? True : False;
+		}
+		if (addEvent(watch, watch->dir, name, events, isDirectory) != 0) {
+			return -1;
+		}
+
+		if (info->NextEntryOffset == 0) {
+			break;
+		}
+		info = (FILE_NOTIFY_INFORMATION *)((char *)info + info->NextEntryOffset);
+	}
+	return 0;
+}
+
+#else
+
+/**
+ * @brief イベントを待って読み込み、集約中のイベントに加える
+ * @param timeout イベントを待つ時間（ミリ秒）。負の値の場合は無期限に待つ。
+ * @return 読み込んだ場合は1、タイムアウトした場合は0、エラーの場合は-1。
+ */
+static int readEvents(CmnFileWatch *watch, int timeout)
+{
+	struct pollfd pfd;
+	ssize_t size;
+	char *pos;
+	int ret, isError = False;
+
+	pfd.fd = watch->fd;
+	pfd.events = POLLIN;
+	if ((ret = poll(&pfd, 1, timeout)) <= 0) {
+		return (ret == 0 || errno == EINTR) ? 0 : -1;
+	}
+
+	/* 読み込めるイベントを全て読み込む */
+	for (;;) {
+		if ((size = read(watch->fd, watch->buffer, EVENT_BUFFER_SIZE)) < 0) {
+			if (errno == EAGAIN || errno == EINTR) {
+				break;
+			}
+			return -1;
+		}
+		/* 失敗したイベントがあっても、読み込んだ残りのイベントは処理する */
+		for (pos = watch->buffer; pos < watch->buffer + size; ) {
+			struct inotify_event *event = (struct inotify_event *)pos;
+			if (processEvent(watch, event) != 0) {
+				isError = True;
+			}
+			pos += sizeof(struct inotify_event) + event->len;
+		}
+	}
+	return isError ? -1 : 1;
+}
+
+/**
+ * @brief inotifyのイベントを集約中のイベントに加える
+ * @return 成功した場合は0、メモリ不足の場合は-1。
+ */
+static int processEvent(CmnFileWatch *watch, const struct inotify_event *event)
+{
+	const char *dir, *name;
+	char *path;
+	int isDirectory = (event->mask & IN_ISDIR) ? True : False;
+	int recursive = (watch->flags & CMN_FILE_WATCH_RECURSIVE) ? True : False;
+	int ret;
+
+	/* キューがあふれた場合は、再走査を通知して監視を登録し直す */
+	if (event->mask & IN_Q_OVERFLOW) {
+		CMNLOG_WARN("File watch event queue overflowed, path=%s", watch->path);
+		if (recursive && addWatchTree(watch, watch->dir, False) != 0) {
+			CMNLOG_WARN("Failed to add file watch, path=%s", watch->dir);
+		}
+		return addEvent(watch, watch->path, NULL, CMN_FILE_WATCH_RESCAN, watch->fileName == NULL);
+	}
+
+	if (event->wd < 0 || event->wd >= watch->dirsSize || (dir = watch->dirs[event->wd]) == NULL) {
+		return 0;
+	}
+	if (event->mask & IN_IGNORED) {
+		free(watch->dirs[event->wd]);
+		watch->dirs[event->wd] = NULL;
+		return 0;
+	}
+	/* 配下のディレクトリ自体の削除、移動は親ディレクトリのイベントで通知する */
+	if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+		if (strcmp(dir, watch->dir) == 0 && watch->fileName == NULL) {
+			return addEvent(watch, watch->path, NULL, CMN_FILE_WATCH_DELETE, True);
+		}
+		return 0;
+	}
+	name = (event->len > 0) ? event->name : NULL;
+
+	if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+		if ((ret = addEvent(watch, dir, name, CMN_FILE_WATCH_CREATE, isDirectory)) != 0 || !isDirectory || !recursive || name == NULL) {
+			return ret;
+		}
+		/* 作成されたディレクトリの監視を登録し、登録前に作成された配下のファイルも通知する */
+		if ((path = malloc(strlen(dir) + strlen(name) + 2)) == NULL) {
+			return -1;
+		}
+		sprintf(path, "%s/%s", dir, name);
+		if (addWatchTree(watch, path, True) != 0) {
+			/* 配下のイベントを取りこぼすため、再走査を通知する */
+			CMNLOG_WARN("Failed to add file watch, path=%s", path);
+			ret = addEvent(watch, watch->path, NULL, CMN_FILE_WATCH_RESCAN, watch->fileName == NULL);
+		}
+		free(path);
+		return ret;
+	}
+	if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+		if (isDirectory && recursive && name != NULL && (event->mask & IN_MOVED_FROM)) {
+			/* 監視の外に移動したディレクトリの監視を外す（監視内の移動はIN_MOVED_TOで登録し直す） */
+			if ((path = malloc(strlen(dir) + strlen(name) + 2)) == NULL) {
+				return -1;
+			}
+			sprintf(path, "%s/%s", dir, name);
+			removeWatchTree(watch, path);
+			free(path);
+		}
+		return addEvent(watch, dir, name, CMN_FILE_WATCH_DELETE, isDirectory);
+	}
+	return addEvent(watch, dir, name, CMN_FILE_WATCH_MODIFY, isDirectory);
+}
+
+/**
+ * @brief ディレクトリの監視を登録する
+ * @return 成功した場合は0、登録できなかった場合は-1。
+ */
+static int addWatch(CmnFileWatch *watch, const char *dir)
+{
+	int wd;
+
+	/* 登録までの間にディレクトリがファイルに置き換えられた場合はエラーにする */
+	if ((wd = inotify_add_watch(watch->fd, dir, WATCH_MASK | IN_ONLYDIR)) < 0) {
+		return -1;
+	}
+	if (wd >= watch->dirsSize) {
+		int newSize = (watch->dirsSize == 0) ? INITIAL_PENDING_SIZE : watch->dirsSize;
+		char **tmp;
+		while (newSize <= wd) {
+			newSize *= 2;
+		}
+		if ((tmp = realloc(watch->dirs, newSize * sizeof(char *))) == NULL) {
+			return -1;
+		}
+		memset(tmp + watch->dirsSize, 0, (newSize - watch->dirsSize) * sizeof(char *));
+		watch->dirs = tmp;
+		watch->dirsSize = newSize;
+	}
+	/* 登録済みのディレクトリ（再走査、監視内の移動）はパスを更新する */
+	free(watch->dirs[wd]);
+	if ((watch->dirs[wd] = malloc(strlen(dir) + 1)) == NULL) {
+		return -1;
+	}
+	strcpy(watch->dirs[wd], dir);
+	return 0;
+}
+
+/** addWatchTreeの走査の状態 */
+typedef struct {
+	CmnFileWatch *watch;
+	int notifyCreate;
+	int error;
+} AddWatchContext;
+
+/**
+ * @brief ディレクトリ（CMN_FILE_WATCH_RECURSIVEの場合は配下のディレクトリも）の監視を登録する
+ * @param notifyCreate 配下のファイル、ディレクトリの作成を通知するか（監視の登録前に作成されたものを取りこぼさないため）
+ * @return 成功した場合は0、起点のディレクトリの監視を登録できなかった場合、メモリ不足の場合は-1。
+ */
+static int addWatchTree(CmnFileWatch *watch, const char *dir, int notifyCreate)
+{
+	AddWatchContext context;
+
+	if (addWatch(watch, dir) != 0) {
+		/* 登録前に削除されたディレクトリは無視する */
+		return (notifyCreate && errno == ENOENT) ? 0 : -1;
+	}
+	if (!(watch->flags & CMN_FILE_WATCH_RECURSIVE)) {
+		return 0;
+	}
+
+	context.watch = watch;
+	context.notifyCreate = notifyCreate;
+	context.error = False;
+	CmnFile_Walk(dir, 0, 0, addWatchCallback, &context);
+	return context.error ? -1 : 0;
+}
+
+/**
+ * @brief addWatchTreeの走査のコールバック関数
+ */
+static int addWatchCallback(const CmnFileWalkEntry *entry, void *data)
+{
+	AddWatchContext *context = data;
+	int isDirectory = (entry->type == CMN_FILE_TYPE_DIRECTORY) ? True : False;
+
+	if (context->notifyCreate && addEvent(context->watch, entry->path, NULL, CMN_FILE_WATCH_CREATE, isDirectory) != 0) {
+		context->error = True;
+		return CMN_FILE_WALK_STOP;
+	}
+	/* 走査中に削除されたディレクトリは無視する */
+	if (isDirectory && addWatch(context->watch, entry->path) != 0 && errno != ENOENT) {
+		context->error = True;
+		return CMN_FILE_WALK_STOP;
+	}
+	return CMN_FILE_WALK_CONTINUE;
+}
+
+/**
+ * @brief ディレクトリとその配下のディレクトリの監視を外す
+ */
+static void removeWatchTree(CmnFileWatch *watch, const char *dir)
+{
+	size_t dirLen = strlen(dir);
+	int wd;
+
+	for (wd = 0; wd < watch->dirsSize; wd++) {
+		char *path = watch->dirs[wd];
+		if (path != NULL && strncmp(path, dir, dirLen) == 0 && (path[dirLen] == '\0' || path[dirLen] == '/')) {
+			inotify_rm_watch(watch->fd, wd);
+			free(path);
+			watch->dirs[wd] = NULL;
+		}
+	}
+}
+
+#endif
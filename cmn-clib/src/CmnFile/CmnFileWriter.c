@@ -0,0 +1,426 @@
+/** @file *********************************************************************
+ * @brief バッファ付きファイル書き込み 共通関数
+ *
+ *  ファイルを開いたまま、書き込むデータをバッファに溜めてまとめて書き込む共通関数。<br>
+ *  CmnFile_WriteTailのように書き込みごとにファイルを開閉しないため、小さなレコードを大量に追記する場合に使用する。<br>
+ *  バッファに収まらないデータは、バッファの内容と合わせて1回のシステムコール（writev）で書き込む。<br>
+ *  <br>
+ *  フラッシュ（バッファの内容をファイルに書き込む）するタイミングは以下の通り。<br>
+ *  ・バッファが一杯になった時<br>
+ *  ・CmnFileWriterOption.flushIntervalを指定した場合、その間隔ごと（フラッシュ用のスレッドで実行）<br>
+ *  ・CmnFileWriter_Flush、CmnFileWriter_Commit、CmnFileWriter_Closeを呼び出した時<br>
+ *  <br>
+ *  ディスクへの同期（永続化）の方法はCmnFileWriterOption.syncで指定する。<br>
+ *  ・CMN_FILE_WRITER_SYNC_NONE  : 同期しない（OSに任せる）<br>
+ *  ・CMN_FILE_WRITER_SYNC_FLUSH : フラッシュのたびに同期する（fdatasync）<br>
+ *  ・CMN_FILE_WRITER_SYNC_GROUP : CmnFileWriter_Commitで同期する。
+ *    複数のスレッドが同時にコミットした場合は、1回の同期でまとめてコミットする（グループコミット）<br>
+ *  <br>
+ *  1つのCmnFileWriterを複数のスレッドで共有できる（内部でロックする）。
+ *  1回のCmnFileWriter_Writeで書き込んだデータは、他のスレッドの書き込みと混ざらない。<br>
+ *  CmnFileWriter_Writeは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  ＜使用例＞<BR>
+ *  CmnFileWriterOption option = { 1024 * 1024, 1000, CMN_FILE_WRITER_SYNC_GROUP };<BR>
+ *  CmnFileWriter *writer = CmnFileWriter_Open("data.log", CMN_FILE_WRITER_APPEND, &option);<BR>
+ *  CmnFileWriter_Write(writer, "record\n", 7);<BR>
+ *  CmnFileWriter_Commit(writer);<BR>
+ *  CmnFileWriter_Close(writer);<BR>
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<errno.h>
+
+#include "cmnclib/Common.h"
+#include "cmnclib/CmnFile.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnTime.h"
+#include "cmnclib/CmnLog.h"
+
+#if IS_PRATFORM_WINDOWS()
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/** バッファサイズの既定値 */
+#define DEFAULT_BUFFER_SIZE (64 * 1024)
+/** フラッシュ用スレッドが終了要求を確認する間隔（ミリ秒） */
+#define FLUSHER_CHECK_INTERVAL 50
+
+/** バッファ付きファイル書き込み */
+struct _tag_CmnFileWriter {
+	int fd;								/**< 書き込み先 */
+	char *buf;							/**< 書き込み待ちのデータ */
+	size_t bufSize;
+	size_t len;							/**< 書き込み待ちのデータのバイト数 */
+	int sync;							/**< 同期の方法（CMN_FILE_WRITER_SYNC_*） */
+	int error;							/**< 書き込みエラーが発生したか */
+	unsigned long long written;			/**< ファイルに書き込んだバイト数 */
+	unsigned long long synced;			/**< ディスクに同期したバイト数 */
+	CmnThreadMutex *mutex;				/**< バッファとファイルへの書き込み用のロック */
+	CmnThreadMutex *syncMutex;			/**< グループコミット用のロック */
+
+	/* 時間によるフラッシュ */
+	unsigned long flushInterval;		/**< フラッシュする間隔（ミリ秒） */
+	int flusherRunning;					/**< フラッシュ用スレッドが実行中か */
+	volatile int stop;					/**< フラッシュ用スレッドの終了要求 */
+	CmnThread flusher;					/**< フラッシュ用スレッド */
+};
+
+static int flush(CmnFileWriter *writer, const void *data, size_t len);
+static int writeData(CmnFileWriter *writer, const void *data, size_t len);
+static int syncFile(int fd);
+static void flusherMethod(CmnThread *thread);
+
+/**
+ * @brief ファイルを開いてバッファ付きの書き込みを開始する
+ *
+ * @param filePath ファイルパス
+ * @param flags CMN_FILE_WRITER_APPEND（追記する）もしくは0（新規作成。既存のファイルは内容を消去する）
+ * @param option バッファサイズ、フラッシュの間隔、同期の方法。NULLの場合は既定値（64KB、時間ではフラッシュしない、同期しない）。
+ * @return バッファ付きファイル書き込み。ファイルが開けない場合、メモリ不足の場合はNULL。
+ */
+CmnFileWriter* CmnFileWriter_Open(const char *filePath, int flags, const CmnFileWriterOption *option)
+{
+	CmnFileWriter *writer;
+	int openFlags;
+	CMNLOG_TRACE_START();
+
+	if ((writer = calloc(1, sizeof(CmnFileWriter))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	writer->fd = -1;
+	writer->bufSize = (option != NULL && option->bufferSize > 0) ? option->bufferSize : DEFAULT_BUFFER_SIZE;
+	writer->sync = (option != NULL) ? option->sync : CMN_FILE_WRITER_SYNC_NONE;
+	writer->flushInterval = (option != NULL) ? option->flushInterval : 0;
+
+	writer->buf = malloc(writer->bufSize);
+	writer->mutex = CmnThreadMutex_Create();
+	writer->syncMutex = CmnThreadMutex_Create();
+	if (writer->buf == NULL || writer->mutex == NULL || writer->syncMutex == NULL) {
+		CmnFileWriter_Close(writer);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	openFlags = _O_WRONLY | _O_CREAT | _O_BINARY | ((flags & CMN_FILE_WRITER_APPEND) ? _O_APPEND : _O_TRUNC);
+	writer->fd = _open(filePath, openFlags, _S_IREAD | _S_IWRITE);
+#else
+	openFlags = O_WRONLY | O_CREAT | O_CLOEXEC | ((flags & CMN_FILE_WRITER_APPEND) ? O_APPEND : O_TRUNC);
+	writer->fd = open(filePath, openFlags, 0666);
+#endif
+	if (writer->fd < 0) {
+		CMNLOG_DEBUG("Failed to open file, path=%s", filePath);
+		CmnFileWriter_Close(writer);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+	/* 時間によるフラッシュ（スレッドを開始できない場合はバッファが一杯になるまで書き込まない） */
+	if (writer->flushInterval > 0) {
+		CmnThread_Init(&writer->flusher, flusherMethod, writer, NULL);
+		if (CmnThread_Start(&writer->flusher) == 0) {
+			writer->flusherRunning = True;
+		}
+		else {
+			CMNLOG_WARN("Failed to start flush thread, path=%s", filePath);
+		}
+	}
+
+	CMNLOG_TRACE_END();
+	return writer;
+}
+
+/**
+ * @brief データを書き込む
+ *
+ *  データをバッファに追加する。バッファに収まらない場合は、バッファの内容とデータをまとめてファイルに書き込む。<br>
+ *  CMN_FILE_WRITER_SYNC_FLUSHの場合、ファイルに書き込んだ時にディスクに同期する。
+ *
+ * @param writer バッファ付きファイル書き込み
+ * @param data 書き込むデータ
+ * @param len 書き込むデータのバイト数
+ * @return 正常:0, エラー（書き込みエラー。以降の書き込みも全てエラーになる）:-1
+ */
+int CmnFileWriter_Write(CmnFileWriter *writer, const void *data, size_t len)
+{
+	int ret = 0;
+
+	CmnThreadMutex_Lock(writer->mutex);
+	if (writer->error) {
+		ret = -1;
+	}
+	else if (writer->len + len < writer->bufSize) {
+		memcpy(writer->buf + writer->len, data, len);
+		writer->len += len;
+	}
+	else {
+		/* バッファが一杯になる場合は、バッファの内容とデータをまとめて書き込む */
+		ret = flush(writer, data, len);
+	}
+	CmnThreadMutex_UnLock(writer->mutex);
+	return ret;
+}
+
+/**
+ * @brief バッファの内容をファイルに書き込む
+ *
+ *  CMN_FILE_WRITER_SYNC_FLUSHの場合はディスクに同期する。
+ *
+ * @param writer バッファ付きファイル書き込み
+ * @return 正常:0, エラー:-1
+ */
+int CmnFileWriter_Flush(CmnFileWriter *writer)
+{
+	int ret;
+	CMNLOG_TRACE_START();
+
+	CmnThreadMutex_Lock(writer->mutex);
+	ret = flush(writer, NULL, 0);
+	CmnThreadMutex_UnLock(writer->mutex);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief これまでに書き込んだデータを確定する
+ *
+ *  バッファの内容をファイルに書き込み、CMN_FILE_WRITER_SYNC_GROUPの場合はディスクに同期する。<br>
+ *  同期中に他のスレッドがコミットした場合、そのスレッドは同期の完了を待ち、
+ *  まだ同期されていなければ待っている間に書き込まれた分とまとめて1回で同期する（グループコミット）。<br>
+ *  CMN_FILE_WRITER_SYNC_NONEの場合は同期しない（CmnFileWriter_Flushと同じ）。
+ *
+ * @param writer バッファ付きファイル書き込み
+ * @return 正常:0, エラー:-1
+ */
+int CmnFileWriter_Commit(CmnFileWriter *writer)
+{
+	unsigned long long target, upto;
+	int ret;
+	CMNLOG_TRACE_START();
+
+	CmnThreadMutex_Lock(writer->mutex);
+	ret = flush(writer, NULL, 0);
+	target = writer->written;
+	CmnThreadMutex_UnLock(writer->mutex);
+
+	if (ret != 0 || writer->sync != CMN_FILE_WRITER_SYNC_GROUP) {
+		CMNLOG_TRACE_END();
+		return ret;
+	}
+
+	/* 他のスレッドの同期が自分の書き込みまで含んでいれば、同期は不要 */
+	CmnThreadMutex_Lock(writer->syncMutex);
+	if (writer->synced < target) {
+		CmnThreadMutex_Lock(writer->mutex);
+		upto = writer->written;
+		CmnThreadMutex_UnLock(writer->mutex);
+
+		if (syncFile(writer->fd) == 0) {
+			writer->synced = upto;
+		}
+		else {
+			CMNLOG_WARN("file sync error. errno=%d", errno);
+			ret = -1;
+		}
+	}
+	CmnThreadMutex_UnLock(writer->syncMutex);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief バッファ付きファイル書き込みの終了
+ *
+ *  フラッシュ用スレッドを停止し、バッファの内容を書き込んで（CMN_FILE_WRITER_SYNC_NONE以外は同期して）ファイルを閉じる。
+ *
+ * @param writer バッファ付きファイル書き込み（NULLの場合は何もしない）
+ * @return 正常:0, エラー（書き込みエラー、同期エラー）:-1
+ */
+int CmnFileWriter_Close(CmnFileWriter *writer)
+{
+	int ret = 0;
+	CMNLOG_TRACE_START();
+
+	if (writer == NULL) {
+		CMNLOG_TRACE_END();
+		return 0;
+	}
+	if (writer->flusherRunning) {
+		writer->stop = True;
+		CmnThread_Join(&writer->flusher);
+	}
+	if (writer->fd >= 0) {
+		if (writer->error || flush(writer, NULL, 0) != 0) {
+			ret = -1;
+		}
+		else if (writer->sync == CMN_FILE_WRITER_SYNC_GROUP && writer->synced < writer->written && syncFile(writer->fd) != 0) {
+			CMNLOG_WARN("file sync error. errno=%d", errno);
+			ret = -1;
+		}
+#if IS_PRATFORM_WINDOWS()
+		_close(writer->fd);
+#else
+		close(writer->fd);
+#endif
+	}
+	if (writer->mutex != NULL) {
+		CmnThreadMutex_Free(writer->mutex);
+	}
+	if (writer->syncMutex != NULL) {
+		CmnThreadMutex_Free(writer->syncMutex);
+	}
+	free(writer->buf);
+	free(writer);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief バッファの内容と追加のデータをファイルに書き込む（ロックした状態で呼び出すこと）
+ *
+ * @param data バッファの内容に続けて書き込むデータ（不要な場合はNULL）
+ * @param len dataのバイト数
+ * @return 正常:0, エラー:-1
+ */
+static int flush(CmnFileWriter *writer, const void *data, size_t len)
+{
+	if (writer->error) {
+		return -1;
+	}
+	if (writer->len == 0 && len == 0) {
+		return 0;
+	}
+	if (writeData(writer, data, len) != 0) {
+		CMNLOG_WARN("file write error. errno=%d", errno);
+		writer->error = True;
+		return -1;
+	}
+	writer->written += writer->len + len;
+	writer->len = 0;
+
+	if (writer->sync == CMN_FILE_WRITER_SYNC_FLUSH) {
+		if (syncFile(writer->fd) != 0) {
+			CMNLOG_WARN("file sync error. errno=%d", errno);
+			writer->error = True;
+			return -1;
+		}
+		writer->synced = writer->written;
+	}
+	return 0;
+}
+
+/**
+ * @brief バッファの内容と追加のデータを全て書き込む（途中までしか書き込めなかった場合は続きを書き込む）
+ * @return 正常:0, エラー:-1
+ */
+static int writeData(CmnFileWriter *writer, const void *data, size_t len)
+{
+#if IS_PRATFORM_WINDOWS()
+	const char *parts[2];
+	size_t lens[2];
+	int i, n;
+
+	parts[0] = writer->buf;
+	lens[0] = writer->len;
+	parts[1] = data;
+	lens[1] = len;
+	for (i = 0; i < 2; i++) {
+		while (lens[i] > 0) {
+			n = _write(writer->fd, parts[i], (unsigned int)((lens[i] > INT_MAX) ? INT_MAX : lens[i]));
+			if (n <= 0) {
+				return -1;
+			}
+			parts[i] += n;
+			lens[i] -= n;
+		}
+	}
+	return 0;
+#else
+	struct iovec iov[2];
+	int first = 0, count = 0;
+	ssize_t n;
+
+	if (writer->len > 0) {
+		iov[count].iov_base = writer->buf;
+		iov[count].iov_len = writer->len;
+		count++;
+	}
+	if (len > 0) {
+		iov[count].iov_base = (void *)data;
+		iov[count].iov_len = len;
+		count++;
+	}
+	while (first < count) {
+		n = writev(writer->fd, iov + first, count - first);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		/* 書き込めた分を進める */
+		while (first < count && (size_t)n >= iov[first].iov_len) {
+			n -= iov[first].iov_len;
+			first++;
+		}
+		if (first < count) {
+			iov[first].iov_base = (char *)iov[first].iov_base + n;
+			iov[first].iov_len -= n;
+		}
+	}
+	return 0;
+#endif
+}
+
+/**
+ * @brief ファイルの内容をディスクに同期する
+ * @return 正常:0, エラー:-1
+ */
+static int syncFile(int fd)
+{
+#if IS_PRATFORM_WINDOWS()
+	return _commit(fd);
+#else
+	return fdatasync(fd);
+#endif
+}
+
+/**
+ * @brief フラッシュ用スレッドの処理（一定間隔でバッファの内容を書き込む）
+ */
+static void flusherMethod(CmnThread *thread)
+{
+	CmnFileWriter *writer = thread->data;
+	unsigned long elapsed = 0;
+
+	while (!writer->stop) {
+		CmnTime_Sleep(FLUSHER_CHECK_INTERVAL);
+		elapsed += FLUSHER_CHECK_INTERVAL;
+		if (elapsed < writer->flushInterval) {
+			continue;
+		}
+		elapsed = 0;
+
+		CmnThreadMutex_Lock(writer->mutex);
+		flush(writer, NULL, 0);
+		CmnThreadMutex_UnLock(writer->mutex);
+	}
+}
@@ -0,0 +1,1046 @@
+/** @file *********************************************************************
+ * @brief JSONパーサ 共通関数
+ *
+ *  JSONをイベント（CmnJsonHandlerの各関数）として通知する逐次解析のパーサ。<br>
+ *  入力データは任意の位置で区切って複数回に分けて渡すことができる（CmnNetSocket_ReceiveAllで受信したバッファを
+ *  そのままCmnJsonParser_Feedに渡す等）。区切りをまたいだ文字列、数値のみ内部のバッファに蓄積する。<br>
+ *  エスケープを含まない文字列は複写せずに入力データを直接通知する。
+ *  SSE2が使用できる場合は、文字列中の'"'、'\\'、制御文字の検索を16バイト単位で行う。<br>
+ *  CmnJsonParser_CreateDomで作成したパーサは、イベントの代わりにアリーナ上にDOM（CmnJsonValue）を構築する。<br>
+ *  文字列のUTF-8としての妥当性は検査しない。<br>
+ *  入力データの解析（CmnJsonParser_Feed等）は受信ごとに呼び出されるためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnJson.h"
+#include"cmnclib/CmnLog.h"
+#include"cmnclib/CmnThread.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+/** 次に期待する字句 */
+enum {
+	ST_VALUE,			/**< 値（文書の先頭、':'の後、配列内の','の後） */
+	ST_VALUE_OR_END,	/**< 値または']'（'['の後） */
+	ST_KEY_OR_END,		/**< キーまたは'}'（'{'の後） */
+	ST_KEY,				/**< キー（オブジェクト内の','の後） */
+	ST_COLON,			/**< ':' */
+	ST_COMMA_OR_END,	/**< ','または閉じ括弧 */
+	ST_DONE				/**< 文書の終了 */
+};
+
+/** 入力データの区切りをまたいで解析中の字句 */
+enum {
+	TOK_NONE,			/**< なし */
+	TOK_STRING,			/**< 文字列 */
+	TOK_NUMBER,			/**< 数値 */
+	TOK_LITERAL			/**< true, false, null */
+};
+
+/** 文字の分類 */
+#define CC_SPACE	0x01	/**< 空白（' ', '\t', '\n', '\r'） */
+#define CC_NUMBER	0x02	/**< 数値を構成する文字 */
+#define CC_LITERAL	0x04	/**< true, false, nullを構成する文字（英小文字） */
+#define CC_STRING	0x08	/**< 文字列中で特別な処理が必要な文字（'"', '\\', 制御文字） */
+
+/** DOM構築中の配列、オブジェクト */
+typedef struct _tag_DomFrame {
+	CmnJsonValue *container;	/**< 配列、オブジェクト */
+	CmnJsonValue *last;			/**< 最後の要素 */
+} DomFrame;
+
+/** DOM構築の状態 */
+typedef struct _tag_DomBuilder {
+	CmnDataArena *arena;					/**< 値を確保するアリーナ */
+	CmnJsonValue *root;						/**< ルートの値 */
+	const char *key;						/**< 次の値のキー */
+	size_t keyLen;							/**< 次の値のキーのバイト数 */
+	int depth;								/**< 入れ子の深さ */
+	DomFrame frames[CMN_JSON_MAX_DEPTH];	/**< 構築中の配列、オブジェクト */
+} DomBuilder;
+
+/** JSONパーサ */
+struct _tag_CmnJsonParser {
+	CmnJsonHandler handler;			/**< イベントハンドラ */
+	void *ctx;						/**< イベントハンドラに渡す値 */
+	int state;						/**< 次に期待する字句（ST_*） */
+	int token;						/**< 区切りをまたいで解析中の字句（TOK_*） */
+	int tokenIsKey;					/**< 解析中の文字列がキーか */
+	int tokenEscaped;				/**< 解析中の文字列が'\'を含むか */
+	int tokenBackslash;				/**< 解析中の文字列が'\'で区切られたか */
+	CmnDataBuffer *tokenBuf;		/**< 区切りをまたいだ字句（エスケープ解除前） */
+	CmnDataBuffer *decodeBuf;		/**< エスケープ解除後の文字列 */
+	int depth;						/**< 入れ子の深さ */
+	unsigned char stack[CMN_JSON_MAX_DEPTH];	/**< 入れ子の種類（'{' or '['） */
+	const char *chunk;				/**< 解析中の入力データの先頭 */
+	size_t offset;					/**< 解析中の入力データより前に渡されたバイト数 */
+	const char *error;				/**< エラー内容（エラーがない場合はNULL） */
+	size_t errorOffset;				/**< エラー位置（先頭からのバイト数） */
+	DomBuilder *dom;				/**< DOM構築の状態（DOMを構築しない場合はNULL） */
+};
+
+static unsigned char charClass[256];
+/** 文字の分類表の初期化を一度だけ行うための制御オブジェクト */
+static CmnThreadOnce charClassOnce = CMN_THREAD_ONCE_INIT;
+
+static void initCharClass(void);
+static const char* parseChunk(CmnJsonParser *parser, const char *p, const char *end);
+static const char* parseValue(CmnJsonParser *parser, const char *p, const char *end);
+static const char* parseString(CmnJsonParser *parser, const char *p, const char *end, int isKey);
+static const char* continueString(CmnJsonParser *parser, const char *p, const char *end);
+static int emitString(CmnJsonParser *parser, const char *str, size_t len, const char *pos);
+static const char* continueScalar(CmnJsonParser *parser, const char *p, const char *end, int cls);
+static int emitScalar(CmnJsonParser *parser, int token, const char *str, size_t len, const char *pos);
+static int endContainer(CmnJsonParser *parser, char close, const char *pos);
+static int decodeString(CmnJsonParser *parser, const char *str, size_t len);
+static int parseHex4(const char *p, const char *end, unsigned int *code);
+static int isValidNumber(const char *p, size_t len);
+static int appendBuf(CmnDataBuffer *buf, const char *data, size_t len);
+static int setError(CmnJsonParser *parser, const char *pos, const char *message);
+static const char* scanString(const char *p, const char *end);
+static int domOnNull(void *ctx);
+static int domOnBool(void *ctx, int value);
+static int domOnNumber(void *ctx, const char *str, size_t len);
+static int domOnString(void *ctx, const char *str, size_t len);
+static int domOnKey(void *ctx, const char *str, size_t len);
+static int domOnStartObject(void *ctx);
+static int domOnStartArray(void *ctx);
+static int domOnEnd(void *ctx);
+static CmnJsonValue* domAdd(DomBuilder *dom, CmnJsonType type);
+
+/** ハンドラの呼び出し（NULLの場合は何もしない。中断された場合はエラーを設定して-1を返す） */
+#define CALL_HANDLER(parser, pos, func, args) \
+	(((parser)->handler.func != NULL && (parser)->handler.func args != 0) ? setError((parser), (pos), "aborted by handler") : 0)
+
+/**
+ * @brief JSONパーサ作成
+ *
+ *  イベントハンドラに解析結果を通知するパーサを作成する。
+ *
+ * @param handler イベントハンドラ。内容は作成時に複写する。
+ * @param ctx イベントハンドラの各関数の第1引数に渡す値
+ * @return 作成したパーサ。作成に失敗した場合はNULL。使用後はCmnJsonParser_Freeで解放すること。
+ */
+CmnJsonParser* CmnJsonParser_Create(const CmnJsonHandler *handler, void *ctx)
+{
+	CmnJsonParser *parser;
+	CMNLOG_TRACE_START();
+
+	CmnThread_Once(&charClassOnce, initCharClass);
+
+	parser = calloc(1, sizeof(CmnJsonParser));
+	if (parser == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	parser->handler = *handler;
+	parser->ctx = ctx;
+	parser->tokenBuf = CmnDataBuffer_Create(256);
+	parser->decodeBuf = CmnDataBuffer_Create(256);
+	if (parser->tokenBuf == NULL || parser->decodeBuf == NULL) {
+		CmnJsonParser_Free(parser);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	CmnJsonParser_Reset(parser);
+
+	CMNLOG_TRACE_END();
+	return parser;
+}
+
+/**
+ * @brief JSONパーサ作成（DOM構築）
+ *
+ *  解析結果をDOM（CmnJsonValue）としてアリーナ上に構築するパーサを作成する。<br>
+ *  構築したDOMはCmnJsonParser_Finishの後にCmnJsonParser_GetRootで取得する。
+ *  DOMの値、文字列はすべてアリーナ上に複写するため、入力データやパーサを解放した後も使用できる。
+ *
+ * @param arena DOMを確保するアリーナ
+ * @return 作成したパーサ。作成に失敗した場合はNULL。使用後はCmnJsonParser_Freeで解放すること。
+ */
+CmnJsonParser* CmnJsonParser_CreateDom(CmnDataArena *arena)
+{
+	static const CmnJsonHandler domHandler = {
+		domOnNull, domOnBool, domOnNumber, domOnString, domOnKey,
+		domOnStartObject, domOnEnd, domOnStartArray, domOnEnd
+	};
+	CmnJsonParser *parser;
+	DomBuilder *dom;
+	CMNLOG_TRACE_START();
+
+	dom = calloc(1, sizeof(DomBuilder));
+	if (dom == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	dom->arena = arena;
+
+	parser = CmnJsonParser_Create(&domHandler, dom);
+	if (parser == NULL) {
+		free(dom);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	parser->dom = dom;
+
+	CMNLOG_TRACE_END();
+	return parser;
+}
+
+/**
+ * @brief 入力データの解析
+ *
+ *  入力データを解析し、イベントハンドラを呼び出す。<br>
+ *  入力データは任意の位置で区切ってよく、続きは再度この関数で渡す。すべて渡した後はCmnJsonParser_Finishを呼び出すこと。
+ *
+ * @param parser パーサ
+ * @param data 入力データ（UTF-8）
+ * @param len dataのバイト数
+ * @return 正常:0, 構文エラーまたはハンドラによる中断:-1（以降の呼び出しもエラーとなる）
+ */
+int CmnJsonParser_Feed(CmnJsonParser *parser, const char *data, size_t len)
+{
+	const char *p = data;
+	const char *end = data + len;
+
+	if (parser->error != NULL) {
+		return -1;
+	}
+	parser->chunk = data;
+
+	/* 前回の入力データの末尾で区切られた字句の続き */
+	if (parser->token == TOK_STRING) {
+		p = continueString(parser, p, end);
+	}
+	else if (parser->token == TOK_NUMBER) {
+		p = continueScalar(parser, p, end, CC_NUMBER);
+	}
+	else if (parser->token == TOK_LITERAL) {
+		p = continueScalar(parser, p, end, CC_LITERAL);
+	}
+
+	if (p != NULL) {
+		p = parseChunk(parser, p, end);
+	}
+	parser->offset += len;
+
+	if (p == NULL) {
+		CMNLOG_WARN("json parse error. %s, offset=%lld", parser->error, (long long)parser->errorOffset);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 解析の終了
+ *
+ *  入力データの終端を通知する。末尾で区切られていた数値等を確定し、文書が完結しているかを検査する。
+ *
+ * @param parser パーサ
+ * @return 正常:0, 文書が完結していない、またはエラー:-1
+ */
+int CmnJsonParser_Finish(CmnJsonParser *parser)
+{
+	const char *end;
+
+	if (parser->error != NULL) {
+		return -1;
+	}
+	/* エラー位置を入力データの末尾とする */
+	parser->chunk = "";
+	end = parser->chunk;
+
+	if (parser->token == TOK_NUMBER || parser->token == TOK_LITERAL) {
+		int token = parser->token;
+		parser->token = TOK_NONE;
+		emitScalar(parser, token, parser->tokenBuf->data, parser->tokenBuf->size, end);
+	}
+	else if (parser->token == TOK_STRING) {
+		setError(parser, end, "unterminated string");
+	}
+	if (parser->error == NULL && parser->state != ST_DONE) {
+		setError(parser, end, "unexpected end of data");
+	}
+
+	if (parser->error != NULL) {
+		CMNLOG_WARN("json parse error. %s, offset=%lld", parser->error, (long long)parser->errorOffset);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 構築したDOMの取得
+ *
+ * @param parser CmnJsonParser_CreateDomで作成したパーサ
+ * @return ルートの値。CmnJsonParser_Finishが正常終了していない場合、DOMを構築しないパーサの場合はNULL。
+ */
+CmnJsonValue* CmnJsonParser_GetRoot(CmnJsonParser *parser)
+{
+	if (parser->dom == NULL || parser->error != NULL || parser->state != ST_DONE || parser->token != TOK_NONE) {
+		return NULL;
+	}
+	return parser->dom->root;
+}
+
+/**
+ * @brief エラー内容の取得
+ *
+ * @param parser パーサ
+ * @param offset (O) エラー位置（入力データの先頭からのバイト数）。NULLの場合は格納しない。
+ * @return エラー内容。エラーがない場合はNULL。
+ */
+const char* CmnJsonParser_GetError(CmnJsonParser *parser, size_t *offset)
+{
+	if (offset != NULL) {
+		*offset = parser->errorOffset;
+	}
+	return parser->error;
+}
+
+/**
+ * @brief パーサの初期化
+ *
+ *  解析状態、エラーを初期化し、次の文書を解析できるようにする。
+ *  DOMを構築するパーサの場合も、構築済みのDOMを確保したアリーナは解放しない。
+ *
+ * @param parser パーサ
+ */
+void CmnJsonParser_Reset(CmnJsonParser *parser)
+{
+	parser->state = ST_VALUE;
+	parser->token = TOK_NONE;
+	parser->tokenEscaped = False;
+	parser->tokenBackslash = False;
+	parser->depth = 0;
+	parser->offset = 0;
+	parser->error = NULL;
+	parser->errorOffset = 0;
+	if (parser->dom != NULL) {
+		parser->dom->root = NULL;
+		parser->dom->key = NULL;
+		parser->dom->depth = 0;
+	}
+}
+
+/**
+ * @brief パーサの解放
+ *
+ * @param parser パーサ
+ */
+void CmnJsonParser_Free(CmnJsonParser *parser)
+{
+	CMNLOG_TRACE_START();
+
+	if (parser != NULL) {
+		if (parser->tokenBuf != NULL) {
+			CmnDataBuffer_Free(parser->tokenBuf);
+		}
+		if (parser->decodeBuf != NULL) {
+			CmnDataBuffer_Free(parser->decodeBuf);
+		}
+		free(parser->dom);
+		free(parser);
+	}
+
+	CMNLOG_TRACE_END();
+}
+
+/** 文字の分類表の初期化 */
+static void initCharClass(void)
+{
+	const char *s;
+	int c;
+
+	charClass[' '] = charClass['\t'] = charClass['\n'] = charClass['\r'] = CC_SPACE;
+	for (s = "0123456789+-.eE"; *s; s++) {
+		charClass[(unsigned char)*s] |= CC_NUMBER;
+	}
+	for (c = 'a'; c <= 'z'; c++) {
+		charClass[c] |= CC_LITERAL;
+	}
+	for (c = 0; c < 0x20; c++) {
+		charClass[c] |= CC_STRING;
+	}
+	charClass['"'] |= CC_STRING;
+	charClass['\\'] |= CC_STRING;
+}
+
+/**
+ * @brief 入力データの解析（字句の区切りから）
+ * @return 正常:end, エラー:NULL
+ */
+static const char* parseChunk(CmnJsonParser *parser, const char *p, const char *end)
+{
+	while (p != NULL && p < end) {
+		unsigned char c = (unsigned char)*p;
+		if (charClass[c] & CC_SPACE) {
+			p++;
+			continue;
+		}
+
+		switch (parser->state) {
+		case ST_VALUE_OR_END:
+			if (c == ']') {
+				p = (endContainer(parser, ']', p) == 0) ? p + 1 : NULL;
+				break;
+			}
+			/* FALLTHROUGH */
+		case ST_VALUE:
+			p = parseValue(parser, p, end);
+			break;
+		case ST_KEY_OR_END:
+			if (c == '}') {
+				p = (endContainer(parser, '}', p) == 0) ? p + 1 : NULL;
+				break;
+			}
+			/* FALLTHROUGH */
+		case ST_KEY:
+			if (c != '"') {
+				setError(parser, p, "expected object key");
+				return NULL;
+			}
+			p = parseString(parser, p, end, True);
+			break;
+		case ST_COLON:
+			if (c != ':') {
+				setError(parser, p, "expected ':'");
+				return NULL;
+			}
+			parser->state = ST_VALUE;
+			p++;
+			break;
+		case ST_COMMA_OR_END:
+			if (c == ',') {
+				parser->state = (parser->stack[parser->depth - 1] == '{') ? ST_KEY : ST_VALUE;
+				p++;
+			}
+			else if (c == '}' || c == ']') {
+				p = (endContainer(parser, (char)c, p) == 0) ? p + 1 : NULL;
+			}
+			else {
+				setError(parser, p, "expected ',' or close bracket");
+				return NULL;
+			}
+			break;
+		default:
+			setError(parser, p, "unexpected data after document");
+			return NULL;
+		}
+	}
+	return p;
+}
+
+/**
+ * @brief 値の解析
+ * @return 正常:値の次の位置（区切りをまたぐ場合はend）, エラー:NULL
+ */
+static const char* parseValue(CmnJsonParser *parser, const char *p, const char *end)
+{
+	const char *q;
+	int cls;
+
+	switch (*p) {
+	case '{':
+	case '[':
+		if (parser->depth >= CMN_JSON_MAX_DEPTH) {
+			setError(parser, p, "too deep nesting");
+			return NULL;
+		}
+		parser->stack[parser->depth++] = (unsigned char)*p;
+		if (*p == '{') {
+			parser->state = ST_KEY_OR_END;
+			return (CALL_HANDLER(parser, p, onStartObject, (parser->ctx)) == 0) ? p + 1 : NULL;
+		}
+		parser->state = ST_VALUE_OR_END;
+		return (CALL_HANDLER(parser, p, onStartArray, (parser->ctx)) == 0) ? p + 1 : NULL;
+	case '"':
+		return parseString(parser, p, end, False);
+	case 't':
+	case 'f':
+	case 'n':
+		cls = CC_LITERAL;
+		break;
+	default:
+		if (*p != '-' && (unsigned int)(*p - '0') > 9) {
+			setError(parser, p, "unexpected character");
+			return NULL;
+		}
+		cls = CC_NUMBER;
+		break;
+	}
+
+	/* 数値、リテラル */
+	for (q = p + 1; q < end && (charClass[(unsigned char)*q] & cls); q++) {
+	}
+	if (q == end) {
+		/* 入力データの末尾で区切られた（続きがある可能性がある） */
+		parser->token = (cls == CC_NUMBER) ? TOK_NUMBER : TOK_LITERAL;
+		parser->tokenBuf->size = 0;
+		if (appendBuf(parser->tokenBuf, p, (size_t)(q - p)) != 0) {
+			setError(parser, p, "out of memory");
+			return NULL;
+		}
+		return end;
+	}
+	if (emitScalar(parser, (cls == CC_NUMBER) ? TOK_NUMBER : TOK_LITERAL, p, (size_t)(q - p), p) != 0) {
+		return NULL;
+	}
+	return q;
+}
+
+/**
+ * @brief 数値、リテラルの続きの解析
+ * @return 正常:字句の次の位置（さらに区切りをまたぐ場合はend）, エラー:NULL
+ */
+static const char* continueScalar(CmnJsonParser *parser, const char *p, const char *end, int cls)
+{
+	const char *q;
+	int token = parser->token;
+
+	for (q = p; q < end && (charClass[(unsigned char)*q] & cls); q++) {
+	}
+	if (appendBuf(parser->tokenBuf, p, (size_t)(q - p)) != 0) {
+		setError(parser, p, "out of memory");
+		return NULL;
+	}
+	if (q == end) {
+		return end;
+	}
+	parser->token = TOK_NONE;
+	if (emitScalar(parser, token, parser->tokenBuf->data, parser->tokenBuf->size, q) != 0) {
+		return NULL;
+	}
+	return q;
+}
+
+/**
+ * @brief 数値、リテラルの通知
+ * @return 正常:0, エラー:-1
+ */
+static int emitScalar(CmnJsonParser *parser, int token, const char *str, size_t len, const char *pos)
+{
+	int ret;
+
+	if (token == TOK_NUMBER) {
+		if (!isValidNumber(str, len)) {
+			return setError(parser, pos, "invalid number");
+		}
+		ret = CALL_HANDLER(parser, pos, onNumber, (parser->ctx, str, len));
+	}
+	else if (len == 4 && memcmp(str, "true", 4) == 0) {
+		ret = CALL_HANDLER(parser, pos, onBool, (parser->ctx, True));
+	}
+	else if (len == 5 && memcmp(str, "false", 5) == 0) {
+		ret = CALL_HANDLER(parser, pos, onBool, (parser->ctx, False));
+	}
+	else if (len == 4 && memcmp(str, "null", 4) == 0) {
+		ret = CALL_HANDLER(parser, pos, onNull, (parser->ctx));
+	}
+	else {
+		return setError(parser, pos, "invalid literal");
+	}
+	parser->state = (parser->depth == 0) ? ST_DONE : ST_COMMA_OR_END;
+	return ret;
+}
+
+/**
+ * @brief 文字列の解析
+ *
+ *  エスケープを含まず、入力データ内で完結する文字列は複写せずに通知する。
+ *
+ * @param p 開始の'"'の位置
+ * @return 正常:終了の'"'の次の位置（区切りをまたぐ場合はend）, エラー:NULL
+ */
+static const char* parseString(CmnJsonParser *parser, const char *p, const char *end, int isKey)
+{
+	const char *s = p + 1;
+	const char *q = scanString(s, end);
+
+	parser->tokenIsKey = isKey;
+	if (q < end && *q == '"') {
+		return (emitString(parser, s, (size_t)(q - s), q) == 0) ? q + 1 : NULL;
+	}
+
+	parser->token = TOK_STRING;
+	parser->tokenEscaped = False;
+	parser->tokenBackslash = False;
+	parser->tokenBuf->size = 0;
+	return continueString(parser, s, end);
+}
+
+/**
+ * @brief 文字列の続きの解析
+ *
+ *  終了の'"'までを探す。エスケープを含む場合、入力データの区切りをまたぐ場合のみこの関数で処理する。
+ *
+ * @return 正常:終了の'"'の次の位置（さらに区切りをまたぐ場合はend）, エラー:NULL
+ */
+static const char* continueString(CmnJsonParser *parser, const char *p, const char *end)
+{
+	const char *start = p;
+	const char *q;
+
+	if (parser->tokenBackslash) {
+		/* 前回の入力データが'\'で終わった場合は、先頭の1文字はエスケープされた文字 */
+		if (p == end) {
+			return end;
+		}
+		parser->tokenBackslash = False;
+		p++;
+	}
+
+	for (;;) {
+		q = scanString(p, end);
+		if (q == end) {
+			if (appendBuf(parser->tokenBuf, start, (size_t)(end - start)) != 0) {
+				setError(parser, start, "out of memory");
+				return NULL;
+			}
+			return end;
+		}
+		if (*q == '"') {
+			break;
+		}
+		if (*q != '\\') {
+			setError(parser, q, "control character in string");
+			return NULL;
+		}
+		parser->tokenEscaped = True;
+		if (q + 1 == end) {
+			parser->tokenBackslash = True;
+			if (appendBuf(parser->tokenBuf, start, (size_t)(end - start)) != 0) {
+				setError(parser, start, "out of memory");
+				return NULL;
+			}
+			return end;
+		}
+		p = q + 2;
+	}
+
+	/* 前回までの入力データに続きがない場合は、入力データ上の文字列をそのまま使う */
+	parser->token = TOK_NONE;
+	if (parser->tokenBuf->size == 0) {
+		return (emitString(parser, start, (size_t)(q - start), q) == 0) ? q + 1 : NULL;
+	}
+	if (appendBuf(parser->tokenBuf, start, (size_t)(q - start)) != 0) {
+		setError(parser, start, "out of memory");
+		return NULL;
+	}
+	return (emitString(parser, parser->tokenBuf->data, parser->tokenBuf->size, q) == 0) ? q + 1 : NULL;
+}
+
+/**
+ * @brief 文字列の通知
+ *
+ * @param str エスケープ解除前の文字列
+ * @param len strのバイト数
+ * @param pos エラー位置とする位置
+ * @return 正常:0, エラー:-1
+ */
+static int emitString(CmnJsonParser *parser, const char *str, size_t len, const char *pos)
+{
+	if (parser->tokenEscaped) {
+		parser->tokenEscaped = False;
+		if (decodeString(parser, str, len) != 0) {
+			return setError(parser, pos, "invalid escape in string");
+		}
+		str = parser->decodeBuf->data;
+		len = parser->decodeBuf->size;
+	}
+
+	if (parser->tokenIsKey) {
+		parser->state = ST_COLON;
+		return CALL_HANDLER(parser, pos, onKey, (parser->ctx, str, len));
+	}
+	parser->state = (parser->depth == 0) ? ST_DONE : ST_COMMA_OR_END;
+	return CALL_HANDLER(parser, pos, onString, (parser->ctx, str, len));
+}
+
+/**
+ * @brief 配列、オブジェクトの終了
+ * @return 正常:0, エラー:-1
+ */
+static int endContainer(CmnJsonParser *parser, char close, const char *pos)
+{
+	unsigned char open = parser->stack[--parser->depth];
+
+	if ((open == '{') != (close == '}')) {
+		return setError(parser, pos, "mismatched close bracket");
+	}
+	parser->state = (parser->depth == 0) ? ST_DONE : ST_COMMA_OR_END;
+	if (close == '}') {
+		return CALL_HANDLER(parser, pos, onEndObject, (parser->ctx));
+	}
+	return CALL_HANDLER(parser, pos, onEndArray, (parser->ctx));
+}
+
+/**
+ * @brief 文字列のエスケープ解除
+ *
+ *  エスケープを解除した文字列をdecodeBufに格納する。\\uXXXXはUTF-8に変換する（サロゲートペアは1文字に結合する）。
+ *
+ * @return 正常:0, 不正なエスケープ:-1
+ */
+static int decodeString(CmnJsonParser *parser, const char *str, size_t len)
+{
+	const char *p = str;
+	const char *end = str + len;
+	char *out;
+	unsigned int code, low;
+
+	/* エスケープを解除すると短くなるため、元の長さがあれば足りる */
+	if (len > parser->decodeBuf->bufSize && CmnDataBuffer_Reserve(parser->decodeBuf, len) != 0) {
+		return -1;
+	}
+	out = parser->decodeBuf->data;
+
+	while (p < end) {
+		const char *q = memchr(p, '\\', (size_t)(end - p));
+		if (q == NULL) {
+			q = end;
+		}
+		memcpy(out, p, (size_t)(q - p));
+		out += q - p;
+		if (q == end) {
+			break;
+		}
+
+		p = q + 2;
+		switch (q[1]) {
+		case '"':	*out++ = '"';	break;
+		case '\\':	*out++ = '\\';	break;
+		case '/':	*out++ = '/';	break;
+		case 'b':	*out++ = '\b';	break;
+		case 'f':	*out++ = '\f';	break;
+		case 'n':	*out++ = '\n';	break;
+		case 'r':	*out++ = '\r';	break;
+		case 't':	*out++ = '\t';	break;
+		case 'u':
+			if (parseHex4(p, end, &code) != 0) {
+				return -1;
+			}
+			p += 4;
+			if (0xDC00 <= code && code <= 0xDFFF) {
+				return -1;
+			}
+			if (0xD800 <= code && code <= 0xDBFF) {
+				/* サロゲートペア */
+				if (end - p < 6 || p[0] != '\\' || p[1] != 'u' || parseHex4(p + 2, end, &low) != 0
+						|| low < 0xDC00 || 0xDFFF < low) {
+					return -1;
+				}
+				p += 6;
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+			}
+			if (code < 0x80) {
+				*out++ = (char)code;
+			}
+			else if (code < 0x800) {
+				*out++ = (char)(0xC0 | (code >> 6));
+				*out++ = (char)(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000) {
+				*out++ = (char)(0xE0 | (code >> 12));
+				*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+				*out++ = (char)(0x80 | (code & 0x3F));
+			}
+			else {
+				*out++ = (char)(0xF0 | (code >> 18));
+				*out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+				*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+				*out++ = (char)(0x80 | (code & 0x3F));
+			}
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	parser->decodeBuf->size = (size_t)(out - (char *)parser->decodeBuf->data);
+	return 0;
+}
+
+/**
+ * @brief 4桁の16進数の変換
+ * @return 正常:0, エラー:-1
+ */
+static int parseHex4(const char *p, const char *end, unsigned int *code)
+{
+	unsigned int value = 0;
+	int i;
+
+	if (end - p < 4) {
+		return -1;
+	}
+	for (i = 0; i < 4; i++) {
+		unsigned int c = (unsigned char)p[i];
+		if ('0' <= c && c <= '9') {
+			c -= '0';
+		}
+		else if ('a' <= (c | 0x20) && (c | 0x20) <= 'f') {
+			c = (c | 0x20) - 'a' + 10;
+		}
+		else {
+			return -1;
+		}
+		value = (value << 4) | c;
+	}
+	*code = value;
+	return 0;
+}
+
+/**
+ * @brief 数値の書式の検査
+ *
+ *  JSONの数値の書式（-?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?）に一致するかを検査する。
+ *
+ * @return 一致:True, 不一致:False
+ */
+static int isValidNumber(const char *p, size_t len)
+{
+	const char *end = p + len;
+
+	if (p < end && *p == '-') {
+		p++;
+	}
+	if (p == end || (unsigned int)(*p - '0') > 9) {
+		return False;
+	}
+	if (*p++ != '0') {
+		while (p < end && (unsigned int)(*p - '0') <= 9) {
+			p++;
+		}
+	}
+	if (p < end && *p == '.') {
+		p++;
+		if (p == end || (unsigned int)(*p - '0') > 9) {
+			return False;
+		}
+		while (p < end && (unsigned int)(*p - '0') <= 9) {
+			p++;
+		}
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < end && (*p == '+' || *p == '-')) {
+			p++;
+		}
+		if (p == end || (unsigned int)(*p - '0') > 9) {
+			return False;
+		}
+		while (p < end && (unsigned int)(*p - '0') <= 9) {
+			p++;
+		}
+	}
+	return p == end;
+}
+
+/**
+ * @brief バッファへの追加
+ *
+ *  CmnDataBuffer_Appendと同じだが、領域拡張を倍々で行い、拡張しない場合は関数呼び出しを行わない。
+ *
+ * @return 正常:0, エラー:-1
+ */
+static int appendBuf(CmnDataBuffer *buf, const char *data, size_t len)
+{
+	if (buf->size + len > buf->bufSize) {
+		size_t newSize = buf->bufSize * 2;
+		if (newSize < buf->size + len) {
+			newSize = buf->size + len;
+		}
+		if (CmnDataBuffer_Reserve(buf, newSize) != 0) {
+			return -1;
+		}
+	}
+	memcpy((char *)buf->data + buf->size, data, len);
+	buf->size += len;
+	return 0;
+}
+
+/**
+ * @brief エラーの設定
+ * @param pos エラー位置（解析中の入力データ上の位置）
+ * @return -1
+ */
+static int setError(CmnJsonParser *parser, const char *pos, const char *message)
+{
+	if (parser->error == NULL) {
+		parser->error = message;
+		parser->errorOffset = parser->offset + (size_t)(pos - parser->chunk);
+	}
+	return -1;
+}
+
+/**
+ * @brief 文字列中の特別な処理が必要な文字の検索
+ * @return 最初の'"'、'\\'、制御文字の位置（ない場合はend）
+ */
+static const char* scanString(const char *p, const char *end)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i ctrl = _mm_set1_epi8(0x1F);
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+		unsigned int mask;
+		/* 0x1F以下（符号なし）は制御文字 */
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v));
+		mask = (unsigned int)_mm_movemask_epi8(m);
+		if (mask != 0) {
+			return p + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && !(charClass[(unsigned char)*p] & CC_STRING)) {
+		p++;
+	}
+	return p;
+}
+
+/* --- DOM構築 --- */
+
+/** null */
+static int domOnNull(void *ctx)
+{
+	return (domAdd(ctx, CMN_JSON_NULL) != NULL) ? 0 : -1;
+}
+
+/** true, false */
+static int domOnBool(void *ctx, int value)
+{
+	CmnJsonValue *v = domAdd(ctx, CMN_JSON_BOOL);
+	if (v == NULL) {
+		return -1;
+	}
+	v->boolean = value;
+	return 0;
+}
+
+/** 数値 */
+static int domOnNumber(void *ctx, const char *str, size_t len)
+{
+	DomBuilder *dom = ctx;
+	CmnJsonValue *v = domAdd(dom, CMN_JSON_NUMBER);
+	if (v == NULL || (v->str = CmnDataArena_CopyString(dom->arena, str, len)) == NULL) {
+		return -1;
+	}
+	v->len = len;
+	if (CmnString_ParseDouble(v->str, len, &v->number) != CMN_STRING_PARSE_OK) {
+		/* 倍精度の範囲外 */
+		v->number = strtod(v->str, NULL);
+	}
+	return 0;
+}
+
+/** 文字列 */
+static int domOnString(void *ctx, const char *str, size_t len)
+{
+	DomBuilder *dom = ctx;
+	CmnJsonValue *v = domAdd(dom, CMN_JSON_STRING);
+	if (v == NULL || (v->str = CmnDataArena_CopyString(dom->arena, str, len)) == NULL) {
+		return -1;
+	}
+	v->len = len;
+	return 0;
+}
+
+/** オブジェクトのキー */
+static int domOnKey(void *ctx, const char *str, size_t len)
+{
+	DomBuilder *dom = ctx;
+	dom->key = CmnDataArena_CopyString(dom->arena, str, len);
+	dom->keyLen = len;
+	return (dom->key != NULL) ? 0 : -1;
+}
+
+/** オブジェクトの開始 */
+static int domOnStartObject(void *ctx)
+{
+	DomBuilder *dom = ctx;
+	CmnJsonValue *v = domAdd(dom, CMN_JSON_OBJECT);
+	if (v == NULL) {
+		return -1;
+	}
+	dom->frames[dom->depth].container = v;
+	dom->frames[dom->depth].last = NULL;
+	dom->depth++;
+	return 0;
+}
+
+/** 配列の開始 */
+static int domOnStartArray(void *ctx)
+{
+	DomBuilder *dom = ctx;
+	CmnJsonValue *v = domAdd(dom, CMN_JSON_ARRAY);
+	if (v == NULL) {
+		return -1;
+	}
+	dom->frames[dom->depth].container = v;
+	dom->frames[dom->depth].last = NULL;
+	dom->depth++;
+	return 0;
+}
+
+/** 配列、オブジェクトの終了 */
+static int domOnEnd(void *ctx)
+{
+	DomBuilder *dom = ctx;
+	dom->depth--;
+	return 0;
+}
+
+/**
+ * @brief 値の追加
+ *
+ *  値をアリーナ上に確保し、構築中の配列、オブジェクトの末尾（入れ子の外の場合はルート）に追加する。
+ *
+ * @return 追加した値。メモリ不足の場合はNULL。
+ */
+static CmnJsonValue* domAdd(DomBuilder *dom, CmnJsonType type)
+{
+	CmnJsonValue *v = CmnDataArena_Alloc(dom->arena, sizeof(CmnJsonValue));
+	DomFrame *frame;
+
+	if (v == NULL) {
+		return NULL;
+	}
+	memset(v, 0, sizeof(CmnJsonValue));
+	v->type = type;
+
+	if (dom->depth == 0) {
+		dom->root = v;
+		return v;
+	}
+
+	frame = &dom->frames[dom->depth - 1];
+	if (frame->container->type == CMN_JSON_OBJECT) {
+		v->key = dom->key;
+		v->keyLen = dom->keyLen;
+		dom->key = NULL;
+	}
+	if (frame->last == NULL) {
+		frame->container->child = v;
+	}
+	else {
+		frame->last->next = v;
+	}
+	frame->last = v;
+	frame->container->count++;
+	return v;
+}
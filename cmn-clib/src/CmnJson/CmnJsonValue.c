@@ -0,0 +1,93 @@
+/** @file *********************************************************************
+ * @brief JSONの値（DOM） 共通関数
+ *
+ *  JSON文字列をDOM（CmnJsonValue）に変換する関数と、DOMの要素を取得する関数。<br>
+ *  DOMはすべてアリーナ上に確保されるため、個別の解放は不要（アリーナごと解放する）。<br>
+ *  要素の取得は呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnJson.h"
+#include"cmnclib/CmnLog.h"
+
+/**
+ * @brief JSON文字列の解析（DOM構築）
+ *
+ *  JSON文字列を解析し、アリーナ上にDOMを構築する。
+ *
+ * @param json JSON文字列（UTF-8）。'\0'で終端している必要はない。
+ * @param len jsonのバイト数
+ * @param arena DOMを確保するアリーナ
+ * @return ルートの値。構文エラーの場合はNULL（途中まで構築したDOMの領域はアリーナに残る）。
+ */
+CmnJsonValue* CmnJson_Parse(const char *json, size_t len, CmnDataArena *arena)
+{
+	CmnJsonParser *parser;
+	CmnJsonValue *root = NULL;
+	CMNLOG_TRACE_START();
+
+	parser = CmnJsonParser_CreateDom(arena);
+	if (parser == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	if (CmnJsonParser_Feed(parser, json, len) == 0 && CmnJsonParser_Finish(parser) == 0) {
+		root = CmnJsonParser_GetRoot(parser);
+	}
+	CmnJsonParser_Free(parser);
+
+	CMNLOG_TRACE_END();
+	return root;
+}
+
+/**
+ * @brief オブジェクトのメンバの取得
+ *
+ *  キーが一致するメンバを先頭から探す。同じキーが複数ある場合は最初のメンバを返す。
+ *
+ * @param object オブジェクト
+ * @param key キー
+ * @return 値。オブジェクトでない場合、キーが存在しない場合はNULL。
+ */
+CmnJsonValue* CmnJsonValue_Get(const CmnJsonValue *object, const char *key)
+{
+	CmnJsonValue *v;
+	size_t keyLen;
+
+	if (object == NULL || object->type != CMN_JSON_OBJECT) {
+		return NULL;
+	}
+	keyLen = strlen(key);
+	for (v = object->child; v != NULL; v = v->next) {
+		if (v->keyLen == keyLen && memcmp(v->key, key, keyLen) == 0) {
+			return v;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief 配列の要素の取得
+ *
+ * @param array 配列（オブジェクトの場合はメンバの順序で取得する）
+ * @param index 添え字（0～）
+ * @return 値。配列、オブジェクトでない場合、添え字が範囲外の場合はNULL。
+ */
+CmnJsonValue* CmnJsonValue_GetAt(const CmnJsonValue *array, size_t index)
+{
+	CmnJsonValue *v;
+
+	if (array == NULL || (array->type != CMN_JSON_ARRAY && array->type != CMN_JSON_OBJECT) || index >= array->count) {
+		return NULL;
+	}
+	for (v = array->child; index > 0; index--) {
+		v = v->next;
+	}
+	return v;
+}
@@ -0,0 +1,490 @@
+/** @file *********************************************************************
+ * @brief JSON書き込み 共通関数
+ *
+ *  JSONを文字列バッファ（CmnStringBuffer）の末尾に直接書き込む関数。<br>
+ *  区切りの','、キーの後の':'は自動で書き込む。改行、インデントは行わない。<br>
+ *  文字列は'"'、'\\'、制御文字のみをエスケープし、それ以外（UTF-8の非ASCII文字を含む）はそのまま書き込む。
+ *  SSE2が使用できる場合は、エスケープが必要な文字の検索を16バイト単位で行う。<br>
+ *  数値、文字列等の書き込みは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnJson.h"
+#include"cmnclib/CmnLog.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+static char* beginValue(CmnJsonWriter *writer, size_t len);
+static char* reserve(CmnJsonWriter *writer, size_t len);
+static void commit(CmnJsonWriter *writer, char *end);
+static int writeString(CmnJsonWriter *writer, const char *str, size_t len, int isKey);
+static int writeRaw(CmnJsonWriter *writer, const char *str, size_t len);
+static int writeValue(CmnJsonWriter *writer, const CmnJsonValue *value);
+static const char* scanEscape(const char *p, const char *end);
+
+/**
+ * @brief JSON書き込みの初期化
+ *
+ * @param writer 初期化するJSON書き込み
+ * @param buf 書き込み先の文字列バッファ。末尾に追加する。
+ */
+void CmnJsonWriter_Init(CmnJsonWriter *writer, CmnStringBuffer *buf)
+{
+	writer->_buf = buf;
+	writer->_depth = 0;
+	writer->_afterKey = False;
+	writer->_error = False;
+	writer->_first[0] = True;
+}
+
+/**
+ * @brief オブジェクトの開始
+ *
+ * @param writer JSON書き込み
+ * @return 正常:0, エラー:-1（入れ子が深すぎる、メモリ不足。以降の書き込みもエラーとなる）
+ */
+int CmnJsonWriter_StartObject(CmnJsonWriter *writer)
+{
+	char *p;
+
+	if (writer->_depth >= CMN_JSON_MAX_DEPTH) {
+		writer->_error = True;
+	}
+	if ((p = beginValue(writer, 1)) == NULL) {
+		return -1;
+	}
+	*p++ = '{';
+	commit(writer, p);
+	writer->_first[++writer->_depth] = True;
+	return 0;
+}
+
+/**
+ * @brief オブジェクトの終了
+ *
+ * @param writer JSON書き込み
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_EndObject(CmnJsonWriter *writer)
+{
+	char *p;
+
+	if (writer->_depth == 0) {
+		writer->_error = True;
+	}
+	if (writer->_error || (p = reserve(writer, 1)) == NULL) {
+		return -1;
+	}
+	*p++ = '}';
+	commit(writer, p);
+	writer->_depth--;
+	return 0;
+}
+
+/**
+ * @brief 配列の開始
+ *
+ * @param writer JSON書き込み
+ * @return 正常:0, エラー:-1（入れ子が深すぎる、メモリ不足）
+ */
+int CmnJsonWriter_StartArray(CmnJsonWriter *writer)
+{
+	char *p;
+
+	if (writer->_depth >= CMN_JSON_MAX_DEPTH) {
+		writer->_error = True;
+	}
+	if ((p = beginValue(writer, 1)) == NULL) {
+		return -1;
+	}
+	*p++ = '[';
+	commit(writer, p);
+	writer->_first[++writer->_depth] = True;
+	return 0;
+}
+
+/**
+ * @brief 配列の終了
+ *
+ * @param writer JSON書き込み
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_EndArray(CmnJsonWriter *writer)
+{
+	char *p;
+
+	if (writer->_depth == 0) {
+		writer->_error = True;
+	}
+	if (writer->_error || (p = reserve(writer, 1)) == NULL) {
+		return -1;
+	}
+	*p++ = ']';
+	commit(writer, p);
+	writer->_depth--;
+	return 0;
+}
+
+/**
+ * @brief オブジェクトのキーの書き込み
+ *
+ *  キーと':'を書き込む。続けて値を書き込むこと。
+ *
+ * @param writer JSON書き込み
+ * @param key キー（UTF-8）
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_Key(CmnJsonWriter *writer, const char *key)
+{
+	return CmnJsonWriter_KeyN(writer, key, strlen(key));
+}
+
+/**
+ * @brief オブジェクトのキーの書き込み（長さ指定）
+ *
+ * @param writer JSON書き込み
+ * @param key キー（UTF-8）。'\0'で終端している必要はない。
+ * @param len keyのバイト数
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_KeyN(CmnJsonWriter *writer, const char *key, size_t len)
+{
+	if (writeString(writer, key, len, True) != 0) {
+		return -1;
+	}
+	writer->_afterKey = True;
+	return 0;
+}
+
+/**
+ * @brief 文字列の書き込み
+ *
+ * @param writer JSON書き込み
+ * @param str 文字列（UTF-8）
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_String(CmnJsonWriter *writer, const char *str)
+{
+	return writeString(writer, str, strlen(str), False);
+}
+
+/**
+ * @brief 文字列の書き込み（長さ指定）
+ *
+ * @param writer JSON書き込み
+ * @param str 文字列（UTF-8）。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_StringN(CmnJsonWriter *writer, const char *str, size_t len)
+{
+	return writeString(writer, str, len, False);
+}
+
+/**
+ * @brief 整数の書き込み
+ *
+ * @param writer JSON書き込み
+ * @param value 値
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_Int(CmnJsonWriter *writer, long long value)
+{
+	char *p = beginValue(writer, CMN_STRING_INT_SIZE);
+	if (p == NULL) {
+		return -1;
+	}
+	p += CmnString_FormatInt(value, p);
+	commit(writer, p);
+	return 0;
+}
+
+/**
+ * @brief 浮動小数点数の書き込み
+ *
+ *  読み戻したときに同じ値になる最短の表現で書き込む。JSONで表現できない非数、無限大はnullを書き込む。
+ *
+ * @param writer JSON書き込み
+ * @param value 値
+ * @return 正常:0, エラー:-1
+ * @sa CmnString_FormatDouble
+ */
+int CmnJsonWriter_Double(CmnJsonWriter *writer, double value)
+{
+	char *p;
+
+	if (value != value || value - value != 0) {
+		return CmnJsonWriter_Null(writer);
+	}
+	if ((p = beginValue(writer, CMN_STRING_DOUBLE_SIZE)) == NULL) {
+		return -1;
+	}
+	p += CmnString_FormatDouble(value, p);
+	commit(writer, p);
+	return 0;
+}
+
+/**
+ * @brief 真偽値の書き込み
+ *
+ * @param writer JSON書き込み
+ * @param value True:trueを書き込む, False:falseを書き込む
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_Bool(CmnJsonWriter *writer, int value)
+{
+	return value ? writeRaw(writer, "true", 4) : writeRaw(writer, "false", 5);
+}
+
+/**
+ * @brief nullの書き込み
+ *
+ * @param writer JSON書き込み
+ * @return 正常:0, エラー:-1
+ */
+int CmnJsonWriter_Null(CmnJsonWriter *writer)
+{
+	return writeRaw(writer, "null", 4);
+}
+
+/**
+ * @brief DOMの書き込み
+ *
+ *  DOM（CmnJsonValue）をJSONとして文字列バッファの末尾に書き込む。
+ *  数値は解析時の表現のまま書き込む。
+ *
+ * @param value 書き込む値
+ * @param buf 書き込み先の文字列バッファ
+ * @return 正常:0, エラー:-1
+ */
+int CmnJson_Write(const CmnJsonValue *value, CmnStringBuffer *buf)
+{
+	CmnJsonWriter writer;
+	int ret;
+	CMNLOG_TRACE_START();
+
+	CmnJsonWriter_Init(&writer, buf);
+	ret = writeValue(&writer, value);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 値の書き込み開始
+ *
+ *  必要に応じて区切りの','を書き込み、続けて書き込む領域を確保する。
+ *
+ * @param len 続けて書き込むバイト数
+ * @return 書き込み位置。エラーの場合はNULL。
+ */
+static char* beginValue(CmnJsonWriter *writer, size_t len)
+{
+	char *p;
+
+	if (writer->_error || (p = reserve(writer, len + 1)) == NULL) {
+		return NULL;
+	}
+	if (writer->_afterKey) {
+		writer->_afterKey = False;
+	}
+	else if (!writer->_first[writer->_depth]) {
+		*p++ = ',';
+	}
+	writer->_first[writer->_depth] = False;
+	return p;
+}
+
+/**
+ * @brief 書き込み領域の確保
+ *
+ *  文字列バッファの末尾にlenバイト（と終端の'\0'）を書き込めるよう領域を確保する。領域の拡張は倍々で行う。
+ *
+ * @return 書き込み位置（文字列バッファの末尾）。メモリ不足の場合はNULL。
+ */
+static char* reserve(CmnJsonWriter *writer, size_t len)
+{
+	CmnStringBuffer *buf = writer->_buf;
+	size_t need = buf->length + len + 1;
+
+	if (need > buf->_buf->bufSize) {
+		size_t newSize = buf->_buf->bufSize * 2;
+		if (newSize < need) {
+			newSize = need;
+		}
+		if (CmnStringBuffer_Reserve(buf, newSize - 1) != 0) {
+			writer->_error = True;
+			return NULL;
+		}
+	}
+	return buf->string + buf->length;
+}
+
+/**
+ * @brief 書き込みの確定
+ * @param end 書き込んだ末尾の次の位置
+ */
+static void commit(CmnJsonWriter *writer, char *end)
+{
+	CmnStringBuffer *buf = writer->_buf;
+	*end = '\0';
+	buf->length = (size_t)(end - buf->string);
+	buf->_buf->size = buf->length + 1;
+}
+
+/**
+ * @brief 文字列の書き込み
+ * @param isKey True:キーとして書き込む（末尾に':'を付ける）
+ * @return 正常:0, エラー:-1
+ */
+static int writeString(CmnJsonWriter *writer, const char *str, size_t len, int isKey)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *end = str + len;
+	char *p = beginValue(writer, len + 3);
+
+	if (p == NULL) {
+		return -1;
+	}
+	*p++ = '"';
+	for (;;) {
+		const char *q = scanEscape(str, end);
+		unsigned char c;
+
+		memcpy(p, str, (size_t)(q - str));
+		p += q - str;
+		if (q == end) {
+			break;
+		}
+
+		/* エスケープは最大6バイト。確保済みの領域は元の1バイト分のため、残りと合わせて確保し直す */
+		commit(writer, p);
+		if ((p = reserve(writer, 6 + (size_t)(end - q - 1) + 2)) == NULL) {
+			return -1;
+		}
+		c = (unsigned char)*q;
+		*p++ = '\\';
+		switch (c) {
+		case '"':	*p++ = '"';		break;
+		case '\\':	*p++ = '\\';	break;
+		case '\b':	*p++ = 'b';		break;
+		case '\f':	*p++ = 'f';		break;
+		case '\n':	*p++ = 'n';		break;
+		case '\r':	*p++ = 'r';		break;
+		case '\t':	*p++ = 't';		break;
+		default:
+			*p++ = 'u';
+			*p++ = '0';
+			*p++ = '0';
+			*p++ = hex[c >> 4];
+			*p++ = hex[c & 0x0F];
+			break;
+		}
+		str = q + 1;
+	}
+	*p++ = '"';
+	if (isKey) {
+		*p++ = ':';
+	}
+	commit(writer, p);
+	return 0;
+}
+
+/**
+ * @brief 値の書き込み（エスケープなし）
+ * @return 正常:0, エラー:-1
+ */
+static int writeRaw(CmnJsonWriter *writer, const char *str, size_t len)
+{
+	char *p = beginValue(writer, len);
+	if (p == NULL) {
+		return -1;
+	}
+	memcpy(p, str, len);
+	commit(writer, p + len);
+	return 0;
+}
+
+/**
+ * @brief DOMの値の書き込み
+ * @return 正常:0, エラー:-1
+ */
+static int writeValue(CmnJsonWriter *writer, const CmnJsonValue *value)
+{
+	const CmnJsonValue *v;
+
+	switch (value->type) {
+	case CMN_JSON_NULL:
+		return CmnJsonWriter_Null(writer);
+	case CMN_JSON_BOOL:
+		return CmnJsonWriter_Bool(writer, value->boolean);
+	case CMN_JSON_NUMBER:
+		if (value->str != NULL) {
+			return writeRaw(writer, value->str, value->len);
+		}
+		return CmnJsonWriter_Double(writer, value->number);
+	case CMN_JSON_STRING:
+		return writeString(writer, value->str, value->len, False);
+	case CMN_JSON_ARRAY:
+		if (CmnJsonWriter_StartArray(writer) != 0) {
+			return -1;
+		}
+		for (v = value->child; v != NULL; v = v->next) {
+			if (writeValue(writer, v) != 0) {
+				return -1;
+			}
+		}
+		return CmnJsonWriter_EndArray(writer);
+	case CMN_JSON_OBJECT:
+		if (CmnJsonWriter_StartObject(writer) != 0) {
+			return -1;
+		}
+		for (v = value->child; v != NULL; v = v->next) {
+			if (CmnJsonWriter_KeyN(writer, v->key, v->keyLen) != 0 || writeValue(writer, v) != 0) {
+				return -1;
+			}
+		}
+		return CmnJsonWriter_EndObject(writer);
+	default:
+		writer->_error = True;
+		return -1;
+	}
+}
+
+/**
+ * @brief エスケープが必要な文字の検索
+ * @return 最初の'"'、'\\'、制御文字の位置（ない場合はend）
+ */
+static const char* scanEscape(const char *p, const char *end)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i ctrl = _mm_set1_epi8(0x1F);
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+		unsigned int mask;
+		/* 0x1F以下（符号なし）は制御文字 */
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl), v));
+		mask = (unsigned int)_mm_movemask_epi8(m);
+		if (mask != 0) {
+			return p + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) {
+		p++;
+	}
+	return p;
+}
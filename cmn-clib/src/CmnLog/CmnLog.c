@@ -171,7 +171,7 @@ void CmnLog_PutByCode(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msgCode, .
 
 	/* メッセージ本文を出力 */
 	va_start(args, msgCode);
-	cmnLogEx_PutLog(log, level, msg.msg, args);
+	cmnLogEx_PutLogFormat(log, level, msg.format, args);
 	va_end(args);
 }
 
@@ -36,16 +36,24 @@
 #include"cmnclib/Common.h"
 #include"cmnclib/CmnLog.h"
 #include"cmnclib/CmnTime.h"
-
-static const char* CMN_LOG_LEVEL_NAMES[] = {
-	"",
-	"ERROR",
-	"WARN",
-	"INFO",
-	"DEBUG",
-	"TRACE"
+#include"cmnclib/CmnString.h"
+
+/** ログ1行の書式化に使用するバッファサイズ（収まらない場合のみ領域を確保する） */
+#define LINE_BUFSIZ 1024
+
+/** ログレベルの出力文字列（" [%5s] "で書式化したもの） */
+static const char* CMN_LOG_LEVEL_TAGS[] = {
+	" [     ] ",
+	" [ERROR] ",
+	" [ WARN] ",
+	" [ INFO] ",
+	" [DEBUG] ",
+	" [TRACE] "
 };
+/** ログレベルの出力文字列のバイト数 */
+#define LEVEL_TAG_LEN 9
 
+static void putLog(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, const CmnStringFormat* format, va_list args);
 static char* timeFormat(int type, char* buf);
 static void mutexLock(CmnThreadMutex* mutex);
 static void mutexUnLock(CmnThreadMutex* mutex);
@@ -190,9 +198,9 @@ void CmnLogEx_PutByCode(CmnLogEx *log, CMN_LOG_LEVEL level, const char *msgCode,
 		return ;
 	}
 
-	/* メッセージ本文を出力 */
+	/* メッセージ本文を出力（事前解析済みの書式を使用） */
 	va_start(args, msgCode);
-	cmnLogEx_PutLog(log, level, msg.msg, args);
+	putLog(log, level, NULL, msg.format, args);
 	va_end(args);
 }
 
@@ -213,8 +221,45 @@ void CmnLogEx_PutByCode(CmnLogEx *log, CMN_LOG_LEVEL level, const char *msgCode,
  */
 void cmnLogEx_PutLog(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, va_list args)
 {
-	char str_date[CMN_TIME_FORMAT_SIZE_ALL];
-	char format[512];
+	putLog(log, level, msg, NULL, args);
+}
+
+/**
+ * @brief 拡張ログ出力（内部用関数。事前解析済みのメッセージ文）
+ *
+ *  ログメッセージ定義ファイルから読み込んだメッセージ文のように、
+ *  事前解析済みの書式でログを出力する。出力形式はcmnLogEx_PutLog()と同じ。
+ *
+ * @param log              (I) 拡張ログ情報構造体へのポインタ（CmnLog_InitEx()関数の戻り値）
+ * @param level            (I) ログレベル。LoggerInitで指定されたログレベルと比較し、出力可否を決める。
+ * @param format           (I) 事前解析済みのメッセージ文言
+ * @param args             (I) メッセージ内に含まれる%sや%dの部分に対応する変数を指定する
+ */
+void cmnLogEx_PutLogFormat(CmnLogEx* log, CMN_LOG_LEVEL level, const CmnStringFormat* format, va_list args)
+{
+	putLog(log, level, NULL, format, args);
+}
+
+/**
+ * @brief ログ1行の書式化と出力
+ *
+ *  時刻、ログレベル、メッセージ本文、改行を1つのバッファに書式化し、1回の書き込みで出力する。<BR>
+ *  書式化はロックの外で行い、ロック中はファイルへの書き込みのみを行う。
+ *
+ * @param log              (I) 拡張ログ情報構造体へのポインタ
+ * @param level            (I) ログレベル
+ * @param msg              (I) メッセージ文言（formatを指定した場合は使用しない）
+ * @param format           (I) 事前解析済みのメッセージ文言（NULLの場合はmsgを使用する）
+ * @param args             (I) メッセージ内に含まれる%sや%dの部分に対応する変数
+ */
+static void putLog(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, const CmnStringFormat* format, va_list args)
+{
+	char line[LINE_BUFSIZ];
+	char *buf = line;
+	char *p;
+	size_t prefixLen;
+	size_t len;
+	va_list retryArgs;
 	FILE* file;
 
 	if (log == NULL) return;
@@ -222,55 +267,97 @@ void cmnLogEx_PutLog(CmnLogEx* log, CMN_LOG_LEVEL level, const char* msg, va_lis
 	/* ログレベルチェック */
 	if (level > log->level) return;
 
-	/* 書式フォーマットされた現在時刻文字列を取得 */
-	timeFormat(CMN_TIME_FORMAT_ALL, str_date);
+	/* 時刻、ログレベルの出力文字列（"yyyy/mm/dd hh:mm:ss [LEVEL] "）を作成 */
+	p = timeFormat(CMN_TIME_FORMAT_ALL, line);
+	memcpy(p, CMN_LOG_LEVEL_TAGS[level], LEVEL_TAG_LEN);
+	prefixLen = p + LEVEL_TAG_LEN - line;
+
+	/* メッセージ本文を改行の領域を残して書式化。収まらない場合は領域を確保して書式化し直す */
+	va_copy(retryArgs, args);
+	len = (format != NULL)
+		? CmnStringFormat_VFormat(format, line + prefixLen, sizeof(line) - prefixLen - 1, args)
+		: CmnString_VFormat(line + prefixLen, sizeof(line) - prefixLen - 1, msg, args);
+	if (prefixLen + len + 2 > sizeof(line)) {
+		if ((buf = malloc(prefixLen + len + 2)) != NULL) {
+			memcpy(buf, line, prefixLen);
+			if (format != NULL) {
+				CmnStringFormat_VFormat(format, buf + prefixLen, len + 1, retryArgs);
+			}
+			else {
+				CmnString_VFormat(buf + prefixLen, len + 1, msg, retryArgs);
+			}
+		}
+		else {
+			/* 領域を確保できない場合は切り詰めて出力 */
+			buf = line;
+			len = sizeof(line) - prefixLen - 2;
+		}
+	}
+	va_end(retryArgs);
+	len += prefixLen;
+	buf[len++] = '\n';
 
 	/* START Synchronized */
 	mutexLock(log->mutex);
 
 	/* ログファイルオープン */
 	if (log->file != NULL) {
-		if ((file = fopen(log->file, "a")) == NULL) {
-			return;
-		}
+		file = fopen(log->file, "a");
 	}
 	else {
 		file = stdout;
 	}
 
-	/* 時刻、ログレベルを出力 */
-	sprintf(format, "%s [%5s] ", str_date, CMN_LOG_LEVEL_NAMES[level]);
-	fprintf(file, format);
-
-	/* メッセージ本文を出力 */
-	vfprintf(file, msg, args);
-	fprintf(file, "\n");
-
-	if (log->file != NULL) {
-		fclose(file);
+	if (file != NULL) {
+		fwrite(buf, 1, len, file);
+		if (log->file != NULL) {
+			fclose(file);
+		}
 	}
 
 	/* END Synchronized */
 	mutexUnLock(log->mutex);
+
+	if (buf != line) {
+		free(buf);
+	}
 }
 
+/**
+ * @brief 現在時刻を"yyyy/mm/dd hh:mm:ss"形式で書き込む
+ *
+ *  CmnTime_Formatはトレースログを出力するため、ログ出力処理の中では使用しない。
+ *
+ * @param type フォーマットタイプ（CMN_TIME_FORMAT_ALLのみ）
+ * @param buf 書き込み先
+ * @return 書き込んだ文字列の末尾（'\0'の位置）
+ */
 static char* timeFormat(int type, char* buf)
 {
-	struct tm* ptime;
+	struct tm ptime;
 	time_t now;
+	char *p = buf;
 
 	time(&now);
-	ptime = localtime(&now);
-
-	/* 年、月情報の修正 */
-	ptime->tm_year += 1900;
-	ptime->tm_mon += 1;
-
-	sprintf(buf, "%04d/%02d/%02d %02d:%02d:%02d",
-		ptime->tm_year, ptime->tm_mon, ptime->tm_mday,
-		ptime->tm_hour, ptime->tm_min, ptime->tm_sec);
+#if IS_PRATFORM_WINDOWS()
+	localtime_s(&ptime, &now);
+#else
+	localtime_r(&now, &ptime);
+#endif
 
-	return buf;
+	p += CmnString_FormatUIntPad(ptime.tm_year + 1900, 4, p);
+	*p++ = '/';
+	p += CmnString_FormatUIntPad(ptime.tm_mon + 1, 2, p);
+	*p++ = '/';
+	p += CmnString_FormatUIntPad(ptime.tm_mday, 2, p);
+	*p++ = ' ';
+	p += CmnString_FormatUIntPad(ptime.tm_hour, 2, p);
+	*p++ = ':';
+	p += CmnString_FormatUIntPad(ptime.tm_min, 2, p);
+	*p++ = ':';
+	p += CmnString_FormatUIntPad(ptime.tm_sec, 2, p);
+
+	return p;
 }
 
 static void mutexLock(CmnThreadMutex* mutex)
@@ -46,10 +46,9 @@ CmnLogMessage *CmnLogMessage_Create(const char *msgFile)
 	CmnLogMessage *list = NULL;
 	CmnLogMessage *tmp;
 	char  buf[MSG_BUFSIZ];
-	char *code_pos;
-	char *code_buf;
-	char *msg_pos;
-	char *msg_buf;
+	CmnStringView line;
+	CmnStringView code;
+	CmnStringView msg;
 
 	fp = fopen(msgFile, "r");
 	if (fp == NULL) {
@@ -57,50 +56,55 @@ CmnLogMessage *CmnLogMessage_Create(const char *msgFile)
 	}
 
 	while (fgets(buf, MSG_BUFSIZ, fp)) {
+		/* 前後の空白と改行コードを除去 */
+		CmnString_TrimView(buf, strlen(buf), &line);
+
 		/* コメントもしくは空行であれば無視 */
-		if(CmnString_Trim(buf)[0] == '\n' || CmnString_Trim(buf)[0] == COMMENT_CHAR) {
+		if (line.len == 0 || line.str[0] == COMMENT_CHAR) {
 			continue ;
 		}
 
-		/* コードとメッセージへのポインタを取得（同時に区切り文字を'\0'に変換） */
-		msg_pos = strchr(buf, PARSE_CHAR);
-		if (msg_pos == NULL) {
+		/* コードとメッセージを取得（前後の空白は除去済み） */
+		if (CmnString_SplitKeyValue(line.str, line.len, PARSE_CHAR, &code, &msg) != 0) {
+			CmnLogMessage_Free(list);
 			fclose(fp);
 			return NULL;
 		}
-		*msg_pos = '\0';
-		msg_pos++ ;
-		code_pos = buf;
-
-		/* 改行コードを除去 */
-		if (msg_pos[strlen(msg_pos) - 1] == '\n') {
-			msg_pos[strlen(msg_pos) - 1] = '\0';
-		}
-
-		/* コードとメッセージの領域を確保 */
-		code_buf = malloc(strlen(code_pos) + 1);
-		strcpy(code_buf, CmnString_Trim(code_pos));
-		msg_buf = malloc(strlen(msg_pos) + 1);
-		strcpy(msg_buf, CmnString_Trim(msg_pos));
 
 		/* 最初のリストを作成 */
 		if (list == NULL) {
 			list = (CmnLogMessage *)calloc(1, sizeof(CmnLogMessage));
 			if (list == NULL) {
+				fclose(fp);
 				return NULL;
 			}
-			list->code = code_buf;
-			list->msg  = msg_buf;
-			list->next = NULL;
 			tmp = list;
 		}
 		/* 2番目以降のリストを作成 */
 		else {
 			tmp->next = (CmnLogMessage *)calloc(1, sizeof(CmnLogMessage));
+			if (tmp->next == NULL) {
+				CmnLogMessage_Free(list);
+				fclose(fp);
+				return NULL;
+			}
 			tmp = tmp->next;
-			tmp->code = code_buf;
-			tmp->msg  = msg_buf;
-			tmp->next = NULL;
+		}
+		tmp->code = CmnStringView_CopyNew(&code);
+		tmp->msg  = CmnStringView_CopyNew(&msg);
+		tmp->next = NULL;
+		if (tmp->code == NULL || tmp->msg == NULL) {
+			CmnLogMessage_Free(list);
+			fclose(fp);
+			return NULL;
+		}
+
+		/* ログ出力のたびに書式を解析しないよう、事前解析しておく */
+		tmp->format = CmnStringFormat_Compile(tmp->msg);
+		if (tmp->format == NULL) {
+			CmnLogMessage_Free(list);
+			fclose(fp);
+			return NULL;
 		}
 	}
 	fclose(fp);
@@ -131,6 +135,7 @@ void CmnLogMessage_Free(CmnLogMessage *list)
 
 		free(p->code);
 		free(p->msg);
+		CmnStringFormat_Free(p->format);
 		free(p);
 	}
 }
@@ -144,7 +149,7 @@ void CmnLogMessage_Free(CmnLogMessage *list)
  * @param list         (I) ログメッセージリスト
  * @param msg_code     (I) メッセージコード
  * @param msg          (O) LogMessage構造体へのポインタを指定する。<BR>
- *                         メッセージ取得成功時には、msg->codeとmsg->msgに値が格納される
+ *                         メッセージ取得成功時には、msg->code、msg->msg、msg->formatに値が格納される
  * @retval True 取得成功時
  * @retval False 取得失敗時（該当するメッセージコードが存在しない場合）
  * @author H.Kumagai
@@ -160,6 +165,7 @@ int CmnLogMessage_Get(CmnLogMessage *list, const char *msg_code, CmnLogMessage *
 		if (strcmp(p->code, msg_code) == EQUAL) {
 			msg->code = p->code;
 			msg->msg  = p->msg;
+			msg->format = p->format;
 			return True;
 		}
 	}
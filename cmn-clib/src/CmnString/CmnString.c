@@ -26,7 +26,7 @@
  */
 char *CmnString_RTrim(char *str)
 {
-	size_t len;
+	char *end;
 	CMNLOG_TRACE_START();
 
 	if ( ! str) {
@@ -34,20 +34,11 @@ char *CmnString_RTrim(char *str)
 		return str;
 	}
 
-	len = strlen(str) - 1;
-	if (len <= 0) {
-		CMNLOG_TRACE_END();
-		return str;
-	}
-
-	while (len) {
-		if (*(str + len) != ' ') {
-			break;
-		}
-		len--;
+	end = str + strlen(str);
+	while (str < end && *(end - 1) == ' ') {
+		end--;
 	}
-	len++;
-	*(str + len) = '\0';
+	*end = '\0';
 
 	CMNLOG_TRACE_END();
 	return str;
@@ -86,13 +77,24 @@ char *CmnString_LTrim(char *str)
  */
 char *CmnString_Trim(char *str)
 {
-	char *ret;
+	char *end;
 	CMNLOG_TRACE_START();
 
-	ret = CmnString_RTrim(CmnString_LTrim(str));
+	if ( ! str) {
+		CMNLOG_TRACE_END();
+		return str;
+	}
+
+	/* 左側はポインタを進め、右側は末尾から戻る（文字列の走査は1回） */
+	for (; *str == ' '; str++) ;
+	end = str + strlen(str);
+	while (str < end && *(end - 1) == ' ') {
+		end--;
+	}
+	*end = '\0';
 
 	CMNLOG_TRACE_END();
-	return ret;
+	return str;
 }
 
 /**
@@ -322,23 +324,23 @@ CmnStringList* CmnString_SplitAsList(CmnStringList *list, const char *str, const
 			}
 			strcpy(tmp, str);
 			CmnStringList_Add(list, tmp);
+			free(tmp);
 			break;
 		}
 
-		if ((tmp = calloc(strlen(str) + 1, sizeof(char))) == NULL) {
+		/* CmnStringList_Addは複写して追加するため、区切り文字までの長さ分のみ確保し、追加後に解放する */
+		if ((tmp = calloc(pos - str + 1, sizeof(char))) == NULL) {
 			return NULL;
 		}
-		strncpy(tmp, str, pos - str);
+		memcpy(tmp, str, pos - str);
 		CmnStringList_Add(list, tmp);
+		free(tmp);
 
 		str = pos + delimlen;
 
 		/* 最後がdelimで終わっている場合は末尾に空文字列の要素を補充 */
 		if (*str == '\0') {
-			if ((tmp = calloc(1, sizeof(char))) == NULL) {
-				return NULL;
-			}
-			CmnStringList_Add(list, tmp);
+			CmnStringList_Add(list, "");
 		}
 	}
 
@@ -411,11 +413,11 @@ char* CmnString_Lpad(char *buf, const char *str, char padch, size_t digit)
 	/* padding */
 	if (stlen < digit) {
 		padlen = digit - stlen;
-		memset(buf, padch, padlen);
 	}
 
-	/* add str */
-	strcpy(buf + padlen, str);
+	/* add str（bufとstrが同じ場合も考慮して先に移動する） */
+	memmove(buf + padlen, str, stlen + 1);
+	memset(buf, padch, padlen);
 
 	CMNLOG_TRACE_END();
 	return buf;
@@ -435,14 +437,15 @@ char* CmnString_Rpad(char *buf, const char *str, char padch, size_t digit)
 	size_t padlen = 0;
 	CMNLOG_TRACE_START();
 
-	strcpy(buf, str);
 	stlen = strlen(str);
+	memmove(buf, str, stlen);
 
 	if (stlen < digit) {
 		/* padding */
 		padlen = digit - stlen;
 		memset(buf + stlen, padch, padlen);
 	}
+	buf[stlen + padlen] = '\0';
 
 	CMNLOG_TRACE_END();
 	return buf;
@@ -456,12 +459,17 @@ char* CmnString_Rpad(char *buf, const char *str, char padch, size_t digit)
  */
 int CmnString_StartWith(const char *str, const char *mark)
 {
-	int ret = 0;
+	int ret = 1;
 	CMNLOG_TRACE_START();
 
-	if (strstr(str, mark) == str) {
-		return 1;
+	/* markの長さ分のみ比較する */
+	for (; *mark != '\0'; str++, mark++) {
+		if (*str != *mark) {
+			ret = 0;
+			break;
+		}
 	}
+
 	CMNLOG_TRACE_END();
 	return ret;
 }
@@ -482,7 +490,7 @@ int CmnString_EndWith(const char *str, const char *mark)
 	strLen = strlen(str);
 	markLen = strlen(mark);
 
-	if (strcmp(str + strLen - markLen, mark) == EQUAL) {
+	if (markLen <= strLen && memcmp(str + strLen - markLen, mark, markLen) == EQUAL) {
 		ret = 1;
 	}
 
@@ -541,3 +549,32 @@ int CmnString_LastIndexOf(const char *str, const char *mark)
 	CMNLOG_TRACE_END();
 	return index;
 }
+
+/**
+ * @brief 文字列のハッシュ値計算
+ *
+ *  文字列（終端の'\0'を含まない）の64bitハッシュ値を計算する。
+ *
+ * @param str 文字列
+ * @return ハッシュ値
+ * @sa CmnData_Hash
+ */
+unsigned long long CmnString_Hash(const char *str)
+{
+	return CmnData_Hash(str, strlen(str));
+}
+
+/**
+ * @brief 文字列のシード指定ハッシュ値計算
+ *
+ *  シードを指定して文字列（終端の'\0'を含まない）の64bitハッシュ値を計算する。
+ *
+ * @param str 文字列
+ * @param seed シード
+ * @return ハッシュ値
+ * @sa CmnData_HashSeed
+ */
+unsigned long long CmnString_HashSeed(const char *str, unsigned long long seed)
+{
+	return CmnData_HashSeed(str, strlen(str), seed);
+}
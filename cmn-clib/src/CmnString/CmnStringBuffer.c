@@ -6,12 +6,16 @@
  * @author H.Kumagai
  * @date   2020-05-09
  *****************************************************************************/
+#include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include<stdarg.h>
 
 #include "cmnclib/CmnString.h"
 #include "cmnclib/CmnLog.h"
 
+static int growBuffer(CmnStringBuffer *buf, size_t addLen);
+
 /**
  * @brief 文字列バッファ作成
  *
@@ -62,21 +66,227 @@ CmnStringBuffer* CmnStringBuffer_Create(const char *str)
  */
 int CmnStringBuffer_Append(CmnStringBuffer *buf, const char *str)
 {
-	size_t strLen;
+	int ret;
 	CMNLOG_TRACE_START();
 
-	strLen = strlen(str);
+	ret = CmnStringBuffer_AppendN(buf, str, strlen(str));
 
-	/* '\0'を削除 */
-	CmnDataBuffer_Delete(buf->_buf, 1);
-	/* 文字列を追加 */
-	if (CmnDataBuffer_Append(buf->_buf, str, strLen + 1) != 0) {
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 文字列バッファへの長さ指定データ追加
+ *
+ *  文字列バッファの末尾にstrの先頭からlen文字を追加する。<br>
+ *  文字数を呼び出し側で把握している場合はCmnStringBuffer_Appendよりも高速（strlenを行わない）。
+ *
+ * @param buf 文字列バッファ
+ * @param str 追加する文字列。'\0'で終端している必要はない。
+ * @param len 追加する文字数
+ * @return 正常:0, エラー:-1
+ */
+int CmnStringBuffer_AppendN(CmnStringBuffer *buf, const char *str, size_t len)
+{
+	CMNLOG_TRACE_START();
+
+	/* strがbuf自身の一部の場合は領域拡張でアドレスが変わるため、位置を付け替える */
+	if (buf->string <= str && str < buf->string + buf->length) {
+		size_t srcPos = str - buf->string;
+		if (growBuffer(buf, len) != 0) {
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+		str = buf->string + srcPos;
+	}
+	else if (growBuffer(buf, len) != 0) {
 		CMNLOG_TRACE_END();
 		return -1;
 	}
 
+	/* 文字列を追加 */
+	memmove(buf->string + buf->length, str, len);
+	buf->length += len;
+	buf->string[buf->length] = '\0';
+	buf->_buf->size = buf->length + 1;
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファへの書式指定データ追加
+ *
+ *  printf形式で書式化した文字列を文字列バッファの末尾に追加する。<br>
+ *  一時バッファを介さず、文字列バッファの空き領域に直接書式化する。
+ *
+ * @param buf 文字列バッファ
+ * @param format 書式（printf形式）
+ * @param ... 書式に対応する値
+ * @return 正常:0, エラー:-1
+ */
+int CmnStringBuffer_AppendFormat(CmnStringBuffer *buf, const char *format, ...)
+{
+	int ret;
+	va_list args;
+	CMNLOG_TRACE_START();
+
+	va_start(args, format);
+	ret = CmnStringBuffer_AppendVFormat(buf, format, args);
+	va_end(args);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 文字列バッファへの書式指定データ追加（va_list版）
+ *
+ *  vprintf形式で書式化した文字列を文字列バッファの末尾に追加する。<br>
+ *  空き領域に直接書式化し、領域が不足した場合は必要なサイズに拡張して1度だけ書式化し直す。
+ *
+ * @param buf 文字列バッファ
+ * @param format 書式（printf形式）
+ * @param args 書式に対応する値
+ * @return 正常:0, エラー:-1
+ */
+int CmnStringBuffer_AppendVFormat(CmnStringBuffer *buf, const char *format, va_list args)
+{
+	size_t len;
+	size_t spare;
+	va_list retryArgs;
+	CMNLOG_TRACE_START();
+
+	/* 空き領域に直接書式化（'\0'の領域を含む） */
+	spare = buf->_buf->bufSize - buf->length;
+	va_copy(retryArgs, args);
+	len = CmnString_VFormat(buf->string + buf->length, spare, format, args);
+
+	/* 領域不足の場合は拡張して再度書式化 */
+	if (spare <= len) {
+		if (growBuffer(buf, len) != 0) {
+			buf->string[buf->length] = '\0';
+			va_end(retryArgs);
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+		CmnString_VFormat(buf->string + buf->length, len + 1, format, retryArgs);
+	}
+	va_end(retryArgs);
+
+	buf->length += len;
+	buf->_buf->size = buf->length + 1;
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファへのデータ挿入
+ *
+ *  文字列バッファのindex文字目の位置にstrの先頭からlen文字を挿入する。
+ *
+ * @param buf 文字列バッファ
+ * @param index 挿入位置（先頭文字をゼロとした文字数）。文字数を超える場合は末尾に追加する。
+ * @param str 挿入する文字列。'\0'で終端している必要はない。
+ * @param len 挿入する文字数
+ * @return 正常:0, エラー:-1
+ */
+int CmnStringBuffer_Insert(CmnStringBuffer *buf, size_t index, const char *str, size_t len)
+{
+	CMNLOG_TRACE_START();
+
+	if (buf->length < index) {
+		index = buf->length;
+	}
+
+	/* strがbuf自身の一部の場合は領域拡張でアドレスが変わるため、事前に位置を保存しておく */
+	if (buf->string <= str && str < buf->string + buf->length) {
+		size_t srcPos = str - buf->string;
+		if (growBuffer(buf, len) != 0) {
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+		memmove(buf->string + index + len, buf->string + index, buf->length - index + 1);
+		/* 挿入位置より後ろにあった文字はlen文字分ずれている */
+		if (index <= srcPos) {
+			srcPos += len;
+			memmove(buf->string + index, buf->string + srcPos, len);
+		}
+		else {
+			size_t before = index - srcPos;
+			if (len <= before) {
+				memmove(buf->string + index, buf->string + srcPos, len);
+			}
+			else {
+				memmove(buf->string + index, buf->string + srcPos, before);
+				memmove(buf->string + index + before, buf->string + index + len, len - before);
+			}
+		}
+	}
+	else {
+		if (growBuffer(buf, len) != 0) {
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+		memmove(buf->string + index + len, buf->string + index, buf->length - index + 1);
+		memcpy(buf->string + index, str, len);
+	}
+
+	buf->length += len;
+	buf->_buf->size = buf->length + 1;
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファのデータ削除
+ *
+ *  文字列バッファのindex文字目からlen文字を削除し、後ろの文字列を詰める。
+ *
+ * @param buf 文字列バッファ
+ * @param index 削除開始位置（先頭文字をゼロとした文字数）。文字数を超える場合は何もしない。
+ * @param len 削除する文字数。末尾を超える場合は末尾まで削除する。
+ */
+void CmnStringBuffer_Erase(CmnStringBuffer *buf, size_t index, size_t len)
+{
+	CMNLOG_TRACE_START();
+
+	if (buf->length <= index) {
+		CMNLOG_TRACE_END();
+		return;
+	}
+	if (buf->length - index < len) {
+		len = buf->length - index;
+	}
+
+	memmove(buf->string + index, buf->string + index + len, buf->length - index - len + 1);
+	buf->length -= len;
+	buf->_buf->size = buf->length + 1;
+
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief 文字列バッファの領域予約
+ *
+ *  length文字（終端の'\0'を除く）を格納できるよう、あらかじめ領域を拡張する。<br>
+ *  追加する文字数が事前にわかっている場合に呼び出すと、追加時の領域拡張を1回にできる。
+ *
+ * @param buf 文字列バッファ
+ * @param length 予約する文字数
+ * @return 正常:0, エラー:-1
+ */
+int CmnStringBuffer_Reserve(CmnStringBuffer *buf, size_t length)
+{
+	CMNLOG_TRACE_START();
+
+	if (CmnDataBuffer_Reserve(buf->_buf, length + 1) != 0) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
 	buf->string = buf->_buf->data;
-	buf->length += strLen;
 
 	CMNLOG_TRACE_END();
 	return 0;
@@ -149,8 +359,38 @@ int CmnStringBuffer_SetByCmnDataBuffer(CmnStringBuffer *buf, const CmnDataBuffer
 void CmnStringBuffer_Free(CmnStringBuffer *buf)
 {
 	CMNLOG_TRACE_START();
-	free(buf->_buf);
+	CmnDataBuffer_Free(buf->_buf);
 	free(buf);
 	CMNLOG_TRACE_END();
 }
 
+/**
+ * @brief 文字列バッファの領域拡張
+ *
+ *  現在の文字列の末尾にaddLen文字（と終端の'\0'）を格納できるよう領域を拡張する。<br>
+ *  追加を繰り返しても拡張回数が増えすぎないよう、不足時は現在の領域の1.5倍以上に拡張する。
+ *
+ * @param buf 文字列バッファ
+ * @param addLen 追加する文字数
+ * @return 正常:0, エラー:-1
+ */
+static int growBuffer(CmnStringBuffer *buf, size_t addLen)
+{
+	size_t need = buf->length + addLen + 1;
+	size_t newSize;
+
+	if (need <= buf->_buf->bufSize) {
+		return 0;
+	}
+
+	newSize = buf->_buf->bufSize + (buf->_buf->bufSize / 2);
+	if (newSize < need) {
+		newSize = need;
+	}
+	if (CmnDataBuffer_Reserve(buf->_buf, newSize) != 0) {
+		return -1;
+	}
+	buf->string = buf->_buf->data;
+	return 0;
+}
+
@@ -0,0 +1,331 @@
+/** @file *********************************************************************
+ * @brief 大文字小文字を区別しない文字列操作 共通関数
+ *
+ *  ASCII文字の大文字小文字を区別しない比較・検索・ハッシュ値計算を行う共通関数。<br>
+ *  ロケールに依存せず、'A'～'Z'と'a'～'z'のみを同一視する（0x80以上のバイトはそのまま比較する）。<br>
+ *  SSE2が使用できる場合は16バイト単位で比較・検索する。
+ *  マップのキー比較など呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+/** ASCII大文字を小文字に変換 */
+#define FOLD(c)  ((unsigned char)((unsigned char)((c) - 'A') < 26 ? (c) | 0x20 : (c)))
+
+/** ハッシュ値計算時に1度に小文字化するバイト数 */
+#define HASH_CHUNK_SIZE 256
+
+static void foldCopy(unsigned char *dest, const unsigned char *src, size_t len);
+#ifdef CMN_CLIB_USE_SSE2
+static __m128i fold16(__m128i v);
+#endif
+
+/**
+ * @brief 大文字小文字を区別しない文字列比較
+ *
+ *  ASCII文字の大文字小文字を区別せずに2つの文字列を比較する（strcasecmpと同等、ロケール非依存）。
+ *
+ * @param s1 比較する文字列1
+ * @param s2 比較する文字列2
+ * @return s1 < s2:負の値, s1 == s2:0, s1 > s2:正の値（小文字に変換した値で比較する）
+ */
+int CmnString_CompareIgnoreCase(const char *s1, const char *s2)
+{
+	return CmnString_CompareIgnoreCaseN(s1, strlen(s1), s2, strlen(s2));
+}
+
+/**
+ * @brief 大文字小文字を区別しない文字列比較（長さ指定）
+ *
+ *  ASCII文字の大文字小文字を区別せずに2つの文字列を比較する。共通部分が一致する場合は短いほうを小さいとする。
+ *
+ * @param s1 比較する文字列1。'\0'で終端している必要はない。
+ * @param len1 s1のバイト数
+ * @param s2 比較する文字列2。'\0'で終端している必要はない。
+ * @param len2 s2のバイト数
+ * @return s1 < s2:負の値, s1 == s2:0, s1 > s2:正の値（小文字に変換した値で比較する）
+ */
+int CmnString_CompareIgnoreCaseN(const char *s1, size_t len1, const char *s2, size_t len2)
+{
+	const unsigned char *p1 = (const unsigned char *)s1;
+	const unsigned char *p2 = (const unsigned char *)s2;
+	size_t len = (len1 < len2) ? len1 : len2;
+	size_t i = 0;
+
+#ifdef CMN_CLIB_USE_SSE2
+	while (i + 16 <= len) {
+		__m128i v1 = fold16(_mm_loadu_si128((const __m128i *)(p1 + i)));
+		__m128i v2 = fold16(_mm_loadu_si128((const __m128i *)(p2 + i)));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2)) ^ 0xFFFF;
+		if (mask != 0) {
+			i += firstBit(mask);
+			return (int)FOLD(p1[i]) - (int)FOLD(p2[i]);
+		}
+		i += 16;
+	}
+#endif
+
+	for (; i < len; i++) {
+		int diff = (int)FOLD(p1[i]) - (int)FOLD(p2[i]);
+		if (diff != 0) {
+			return diff;
+		}
+	}
+
+	if (len1 == len2) {
+		return 0;
+	}
+	return (len1 < len2) ? -1 : 1;
+}
+
+/**
+ * @brief 大文字小文字を区別しない一致判定（長さ指定）
+ *
+ *  ASCII文字の大文字小文字を区別せずに、s1とs2の先頭lenバイトが一致するかを判定する。
+ *
+ * @param s1 比較する文字列1。'\0'で終端している必要はない。
+ * @param s2 比較する文字列2。'\0'で終端している必要はない。
+ * @param len 比較するバイト数
+ * @return 一致:True, 不一致:False
+ */
+int CmnString_EqualsIgnoreCaseN(const char *s1, const char *s2, size_t len)
+{
+	const unsigned char *p1 = (const unsigned char *)s1;
+	const unsigned char *p2 = (const unsigned char *)s2;
+	size_t i = 0;
+
+#ifdef CMN_CLIB_USE_SSE2
+	while (i + 16 <= len) {
+		__m128i v1 = fold16(_mm_loadu_si128((const __m128i *)(p1 + i)));
+		__m128i v2 = fold16(_mm_loadu_si128((const __m128i *)(p2 + i)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2)) != 0xFFFF) {
+			return False;
+		}
+		i += 16;
+	}
+#endif
+
+	for (; i < len; i++) {
+		if (FOLD(p1[i]) != FOLD(p2[i])) {
+			return False;
+		}
+	}
+	return True;
+}
+
+/**
+ * @brief 大文字小文字を区別しない前方一致
+ *
+ *  ASCII文字の大文字小文字を区別せずに、strがmarkで始まっているかチェックする。
+ *
+ * @param str 対象文字列
+ * @param mark チェックする文字列
+ * @return strがmarkで始まっている場合は1を、そうでない場合は0を返す。
+ */
+int CmnString_StartWithIgnoreCase(const char *str, const char *mark)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	const unsigned char *m = (const unsigned char *)mark;
+
+	/* strの終端（'\0'）はmarkの文字と一致しないため、strlenせずに1回の走査で判定できる */
+	for (; *m != '\0'; s++, m++) {
+		if (FOLD(*s) != FOLD(*m)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief 大文字小文字を区別しない後方一致
+ *
+ *  ASCII文字の大文字小文字を区別せずに、strがmarkで終わっているかチェックする。
+ *
+ * @param str 対象文字列
+ * @param mark チェックする文字列
+ * @return strがmarkで終わっている場合は1を、そうでない場合は0を返す。
+ */
+int CmnString_EndWithIgnoreCase(const char *str, const char *mark)
+{
+	size_t strLen = strlen(str);
+	size_t markLen = strlen(mark);
+
+	if (strLen < markLen) {
+		return 0;
+	}
+	return CmnString_EqualsIgnoreCaseN(str + strLen - markLen, mark, markLen) ? 1 : 0;
+}
+
+/**
+ * @brief 大文字小文字を区別しない検索
+ *
+ *  ASCII文字の大文字小文字を区別せずに、strのなかで最初に出現するmarkの位置を返す。
+ *
+ * @param str ベース文字列
+ * @param mark 検索する文字列
+ * @return 最初にmarkが出現した位置（先頭文字をゼロとした文字数）を返す。markが出現しなかった場合は-1を返す。
+ */
+int CmnString_IndexOfIgnoreCase(const char *str, const char *mark)
+{
+	const char *pos = CmnString_FindIgnoreCase(str, strlen(str), mark, strlen(mark));
+	if (pos == NULL) {
+		return -1;
+	}
+	return (int)(pos - str);
+}
+
+/**
+ * @brief 大文字小文字を区別しない検索（長さ指定）
+ *
+ *  ASCII文字の大文字小文字を区別せずに、strのなかで最初に出現するmarkを探す。<br>
+ *  SSE2が使用できる場合は、markの先頭文字と末尾文字が一致する位置を16箇所ずつまとめて探し、候補のみを比較する。
+ *
+ * @param str ベース文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param mark 検索する文字列。'\0'で終端している必要はない。
+ * @param markLen markのバイト数
+ * @return 最初にmarkが出現した位置へのポインタ。出現しなかった場合はNULL。markLenが0の場合はstr。
+ */
+const char* CmnString_FindIgnoreCase(const char *str, size_t len, const char *mark, size_t markLen)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	const unsigned char *m = (const unsigned char *)mark;
+	unsigned char first, last;
+	size_t i = 0;
+	size_t end;
+
+	if (markLen == 0) {
+		return str;
+	}
+	if (len < markLen) {
+		return NULL;
+	}
+	first = FOLD(m[0]);
+	last = FOLD(m[markLen - 1]);
+	end = len - markLen;	/* 候補位置の最大値 */
+
+#ifdef CMN_CLIB_USE_SSE2
+	{
+		__m128i vFirst = _mm_set1_epi8((char)first);
+		__m128i vLast = _mm_set1_epi8((char)last);
+
+		while (i + 16 <= end + 1) {
+			__m128i blockFirst = fold16(_mm_loadu_si128((const __m128i *)(s + i)));
+			__m128i blockLast = fold16(_mm_loadu_si128((const __m128i *)(s + i + markLen - 1)));
+			unsigned int mask = (unsigned int)_mm_movemask_epi8(
+					_mm_and_si128(_mm_cmpeq_epi8(blockFirst, vFirst), _mm_cmpeq_epi8(blockLast, vLast)));
+			while (mask != 0) {
+				int bit = firstBit(mask);
+				if (CmnString_EqualsIgnoreCaseN(str + i + bit + 1, mark + 1, markLen < 2 ? 0 : markLen - 2)) {
+					return str + i + bit;
+				}
+				mask &= mask - 1;
+			}
+			i += 16;
+		}
+	}
+#endif
+
+	for (; i <= end; i++) {
+		if (FOLD(s[i]) == first && FOLD(s[i + markLen - 1]) == last
+				&& CmnString_EqualsIgnoreCaseN(str + i + 1, mark + 1, markLen < 2 ? 0 : markLen - 2)) {
+			return str + i;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief 大文字小文字を区別しないハッシュ値計算
+ *
+ *  ASCII文字を小文字に変換した文字列のハッシュ値を計算する（シード0）。<br>
+ *  CmnString_CompareIgnoreCaseで一致する文字列は同じハッシュ値になる。
+ *
+ * @param str 文字列
+ * @return ハッシュ値
+ */
+unsigned long long CmnString_HashIgnoreCase(const char *str)
+{
+	return CmnString_HashIgnoreCaseN(str, strlen(str), 0);
+}
+
+/**
+ * @brief 大文字小文字を区別しないハッシュ値計算（長さ・シード指定）
+ *
+ *  ASCII文字を小文字に変換した文字列のハッシュ値を計算する。小文字に変換した文字列を
+ *  CmnData_HashSeedで計算した値と同じになる。変換は固定長の作業領域で少しずつ行うため、メモリ確保は行わない。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param seed シード
+ * @return ハッシュ値
+ */
+unsigned long long CmnString_HashIgnoreCaseN(const char *str, size_t len, unsigned long long seed)
+{
+	unsigned char chunk[HASH_CHUNK_SIZE];
+	const unsigned char *p = (const unsigned char *)str;
+	CmnDataHash state;
+
+	/* 短いキーは一括計算 */
+	if (len <= HASH_CHUNK_SIZE) {
+		foldCopy(chunk, p, len);
+		return CmnData_HashSeed(chunk, len, seed);
+	}
+
+	CmnDataHash_Init(&state, seed);
+	while (len > 0) {
+		size_t n = (len < HASH_CHUNK_SIZE) ? len : HASH_CHUNK_SIZE;
+		foldCopy(chunk, p, n);
+		CmnDataHash_Update(&state, chunk, n);
+		p += n;
+		len -= n;
+	}
+	return CmnDataHash_Final(&state);
+}
+
+/**
+ * @brief 小文字に変換して複写
+ *
+ *  srcのASCII大文字を小文字に変換してdestに複写する。
+ */
+static void foldCopy(unsigned char *dest, const unsigned char *src, size_t len)
+{
+	size_t i = 0;
+
+#ifdef CMN_CLIB_USE_SSE2
+	while (i + 16 <= len) {
+		_mm_storeu_si128((__m128i *)(dest + i), fold16(_mm_loadu_si128((const __m128i *)(src + i))));
+		i += 16;
+	}
+#endif
+
+	for (; i < len; i++) {
+		dest[i] = FOLD(src[i]);
+	}
+}
+
+#ifdef CMN_CLIB_USE_SSE2
+/**
+ * @brief 16バイトの小文字化
+ *
+ *  'A'～'Z'のバイトのみ0x20を立てる。0x80以上のバイトは符号付き比較で範囲外となるため変換しない。
+ */
+static __m128i fold16(__m128i v)
+{
+	__m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(v, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+}
+#endif
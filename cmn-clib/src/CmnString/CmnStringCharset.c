@@ -0,0 +1,562 @@
+/** @file *********************************************************************
+ * @brief 文字コード判定・変換 共通関数
+ *
+ *  UTF-8/Shift_JIS（CP932）の妥当性判定と相互変換を行う共通関数。<br>
+ *  iconv等の外部ライブラリを使用せず、変換テーブル（CmnStringCharsetTable.c）で変換する。<br>
+ *  入力の大半がASCII文字であることを想定し、ASCII文字の連続はSSE2（使用できない場合は8バイト単位）で
+ *  まとめて判定・複写する。判定系の関数は呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+/* 変換テーブル（CmnStringCharsetTable.c） */
+extern const unsigned short cmnStringCharset_SjisToUcs[60][189];
+extern const unsigned char cmnStringCharset_UcsToSjisIndex[256];
+extern const unsigned short cmnStringCharset_UcsToSjis[][256];
+
+/** Shift_JISの2バイト文字の第1バイトか */
+#define IS_SJIS_LEAD(c)   ((0x81 <= (c) && (c) <= 0x9F) || (0xE0 <= (c) && (c) <= 0xFC))
+/** Shift_JISの2バイト文字の第2バイトか */
+#define IS_SJIS_TRAIL(c)  (0x40 <= (c) && (c) <= 0xFC && (c) != 0x7F)
+/** Shift_JISの半角カナか */
+#define IS_SJIS_KANA(c)   (0xA1 <= (c) && (c) <= 0xDF)
+/** UTF-8の2バイト目以降か */
+#define IS_UTF8_CONT(c)   (((c) & 0xC0) == 0x80)
+
+static size_t asciiLength(const unsigned char *p, size_t len);
+static size_t utf8SequenceLength(const unsigned char *p, size_t len);
+static size_t sjisSequenceLength(const unsigned char *p, size_t len);
+static int reserveSpare(CmnStringBuffer *buf, size_t pos, size_t spare, size_t rest);
+static int appendToAscii(CmnStringBuffer *buf, const char *str, size_t len, CHARSET from);
+
+/**
+ * @brief 先頭のASCII文字数取得
+ *
+ *  文字列の先頭から連続するASCII文字（0x00～0x7F）のバイト数を返す。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 先頭から連続するASCII文字のバイト数。すべてASCII文字の場合はlen。
+ */
+size_t CmnString_AsciiLength(const char *str, size_t len)
+{
+	return asciiLength((const unsigned char *)str, len);
+}
+
+/**
+ * @brief ASCII文字列判定
+ *
+ *  文字列がASCII文字（0x00～0x7F）のみで構成されているかを判定する。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return ASCII文字のみ:True, それ以外:False
+ */
+int CmnString_IsAscii(const char *str, size_t len)
+{
+	return asciiLength((const unsigned char *)str, len) == len;
+}
+
+/**
+ * @brief UTF-8妥当性チェック
+ *
+ *  文字列の先頭から正しいUTF-8として解釈できるバイト数を返す。<br>
+ *  冗長表現（overlong）、サロゲート（U+D800～U+DFFF）、U+10FFFFを超える値、途中で切れた文字は不正とする。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 正しいUTF-8として解釈できるバイト数。すべて正しい場合はlen。
+ */
+size_t CmnString_Utf8ValidLength(const char *str, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	size_t i = 0;
+	size_t n;
+
+	while (i < len) {
+		if (p[i] < 0x80) {
+			i += asciiLength(p + i, len - i);
+			continue;
+		}
+		n = utf8SequenceLength(p + i, len - i);
+		if (n == 0) {
+			break;
+		}
+		i += n;
+	}
+	return i;
+}
+
+/**
+ * @brief UTF-8文字列判定
+ *
+ *  文字列全体が正しいUTF-8であるかを判定する。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 正しいUTF-8:True, それ以外:False
+ * @sa CmnString_Utf8ValidLength
+ */
+int CmnString_IsUtf8(const char *str, size_t len)
+{
+	return CmnString_Utf8ValidLength(str, len) == len;
+}
+
+/**
+ * @brief Shift_JIS文字列判定
+ *
+ *  文字列全体がShift_JIS（CP932）のバイト構成として正しいかを判定する。<br>
+ *  文字の割り当ての有無は判定しない（未定義の文字コードも正しいと判定する）。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 正しいShift_JIS:True, それ以外:False
+ */
+int CmnString_IsSjis(const char *str, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	size_t i = 0;
+	size_t n;
+
+	while (i < len) {
+		if (p[i] < 0x80) {
+			i += asciiLength(p + i, len - i);
+			continue;
+		}
+		n = sjisSequenceLength(p + i, len - i);
+		if (n == 0) {
+			return False;
+		}
+		i += n;
+	}
+	return True;
+}
+
+/**
+ * @brief 文字コード判定
+ *
+ *  文字列の文字コードを推定する。<br>
+ *  ASCII文字のみの場合はCHARSET_ASCII、正しいUTF-8の場合はCHARSET_UTF8、それ以外はCHARSET_SHIFT_JISと判定する。
+ *
+ * @param str 文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 推定した文字コード
+ */
+CHARSET CmnString_DetectCharset(const char *str, size_t len)
+{
+	size_t ascii;
+	CMNLOG_TRACE_START();
+
+	ascii = asciiLength((const unsigned char *)str, len);
+	if (ascii == len) {
+		CMNLOG_TRACE_END();
+		return CHARSET_ASCII;
+	}
+	if (CmnString_Utf8ValidLength(str + ascii, len - ascii) == len - ascii) {
+		CMNLOG_TRACE_END();
+		return CHARSET_UTF8;
+	}
+
+	CMNLOG_TRACE_END();
+	return CHARSET_SHIFT_JIS;
+}
+
+/**
+ * @brief Shift_JIS → UTF-8変換
+ *
+ *  Shift_JIS（CP932）の文字列をUTF-8に変換して文字列バッファの末尾に追加する。<br>
+ *  不正なバイトや変換できない文字はU+FFFD（CMN_STRING_REPLACEMENT_UTF8）に置き換える。
+ *
+ * @param buf 文字列バッファ
+ * @param str 変換するShift_JIS文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 正常:置き換えた文字数（0以上）, エラー:-1
+ */
+int CmnStringBuffer_AppendSjisToUtf8(CmnStringBuffer *buf, const char *str, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	size_t i = 0;
+	size_t pos = buf->length;
+	int replaced = 0;
+	CMNLOG_TRACE_START();
+
+	while (i < len) {
+		unsigned char c = p[i];
+		unsigned int ucs = 0;
+		unsigned char *out;
+
+		/* ASCII文字の連続はまとめて複写 */
+		if (c < 0x80) {
+			size_t n = asciiLength(p + i, len - i);
+			if (reserveSpare(buf, pos, n, len - i) != 0) {
+				goto ERROR;
+			}
+			memcpy(buf->string + pos, p + i, n);
+			pos += n;
+			i += n;
+			continue;
+		}
+
+		/* 1文字変換（UTF-8は最大3バイト） */
+		if (reserveSpare(buf, pos, 3, len - i) != 0) {
+			goto ERROR;
+		}
+		if (IS_SJIS_KANA(c)) {
+			ucs = 0xFF61 + (c - 0xA1);
+			i++;
+		}
+		else if (IS_SJIS_LEAD(c) && i + 1 < len && IS_SJIS_TRAIL(p[i + 1])) {
+			int lead = (c <= 0x9F) ? c - 0x81 : c - 0xE0 + 31;
+			ucs = cmnStringCharset_SjisToUcs[lead][p[i + 1] - 0x40];
+			i += 2;
+		}
+		else {
+			i++;
+		}
+
+		out = (unsigned char *)buf->string + pos;
+		if (ucs == 0) {
+			memcpy(out, CMN_STRING_REPLACEMENT_UTF8, 3);
+			pos += 3;
+			replaced++;
+		}
+		else if (ucs < 0x800) {
+			out[0] = (unsigned char)(0xC0 | (ucs >> 6));
+			out[1] = (unsigned char)(0x80 | (ucs & 0x3F));
+			pos += 2;
+		}
+		else {
+			out[0] = (unsigned char)(0xE0 | (ucs >> 12));
+			out[1] = (unsigned char)(0x80 | ((ucs >> 6) & 0x3F));
+			out[2] = (unsigned char)(0x80 | (ucs & 0x3F));
+			pos += 3;
+		}
+	}
+
+	buf->length = pos;
+	buf->string[pos] = '\0';
+	buf->_buf->size = pos + 1;
+
+	CMNLOG_TRACE_END();
+	return replaced;
+
+ERROR:
+	buf->string[buf->length] = '\0';
+	CMNLOG_TRACE_END();
+	return -1;
+}
+
+/**
+ * @brief UTF-8 → Shift_JIS変換
+ *
+ *  UTF-8の文字列をShift_JIS（CP932）に変換して文字列バッファの末尾に追加する。<br>
+ *  不正なバイトやShift_JISにない文字は'?'（CMN_STRING_REPLACEMENT_CHAR）に置き換える。
+ *
+ * @param buf 文字列バッファ
+ * @param str 変換するUTF-8文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 正常:置き換えた文字数（0以上）, エラー:-1
+ */
+int CmnStringBuffer_AppendUtf8ToSjis(CmnStringBuffer *buf, const char *str, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	size_t i = 0;
+	size_t pos = buf->length;
+	int replaced = 0;
+	unsigned char *out;
+	CMNLOG_TRACE_START();
+
+	/* Shift_JISはUTF-8よりバイト数が増えないため、1度の領域予約で済む */
+	if (CmnStringBuffer_Reserve(buf, buf->length + len) != 0) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	out = (unsigned char *)buf->string;
+
+	while (i < len) {
+		size_t n;
+		unsigned int ucs;
+		unsigned short sjis;
+
+		/* ASCII文字の連続はまとめて複写 */
+		if (p[i] < 0x80) {
+			n = asciiLength(p + i, len - i);
+			memcpy(out + pos, p + i, n);
+			pos += n;
+			i += n;
+			continue;
+		}
+
+		n = utf8SequenceLength(p + i, len - i);
+		sjis = 0;
+		if (n == 2) {
+			ucs = ((p[i] & 0x1F) << 6) | (p[i + 1] & 0x3F);
+			sjis = cmnStringCharset_UcsToSjis[cmnStringCharset_UcsToSjisIndex[ucs >> 8]][ucs & 0xFF];
+		}
+		else if (n == 3) {
+			ucs = ((p[i] & 0x0F) << 12) | ((p[i + 1] & 0x3F) << 6) | (p[i + 2] & 0x3F);
+			sjis = cmnStringCharset_UcsToSjis[cmnStringCharset_UcsToSjisIndex[ucs >> 8]][ucs & 0xFF];
+		}
+		i += (n == 0) ? 1 : n;
+
+		if (sjis == 0) {
+			out[pos++] = CMN_STRING_REPLACEMENT_CHAR;
+			replaced++;
+		}
+		else if (sjis < 0x100) {
+			out[pos++] = (unsigned char)sjis;
+		}
+		else {
+			out[pos++] = (unsigned char)(sjis >> 8);
+			out[pos++] = (unsigned char)(sjis & 0xFF);
+		}
+	}
+
+	buf->length = pos;
+	buf->string[pos] = '\0';
+	buf->_buf->size = pos + 1;
+
+	CMNLOG_TRACE_END();
+	return replaced;
+}
+
+/**
+ * @brief 文字コード変換
+ *
+ *  fromの文字コードの文字列をtoの文字コードに変換して文字列バッファの末尾に追加する。<br>
+ *  ASCIIはUTF-8/Shift_JISの部分集合として扱う。toがCHARSET_ASCIIの場合、ASCII以外の文字は1文字ずつ'?'に置き換える。
+ *
+ * @param buf 文字列バッファ
+ * @param str 変換する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param from strの文字コード
+ * @param to 変換後の文字コード
+ * @return 正常:置き換えた文字数（0以上）, エラー:-1
+ */
+int CmnStringBuffer_AppendConvert(CmnStringBuffer *buf, const char *str, size_t len, CHARSET from, CHARSET to)
+{
+	int ret;
+	CMNLOG_TRACE_START();
+
+	if (to == CHARSET_ASCII) {
+		ret = appendToAscii(buf, str, len, from);
+	}
+	else if (from == to || from == CHARSET_ASCII) {
+		ret = CmnStringBuffer_AppendN(buf, str, len);
+	}
+	else if (from == CHARSET_SHIFT_JIS) {
+		ret = CmnStringBuffer_AppendSjisToUtf8(buf, str, len);
+	}
+	else {
+		ret = CmnStringBuffer_AppendUtf8ToSjis(buf, str, len);
+	}
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 先頭のASCII文字数取得
+ *
+ *  SSE2が使用できる場合は64/16バイト単位、使用できない場合は8バイト単位で最上位ビットを判定する。
+ *
+ * @param p 文字列
+ * @param len pのバイト数
+ * @return 先頭から連続するASCII文字のバイト数
+ */
+static size_t asciiLength(const unsigned char *p, size_t len)
+{
+	size_t i = 0;
+
+#ifdef CMN_CLIB_USE_SSE2
+	int mask;
+
+	/* 64バイト単位で判定し、ASCII以外を含む場合は16バイト単位で位置を特定 */
+	while (i + 64 <= len) {
+		__m128i v0 = _mm_loadu_si128((const __m128i *)(p + i));
+		__m128i v1 = _mm_loadu_si128((const __m128i *)(p + i + 16));
+		__m128i v2 = _mm_loadu_si128((const __m128i *)(p + i + 32));
+		__m128i v3 = _mm_loadu_si128((const __m128i *)(p + i + 48));
+		if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3))) != 0) {
+			break;
+		}
+		i += 64;
+	}
+	while (i + 16 <= len) {
+		mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(p + i)));
+		if (mask != 0) {
+			return i + firstBit((unsigned int)mask);
+		}
+		i += 16;
+	}
+#else
+	/* 8バイト単位で判定 */
+	while (i + 8 <= len) {
+		unsigned long long v;
+		memcpy(&v, p + i, 8);
+		if ((v & 0x8080808080808080ULL) != 0) {
+			break;
+		}
+		i += 8;
+	}
+#endif
+
+	while (i < len && p[i] < 0x80) {
+		i++;
+	}
+	return i;
+}
+
+/**
+ * @brief UTF-8の1文字のバイト数取得
+ *
+ *  先頭バイトが0x80以上のUTF-8の1文字を検査し、バイト数を返す。
+ *
+ * @param p 文字の先頭
+ * @param len pから末尾までのバイト数（1以上）
+ * @return 正常:文字のバイト数（2～4）, 不正な文字:0
+ */
+static size_t utf8SequenceLength(const unsigned char *p, size_t len)
+{
+	unsigned char c = p[0];
+	unsigned char lo = 0x80;
+	unsigned char hi = 0xBF;
+
+	if (c < 0xC2) {
+		/* 2バイト目以降のバイト、または冗長表現 */
+		return 0;
+	}
+	if (c < 0xE0) {
+		return (2 <= len && IS_UTF8_CONT(p[1])) ? 2 : 0;
+	}
+	if (c < 0xF0) {
+		if (c == 0xE0) {
+			lo = 0xA0;		/* 冗長表現 */
+		}
+		else if (c == 0xED) {
+			hi = 0x9F;		/* サロゲート */
+		}
+		return (3 <= len && lo <= p[1] && p[1] <= hi && IS_UTF8_CONT(p[2])) ? 3 : 0;
+	}
+	if (c < 0xF5) {
+		if (c == 0xF0) {
+			lo = 0x90;		/* 冗長表現 */
+		}
+		else if (c == 0xF4) {
+			hi = 0x8F;		/* U+10FFFFを超える値 */
+		}
+		return (4 <= len && lo <= p[1] && p[1] <= hi && IS_UTF8_CONT(p[2]) && IS_UTF8_CONT(p[3])) ? 4 : 0;
+	}
+	return 0;
+}
+
+/**
+ * @brief Shift_JISの1文字のバイト数取得
+ *
+ *  先頭バイトが0x80以上のShift_JISの1文字を検査し、バイト数を返す。
+ *
+ * @param p 文字の先頭
+ * @param len pから末尾までのバイト数（1以上）
+ * @return 正常:文字のバイト数（1～2）, 不正な文字:0
+ */
+static size_t sjisSequenceLength(const unsigned char *p, size_t len)
+{
+	if (IS_SJIS_KANA(p[0])) {
+		return 1;
+	}
+	if (IS_SJIS_LEAD(p[0]) && 2 <= len && IS_SJIS_TRAIL(p[1])) {
+		return 2;
+	}
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファの空き領域確保
+ *
+ *  pos文字目からspare文字を書き込めるよう領域を拡張する。<br>
+ *  拡張する場合は、残りの入力restバイトの1.5倍（Shift_JIS 2バイト→UTF-8 3バイトの比率）を見込んで拡張し、
+ *  拡張回数を抑える。
+ *
+ * @param buf 文字列バッファ
+ * @param pos 書き込み位置
+ * @param spare 書き込むバイト数
+ * @param rest 残りの入力バイト数
+ * @return 正常:0, エラー:-1
+ */
+static int reserveSpare(CmnStringBuffer *buf, size_t pos, size_t spare, size_t rest)
+{
+	size_t need = pos + spare + 1;
+	size_t newSize;
+
+	if (need <= buf->_buf->bufSize) {
+		return 0;
+	}
+	newSize = pos + rest + rest / 2 + 3;
+	if (newSize < need) {
+		newSize = need;
+	}
+	if (newSize < buf->_buf->bufSize + buf->_buf->bufSize / 2) {
+		newSize = buf->_buf->bufSize + buf->_buf->bufSize / 2;
+	}
+	return CmnStringBuffer_Reserve(buf, newSize);
+}
+
+/**
+ * @brief ASCIIへの変換
+ *
+ *  ASCII文字はそのまま、それ以外の文字は1文字ずつ'?'に置き換えて文字列バッファの末尾に追加する。
+ *
+ * @param buf 文字列バッファ
+ * @param str 変換する文字列
+ * @param len strのバイト数
+ * @param from strの文字コード
+ * @return 正常:置き換えた文字数（0以上）, エラー:-1
+ */
+static int appendToAscii(CmnStringBuffer *buf, const char *str, size_t len, CHARSET from)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	size_t i = 0;
+	size_t pos = buf->length;
+	int replaced = 0;
+
+	/* 出力は入力よりバイト数が増えない */
+	if (CmnStringBuffer_Reserve(buf, buf->length + len) != 0) {
+		return -1;
+	}
+
+	while (i < len) {
+		size_t n;
+		if (p[i] < 0x80) {
+			n = asciiLength(p + i, len - i);
+			memcpy(buf->string + pos, p + i, n);
+			pos += n;
+		}
+		else {
+			n = (from == CHARSET_SHIFT_JIS) ? sjisSequenceLength(p + i, len - i) : utf8SequenceLength(p + i, len - i);
+			if (n == 0) {
+				n = 1;
+			}
+			buf->string[pos++] = CMN_STRING_REPLACEMENT_CHAR;
+			replaced++;
+		}
+		i += n;
+	}
+
+	buf->length = pos;
+	buf->string[pos] = '\0';
+	buf->_buf->size = pos + 1;
+	return replaced;
+}
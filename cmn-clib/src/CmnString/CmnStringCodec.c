@@ -0,0 +1,812 @@
+/** @file *********************************************************************
+ * @brief 文字列エンコード（16進数、Base64、パーセントエンコーディング） 共通関数
+ *
+ *  バイナリデータ、文字列を16進数文字列、Base64（RFC 4648）、パーセントエンコーディング（RFC 3986）に
+ *  変換する関数と、その逆変換を行う関数。<br>
+ *  変換結果は呼び出し側のバッファ（必要なサイズは各関数で求められる）またはCmnStringBufferに格納する。
+ *  大きなデータは、CmnStringBase64_*で任意の位置で区切って逐次変換できる
+ *  （16進数、パーセントエンコーディングへの変換は状態を持たないため、区切った単位でそのまま変換できる）。<br>
+ *  16進数の変換、パーセントエンコーディングの変換が必要な文字の検索は、SSE2が使用できる場合は16バイト単位で行う。
+ *  Base64は12bit単位の変換表で2文字ずつ変換し、逆変換は4文字を1回の検査で変換する。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+#include"cmnclib/CmnThread.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+/** Base64の逆変換表で不正な文字を表すビット */
+#define B64_INVALID 0x01000000U
+
+/** 16進数の文字（大文字） */
+static const char hexUpper[] = "0123456789ABCDEF";
+/** 16進数の文字（小文字） */
+static const char hexLower[] = "0123456789abcdef";
+/** Base64の文字（標準） */
+static const char b64Standard[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+/** Base64の文字（URL、ファイル名用） */
+static const char b64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/** Base64の変換表（12bitを2文字に変換する。[0]:標準、[1]:URL） */
+static char b64Enc12[2][4096][2];
+/** Base64の逆変換表（4文字それぞれの位置の値。不正な文字はB64_INVALID） */
+static unsigned int b64Dec[4][256];
+/** 16進数文字の値（不正な文字は0xFF） */
+static unsigned char hexValue[256];
+/** パーセントエンコーディングで変換しない文字（非予約文字） */
+static unsigned char unreserved[256];
+/** 変換表の初期化を一度だけ行うための制御オブジェクト */
+static CmnThreadOnce tableOnce = CMN_THREAD_ONCE_INIT;
+
+static void initTable(void);
+static char* encodeHex(const unsigned char *p, size_t len, const char *digits, char *out);
+static char* encodeBase64Blocks(const unsigned char *p, size_t blocks, int mode, char *out);
+static char* encodeBase64Tail(const unsigned char *p, size_t len, int mode, char *out);
+static int decodeBase64Blocks(const char *str, size_t blocks, unsigned char *out);
+static int decodeBase64Tail(const char *str, size_t len, unsigned char *out);
+static int decodeBase64Padding(CmnStringBase64 *state, const char *str, size_t len);
+static size_t scanUnreserved(const unsigned char *p, const unsigned char *end);
+static char* appendSpace(CmnStringBuffer *buf, size_t len);
+static void commitSpace(CmnStringBuffer *buf, char *end);
+
+/** 変換表を初期化していない場合は初期化する（複数スレッドから同時に呼ばれても初期化は一度だけ） */
+#define INIT_TABLE() CmnThread_Once(&tableOnce, initTable)
+
+/**
+ * @brief 16進数文字列への変換
+ *
+ *  データを1バイトにつき2文字の16進数文字列に変換する。
+ *
+ * @param data 変換するデータ
+ * @param len dataのバイト数
+ * @param upper True:英字を大文字にする、False:小文字にする
+ * @param buf 変換後の文字列を格納するバッファ。len * 2 + 1バイト以上の領域を有すること（'\0'で終端する）。
+ * @return 変換後の文字数（len * 2）
+ */
+size_t CmnString_HexEncode(const void *data, size_t len, int upper, char *buf)
+{
+	char *end = encodeHex(data, len, upper ? hexUpper : hexLower, buf);
+	*end = '\0';
+	return (size_t)(end - buf);
+}
+
+/**
+ * @brief 16進数文字列の逆変換
+ *
+ *  16進数文字列（英字の大文字小文字は問わない）をデータに変換する。
+ *
+ * @param str 16進数文字列。'\0'で終端している必要はない。
+ * @param len strの文字数（偶数）
+ * @param buf 変換後のデータを格納するバッファ。len / 2バイト以上の領域を有すること。
+ * @param outLen (O) 変換後のバイト数。NULLの場合は格納しない。
+ * @return 正常:0, 奇数の長さ、16進数以外の文字を含む:-1
+ */
+int CmnString_HexDecode(const char *str, size_t len, void *buf, size_t *outLen)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	const unsigned char *end = p + len;
+	unsigned char *out = buf;
+
+	INIT_TABLE();
+	if (len % 2 != 0) {
+		return -1;
+	}
+
+#ifdef CMN_CLIB_USE_SSE2
+	while (end - p >= 32) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i digit9 = _mm_set1_epi8(9);
+		const __m128i alpha5 = _mm_set1_epi8(5);
+		__m128i half[2];
+		int i, invalid = 0;
+
+		for (i = 0; i < 2; i++) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(p + i * 16));
+			/* '0'～'9'は'0'を引いた値が9以下、英字は小文字にして'a'を引いた値が5以下（いずれも符号なし） */
+			__m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+			__m128i a = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+			__m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(d, digit9), d);
+			__m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(a, alpha5), a);
+			__m128i nibble = _mm_or_si128(_mm_and_si128(isDigit, d),
+					_mm_and_si128(isAlpha, _mm_add_epi8(a, _mm_set1_epi8(10))));
+			invalid |= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(isDigit, isAlpha), zero));
+			/* 16bit単位で上位桁（下位バイト）と下位桁（上位バイト）を1バイトにまとめる */
+			half[i] = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibble, _mm_set1_epi16(0x00FF)), 4),
+					_mm_srli_epi16(nibble, 8));
+		}
+		if (invalid != 0) {
+			return -1;
+		}
+		_mm_storeu_si128((__m128i *)out, _mm_packus_epi16(half[0], half[1]));
+		p += 32;
+		out += 16;
+	}
+#endif
+	for (; p < end; p += 2) {
+		unsigned char hi = hexValue[p[0]];
+		unsigned char lo = hexValue[p[1]];
+		if (hi == 0xFF || lo == 0xFF) {
+			return -1;
+		}
+		*out++ = (unsigned char)((hi << 4) | lo);
+	}
+
+	if (outLen != NULL) {
+		*outLen = len / 2;
+	}
+	return 0;
+}
+
+/**
+ * @brief Base64に変換した場合の文字数
+ *
+ * @param len 変換するデータのバイト数
+ * @param mode CMN_STRING_BASE64_STANDARD（パディングあり）, CMN_STRING_BASE64_URL（パディングなし）
+ * @return 変換後の文字数（終端の'\0'を含まない）
+ */
+size_t CmnString_Base64EncodedSize(size_t len, int mode)
+{
+	if (mode == CMN_STRING_BASE64_URL) {
+		return len / 3 * 4 + ((len % 3 == 0) ? 0 : len % 3 + 1);
+	}
+	return (len + 2) / 3 * 4;
+}
+
+/**
+ * @brief Base64を逆変換した場合のバイト数
+ *
+ * @param str Base64文字列。'\0'で終端している必要はない。
+ * @param len strの文字数
+ * @return 逆変換後のバイト数（strが正しいBase64文字列の場合）
+ */
+size_t CmnString_Base64DecodedSize(const char *str, size_t len)
+{
+	size_t n = len;
+	if (n > 0 && str[n - 1] == '=') n--;
+	if (n > 0 && str[n - 1] == '=') n--;
+	return n / 4 * 3 + ((n % 4 <= 1) ? 0 : n % 4 - 1);
+}
+
+/**
+ * @brief Base64への変換
+ *
+ * @param data 変換するデータ
+ * @param len dataのバイト数
+ * @param mode CMN_STRING_BASE64_STANDARD（"+/"、'='でパディング）, CMN_STRING_BASE64_URL（"-_"、パディングなし）
+ * @param buf 変換後の文字列を格納するバッファ。CmnString_Base64EncodedSize + 1バイト以上の領域を有すること（'\0'で終端する）。
+ * @return 変換後の文字数
+ */
+size_t CmnString_Base64Encode(const void *data, size_t len, int mode, char *buf)
+{
+	const unsigned char *p = data;
+	char *out;
+
+	INIT_TABLE();
+	out = encodeBase64Blocks(p, len / 3, mode, buf);
+	out = encodeBase64Tail(p + len / 3 * 3, len % 3, mode, out);
+	*out = '\0';
+	return (size_t)(out - buf);
+}
+
+/**
+ * @brief Base64の逆変換
+ *
+ *  Base64文字列をデータに変換する。標準、URL用のどちらの文字も受け付け、末尾のパディング（'='）は省略できる。
+ *  改行、空白は受け付けない。
+ *
+ * @param str Base64文字列。'\0'で終端している必要はない。
+ * @param len strの文字数
+ * @param buf 変換後のデータを格納するバッファ。CmnString_Base64DecodedSizeバイト以上の領域を有すること。
+ * @param outLen (O) 変換後のバイト数。NULLの場合は格納しない。
+ * @return 正常:0, 不正な文字、長さ:-1
+ */
+int CmnString_Base64Decode(const char *str, size_t len, void *buf, size_t *outLen)
+{
+	unsigned char *out = buf;
+	size_t n = len;
+
+	INIT_TABLE();
+	if (n > 0 && str[n - 1] == '=') n--;
+	if (n > 0 && str[n - 1] == '=') n--;
+	/* パディングがある場合は4文字単位 */
+	if ((n != len && len % 4 != 0) || n % 4 == 1) {
+		return -1;
+	}
+
+	if (decodeBase64Blocks(str, n / 4, out) != 0 || decodeBase64Tail(str + n / 4 * 4, n % 4, out + n / 4 * 3) != 0) {
+		return -1;
+	}
+	if (outLen != NULL) {
+		*outLen = n / 4 * 3 + ((n % 4 == 0) ? 0 : n % 4 - 1);
+	}
+	return 0;
+}
+
+/**
+ * @brief パーセントエンコーディングした場合の文字数
+ *
+ * @param str 変換する文字列
+ * @param len strのバイト数
+ * @param mode CMN_STRING_PERCENT_URI, CMN_STRING_PERCENT_FORM
+ * @return 変換後の文字数（終端の'\0'を含まない）
+ */
+size_t CmnString_PercentEncodedSize(const char *str, size_t len, int mode)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	const unsigned char *end = p + len;
+	size_t size = len;
+
+	INIT_TABLE();
+	for (p += scanUnreserved(p, end); p < end; p += scanUnreserved(p, end)) {
+		if (!(mode == CMN_STRING_PERCENT_FORM && *p == ' ')) {
+			size += 2;
+		}
+		p++;
+	}
+	return size;
+}
+
+/**
+ * @brief パーセントエンコーディング
+ *
+ *  非予約文字（英数字と"-._~"）以外のバイトを"%XX"（16進数大文字）に変換する。
+ *  CMN_STRING_PERCENT_FORMの場合は空白を'+'に変換する。
+ *
+ * @param str 変換する文字列（UTF-8等、バイト単位で変換する）。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param mode CMN_STRING_PERCENT_URI, CMN_STRING_PERCENT_FORM
+ * @param buf 変換後の文字列を格納するバッファ。CmnString_PercentEncodedSize + 1バイト以上
+ *            （またはlen * 3 + 1バイト以上）の領域を有すること（'\0'で終端する）。
+ * @return 変換後の文字数
+ */
+size_t CmnString_PercentEncode(const char *str, size_t len, int mode, char *buf)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	const unsigned char *end = p + len;
+	char *out = buf;
+
+	INIT_TABLE();
+	for (;;) {
+		size_t run = scanUnreserved(p, end);
+		memcpy(out, p, run);
+		out += run;
+		p += run;
+		if (p == end) {
+			break;
+		}
+		if (mode == CMN_STRING_PERCENT_FORM && *p == ' ') {
+			*out++ = '+';
+		}
+		else {
+			*out++ = '%';
+			*out++ = hexUpper[*p >> 4];
+			*out++ = hexUpper[*p & 0x0F];
+		}
+		p++;
+	}
+	*out = '\0';
+	return (size_t)(out - buf);
+}
+
+/**
+ * @brief パーセントエンコーディングの逆変換
+ *
+ *  "%XX"（16進数の大文字小文字は問わない）を1バイトに変換する。
+ *  CMN_STRING_PERCENT_FORMの場合は'+'を空白に変換する。
+ *
+ * @param str 変換する文字列。'\0'で終端している必要はない。
+ * @param len strの文字数
+ * @param mode CMN_STRING_PERCENT_URI, CMN_STRING_PERCENT_FORM
+ * @param buf 変換後の文字列を格納するバッファ。lenバイト以上の領域を有すること（'\0'では終端しない）。
+ * @param outLen (O) 変換後のバイト数。NULLの場合は格納しない。
+ * @return 正常:0, 不正な"%"（16進数2桁が続かない）:-1
+ */
+int CmnString_PercentDecode(const char *str, size_t len, int mode, char *buf, size_t *outLen)
+{
+	const char *p = str;
+	const char *end = str + len;
+	char *out = buf;
+
+	INIT_TABLE();
+	while (p < end) {
+		const char *q = memchr(p, '%', (size_t)(end - p));
+		const char *runEnd = (q == NULL) ? end : q;
+		size_t run = (size_t)(runEnd - p);
+
+		memmove(out, p, run);
+		if (mode == CMN_STRING_PERCENT_FORM) {
+			char *s;
+			for (s = memchr(out, '+', run); s != NULL; s = memchr(s + 1, '+', run - (size_t)(s + 1 - out))) {
+				*s = ' ';
+			}
+		}
+		out += run;
+		if (q == NULL) {
+			break;
+		}
+		if (end - q < 3 || hexValue[(unsigned char)q[1]] == 0xFF || hexValue[(unsigned char)q[2]] == 0xFF) {
+			return -1;
+		}
+		*out++ = (char)((hexValue[(unsigned char)q[1]] << 4) | hexValue[(unsigned char)q[2]]);
+		p = q + 3;
+	}
+
+	if (outLen != NULL) {
+		*outLen = (size_t)(out - buf);
+	}
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファへの16進数文字列追加
+ *
+ * @param buf 文字列バッファ
+ * @param data 変換するデータ
+ * @param len dataのバイト数
+ * @param upper True:英字を大文字にする、False:小文字にする
+ * @return 正常:0, エラー:-1
+ * @sa CmnString_HexEncode
+ */
+int CmnStringBuffer_AppendHex(CmnStringBuffer *buf, const void *data, size_t len, int upper)
+{
+	char *out = appendSpace(buf, len * 2);
+	if (out == NULL) {
+		return -1;
+	}
+	commitSpace(buf, encodeHex(data, len, upper ? hexUpper : hexLower, out));
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファへのBase64文字列追加
+ *
+ * @param buf 文字列バッファ
+ * @param data 変換するデータ
+ * @param len dataのバイト数
+ * @param mode CMN_STRING_BASE64_STANDARD, CMN_STRING_BASE64_URL
+ * @return 正常:0, エラー:-1
+ * @sa CmnString_Base64Encode
+ */
+int CmnStringBuffer_AppendBase64(CmnStringBuffer *buf, const void *data, size_t len, int mode)
+{
+	char *out = appendSpace(buf, CmnString_Base64EncodedSize(len, mode));
+	if (out == NULL) {
+		return -1;
+	}
+	commitSpace(buf, out + CmnString_Base64Encode(data, len, mode, out));
+	return 0;
+}
+
+/**
+ * @brief 文字列バッファへのパーセントエンコーディング文字列追加
+ *
+ * @param buf 文字列バッファ
+ * @param str 変換する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param mode CMN_STRING_PERCENT_URI, CMN_STRING_PERCENT_FORM
+ * @return 正常:0, エラー:-1
+ * @sa CmnString_PercentEncode
+ */
+int CmnStringBuffer_AppendPercent(CmnStringBuffer *buf, const char *str, size_t len, int mode)
+{
+	char *out = appendSpace(buf, CmnString_PercentEncodedSize(str, len, mode));
+	if (out == NULL) {
+		return -1;
+	}
+	commitSpace(buf, out + CmnString_PercentEncode(str, len, mode, out));
+	return 0;
+}
+
+/**
+ * @brief Base64逐次変換の初期化
+ *
+ *  CmnStringBase64_Encode/CmnStringBase64_EncodeFinal、
+ *  またはCmnStringBase64_Decode/CmnStringBase64_DecodeFinalで逐次変換するための状態を初期化する。
+ *
+ * @param state 初期化する状態
+ * @param mode CMN_STRING_BASE64_STANDARD, CMN_STRING_BASE64_URL（逆変換の場合はどちらでもよい）
+ */
+void CmnStringBase64_Init(CmnStringBase64 *state, int mode)
+{
+	INIT_TABLE();
+	state->_mode = mode;
+	state->_restLen = 0;
+	state->_padLen = 0;
+}
+
+/**
+ * @brief Base64への逐次変換
+ *
+ *  データを任意の位置で区切って変換する。3バイトに満たない端数は状態に保持し、次の呼び出しで変換する。
+ *
+ * @param state 状態
+ * @param data 変換するデータ
+ * @param len dataのバイト数
+ * @param buf 変換後の文字列を格納するバッファ。(len + 2) / 3 * 4バイト以上の領域を有すること（'\0'では終端しない）。
+ * @return 変換後の文字数
+ */
+size_t CmnStringBase64_Encode(CmnStringBase64 *state, const void *data, size_t len, char *buf)
+{
+	const unsigned char *p = data;
+	char *out = buf;
+
+	/* 前回の端数 */
+	if (state->_restLen > 0) {
+		while (state->_restLen < 3 && len > 0) {
+			state->_rest[state->_restLen++] = *p++;
+			len--;
+		}
+		if (state->_restLen < 3) {
+			return 0;
+		}
+		out = encodeBase64Blocks(state->_rest, 1, state->_mode, out);
+		state->_restLen = 0;
+	}
+
+	out = encodeBase64Blocks(p, len / 3, state->_mode, out);
+	p += len / 3 * 3;
+	memcpy(state->_rest, p, len % 3);
+	state->_restLen = len % 3;
+	return (size_t)(out - buf);
+}
+
+/**
+ * @brief Base64への逐次変換の終了
+ *
+ *  保持している端数を変換し、必要に応じてパディングを付加する。
+ *
+ * @param state 状態
+ * @param buf 変換後の文字列を格納するバッファ。4バイト以上の領域を有すること（'\0'では終端しない）。
+ * @return 変換後の文字数
+ */
+size_t CmnStringBase64_EncodeFinal(CmnStringBase64 *state, char *buf)
+{
+	char *out = encodeBase64Tail(state->_rest, state->_restLen, state->_mode, buf);
+	state->_restLen = 0;
+	return (size_t)(out - buf);
+}
+
+/**
+ * @brief Base64の逐次逆変換
+ *
+ *  Base64文字列を任意の位置で区切って逆変換する。4文字に満たない端数は状態に保持し、次の呼び出しで変換する。
+ *
+ * @param state 状態
+ * @param str Base64文字列
+ * @param len strの文字数
+ * @param buf 変換後のデータを格納するバッファ。(len + 3) / 4 * 3バイト以上の領域を有すること。
+ * @param outLen (O) 変換後のバイト数
+ * @return 正常:0, 不正な文字、パディングの後にパディング以外の文字、3文字以上のパディング:-1
+ */
+int CmnStringBase64_Decode(CmnStringBase64 *state, const char *str, size_t len, void *buf, size_t *outLen)
+{
+	unsigned char *out = buf;
+	const char *pad;
+	size_t n;
+
+	*outLen = 0;
+	if (state->_padLen > 0) {
+		return decodeBase64Padding(state, str, len);
+	}
+	pad = memchr(str, '=', len);
+	n = (pad == NULL) ? len : (size_t)(pad - str);
+
+	/* 前回の端数 */
+	if (state->_restLen > 0) {
+		while (state->_restLen < 4 && n > 0) {
+			state->_rest[state->_restLen++] = (unsigned char)*str++;
+			n--;
+			len--;
+		}
+		if (state->_restLen == 4) {
+			if (decodeBase64Blocks((const char *)state->_rest, 1, out) != 0) {
+				return -1;
+			}
+			out += 3;
+			state->_restLen = 0;
+		}
+	}
+
+	if (decodeBase64Blocks(str, n / 4, out) != 0) {
+		return -1;
+	}
+	out += n / 4 * 3;
+	memcpy(state->_rest + state->_restLen, str + n / 4 * 4, n % 4);
+	state->_restLen += n % 4;
+	*outLen = (size_t)(out - (unsigned char *)buf);
+
+	if (pad != NULL) {
+		return decodeBase64Padding(state, pad, len - n);
+	}
+	return 0;
+}
+
+/**
+ * @brief Base64の逐次逆変換の終了
+ *
+ *  保持している端数を変換する。長さの確認はCmnString_Base64Decodeと同じ
+ *  （パディングがある場合はパディングを含めて4文字単位、端数が1文字の場合は不正）。
+ *
+ * @param state 状態
+ * @param buf 変換後のデータを格納するバッファ。2バイト以上の領域を有すること。
+ * @param outLen (O) 変換後のバイト数
+ * @return 正常:0, 不正な文字、長さ:-1
+ */
+int CmnStringBase64_DecodeFinal(CmnStringBase64 *state, void *buf, size_t *outLen)
+{
+	size_t restLen = state->_restLen;
+	size_t padLen = state->_padLen;
+
+	*outLen = 0;
+	state->_restLen = 0;
+	state->_padLen = 0;
+	if (restLen == 1 || (padLen > 0 && (restLen + padLen) % 4 != 0)
+			|| decodeBase64Tail((const char *)state->_rest, restLen, buf) != 0) {
+		return -1;
+	}
+	*outLen = (restLen == 0) ? 0 : restLen - 1;
+	return 0;
+}
+
+/** 変換表の初期化 */
+static void initTable(void)
+{
+	int i, j;
+
+	for (i = 0; i < 4096; i++) {
+		b64Enc12[0][i][0] = b64Standard[i >> 6];
+		b64Enc12[0][i][1] = b64Standard[i & 0x3F];
+		b64Enc12[1][i][0] = b64Url[i >> 6];
+		b64Enc12[1][i][1] = b64Url[i & 0x3F];
+	}
+
+	for (i = 0; i < 256; i++) {
+		for (j = 0; j < 4; j++) {
+			b64Dec[j][i] = B64_INVALID;
+		}
+		hexValue[i] = 0xFF;
+	}
+	for (i = 0; i < 64; i++) {
+		unsigned int v = (unsigned int)i;
+		for (j = 0; j < 4; j++) {
+			b64Dec[j][(unsigned char)b64Standard[i]] = v << (18 - j * 6);
+			b64Dec[j][(unsigned char)b64Url[i]] = v << (18 - j * 6);
+		}
+	}
+
+	for (i = 0; i < 16; i++) {
+		hexValue[(unsigned char)hexUpper[i]] = (unsigned char)i;
+		hexValue[(unsigned char)hexLower[i]] = (unsigned char)i;
+	}
+
+	for (i = 0; i < 256; i++) {
+		unreserved[i] = ('A' <= i && i <= 'Z') || ('a' <= i && i <= 'z') || ('0' <= i && i <= '9')
+				|| i == '-' || i == '.' || i == '_' || i == '~';
+	}
+}
+
+/**
+ * @brief 16進数文字列への変換
+ * @return 変換後の末尾の次の位置
+ */
+static char* encodeHex(const unsigned char *p, size_t len, const char *digits, char *out)
+{
+	const unsigned char *end = p + len;
+
+#ifdef CMN_CLIB_USE_SSE2
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i zeroChar = _mm_set1_epi8('0');
+	/* 10～15は'0'からの差分に加えて英字までの差分を足す */
+	const __m128i alphaDiff = _mm_set1_epi8((char)(digits[10] - '0' - 10));
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+		__m128i lo = _mm_and_si128(v, mask);
+		__m128i a = _mm_unpacklo_epi8(hi, lo);
+		__m128i b = _mm_unpackhi_epi8(hi, lo);
+		a = _mm_add_epi8(_mm_add_epi8(a, zeroChar), _mm_and_si128(_mm_cmpgt_epi8(a, nine), alphaDiff));
+		b = _mm_add_epi8(_mm_add_epi8(b, zeroChar), _mm_and_si128(_mm_cmpgt_epi8(b, nine), alphaDiff));
+		_mm_storeu_si128((__m128i *)out, a);
+		_mm_storeu_si128((__m128i *)(out + 16), b);
+		p += 16;
+		out += 32;
+	}
+#endif
+	for (; p < end; p++) {
+		*out++ = digits[*p >> 4];
+		*out++ = digits[*p & 0x0F];
+	}
+	return out;
+}
+
+/**
+ * @brief Base64への変換（3バイト単位）
+ * @param blocks 変換する3バイトの個数
+ * @return 変換後の末尾の次の位置
+ */
+static char* encodeBase64Blocks(const unsigned char *p, size_t blocks, int mode, char *out)
+{
+	char (*table)[2] = b64Enc12[mode == CMN_STRING_BASE64_URL];
+	size_t i;
+
+	for (i = 0; i < blocks; i++) {
+		unsigned int v = ((unsigned int)p[0] << 16) | ((unsigned int)p[1] << 8) | p[2];
+		memcpy(out, table[v >> 12], 2);
+		memcpy(out + 2, table[v & 0xFFF], 2);
+		p += 3;
+		out += 4;
+	}
+	return out;
+}
+
+/**
+ * @brief Base64への変換（3バイトに満たない末尾）
+ * @param len 末尾のバイト数（0～2）
+ * @return 変換後の末尾の次の位置
+ */
+static char* encodeBase64Tail(const unsigned char *p, size_t len, int mode, char *out)
+{
+	const char *digits = (mode == CMN_STRING_BASE64_URL) ? b64Url : b64Standard;
+	unsigned int v;
+
+	if (len == 0) {
+		return out;
+	}
+	v = ((unsigned int)p[0] << 16) | ((len == 2) ? (unsigned int)p[1] << 8 : 0);
+	*out++ = digits[v >> 18];
+	*out++ = digits[(v >> 12) & 0x3F];
+	if (len == 2) {
+		*out++ = digits[(v >> 6) & 0x3F];
+	}
+	if (mode != CMN_STRING_BASE64_URL) {
+		*out++ = '=';
+		if (len == 1) {
+			*out++ = '=';
+		}
+	}
+	return out;
+}
+
+/**
+ * @brief Base64の逆変換（4文字単位）
+ * @param blocks 変換する4文字の個数
+ * @return 正常:0, 不正な文字:-1
+ */
+static int decodeBase64Blocks(const char *str, size_t blocks, unsigned char *out)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	size_t i;
+
+	for (i = 0; i < blocks; i++) {
+		unsigned int v = b64Dec[0][p[0]] | b64Dec[1][p[1]] | b64Dec[2][p[2]] | b64Dec[3][p[3]];
+		if (v & B64_INVALID) {
+			return -1;
+		}
+		out[0] = (unsigned char)(v >> 16);
+		out[1] = (unsigned char)(v >> 8);
+		out[2] = (unsigned char)v;
+		p += 4;
+		out += 3;
+	}
+	return 0;
+}
+
+/**
+ * @brief Base64の逆変換（4文字に満たない末尾）
+ * @param len 末尾の文字数（0, 2, 3）
+ * @return 正常:0, 不正な文字:-1
+ */
+static int decodeBase64Tail(const char *str, size_t len, unsigned char *out)
+{
+	const unsigned char *p = (const unsigned char *)str;
+	unsigned int v;
+
+	if (len < 2) {
+		return (len == 0) ? 0 : -1;
+	}
+	v = b64Dec[0][p[0]] | b64Dec[1][p[1]] | ((len == 3) ? b64Dec[2][p[2]] : 0);
+	if (v & B64_INVALID) {
+		return -1;
+	}
+	out[0] = (unsigned char)(v >> 16);
+	if (len == 3) {
+		out[1] = (unsigned char)(v >> 8);
+	}
+	return 0;
+}
+
+/**
+ * @brief Base64の逐次逆変換でパディングを読み込む
+ * @param state 状態（読み込んだパディングの数を加える）
+ * @param str パディング以降の文字列
+ * @param len strの文字数
+ * @return 正常:0, パディング以外の文字、3文字以上のパディング:-1
+ */
+static int decodeBase64Padding(CmnStringBase64 *state, const char *str, size_t len)
+{
+	for (; len > 0; len--, str++) {
+		if (*str != '=' || ++state->_padLen > 2) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+#ifdef CMN_CLIB_USE_SSE2
+/** 各バイトがlo～hiの範囲内か（範囲内のバイトを0xFFにする） */
+static __m128i inRange(__m128i v, char lo, char hi)
+{
+	__m128i d = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+	return _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8((char)(hi - lo))), d);
+}
+#endif
+
+/**
+ * @brief 非予約文字が続くバイト数
+ * @return 先頭から続く非予約文字のバイト数
+ */
+static size_t scanUnreserved(const unsigned char *p, const unsigned char *end)
+{
+	const unsigned char *start = p;
+
+#ifdef CMN_CLIB_USE_SSE2
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		__m128i ok = _mm_or_si128(inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'), inRange(v, '0', '9'));
+		unsigned int mask;
+		ok = _mm_or_si128(ok, inRange(v, '-', '.'));
+		ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('~'))));
+		mask = ~(unsigned int)_mm_movemask_epi8(ok) & 0xFFFF;
+		if (mask != 0) {
+			return (size_t)(p - start) + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && unreserved[*p]) {
+		p++;
+	}
+	return (size_t)(p - start);
+}
+
+/**
+ * @brief 文字列バッファの末尾の領域確保
+ * @return 書き込み位置。メモリ不足の場合はNULL。
+ */
+static char* appendSpace(CmnStringBuffer *buf, size_t len)
+{
+	size_t need = buf->length + len + 1;
+
+	if (need > buf->_buf->bufSize) {
+		/* 追加を繰り返す場合に備えて倍々で拡張する */
+		size_t newSize = buf->_buf->bufSize * 2;
+		if (newSize < need) {
+			newSize = need;
+		}
+		if (CmnStringBuffer_Reserve(buf, newSize - 1) != 0) {
+			return NULL;
+		}
+	}
+	return buf->string + buf->length;
+}
+
+/** 文字列バッファの末尾への書き込みの確定 */
+static void commitSpace(CmnStringBuffer *buf, char *end)
+{
+	*end = '\0';
+	buf->length = (size_t)(end - buf->string);
+	buf->_buf->size = buf->length + 1;
+}
@@ -0,0 +1,524 @@
+/** @file *********************************************************************
+ * @brief CSV/TSV読み込み 共通関数
+ *
+ *  RFC 4180形式のCSV（区切り文字を'\\t'とすればTSV）を1行ずつ読み込む共通関数。<br>
+ *  メモリ上のデータ（ファイルをマップした領域等）、またはFILEから逐次読み込んだデータを、複写せずにその場で解析し、
+ *  各列をCmnStringView（データ内の位置と長さ）として返す。
+ *  複写が必要なのは、""（エスケープされた"）を含む列のみである。<br>
+ *  列の指定（CmnStringCsv_SetColumns）を行うと、指定した列のみを返し、それ以外の列は値を格納せずに読み飛ばす
+ *  （最後の指定列より後は、"を含まなければ改行まで一度に読み飛ばす）。
+ *  SSE2が使用できる場合は、区切り文字と改行の検索を16バイト単位で行う。
+ *  CmnStringCsv_Nextは呼び出し頻度が高いためトレースログは出力しない。
+ *
+ *  解析の規則は以下の通り。
+ *  - "で始まる列は、次の単独の"までを値とする（区切り文字、改行を含めることができる。""は"を表す）
+ *  - "で始まらない列は、次の区切り文字もしくは改行までを値とする（途中の"は文字として扱う）
+ *  - 改行はLFもしくはCRLF。空行は読み飛ばす。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+/** FILEから読み込む場合の初期バッファサイズ */
+#define CSV_READ_SIZE (64 * 1024)
+/** 列の初期数 */
+#define CSV_FIELD_INIT 16
+
+/** 行の解析結果 */
+typedef enum {
+	ROW_OK,			/**< 1行読み込んだ */
+	ROW_MORE,		/**< データが足りない（続きを読み込んで再解析する） */
+	ROW_ERROR		/**< 書式不正（"が閉じていない） */
+} RowResult;
+
+/** CSVリーダー */
+struct _tag_CmnStringCsv {
+	char delim;					/**< 区切り文字 */
+	FILE *fp;					/**< 読み込み元（メモリ上のデータの場合はNULL） */
+	char *readBuf;				/**< FILEから読み込んだデータ */
+	size_t readBufSize;
+	const char *data;			/**< 未解析のデータの先頭 */
+	const char *end;			/**< データの末尾 */
+	int eof;					/**< endがデータ全体の末尾か */
+	long long row;				/**< 読み込んだ行数（エラーメッセージ用） */
+
+	CmnStringView *fields;		/**< 列 */
+	size_t *copied;				/**< 列の値のscratch内の位置（複写していない場合は-1） */
+	int fieldCap;
+	CmnDataBuffer *scratch;		/**< ""を含む列の値 */
+
+	int *slots;					/**< 列番号 → fieldsの位置（-1は不要な列）。NULLは全列。 */
+	int slotCount;				/**< slotsの要素数 */
+	int columnCount;			/**< 指定した列の数 */
+};
+
+static CmnStringCsv* create(char delim);
+static RowResult parseRow(CmnStringCsv *csv, int *count);
+static int setField(CmnStringCsv *csv, int slot, const char *str, size_t len, size_t copied);
+static int fill(CmnStringCsv *csv);
+static const char* find2(const char *p, const char *end, char a, char b);
+
+/**
+ * @brief CSVリーダー生成（メモリ上のデータ）
+ *
+ *  メモリ上のデータを読み込むCSVリーダーを生成する。dataはCSVリーダーの解放まで保持すること。
+ *
+ * @param data CSVデータ。'\0'で終端している必要はない。
+ * @param len dataのバイト数
+ * @param delim 区切り文字（CSVの場合は','、TSVの場合は'\\t'）
+ * @return CSVリーダー。メモリ不足の場合はNULL。使用後はCmnStringCsv_Freeで解放すること。
+ */
+CmnStringCsv* CmnStringCsv_Create(const char *data, size_t len, char delim)
+{
+	CmnStringCsv *csv;
+	CMNLOG_TRACE_START();
+
+	csv = create(delim);
+	if (csv != NULL) {
+		csv->data = data;
+		csv->end = data + len;
+		csv->eof = True;
+	}
+
+	CMNLOG_TRACE_END();
+	return csv;
+}
+
+/**
+ * @brief CSVリーダー生成（FILE）
+ *
+ *  FILEから逐次読み込むCSVリーダーを生成する。ファイル全体をメモリに読み込むことはない。<br>
+ *  fpはCSVリーダーの解放後に呼び出し側で閉じること。
+ *
+ * @param fp 読み込み元（バイナリモードで開いたもの）
+ * @param delim 区切り文字（CSVの場合は','、TSVの場合は'\\t'）
+ * @return CSVリーダー。メモリ不足の場合はNULL。使用後はCmnStringCsv_Freeで解放すること。
+ */
+CmnStringCsv* CmnStringCsv_CreateFromFile(FILE *fp, char delim)
+{
+	CmnStringCsv *csv;
+	CMNLOG_TRACE_START();
+
+	csv = create(delim);
+	if (csv != NULL) {
+		csv->fp = fp;
+		csv->readBufSize = CSV_READ_SIZE;
+		csv->readBuf = malloc(csv->readBufSize);
+		if (csv->readBuf == NULL) {
+			CmnStringCsv_Free(csv);
+			csv = NULL;
+		}
+		else {
+			csv->data = csv->end = csv->readBuf;
+			csv->eof = False;
+		}
+	}
+
+	CMNLOG_TRACE_END();
+	return csv;
+}
+
+/**
+ * @brief 読み込む列の指定
+ *
+ *  CmnStringCsv_Nextで返す列を指定する。指定した順に返し、指定しなかった列は読み飛ばす。<br>
+ *  行の列数が足りない場合、その列は空文字列になる。
+ *
+ * @param csv CSVリーダー
+ * @param columns 列番号（先頭は0）の配列。NULLの場合は全列を返す（指定の解除）。
+ * @param count columnsの要素数
+ * @return 正常:0, エラー（列の数が0、列番号が負もしくは重複、メモリ不足）:-1
+ */
+int CmnStringCsv_SetColumns(CmnStringCsv *csv, const int *columns, int count)
+{
+	int *slots = NULL;
+	int slotCount = 0;
+	int i;
+	CMNLOG_TRACE_START();
+
+	if (columns != NULL) {
+		if (count <= 0) {
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+		for (i = 0; i < count; i++) {
+			if (columns[i] < 0) {
+				CMNLOG_TRACE_END();
+				return -1;
+			}
+			if (slotCount <= columns[i]) {
+				slotCount = columns[i] + 1;
+			}
+		}
+		slots = malloc(sizeof(int) * (slotCount > 0 ? slotCount : 1));
+		if (slots == NULL) {
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+		for (i = 0; i < slotCount; i++) {
+			slots[i] = -1;
+		}
+		for (i = 0; i < count; i++) {
+			if (slots[columns[i]] >= 0) {
+				free(slots);
+				CMNLOG_TRACE_END();
+				return -1;
+			}
+			slots[columns[i]] = i;
+		}
+		/* 全列を格納できる領域を確保しておく */
+		if (setField(csv, count - 1, "", 0, (size_t)-1) != 0) {
+			free(slots);
+			CMNLOG_TRACE_END();
+			return -1;
+		}
+	}
+
+	free(csv->slots);
+	csv->slots = slots;
+	csv->slotCount = slotCount;
+	csv->columnCount = count;
+
+	CMNLOG_TRACE_END();
+	return 0;
+}
+
+/**
+ * @brief 1行読み込み
+ *
+ *  次の1行を解析し、列の一覧を返す。<br>
+ *  列の値（CmnStringView）は、次にCmnStringCsv_NextもしくはCmnStringCsv_Freeを呼び出すまで有効。
+ *
+ * @param csv CSVリーダー
+ * @param fields (O) 列の一覧。CmnStringCsv_SetColumnsで列を指定した場合は、指定した順の列の一覧。
+ * @return 列の数（1以上）, 終端:0, エラー（"が閉じていない、読み込みエラー、メモリ不足）:-1
+ */
+int CmnStringCsv_Next(CmnStringCsv *csv, const CmnStringView **fields)
+{
+	int count;
+
+	while (True) {
+		/* 空行の読み飛ばし */
+		while (csv->data < csv->end && (*csv->data == '\n' || *csv->data == '\r')) {
+			csv->data++;
+		}
+		if (csv->data >= csv->end) {
+			if (csv->eof) {
+				return 0;
+			}
+		}
+		else {
+			switch (parseRow(csv, &count)) {
+			case ROW_OK:
+				csv->row++;
+				*fields = csv->fields;
+				return count;
+			case ROW_ERROR:
+				CMNLOG_WARN("csv parse error. unterminated quote, row=%lld", csv->row + 1);
+				return -1;
+			default:
+				break;
+			}
+		}
+		/* 続きのデータを読み込む */
+		if (fill(csv) != 0) {
+			return -1;
+		}
+	}
+}
+
+/**
+ * @brief CSVリーダーの解放
+ *
+ * @param csv CSVリーダー
+ */
+void CmnStringCsv_Free(CmnStringCsv *csv)
+{
+	CMNLOG_TRACE_START();
+	if (csv != NULL) {
+		free(csv->readBuf);
+		free(csv->fields);
+		free(csv->copied);
+		free(csv->slots);
+		if (csv->scratch != NULL) {
+			CmnDataBuffer_Free(csv->scratch);
+		}
+		free(csv);
+	}
+	CMNLOG_TRACE_END();
+}
+
+/** CSVリーダーの共通部分の生成 */
+static CmnStringCsv* create(char delim)
+{
+	CmnStringCsv *csv = calloc(1, sizeof(CmnStringCsv));
+	if (csv == NULL) {
+		return NULL;
+	}
+	csv->delim = delim;
+	csv->fieldCap = CSV_FIELD_INIT;
+	csv->fields = malloc(sizeof(CmnStringView) * csv->fieldCap);
+	csv->copied = malloc(sizeof(size_t) * csv->fieldCap);
+	csv->scratch = CmnDataBuffer_Create(256);
+	if (csv->fields == NULL || csv->copied == NULL || csv->scratch == NULL) {
+		CmnStringCsv_Free(csv);
+		return NULL;
+	}
+	return csv;
+}
+
+/**
+ * @brief 1行の解析
+ *
+ *  csv->dataから1行を解析し、成功した場合はcsv->dataを次の行の先頭に進める。
+ *
+ * @param csv CSVリーダー
+ * @param count (O) 列の数
+ * @return 解析結果
+ */
+static RowResult parseRow(CmnStringCsv *csv, int *count)
+{
+	const char *p = csv->data;
+	const char *end = csv->end;
+	const char delim = csv->delim;
+	int column = 0;
+	int n = 0;
+	int hasQuote = False;
+	int i;
+
+	csv->scratch->size = 0;
+	if (csv->slots != NULL) {
+		for (i = 0; i < csv->columnCount; i++) {
+			csv->fields[i].str = "";
+			csv->fields[i].len = 0;
+			csv->copied[i] = (size_t)-1;
+		}
+		n = csv->columnCount;
+	}
+
+	while (True) {
+		int slot = column;
+		if (csv->slots != NULL) {
+			if (csv->slotCount <= column && !hasQuote) {
+				/* 以降の列は不要。行末までに"がなければ改行まで一度に読み飛ばす */
+				const char *q = find2(p, end, '"', '\n');
+				if (q >= end && !csv->eof) {
+					return ROW_MORE;
+				}
+				if (q >= end || *q == '\n') {
+					p = q;
+					break;
+				}
+				hasQuote = True;
+			}
+			/* 不要な列は値を格納せずに読み飛ばす */
+			slot = (column < csv->slotCount) ? csv->slots[column] : -1;
+		}
+
+		if (p < end && *p == '"') {
+			/* "で囲まれた列 */
+			const char *seg = ++p;
+			size_t copied = (size_t)-1;
+			while (True) {
+				const char *q = memchr(p, '"', end - p);
+				if (q == NULL) {
+					return csv->eof ? ROW_ERROR : ROW_MORE;
+				}
+				if (q + 1 >= end && !csv->eof) {
+					/* 次の文字が"（エスケープ）かどうかわからない */
+					return ROW_MORE;
+				}
+				if (q + 1 < end && q[1] == '"') {
+					/* ""は"として複写する */
+					if (slot >= 0) {
+						if (copied == (size_t)-1) {
+							copied = csv->scratch->size;
+						}
+						if (CmnDataBuffer_Append(csv->scratch, seg, q + 1 - seg) != 0) {
+							return ROW_ERROR;
+						}
+					}
+					p = q + 2;
+					seg = p;
+					continue;
+				}
+				if (slot >= 0) {
+					if (copied != (size_t)-1) {
+						if (CmnDataBuffer_Append(csv->scratch, seg, q - seg) != 0) {
+							return ROW_ERROR;
+						}
+						if (setField(csv, slot, NULL, csv->scratch->size - copied, copied) != 0) {
+							return ROW_ERROR;
+						}
+					}
+					else if (setField(csv, slot, seg, q - seg, (size_t)-1) != 0) {
+						return ROW_ERROR;
+					}
+				}
+				p = q + 1;
+				break;
+			}
+			/* 閉じる"の後に文字がある場合は無視する */
+			p = find2(p, end, delim, '\n');
+			if (p >= end && !csv->eof) {
+				return ROW_MORE;
+			}
+		}
+		else {
+			const char *q = find2(p, end, delim, '\n');
+			if (q >= end && !csv->eof) {
+				return ROW_MORE;
+			}
+			if (slot >= 0) {
+				const char *e = q;
+				if ((q >= end || *q == '\n') && p < e && e[-1] == '\r') {
+					e--;
+				}
+				if (setField(csv, slot, p, e - p, (size_t)-1) != 0) {
+					return ROW_ERROR;
+				}
+			}
+			p = q;
+		}
+
+		column++;
+		if (csv->slots == NULL) {
+			n = column;
+		}
+		if (p >= end || *p == '\n') {
+			break;
+		}
+		p++;
+	}
+
+	/* 複写した列の位置を確定する（scratchは行の解析中に移動する場合がある） */
+	for (i = 0; i < n; i++) {
+		if (csv->copied[i] != (size_t)-1) {
+			csv->fields[i].str = (const char *)csv->scratch->data + csv->copied[i];
+		}
+	}
+
+	csv->data = (p < end) ? p + 1 : end;
+	*count = n;
+	return ROW_OK;
+}
+
+/**
+ * @brief 列の値の格納
+ *
+ *  列の領域が足りない場合は拡張する。
+ *
+ * @param csv CSVリーダー
+ * @param slot fieldsの位置
+ * @param str 値の先頭（copiedを指定した場合は使用しない）
+ * @param len 値のバイト数
+ * @param copied 値のscratch内の位置（複写していない場合は-1）
+ * @return 正常:0, エラー（メモリ不足）:-1
+ */
+static int setField(CmnStringCsv *csv, int slot, const char *str, size_t len, size_t copied)
+{
+	if (csv->fieldCap <= slot) {
+		int cap = csv->fieldCap;
+		CmnStringView *fields;
+		size_t *copiedList;
+		while (cap <= slot) {
+			cap *= 2;
+		}
+		fields = realloc(csv->fields, sizeof(CmnStringView) * cap);
+		if (fields == NULL) {
+			return -1;
+		}
+		csv->fields = fields;
+		copiedList = realloc(csv->copied, sizeof(size_t) * cap);
+		if (copiedList == NULL) {
+			return -1;
+		}
+		csv->copied = copiedList;
+		csv->fieldCap = cap;
+	}
+	csv->fields[slot].str = str;
+	csv->fields[slot].len = len;
+	csv->copied[slot] = copied;
+	return 0;
+}
+
+/**
+ * @brief FILEからの読み込み
+ *
+ *  未解析のデータをバッファの先頭に移動し、空いた領域に続きを読み込む。
+ *  未解析のデータでバッファが埋まっている場合（1行がバッファより長い場合）はバッファを拡張する。
+ *
+ * @return 正常:0, エラー（読み込みエラー、メモリ不足）:-1
+ */
+static int fill(CmnStringCsv *csv)
+{
+	size_t remain = csv->end - csv->data;
+	size_t readSize;
+
+	if (csv->fp == NULL) {
+		/* メモリ上のデータは常に全体が揃っている */
+		return -1;
+	}
+
+	if (csv->data != csv->readBuf) {
+		memmove(csv->readBuf, csv->data, remain);
+	}
+	if (remain == csv->readBufSize) {
+		char *buf = realloc(csv->readBuf, csv->readBufSize * 2);
+		if (buf == NULL) {
+			return -1;
+		}
+		csv->readBuf = buf;
+		csv->readBufSize *= 2;
+	}
+
+	readSize = fread(csv->readBuf + remain, 1, csv->readBufSize - remain, csv->fp);
+	if (readSize == 0) {
+		if (ferror(csv->fp)) {
+			CMNLOG_WARN("csv read error. row=%lld", csv->row + 1);
+			return -1;
+		}
+		csv->eof = True;
+	}
+	csv->data = csv->readBuf;
+	csv->end = csv->readBuf + remain + readSize;
+	return 0;
+}
+
+/**
+ * @brief 2種類の文字の検索
+ * @return 最初に出現したaもしくはbの位置。出現しない場合はend。
+ */
+static const char* find2(const char *p, const char *end, char a, char b)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	const __m128i va = _mm_set1_epi8(a);
+	const __m128i vb = _mm_set1_epi8(b);
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+		if (mask != 0) {
+			return p + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	for (; p < end; p++) {
+		if (*p == a || *p == b) {
+			break;
+		}
+	}
+	return p;
+}
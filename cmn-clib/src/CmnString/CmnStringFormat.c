@@ -0,0 +1,752 @@
+/** @file *********************************************************************
+ * @brief 書式化 共通関数
+ *
+ *  printf形式の書式化を行う共通関数。書式を1回走査しながら呼び出し側のバッファに直接書き込む。<br>
+ *  整数（%d %i %u %x %X %o）、文字列（%s）、文字（%c）、ポインタ（%p）はフラグ、幅、精度を含めて独自に変換し、
+ *  浮動小数点数（%f %e %g %a）のみ1項目ずつsnprintfに委ねる。<br>
+ *  同じ書式を繰り返し使用する場合（ログメッセージ等）は、CmnStringFormat_Compileで事前に解析しておくと
+ *  書式化のたびに書式を解析し直す必要がなくなる。<br>
+ *  %nは安全のため値を書き込まない（引数は読み飛ばす）。解釈できない変換指定はそのまま出力する。<br>
+ *  ログ出力処理から使用するため、CmnStringFormat_Compile以外はトレースログを出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdarg.h>
+#include<stdint.h>
+#include<limits.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+
+/* フラグ */
+#define FLAG_MINUS 0x01		/**< '-'：左寄せ */
+#define FLAG_PLUS  0x02		/**< '+'：正の数に'+'を付ける */
+#define FLAG_SPACE 0x04		/**< ' '：正の数に' 'を付ける */
+#define FLAG_ZERO  0x08		/**< '0'：幅を'0'で埋める */
+#define FLAG_HASH  0x10		/**< '#'：代替形式 */
+
+/** 幅、精度の指定なし */
+#define NOT_SPECIFIED (-1)
+/** 幅、精度を引数で指定（'*'） */
+#define FROM_ARGUMENT (-2)
+
+/** 長さ修飾子 */
+typedef enum {
+	LENGTH_NONE,		/**< なし（int, double） */
+	LENGTH_CHAR,		/**< hh */
+	LENGTH_SHORT,		/**< h */
+	LENGTH_LONG,		/**< l */
+	LENGTH_LLONG,		/**< ll（MSVCのI64を含む） */
+	LENGTH_SIZE,		/**< z（MSVCのIを含む） */
+	LENGTH_INTMAX,		/**< j */
+	LENGTH_PTRDIFF,		/**< t */
+	LENGTH_LDOUBLE		/**< L */
+} FormatLength;
+
+/** 変換指定 */
+typedef struct {
+	char conv;				/**< 変換指定子（0の場合は文字列のみ） */
+	unsigned char flags;	/**< フラグ */
+	unsigned char length;	/**< 長さ修飾子（FormatLength） */
+	int width;				/**< 最小幅 */
+	int precision;			/**< 精度 */
+} FormatSpec;
+
+/** 事前解析した書式の要素（文字列と、それに続く変換指定） */
+typedef struct {
+	const char *text;		/**< 文字列 */
+	size_t textLen;			/**< 文字列のバイト数 */
+	FormatSpec spec;		/**< 変換指定 */
+} FormatOp;
+
+/** 事前解析済みの書式 */
+struct _tag_CmnStringFormat {
+	size_t count;			/**< 要素数 */
+	FormatOp *ops;			/**< 要素 */
+	char *format;			/**< 書式のコピー（要素の文字列が指す） */
+};
+
+/** 書き込み先 */
+typedef struct {
+	char *buf;				/**< バッファ */
+	size_t limit;			/**< 書き込める最大文字数（'\0'を除く） */
+	size_t pos;				/**< 書き込み位置（バッファに収まらなかった文字数を含む） */
+} Output;
+
+/** va_listを関数間で受け渡すための構造体（va_listが配列型の環境でもアドレスを渡せるようにする） */
+typedef struct {
+	va_list ap;
+} Arguments;
+
+static const char *parseSpec(const char *p, FormatSpec *spec);
+static void formatSpec(Output *out, const FormatSpec *spec, Arguments *args);
+static void formatInteger(Output *out, const FormatSpec *spec, int flags, int width, int precision, Arguments *args);
+static void formatFloat(Output *out, const FormatSpec *spec, int flags, int width, int precision, Arguments *args);
+static void formatPadded(Output *out, const char *str, size_t len, int width, int flags);
+static void put(Output *out, const char *str, size_t len);
+static void putChars(Output *out, char ch, size_t count);
+static void terminate(Output *out, size_t size);
+
+/**
+ * @brief 書式化
+ *
+ *  printf形式で書式化した文字列をbufに格納する。snprintfと同様に、
+ *  bufに収まらない場合は収まる分だけ格納し、必ず'\0'で終端する。
+ *
+ * @param buf 格納先
+ * @param size bufのサイズ（'\0'を含む）。0の場合は何も格納せず、必要な文字数だけを返す。
+ * @param format 書式（printf形式）
+ * @param ... 書式に対応する値
+ * @return 書式化後の文字数（'\0'を含まない）。戻り値がsize以上の場合は切り詰められている。
+ */
+size_t CmnString_Format(char *buf, size_t size, const char *format, ...)
+{
+	size_t len;
+	va_list args;
+
+	va_start(args, format);
+	len = CmnString_VFormat(buf, size, format, args);
+	va_end(args);
+
+	return len;
+}
+
+/**
+ * @brief 書式化（va_list版）
+ *
+ *  vsnprintfと同様に、printf形式で書式化した文字列をbufに格納する。
+ *
+ * @param buf 格納先
+ * @param size bufのサイズ（'\0'を含む）。0の場合は何も格納せず、必要な文字数だけを返す。
+ * @param format 書式（printf形式）
+ * @param args 書式に対応する値
+ * @return 書式化後の文字数（'\0'を含まない）。戻り値がsize以上の場合は切り詰められている。
+ */
+size_t CmnString_VFormat(char *buf, size_t size, const char *format, va_list args)
+{
+	Output out;
+	Arguments a;
+	FormatSpec spec;
+	const char *p = format;
+	const char *q;
+	const char *next;
+
+	out.buf = buf;
+	out.limit = (size > 0) ? size - 1 : 0;
+	out.pos = 0;
+	va_copy(a.ap, args);
+
+	while ((q = strchr(p, '%')) != NULL) {
+		put(&out, p, q - p);
+		next = parseSpec(q + 1, &spec);
+		if (next == NULL) {
+			/* 解釈できない変換指定は'%'を文字として出力し、続きを文字列として扱う */
+			put(&out, q, 1);
+			p = q + 1;
+			continue;
+		}
+		formatSpec(&out, &spec, &a);
+		p = next;
+	}
+	put(&out, p, strlen(p));
+
+	va_end(a.ap);
+	terminate(&out, size);
+	return out.pos;
+}
+
+/**
+ * @brief 書式の事前解析
+ *
+ *  書式を解析し、CmnStringFormat_Formatで繰り返し使用できる形式に変換する。<br>
+ *  書式はコピーして保持するため、呼び出し後に解放してもよい。<br>
+ *  使用後はCmnStringFormat_Freeで解放すること。
+ *
+ * @param format 書式（printf形式）
+ * @return 事前解析済みの書式。メモリ不足の場合はNULL。
+ */
+CmnStringFormat* CmnStringFormat_Compile(const char *format)
+{
+	CmnStringFormat *fmt;
+	FormatOp *op;
+	FormatSpec spec;
+	size_t len = strlen(format);
+	size_t maxCount = 1;
+	const char *p;
+	const char *q;
+	const char *next;
+	CMNLOG_TRACE_START();
+
+	/* 要素数の上限（'%'の数+1）で、構造体、要素、書式のコピーを一括確保 */
+	for (p = format; (p = strchr(p, '%')) != NULL; p++) {
+		maxCount++;
+	}
+	fmt = malloc(sizeof(CmnStringFormat) + sizeof(FormatOp) * maxCount + len + 1);
+	if (fmt == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	fmt->ops = (FormatOp *)(fmt + 1);
+	fmt->format = (char *)(fmt->ops + maxCount);
+	memcpy(fmt->format, format, len + 1);
+	fmt->count = 0;
+
+	op = fmt->ops;
+	op->text = fmt->format;
+	p = fmt->format;
+	while ((q = strchr(p, '%')) != NULL) {
+		next = parseSpec(q + 1, &spec);
+		if (next == NULL) {
+			/* 解釈できない変換指定は文字列の一部とする */
+			p = q + 1;
+			continue;
+		}
+		if (spec.conv == '%') {
+			/* "%%"は直前の文字列に'%'を含めて終端し、次の文字列を"%%"の直後から始める */
+			op->textLen = q + 1 - op->text;
+			op->spec.conv = 0;
+		}
+		else {
+			op->textLen = q - op->text;
+			op->spec = spec;
+		}
+		op++;
+		op->text = next;
+		p = next;
+	}
+	op->textLen = strlen(op->text);
+	op->spec.conv = 0;
+	fmt->count = op - fmt->ops + 1;
+
+	CMNLOG_TRACE_END();
+	return fmt;
+}
+
+/**
+ * @brief 事前解析済みの書式による書式化
+ *
+ * @param fmt 事前解析済みの書式
+ * @param buf 格納先
+ * @param size bufのサイズ（'\0'を含む）。0の場合は何も格納せず、必要な文字数だけを返す。
+ * @param ... 書式に対応する値
+ * @return 書式化後の文字数（'\0'を含まない）。戻り値がsize以上の場合は切り詰められている。
+ */
+size_t CmnStringFormat_Format(const CmnStringFormat *fmt, char *buf, size_t size, ...)
+{
+	size_t len;
+	va_list args;
+
+	va_start(args, size);
+	len = CmnStringFormat_VFormat(fmt, buf, size, args);
+	va_end(args);
+
+	return len;
+}
+
+/**
+ * @brief 事前解析済みの書式による書式化（va_list版）
+ *
+ * @param fmt 事前解析済みの書式
+ * @param buf 格納先
+ * @param size bufのサイズ（'\0'を含む）。0の場合は何も格納せず、必要な文字数だけを返す。
+ * @param args 書式に対応する値
+ * @return 書式化後の文字数（'\0'を含まない）。戻り値がsize以上の場合は切り詰められている。
+ */
+size_t CmnStringFormat_VFormat(const CmnStringFormat *fmt, char *buf, size_t size, va_list args)
+{
+	Output out;
+	Arguments a;
+	const FormatOp *op;
+	const FormatOp *end = fmt->ops + fmt->count;
+
+	out.buf = buf;
+	out.limit = (size > 0) ? size - 1 : 0;
+	out.pos = 0;
+	va_copy(a.ap, args);
+
+	for (op = fmt->ops; op < end; op++) {
+		put(&out, op->text, op->textLen);
+		if (op->spec.conv != 0) {
+			formatSpec(&out, &op->spec, &a);
+		}
+	}
+
+	va_end(a.ap);
+	terminate(&out, size);
+	return out.pos;
+}
+
+/**
+ * @brief 事前解析済みの書式の解放
+ *
+ * @param fmt 事前解析済みの書式（NULLの場合は何もしない）
+ */
+void CmnStringFormat_Free(CmnStringFormat *fmt)
+{
+	free(fmt);
+}
+
+/**
+ * @brief 変換指定の解析
+ *
+ *  "%"の直後から、フラグ、幅、精度、長さ修飾子、変換指定子を解析する。
+ *
+ * @param p '%'の次の文字
+ * @param spec 解析結果
+ * @return 変換指定の次の文字。解釈できない変換指定の場合はNULL。
+ */
+static const char *parseSpec(const char *p, FormatSpec *spec)
+{
+	spec->flags = 0;
+	spec->length = LENGTH_NONE;
+	spec->width = NOT_SPECIFIED;
+	spec->precision = NOT_SPECIFIED;
+
+	/* フラグ */
+	for (;; p++) {
+		switch (*p) {
+		case '-': spec->flags |= FLAG_MINUS; continue;
+		case '+': spec->flags |= FLAG_PLUS; continue;
+		case ' ': spec->flags |= FLAG_SPACE; continue;
+		case '0': spec->flags |= FLAG_ZERO; continue;
+		case '#': spec->flags |= FLAG_HASH; continue;
+		}
+		break;
+	}
+
+	/* 幅 */
+	if (*p == '*') {
+		spec->width = FROM_ARGUMENT;
+		p++;
+	}
+	else if ('0' <= *p && *p <= '9') {
+		spec->width = 0;
+		for (; '0' <= *p && *p <= '9'; p++) {
+			spec->width = spec->width * 10 + (*p - '0');
+		}
+	}
+
+	/* 精度（'.'のみの場合は0） */
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->precision = FROM_ARGUMENT;
+			p++;
+		}
+		else {
+			spec->precision = 0;
+			for (; '0' <= *p && *p <= '9'; p++) {
+				spec->precision = spec->precision * 10 + (*p - '0');
+			}
+		}
+	}
+
+	/* 長さ修飾子 */
+	switch (*p) {
+	case 'h':
+		if (p[1] == 'h') {
+			spec->length = LENGTH_CHAR;
+			p += 2;
+		}
+		else {
+			spec->length = LENGTH_SHORT;
+			p++;
+		}
+		break;
+	case 'l':
+		if (p[1] == 'l') {
+			spec->length = LENGTH_LLONG;
+			p += 2;
+		}
+		else {
+			spec->length = LENGTH_LONG;
+			p++;
+		}
+		break;
+	case 'z': spec->length = LENGTH_SIZE; p++; break;
+	case 'j': spec->length = LENGTH_INTMAX; p++; break;
+	case 't': spec->length = LENGTH_PTRDIFF; p++; break;
+	case 'L': spec->length = LENGTH_LDOUBLE; p++; break;
+	case 'I':
+		/* MSVCの長さ修飾子（I64、I32、I） */
+		if (p[1] == '6' && p[2] == '4') {
+			spec->length = LENGTH_LLONG;
+			p += 3;
+		}
+		else if (p[1] == '3' && p[2] == '2') {
+			p += 3;
+		}
+		else {
+			spec->length = LENGTH_SIZE;
+			p++;
+		}
+		break;
+	}
+
+	/* 変換指定子 */
+	switch (*p) {
+	case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+	case 's': case 'c': case 'p': case 'n': case '%':
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		spec->conv = *p;
+		return p + 1;
+	}
+	return NULL;
+}
+
+/**
+ * @brief 変換指定1つ分の書式化
+ *
+ * @param out 書き込み先
+ * @param spec 変換指定
+ * @param args 値
+ */
+static void formatSpec(Output *out, const FormatSpec *spec, Arguments *args)
+{
+	int width = spec->width;
+	int precision = spec->precision;
+	int flags = spec->flags;
+	const char *str;
+	size_t len;
+	char ch;
+
+	/* 引数で指定された幅、精度（負の幅は左寄せ、負の精度は指定なし） */
+	if (width == FROM_ARGUMENT) {
+		width = va_arg(args->ap, int);
+		if (width < 0) {
+			flags |= FLAG_MINUS;
+			width = (width == INT_MIN) ? 0 : -width;
+		}
+	}
+	if (precision == FROM_ARGUMENT) {
+		precision = va_arg(args->ap, int);
+		if (precision < 0) {
+			precision = NOT_SPECIFIED;
+		}
+	}
+
+	switch (spec->conv) {
+	case 's':
+		str = va_arg(args->ap, const char *);
+		if (str == NULL) {
+			str = "(null)";
+		}
+		if (precision < 0) {
+			len = strlen(str);
+		}
+		else {
+			const char *nul = memchr(str, '\0', precision);
+			len = (nul != NULL) ? (size_t)(nul - str) : (size_t)precision;
+		}
+		if (width <= 0) {
+			put(out, str, len);
+		}
+		else {
+			formatPadded(out, str, len, width, flags);
+		}
+		break;
+	case 'c':
+		ch = (char)va_arg(args->ap, int);
+		formatPadded(out, &ch, 1, width, flags);
+		break;
+	case '%':
+		put(out, "%", 1);
+		break;
+	case 'n':
+		/* 書き込みは行わない */
+		(void)va_arg(args->ap, void *);
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		formatFloat(out, spec, flags, width, precision, args);
+		break;
+	default:
+		formatInteger(out, spec, flags, width, precision, args);
+		break;
+	}
+}
+
+/**
+ * @brief 整数、ポインタの書式化
+ *
+ * @param out 書き込み先
+ * @param spec 変換指定
+ * @param flags フラグ（幅を引数で指定した場合の左寄せを含む）
+ * @param width 最小幅（指定なしの場合は負数）
+ * @param precision 精度（指定なしの場合は負数）
+ * @param args 値
+ */
+static void formatInteger(Output *out, const FormatSpec *spec, int flags, int width, int precision, Arguments *args)
+{
+	static const char lowerDigits[] = "0123456789abcdef";
+	static const char upperDigits[] = "0123456789ABCDEF";
+	char digitBuf[32];
+	char *digits = digitBuf + sizeof(digitBuf);
+	size_t digitLen;
+	char prefix[2];
+	size_t prefixLen = 0;
+	size_t zeros = 0;
+	size_t total;
+	unsigned long long value;
+	int negative = False;
+	char conv = spec->conv;
+
+	/* 値の取得（符号付きは絶対値と符号に分ける） */
+	if (conv == 'd' || conv == 'i') {
+		long long v;
+		switch (spec->length) {
+		case LENGTH_CHAR: v = (signed char)va_arg(args->ap, int); break;
+		case LENGTH_SHORT: v = (short)va_arg(args->ap, int); break;
+		case LENGTH_LONG: v = va_arg(args->ap, long); break;
+		case LENGTH_LLONG: v = va_arg(args->ap, long long); break;
+		case LENGTH_SIZE: v = (long long)va_arg(args->ap, size_t); break;
+		case LENGTH_INTMAX: v = va_arg(args->ap, intmax_t); break;
+		case LENGTH_PTRDIFF: v = va_arg(args->ap, ptrdiff_t); break;
+		default: v = va_arg(args->ap, int); break;
+		}
+		negative = (v < 0);
+		/* LLONG_MINでも桁あふれしないよう符号なしで反転する */
+		value = negative ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+	}
+	else if (conv == 'p') {
+		value = (unsigned long long)(uintptr_t)va_arg(args->ap, void *);
+#if IS_PRATFORM_WINDOWS()
+		/* MSVCと同じく、ポインタの桁数分を0埋めした大文字の16進数 */
+		conv = 'X';
+		if (precision < 0) {
+			precision = (int)sizeof(void *) * 2;
+		}
+#else
+		/* glibcと同じく、NULLは"(nil)"、それ以外は"0x"を付けた16進数 */
+		if (value == 0) {
+			formatPadded(out, "(nil)", 5, width, flags);
+			return;
+		}
+		conv = 'x';
+		flags |= FLAG_HASH;
+#endif
+	}
+	else {
+		switch (spec->length) {
+		case LENGTH_CHAR: value = (unsigned char)va_arg(args->ap, unsigned int); break;
+		case LENGTH_SHORT: value = (unsigned short)va_arg(args->ap, unsigned int); break;
+		case LENGTH_LONG: value = va_arg(args->ap, unsigned long); break;
+		case LENGTH_LLONG: value = va_arg(args->ap, unsigned long long); break;
+		case LENGTH_SIZE: value = va_arg(args->ap, size_t); break;
+		case LENGTH_INTMAX: value = va_arg(args->ap, uintmax_t); break;
+		case LENGTH_PTRDIFF: value = (unsigned long long)va_arg(args->ap, ptrdiff_t); break;
+		default: value = va_arg(args->ap, unsigned int); break;
+		}
+	}
+
+	/* 修飾のない10進数（最も多い書式）は直接書き込む */
+	if ((conv == 'd' || conv == 'i' || conv == 'u') && width < 0 && precision < 0 && (flags & (FLAG_PLUS | FLAG_SPACE)) == 0) {
+		if (negative) {
+			put(out, "-", 1);
+		}
+		digitLen = CmnString_FormatUInt(value, digitBuf);
+		put(out, digitBuf, digitLen);
+		return;
+	}
+
+	/* 数字列（精度0で値が0の場合は数字を出力しない）。16進数、8進数はバッファの末尾から詰める */
+	if (value == 0 && precision == 0) {
+		digitLen = 0;
+	}
+	else if (conv == 'x' || conv == 'X') {
+		const char *table = (conv == 'x') ? lowerDigits : upperDigits;
+		do {
+			*--digits = table[value & 0xF];
+			value >>= 4;
+		} while (value != 0);
+		digitLen = digitBuf + sizeof(digitBuf) - digits;
+	}
+	else if (conv == 'o') {
+		do {
+			*--digits = (char)('0' + (value & 0x7));
+			value >>= 3;
+		} while (value != 0);
+		digitLen = digitBuf + sizeof(digitBuf) - digits;
+	}
+	else {
+		digits = digitBuf;
+		digitLen = CmnString_FormatUInt(value, digits);
+	}
+
+	/* 符号、接頭辞 */
+	if (conv == 'd' || conv == 'i') {
+		if (negative) {
+			prefix[prefixLen++] = '-';
+		}
+		else if (flags & FLAG_PLUS) {
+			prefix[prefixLen++] = '+';
+		}
+		else if (flags & FLAG_SPACE) {
+			prefix[prefixLen++] = ' ';
+		}
+	}
+	else if ((flags & FLAG_HASH) && (conv == 'x' || conv == 'X') && digitLen > 0 && !(digitLen == 1 && *digits == '0')) {
+		prefix[prefixLen++] = '0';
+		prefix[prefixLen++] = conv;
+	}
+	else if ((flags & FLAG_HASH) && conv == 'o' && (digitLen == 0 || *digits != '0') && (precision < 0 || (size_t)precision <= digitLen)) {
+		/* 8進数の代替形式は先頭を'0'にする（精度で'0'が付く場合を除く） */
+		*--digits = '0';
+		digitLen++;
+	}
+
+	/* 精度による最小桁数。精度指定時は'0'フラグを無視する */
+	if (precision >= 0) {
+		if ((size_t)precision > digitLen) {
+			zeros = precision - digitLen;
+		}
+		flags &= ~FLAG_ZERO;
+	}
+
+	/* 幅による埋め */
+	total = prefixLen + zeros + digitLen;
+	if (width > 0 && (size_t)width > total) {
+		if (flags & FLAG_MINUS) {
+			put(out, prefix, prefixLen);
+			putChars(out, '0', zeros);
+			put(out, digits, digitLen);
+			putChars(out, ' ', width - total);
+			return;
+		}
+		if (flags & FLAG_ZERO) {
+			zeros += width - total;
+		}
+		else {
+			putChars(out, ' ', width - total);
+		}
+	}
+	put(out, prefix, prefixLen);
+	putChars(out, '0', zeros);
+	put(out, digits, digitLen);
+}
+
+/**
+ * @brief 浮動小数点数の書式化
+ *
+ *  変換指定を組み立て直し、1項目だけsnprintfで書式化する。幅、精度は'*'で渡す。
+ *
+ * @param out 書き込み先
+ * @param spec 変換指定
+ * @param flags フラグ（幅を引数で指定した場合の左寄せを含む）
+ * @param width 最小幅（指定なしの場合は負数）
+ * @param precision 精度（指定なしの場合は負数）
+ * @param args 値
+ */
+static void formatFloat(Output *out, const FormatSpec *spec, int flags, int width, int precision, Arguments *args)
+{
+	char conv[16];
+	char *p = conv;
+	char *dest = NULL;
+	size_t spare = 0;
+	int len;
+	long double ldValue = 0;
+	double value = 0;
+	int isLong = (spec->length == LENGTH_LDOUBLE);
+
+	if (isLong) {
+		ldValue = va_arg(args->ap, long double);
+	}
+	else {
+		value = va_arg(args->ap, double);
+	}
+
+	/* "%[flags]*[.*][L]conv"（未指定の精度は既定値に任せるため".*"を付けない） */
+	*p++ = '%';
+	if (flags & FLAG_MINUS) *p++ = '-';
+	if (flags & FLAG_PLUS) *p++ = '+';
+	if (flags & FLAG_SPACE) *p++ = ' ';
+	if (flags & FLAG_ZERO) *p++ = '0';
+	if (flags & FLAG_HASH) *p++ = '#';
+	*p++ = '*';
+	if (precision >= 0) {
+		*p++ = '.';
+		*p++ = '*';
+	}
+	if (isLong) *p++ = 'L';
+	*p++ = spec->conv;
+	*p = '\0';
+	if (width < 0) {
+		width = 0;
+	}
+
+	/* 空き領域に直接書式化する（収まらない場合は切り詰められ、必要な文字数が返る） */
+	if (out->pos < out->limit) {
+		dest = out->buf + out->pos;
+		spare = out->limit - out->pos + 1;
+	}
+	if (precision < 0) {
+		len = isLong ? snprintf(dest, spare, conv, width, ldValue) : snprintf(dest, spare, conv, width, value);
+	}
+	else {
+		len = isLong ? snprintf(dest, spare, conv, width, precision, ldValue) : snprintf(dest, spare, conv, width, precision, value);
+	}
+	if (len > 0) {
+		out->pos += len;
+	}
+}
+
+/**
+ * @brief 幅に合わせて空白で埋めた文字列の書き込み
+ *
+ * @param out 書き込み先
+ * @param str 文字列
+ * @param len 文字列のバイト数
+ * @param width 最小幅（指定なしの場合は負数）
+ * @param flags フラグ（FLAG_MINUSの場合は左寄せ）
+ */
+static void formatPadded(Output *out, const char *str, size_t len, int width, int flags)
+{
+	size_t pad = (width > 0 && (size_t)width > len) ? width - len : 0;
+
+	if (flags & FLAG_MINUS) {
+		put(out, str, len);
+		putChars(out, ' ', pad);
+	}
+	else {
+		putChars(out, ' ', pad);
+		put(out, str, len);
+	}
+}
+
+/**
+ * @brief 文字列の書き込み（バッファに収まらない分は文字数だけ数える）
+ */
+static void put(Output *out, const char *str, size_t len)
+{
+	if (out->pos < out->limit) {
+		size_t n = out->limit - out->pos;
+		memcpy(out->buf + out->pos, str, (n < len) ? n : len);
+	}
+	out->pos += len;
+}
+
+/**
+ * @brief 同じ文字の繰り返し書き込み（バッファに収まらない分は文字数だけ数える）
+ */
+static void putChars(Output *out, char ch, size_t count)
+{
+	if (out->pos < out->limit) {
+		size_t n = out->limit - out->pos;
+		memset(out->buf + out->pos, ch, (n < count) ? n : count);
+	}
+	out->pos += count;
+}
+
+/**
+ * @brief 終端の'\0'の書き込み
+ */
+static void terminate(Output *out, size_t size)
+{
+	if (size > 0) {
+		out->buf[(out->pos < out->limit) ? out->pos : out->limit] = '\0';
+	}
+}
@@ -0,0 +1,441 @@
+/** @file *********************************************************************
+ * @brief ワイルドカード照合 共通関数
+ *
+ *  ファイル名やプロパティのキーをワイルドカード（glob）で絞り込むための共通関数。<br>
+ *  パターンは正規表現に変換してCmnStringRegexでコンパイルするため、照合時にバックトラックは発生せず、
+ *  照合時間は文字列の長さに比例する（"a*a*a*a*b"のようなパターンでも遅くならない）。<br>
+ *  複数のパターンをまとめてコンパイルすると、文字列を1回走査するだけでどのパターンに一致したかがわかる。
+ *
+ *  使用できる構文は以下の通り。パターンは文字列全体に一致する必要がある。
+ *  - *（任意の0文字以上）、?（任意の1文字）
+ *  - [...]、[!...]、[^...]（範囲指定可。先頭の]は文字として扱う）
+ *  - {a,b,c}（いずれか。ネスト可。対応する}がない場合は文字として扱う）
+ *  - \\（次の1文字を特殊文字として扱わない）
+ *
+ *  CMN_STRING_GLOB_PATHNAMEを指定した場合、*、?、[!...]は'/'に一致しない。
+ *  パスの区切りを越えるには**を使用する（"a/ ** /b"（空白なし）は"a/b"、"a/x/y/b"に一致する）。<br>
+ *  コンパイル済みのパターンは照合時にキャッシュを更新するため、複数スレッドから同時に使用しないこと。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+
+/** 任意の1文字（'\0'以外）に一致する正規表現 */
+#define REGEX_ANY "[^\\x00]"
+/** パス区切り以外の任意の1文字に一致する正規表現 */
+#define REGEX_ANY_NOT_SLASH "[^/\\x00]"
+
+/** コンパイル済みワイルドカード */
+struct _tag_CmnStringGlob {
+	CmnStringRegex *re;
+};
+
+static int toRegex(const char *pattern, int flags, CmnStringBuffer *regex);
+static const char* findBraceEnd(const char *p);
+static const char* findClassEnd(const char *p, int flags);
+static const char* appendClass(const char *p, const char *end, int flags, CmnStringBuffer *regex);
+static const char* appendLiteral(const char *p, int flags, CmnStringBuffer *regex);
+static int isSjisLead(const char *p, int flags);
+
+/**
+ * @brief ワイルドカードの照合
+ *
+ *  文字列全体がパターンに一致するかを判定する。<br>
+ *  呼び出しごとにパターンをコンパイルするため、同じパターンで繰り返し照合する場合はCmnStringGlob_Compileを使用すること。
+ *
+ * @param pattern パターン
+ * @param str 照合する文字列
+ * @param flags オプション（CMN_STRING_GLOB_IGNORE_CASE, CMN_STRING_GLOB_BYTES, CMN_STRING_GLOB_PATHNAMEの論理和。なしの場合は0）
+ * @return 一致:True, 不一致:False, エラー（メモリ不足）:-1
+ */
+int CmnString_Glob(const char *pattern, const char *str, int flags)
+{
+	CmnStringGlob *glob;
+	int ret;
+	CMNLOG_TRACE_START();
+
+	glob = CmnStringGlob_Compile(pattern, flags);
+	if (glob == NULL) {
+		CMNLOG_TRACE_END();
+		return -1;
+	}
+	ret = CmnStringGlob_Match(glob, str);
+	CmnStringGlob_Free(glob);
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief ワイルドカードのコンパイル
+ *
+ *  パターンをコンパイルする。コンパイル結果は繰り返し照合に使用できる。
+ *
+ * @param pattern パターン
+ * @param flags オプション（CMN_STRING_GLOB_IGNORE_CASE, CMN_STRING_GLOB_BYTES, CMN_STRING_GLOB_PATHNAMEの論理和。なしの場合は0）
+ * @return コンパイル済みパターン。メモリ不足の場合はNULL。使用後はCmnStringGlob_Freeで解放すること。
+ */
+CmnStringGlob* CmnStringGlob_Compile(const char *pattern, int flags)
+{
+	CmnStringGlob *glob;
+	CMNLOG_TRACE_START();
+
+	glob = CmnStringGlob_CompileSet(&pattern, 1, flags);
+
+	CMNLOG_TRACE_END();
+	return glob;
+}
+
+/**
+ * @brief 複数のワイルドカードの一括コンパイル
+ *
+ *  複数のパターンをまとめてコンパイルする。<br>
+ *  CmnStringGlob_MatchIdで、文字列を1回走査するだけで一致したパターンの番号がわかる。
+ *
+ * @param patterns パターンの配列
+ * @param count パターンの数
+ * @param flags オプション（CMN_STRING_GLOB_IGNORE_CASE, CMN_STRING_GLOB_BYTES, CMN_STRING_GLOB_PATHNAMEの論理和。なしの場合は0）
+ * @return コンパイル済みパターン。メモリ不足の場合はNULL。使用後はCmnStringGlob_Freeで解放すること。
+ */
+CmnStringGlob* CmnStringGlob_CompileSet(const char *const *patterns, int count, int flags)
+{
+	CmnStringGlob *glob = NULL;
+	CmnStringBuffer **regexes = NULL;
+	const char **regexStrs = NULL;
+	int i;
+	CMNLOG_TRACE_START();
+
+	glob = calloc(1, sizeof(CmnStringGlob));
+	regexes = calloc(count > 0 ? count : 1, sizeof(CmnStringBuffer*));
+	regexStrs = calloc(count > 0 ? count : 1, sizeof(char*));
+	if (glob == NULL || regexes == NULL || regexStrs == NULL) {
+		goto ERROR;
+	}
+
+	/* 正規表現に変換 */
+	for (i = 0; i < count; i++) {
+		regexes[i] = CmnStringBuffer_Create("");
+		if (regexes[i] == NULL || toRegex(patterns[i], flags, regexes[i]) != 0) {
+			goto ERROR;
+		}
+		regexStrs[i] = regexes[i]->string;
+	}
+
+	glob->re = CmnStringRegex_CompileSet(regexStrs, count,
+			flags & (CMN_STRING_GLOB_IGNORE_CASE | CMN_STRING_GLOB_BYTES));
+	if (glob->re == NULL) {
+		goto ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		CmnStringBuffer_Free(regexes[i]);
+	}
+	free(regexes);
+	free(regexStrs);
+	CMNLOG_TRACE_END();
+	return glob;
+
+ERROR:
+	if (regexes != NULL) {
+		for (i = 0; i < count; i++) {
+			if (regexes[i] != NULL) {
+				CmnStringBuffer_Free(regexes[i]);
+			}
+		}
+	}
+	free(regexes);
+	free(regexStrs);
+	CmnStringGlob_Free(glob);
+	CMNLOG_TRACE_END();
+	return NULL;
+}
+
+/**
+ * @brief ワイルドカードの照合（コンパイル済み）
+ *
+ *  文字列全体がパターンに一致するかを判定する。一括コンパイルした場合は、いずれかのパターンに一致するかを判定する。
+ *
+ * @param glob コンパイル済みパターン
+ * @param str 照合する文字列
+ * @return 一致:True, 不一致:False, エラー（メモリ不足）:-1
+ */
+int CmnStringGlob_Match(CmnStringGlob *glob, const char *str)
+{
+	return CmnStringRegex_Match(glob->re, str, strlen(str));
+}
+
+/**
+ * @brief ワイルドカードの照合（パターン番号取得）
+ *
+ *  文字列全体が一致するパターンの番号を返す。複数のパターンに一致する場合は最小の番号を返す。
+ *
+ * @param glob コンパイル済みパターン
+ * @param str 照合する文字列
+ * @return 一致したパターンの番号（CmnStringGlob_Compileの場合は0）, 不一致:-1, エラー（メモリ不足）:-2
+ */
+int CmnStringGlob_MatchId(CmnStringGlob *glob, const char *str)
+{
+	return CmnStringRegex_MatchId(glob->re, str, strlen(str));
+}
+
+/**
+ * @brief コンパイル済みワイルドカードの解放
+ *
+ * @param glob コンパイル済みパターン
+ */
+void CmnStringGlob_Free(CmnStringGlob *glob)
+{
+	CMNLOG_TRACE_START();
+	if (glob != NULL) {
+		if (glob->re != NULL) {
+			CmnStringRegex_Free(glob->re);
+		}
+		free(glob);
+	}
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief ワイルドカードを正規表現に変換
+ * @return 正常:0, エラー（メモリ不足）:-1
+ */
+static int toRegex(const char *pattern, int flags, CmnStringBuffer *regex)
+{
+	const char *p = pattern;
+	const char *braceEnd[64];	/* 展開中の{}の終端位置 */
+	int braceDepth = 0;
+	int pathname = flags & CMN_STRING_GLOB_PATHNAME;
+	int ret = 0;
+
+	while (*p != '\0' && ret == 0) {
+		switch (*p) {
+		case '*':
+			if (p[1] == '*' && pathname && (p == pattern || p[-1] == '/') && (p[2] == '/' || p[2] == '\0')) {
+				/* パスの要素全体の**は'/'を含めて一致（"**\/"は0個以上のディレクトリ） */
+				if (p[2] == '/') {
+					ret = CmnStringBuffer_Append(regex, "(" REGEX_ANY "*/)?");
+					p += 3;
+				}
+				else {
+					ret = CmnStringBuffer_Append(regex, REGEX_ANY "*");
+					p += 2;
+				}
+				break;
+			}
+			while (*p == '*') {
+				p++;
+			}
+			ret = CmnStringBuffer_Append(regex, pathname ? REGEX_ANY_NOT_SLASH "*" : REGEX_ANY "*");
+			break;
+		case '?':
+			ret = CmnStringBuffer_Append(regex, pathname ? REGEX_ANY_NOT_SLASH : REGEX_ANY);
+			p++;
+			break;
+		case '[':
+			{
+				const char *end = findClassEnd(p + 1, flags);
+				if (end == NULL) {
+					p = appendLiteral(p, flags, regex);
+				}
+				else {
+					p = appendClass(p + 1, end, flags, regex);
+				}
+				ret = (p == NULL) ? -1 : 0;
+			}
+			break;
+		case '{':
+			if (braceDepth < (int)ARRAY_LENGTH(braceEnd) && (braceEnd[braceDepth] = findBraceEnd(p + 1)) != NULL) {
+				braceDepth++;
+				ret = CmnStringBuffer_Append(regex, "(");
+				p++;
+			}
+			else {
+				p = appendLiteral(p, flags, regex);
+				ret = (p == NULL) ? -1 : 0;
+			}
+			break;
+		case ',':
+			if (braceDepth > 0) {
+				ret = CmnStringBuffer_Append(regex, "|");
+				p++;
+			}
+			else {
+				p = appendLiteral(p, flags, regex);
+				ret = (p == NULL) ? -1 : 0;
+			}
+			break;
+		case '}':
+			if (braceDepth > 0 && braceEnd[braceDepth - 1] == p) {
+				braceDepth--;
+				ret = CmnStringBuffer_Append(regex, ")");
+				p++;
+			}
+			else {
+				p = appendLiteral(p, flags, regex);
+				ret = (p == NULL) ? -1 : 0;
+			}
+			break;
+		case '\\':
+			if (p[1] != '\0') {
+				p++;
+			}
+			p = appendLiteral(p, flags, regex);
+			ret = (p == NULL) ? -1 : 0;
+			break;
+		default:
+			p = appendLiteral(p, flags, regex);
+			ret = (p == NULL) ? -1 : 0;
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * @brief {}の終端の検索
+ *
+ *  pは'{'の次を指していること。ネストした{}とエスケープを考慮して対応する'}'を探す。
+ *
+ * @return '}'の位置, 見つからない場合はNULL
+ */
+static const char* findBraceEnd(const char *p)
+{
+	int depth = 0;
+	for (; *p != '\0'; p++) {
+		if (*p == '\\' && p[1] != '\0') {
+			p++;
+		}
+		else if (*p == '{') {
+			depth++;
+		}
+		else if (*p == '}') {
+			if (depth == 0) {
+				return p;
+			}
+			depth--;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief []の終端の検索
+ *
+ *  pは'['の次を指していること。先頭（否定の!、^の次）の']'は文字として扱う。
+ *
+ * @return ']'の位置, 見つからない場合はNULL
+ */
+static const char* findClassEnd(const char *p, int flags)
+{
+	if (*p == '!' || *p == '^') {
+		p++;
+	}
+	if (*p == ']') {
+		p++;
+	}
+	for (; *p != '\0'; p++) {
+		if (*p == ']') {
+			return p;
+		}
+		if ((*p == '\\' || isSjisLead(p, flags)) && p[1] != '\0') {
+			p++;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief []を正規表現の文字クラスに変換して追加
+ *
+ *  pは'['の次、endは対応する']'を指していること。
+ *
+ * @return endの次の位置, エラー（メモリ不足）:NULL
+ */
+static const char* appendClass(const char *p, const char *end, int flags, CmnStringBuffer *regex)
+{
+	const char *first;
+
+	if (CmnStringBuffer_Append(regex, "[") != 0) {
+		return NULL;
+	}
+	if (*p == '!' || *p == '^') {
+		p++;
+		/* 否定の場合もパス区切りと'\0'には一致させない */
+		if (CmnStringBuffer_Append(regex, (flags & CMN_STRING_GLOB_PATHNAME) ? "^/\\x00" : "^\\x00") != 0) {
+			return NULL;
+		}
+	}
+
+	first = p;
+	while (p < end) {
+		if (*p == '-' && p != first && p + 1 < end) {
+			/* 範囲指定 */
+			if (CmnStringBuffer_Append(regex, "-") != 0) {
+				return NULL;
+			}
+			p++;
+			continue;
+		}
+		if (*p == '\\' && p + 1 < end) {
+			p++;
+		}
+		p = appendLiteral(p, flags, regex);
+		if (p == NULL) {
+			return NULL;
+		}
+	}
+
+	if (CmnStringBuffer_Append(regex, "]") != 0) {
+		return NULL;
+	}
+	return end + 1;
+}
+
+/**
+ * @brief 1文字を正規表現の文字として追加
+ *
+ *  記号はエスケープして追加する。マルチバイト文字は1文字分をそのまま追加する。
+ *
+ * @return 次の文字の位置, エラー（メモリ不足）:NULL
+ */
+static const char* appendLiteral(const char *p, int flags, CmnStringBuffer *regex)
+{
+	unsigned char c = (unsigned char)*p;
+	char escaped[2];
+
+	/* Shift_JISの2バイト目は記号と同じ値の場合があるため、1バイト目とまとめて扱う */
+	if (isSjisLead(p, flags)) {
+		if (CmnStringBuffer_AppendN(regex, p, 1) != 0) {
+			return NULL;
+		}
+		p++;
+		c = (unsigned char)*p;
+	}
+
+	if (c < 0x80 && !('0' <= c && c <= '9') && !('A' <= c && c <= 'Z') && !('a' <= c && c <= 'z') && c != ' ') {
+		escaped[0] = '\\';
+		escaped[1] = (char)c;
+		if (CmnStringBuffer_AppendN(regex, escaped, 2) != 0) {
+			return NULL;
+		}
+	}
+	else if (CmnStringBuffer_AppendN(regex, p, 1) != 0) {
+		return NULL;
+	}
+	return p + 1;
+}
+
+/** Shift_JISの2バイト文字の1バイト目か（CMN_STRING_GLOB_BYTES指定時のみ） */
+static int isSjisLead(const char *p, int flags)
+{
+	unsigned char c = (unsigned char)*p;
+	return (flags & CMN_STRING_GLOB_BYTES) && ((0x81 <= c && c <= 0x9F) || (0xE0 <= c && c <= 0xFC)) && p[1] != '\0';
+}
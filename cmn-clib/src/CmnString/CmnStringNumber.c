@@ -0,0 +1,422 @@
+/** @file *********************************************************************
+ * @brief 数値文字列変換 共通関数
+ *
+ *  整数/浮動小数点数と文字列の相互変換を行う共通関数。<br>
+ *  sprintf/strtolより高速に変換することを目的としており、
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<math.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+
+/** 2桁の数字文字列テーブル（"00"～"99"） */
+static const char DIGITS2[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/** 10のべき乗（浮動小数点数の高速変換用。10^22までは倍精度で正確に表現できる） */
+static const double POW10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static size_t countDigits(unsigned long long value);
+static void writeDigits(char *end, unsigned long long value);
+
+/**
+ * @brief 符号なし整数の文字列変換
+ *
+ *  valueを10進数文字列に変換してbufに格納する。
+ *
+ * @param value 変換する値
+ * @param buf 変換後の文字列を格納するバッファ。CMN_STRING_UINT_SIZE以上の領域を有すること。
+ * @return 変換後の文字数（終端の'\0'を含まない）
+ */
+size_t CmnString_FormatUInt(unsigned long long value, char *buf)
+{
+	size_t len = countDigits(value);
+
+	writeDigits(buf + len, value);
+	buf[len] = '\0';
+	return len;
+}
+
+/**
+ * @brief 符号付き整数の文字列変換
+ *
+ *  valueを10進数文字列に変換してbufに格納する。
+ *
+ * @param value 変換する値
+ * @param buf 変換後の文字列を格納するバッファ。CMN_STRING_INT_SIZE以上の領域を有すること。
+ * @return 変換後の文字数（終端の'\0'を含まない）
+ */
+size_t CmnString_FormatInt(long long value, char *buf)
+{
+	if (value < 0) {
+		*buf = '-';
+		/* LLONG_MINでも桁あふれしないよう符号なしで反転する */
+		return CmnString_FormatUInt(0ULL - (unsigned long long)value, buf + 1) + 1;
+	}
+	return CmnString_FormatUInt((unsigned long long)value, buf);
+}
+
+/**
+ * @brief 符号なし整数の文字列変換（ゼロ埋め）
+ *
+ *  valueを10進数文字列に変換し、digit桁に満たない場合は左側を'0'で埋めてbufに格納する。<br>
+ *  "%02d"や"%04d"のような日時の書式化に使用する。
+ *
+ * @param value 変換する値
+ * @param digit 最小桁数
+ * @param buf 変換後の文字列を格納するバッファ
+ * @return 変換後の文字数（終端の'\0'を含まない）
+ */
+size_t CmnString_FormatUIntPad(unsigned long long value, size_t digit, char *buf)
+{
+	size_t len = countDigits(value);
+
+	if (len < digit) {
+		memset(buf, '0', digit - len);
+		len = digit;
+	}
+	writeDigits(buf + len, value);
+	buf[len] = '\0';
+	return len;
+}
+
+/**
+ * @brief 浮動小数点数の文字列変換
+ *
+ *  valueを、読み戻したときに同じ値になる最短の10進数文字列に変換してbufに格納する。<br>
+ *  書式は"%g"と同じ（例：0.1 -> "0.1"、1e+100 -> "1e+100"、3.0 -> "3"）。<br>
+ *  整数値は整数変換で処理し、それ以外は15桁から順に精度を上げて最初に元の値へ戻る表現を採用する。
+ *  倍精度は15桁以下の10進数を全て区別できるため、15桁で戻らない値に15桁以下の表現は存在しない。
+ *
+ * @param value 変換する値
+ * @param buf 変換後の文字列を格納するバッファ。CMN_STRING_DOUBLE_SIZE以上の領域を有すること。
+ * @return 変換後の文字数（終端の'\0'を含まない）
+ */
+size_t CmnString_FormatDouble(double value, char *buf)
+{
+	int precision;
+	int len = 0;
+
+	/* 非数、無限大 */
+	if (value != value) {
+		strcpy(buf, "nan");
+		return 3;
+	}
+	if (value == HUGE_VAL || value == -HUGE_VAL) {
+		strcpy(buf, (value < 0) ? "-inf" : "inf");
+		return (value < 0) ? 4 : 3;
+	}
+
+	/* 15桁以内の整数は整数として変換（-0は符号を残すため除外） */
+	if (-1e15 < value && value < 1e15 && value == (double)(long long)value
+			&& !(value == 0 && signbit(value))) {
+		return CmnString_FormatInt((long long)value, buf);
+	}
+
+	for (precision = 15; precision <= 17; precision++) {
+		len = sprintf(buf, "%.*g", precision, value);
+		if (strtod(buf, NULL) == value) {
+			break;
+		}
+	}
+	return (size_t)len;
+}
+
+/**
+ * @brief 文字列の符号なし整数変換
+ *
+ *  10進数文字列を符号なし整数に変換する。<br>
+ *  strtoulと異なり、前後の空白や符号、数字以外の文字を1文字でも含む場合はエラーとする。
+ *
+ * @param str 変換する文字列。'\0'で終端している必要はない。
+ * @param len strの文字数
+ * @param value 変換後の値を格納する。エラーの場合は変更しない。
+ * @return CMN_STRING_PARSE_OK:正常、CMN_STRING_PARSE_ERROR_FORMAT:書式不正、CMN_STRING_PARSE_ERROR_OVERFLOW:桁あふれ
+ */
+CmnStringParseResult CmnString_ParseUInt(const char *str, size_t len, unsigned long long *value)
+{
+	unsigned long long ret = 0;
+	const char *end = str + len;
+
+	if (len == 0) {
+		return CMN_STRING_PARSE_ERROR_FORMAT;
+	}
+
+	/* 19桁までは桁あふれしないためチェックを省略 */
+	if (len <= 19) {
+		for (; str < end; str++) {
+			unsigned int d = (unsigned char)*str - '0';
+			if (9 < d) {
+				return CMN_STRING_PARSE_ERROR_FORMAT;
+			}
+			ret = ret * 10 + d;
+		}
+	}
+	else {
+		int overflow = False;
+		for (; str < end; str++) {
+			unsigned int d = (unsigned char)*str - '0';
+			if (9 < d) {
+				return CMN_STRING_PARSE_ERROR_FORMAT;
+			}
+			if (ret > (~0ULL - d) / 10) {
+				overflow = True;
+			}
+			ret = ret * 10 + d;
+		}
+		if (overflow) {
+			return CMN_STRING_PARSE_ERROR_OVERFLOW;
+		}
+	}
+
+	*value = ret;
+	return CMN_STRING_PARSE_OK;
+}
+
+/**
+ * @brief 文字列の符号付き整数変換
+ *
+ *  10進数文字列を符号付き整数に変換する。先頭の'+'/'-'のみ許容する。<br>
+ *  atoi/strtolと異なり、前後の空白や数字以外の文字を1文字でも含む場合はエラーとする。
+ *
+ * @param str 変換する文字列。'\0'で終端している必要はない。
+ * @param len strの文字数
+ * @param value 変換後の値を格納する。エラーの場合は変更しない。
+ * @return CMN_STRING_PARSE_OK:正常、CMN_STRING_PARSE_ERROR_FORMAT:書式不正、CMN_STRING_PARSE_ERROR_OVERFLOW:桁あふれ
+ */
+CmnStringParseResult CmnString_ParseInt(const char *str, size_t len, long long *value)
+{
+	unsigned long long tmp;
+	unsigned long long limit = 9223372036854775807ULL;
+	int negative = False;
+	CmnStringParseResult ret;
+
+	if (len != 0 && (*str == '-' || *str == '+')) {
+		negative = (*str == '-');
+		limit += negative;
+		str++;
+		len--;
+	}
+
+	ret = CmnString_ParseUInt(str, len, &tmp);
+	if (ret != CMN_STRING_PARSE_OK) {
+		return ret;
+	}
+	if (limit < tmp) {
+		return CMN_STRING_PARSE_ERROR_OVERFLOW;
+	}
+
+	*value = negative ? (long long)(0ULL - tmp) : (long long)tmp;
+	return CMN_STRING_PARSE_OK;
+}
+
+/**
+ * @brief 文字列の浮動小数点数変換
+ *
+ *  10進数文字列（例："-12.5", "1e-3", ".5"）を浮動小数点数に変換する。<br>
+ *  前後の空白や"inf"/"nan"、16進表記は受け付けない。<br>
+ *  仮数が2^53未満かつ指数が±22以内の場合は、1回の乗除算で正確に丸めた値を求める。
+ *  それ以外の場合のみstrtodで変換する。
+ *
+ * @param str 変換する文字列。'\0'で終端している必要はない。
+ * @param len strの文字数
+ * @param value 変換後の値を格納する。エラーの場合は変更しない。
+ * @return CMN_STRING_PARSE_OK:正常、CMN_STRING_PARSE_ERROR_FORMAT:書式不正、CMN_STRING_PARSE_ERROR_OVERFLOW:範囲外
+ */
+CmnStringParseResult CmnString_ParseDouble(const char *str, size_t len, double *value)
+{
+	const char *p = str;
+	const char *end = str + len;
+	unsigned long long mantissa = 0;
+	int mantissaDigits = 0;
+	int digits = 0;
+	int exponent = 0;
+	int negative = False;
+
+	/* 符号 */
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	/* 整数部 */
+	for (; p < end && (unsigned int)(*p - '0') <= 9; p++, digits++) {
+		if (mantissaDigits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			mantissaDigits += (mantissa != 0);
+		}
+		else {
+			exponent++;
+		}
+	}
+	/* 小数部 */
+	if (p < end && *p == '.') {
+		for (p++; p < end && (unsigned int)(*p - '0') <= 9; p++, digits++) {
+			if (mantissaDigits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				mantissaDigits += (mantissa != 0);
+				exponent--;
+			}
+		}
+	}
+	if (digits == 0) {
+		return CMN_STRING_PARSE_ERROR_FORMAT;
+	}
+	/* 指数部 */
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		int expNegative = False;
+		int expValue = 0;
+		const char *expStart;
+
+		p++;
+		if (p < end && (*p == '-' || *p == '+')) {
+			expNegative = (*p == '-');
+			p++;
+		}
+		for (expStart = p; p < end && (unsigned int)(*p - '0') <= 9; p++) {
+			if (expValue < 100000) {
+				expValue = expValue * 10 + (*p - '0');
+			}
+		}
+		if (p == expStart) {
+			return CMN_STRING_PARSE_ERROR_FORMAT;
+		}
+		exponent += expNegative ? -expValue : expValue;
+	}
+	if (p != end) {
+		return CMN_STRING_PARSE_ERROR_FORMAT;
+	}
+
+	/* 高速変換：仮数・10のべき乗ともに倍精度で正確に表現できる場合は1回の演算で正しく丸められる */
+	if (mantissa < (1ULL << 53) && -22 <= exponent && exponent <= 22) {
+		double d = (double)mantissa;
+		d = (exponent < 0) ? d / POW10[-exponent] : d * POW10[exponent];
+		*value = negative ? -d : d;
+		return CMN_STRING_PARSE_OK;
+	}
+
+	/* それ以外はstrtodで変換（書式は検証済み） */
+	{
+		char tmp[128];
+		char *copy = tmp;
+		double d;
+
+		if (sizeof(tmp) <= len) {
+			if ((copy = malloc(len + 1)) == NULL) {
+				return CMN_STRING_PARSE_ERROR_FORMAT;
+			}
+		}
+		memcpy(copy, str, len);
+		copy[len] = '\0';
+
+		errno = 0;
+		d = strtod(copy, NULL);
+		if (copy != tmp) {
+			free(copy);
+		}
+		if (errno == ERANGE && (d == HUGE_VAL || d == -HUGE_VAL)) {
+			return CMN_STRING_PARSE_ERROR_OVERFLOW;
+		}
+		*value = d;
+	}
+	return CMN_STRING_PARSE_OK;
+}
+
+/**
+ * @brief 文字列バッファへの整数追加
+ *
+ *  valueを10進数文字列に変換して文字列バッファの末尾に追加する。
+ *
+ * @param buf 文字列バッファ
+ * @param value 追加する値
+ * @return 正常:0, エラー:-1
+ */
+int CmnStringBuffer_AppendInt(CmnStringBuffer *buf, long long value)
+{
+	char tmp[CMN_STRING_INT_SIZE];
+	size_t len = CmnString_FormatInt(value, tmp);
+	return CmnStringBuffer_AppendN(buf, tmp, len);
+}
+
+/**
+ * @brief 文字列バッファへの浮動小数点数追加
+ *
+ *  valueを最短の10進数文字列に変換して文字列バッファの末尾に追加する。
+ *
+ * @param buf 文字列バッファ
+ * @param value 追加する値
+ * @return 正常:0, エラー:-1
+ * @sa CmnString_FormatDouble
+ */
+int CmnStringBuffer_AppendDouble(CmnStringBuffer *buf, double value)
+{
+	char tmp[CMN_STRING_DOUBLE_SIZE];
+	size_t len = CmnString_FormatDouble(value, tmp);
+	return CmnStringBuffer_AppendN(buf, tmp, len);
+}
+
+/**
+ * @brief 10進数の桁数を求める
+ * @param value 値
+ * @return 桁数（1～20）
+ */
+static size_t countDigits(unsigned long long value)
+{
+	size_t len = 1;
+
+	for (;;) {
+		if (value < 10) return len;
+		if (value < 100) return len + 1;
+		if (value < 1000) return len + 2;
+		if (value < 10000) return len + 3;
+		value /= 10000;
+		len += 4;
+	}
+}
+
+/**
+ * @brief 数字を末尾から書き込む
+ *
+ *  2桁ずつテーブルから取得して書き込む。
+ *
+ * @param end 書き込み先の末尾（最後の数字の次の位置）
+ * @param value 値
+ */
+static void writeDigits(char *end, unsigned long long value)
+{
+	while (100 <= value) {
+		unsigned int idx = (unsigned int)(value % 100) * 2;
+		value /= 100;
+		*--end = DIGITS2[idx + 1];
+		*--end = DIGITS2[idx];
+	}
+	if (10 <= value) {
+		unsigned int idx = (unsigned int)value * 2;
+		*--end = DIGITS2[idx + 1];
+		*--end = DIGITS2[idx];
+	}
+	else {
+		*--end = (char)('0' + value);
+	}
+}
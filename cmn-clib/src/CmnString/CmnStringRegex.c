@@ -0,0 +1,1575 @@
+/** @file *********************************************************************
+ * @brief 正規表現 共通関数
+ *
+ *  正規表現をコンパイルして文字列の照合を行う共通関数。<br>
+ *  パターンは構文木からThompson法でNFAに変換し、照合時にNFAの状態集合をDFAの状態として必要な分だけ生成する（遅延DFA）。
+ *  生成したDFAの状態はキャッシュし、キャッシュが上限を超えた場合は破棄して作り直す。
+ *  バックトラックを行わないため、照合時間は入力の長さに比例する。<br>
+ *  パターン先頭の固定文字列（例："ERROR.*timeout"の"ERROR"）は、照合開始前の読み飛ばしに使用する。
+ *
+ *  使用できる構文は以下の通り（後方参照、先読み等は使用不可）。
+ *  - 文字、.（改行以外の1文字）、[...]、[^...]（範囲指定、\\d等を含む）
+ *  - \\d \\D \\w \\W \\s \\S \\t \\n \\r \\f \\v \\xHH、その他の記号のエスケープ
+ *  - * + ? {n} {n,} {n,m}（最短一致指定の?は無視する）
+ *  - | ( ) (?: )、^（入力の先頭）、$（入力の末尾）
+ *
+ *  1文字はUTF-8の1文字として扱う。CMN_STRING_REGEX_BYTESを指定した場合は1バイトを1文字として扱う（Shift_JIS等）。<br>
+ *  コンパイル済みの正規表現は照合時にキャッシュを更新するため、複数スレッドから同時に使用しないこと。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnData.h"
+#include"cmnclib/CmnLog.h"
+
+/** NFAの状態数の上限（{n,m}の展開によるメモリの過剰使用を防ぐ） */
+#define NFA_STATE_MAX 100000
+/** DFAキャッシュのサイズ上限（バイト） */
+#define DFA_CACHE_SIZE (2 * 1024 * 1024)
+/** 括弧のネストの上限 */
+#define NEST_MAX 256
+/** 文字クラスの範囲数の上限 */
+#define CLASS_RANGE_MAX 512
+/** Unicodeの最大値 */
+#define UNICODE_MAX 0x10FFFF
+
+/* ===== 構文木 ===== */
+
+/** 構文木のノード種別 */
+typedef enum {
+	NODE_SET,		/**< 1バイト（集合） */
+	NODE_CONCAT,	/**< 連接 */
+	NODE_ALT,		/**< 選択 */
+	NODE_REPEAT,	/**< 繰り返し */
+	NODE_BOL,		/**< 入力の先頭 */
+	NODE_EOL,		/**< 入力の末尾 */
+	NODE_EMPTY		/**< 空 */
+} NodeType;
+
+/** 構文木のノード */
+typedef struct {
+	NodeType type;
+	int left;				/**< CONCAT/ALT:左, REPEAT:繰り返す対象 */
+	int right;				/**< CONCAT/ALT:右 */
+	int min;				/**< REPEAT:最小回数 */
+	int max;				/**< REPEAT:最大回数（-1は無制限） */
+	unsigned int set[8];	/**< SET:バイトの集合（256bit） */
+} Node;
+
+/** 文字クラスの範囲 */
+typedef struct {
+	unsigned int lo;
+	unsigned int hi;
+} Range;
+
+/** 構文解析の状態 */
+typedef struct {
+	const unsigned char *p;		/**< 解析位置 */
+	const unsigned char *end;	/**< パターンの末尾 */
+	int flags;					/**< コンパイルオプション */
+	Node *nodes;				/**< ノード */
+	int nodeCount;
+	int nodeCap;
+	int depth;					/**< 括弧のネスト数 */
+	const char *error;			/**< エラー内容 */
+} Parser;
+
+/* ===== NFA/DFA ===== */
+
+/** NFAの状態種別 */
+enum {
+	NFA_SET,		/**< 集合に含まれるバイトを読んでoutへ遷移 */
+	NFA_SPLIT,		/**< outとout1へ空遷移 */
+	NFA_BOL,		/**< 入力の先頭の場合のみoutへ空遷移 */
+	NFA_EOL,		/**< 入力の末尾の場合のみoutへ空遷移 */
+	NFA_MATCH		/**< 受理（out1はパターン番号） */
+};
+
+/** NFAの状態 */
+typedef struct {
+	int type;
+	int out;
+	int out1;
+	unsigned int set[8];
+} NfaState;
+
+/** DFAの状態フラグ */
+#define DFA_MATCH        0x01	/**< 受理状態を含む */
+#define DFA_MATCH_AT_END 0x02	/**< 入力の末尾であれば受理状態になる */
+#define DFA_DEAD         0x04	/**< どの入力でも受理しない */
+
+/** DFAの状態 */
+typedef struct {
+	int *next;			/**< バイトクラスごとの遷移先（-1は未生成） */
+	int *list;			/**< 対応するNFAの状態の一覧（昇順） */
+	int count;			/**< listの要素数 */
+	int flags;			/**< DFA_MATCH等 */
+	int matchId;		/**< 受理するパターン番号の最小値 */
+	int matchIdAtEnd;	/**< 末尾で受理するパターン番号の最小値 */
+} DfaState;
+
+/** 遅延DFA */
+typedef struct {
+	int searchMode;			/**< 部分一致（各位置から照合を開始する）か */
+	DfaState *states;
+	int count;
+	int cap;
+	int *table;				/**< 状態のハッシュ表（状態番号+1、0は空き） */
+	int tableSize;
+	size_t memUsed;
+	int start;				/**< 開始状態 */
+	int restart;			/**< 部分一致で先頭以外から照合を開始する状態 */
+} Dfa;
+
+/** コンパイル済み正規表現 */
+struct _tag_CmnStringRegex {
+	int flags;
+	NfaState *nfa;
+	int nfaCount;
+	int nfaCap;
+	int nfaStart;
+	unsigned char classMap[256];	/**< バイト → バイトクラス */
+	unsigned char classRep[256];	/**< バイトクラス → 代表バイト */
+	int classCount;
+	char *prefix;					/**< 先頭の固定文字列（NULLはなし） */
+	size_t prefixLen;
+	Dfa search;
+	Dfa match;
+	int *stack;						/**< 作業領域 */
+	int *mark;
+	int markGen;
+	int *work;
+	int workCount;
+};
+
+static int newNode(Parser *ps, NodeType type);
+static int parseAlt(Parser *ps);
+static int parseConcat(Parser *ps);
+static int parseRepeat(Parser *ps);
+static int parseAtom(Parser *ps);
+static int parseClass(Parser *ps);
+static int parseNumber(Parser *ps, int *value);
+static int parseEscapeClass(Parser *ps, int c, Range *ranges, int *count);
+static int parseEscapeChar(Parser *ps, int c);
+static unsigned int parseChar(Parser *ps);
+static int addRange(Parser *ps, Range *ranges, int *count, unsigned int lo, unsigned int hi);
+static int classNode(Parser *ps, Range *ranges, int count, int negate);
+static int utf8RangeNode(Parser *ps, unsigned int lo, unsigned int hi);
+static int byteNode(Parser *ps, unsigned int lo, unsigned int hi);
+static int joinNode(Parser *ps, NodeType type, int left, int right);
+static int compileNode(CmnStringRegex *re, const Parser *ps, int node, int next);
+static int newState(CmnStringRegex *re, int type, int out, int out1);
+static void buildByteClass(CmnStringRegex *re);
+static void extractPrefix(CmnStringRegex *re, const Parser *ps, int node, CmnStringBuffer *prefix, int *complete);
+static int dfaInit(CmnStringRegex *re, Dfa *dfa, int searchMode);
+static void dfaFree(Dfa *dfa);
+static int dfaNext(CmnStringRegex *re, Dfa *dfa, int cur, int cls);
+static int dfaAdd(CmnStringRegex *re, Dfa *dfa);
+static void closure(CmnStringRegex *re, int start, int atStart, int atEnd);
+static int compareInt(const void *a, const void *b);
+static const char* findPrefix(const CmnStringRegex *re, const char *p, const char *end);
+
+/**
+ * @brief 正規表現のコンパイル
+ *
+ *  正規表現のパターンをコンパイルする。コンパイル結果は繰り返し照合に使用できる。
+ *
+ * @param pattern 正規表現のパターン
+ * @param flags コンパイルオプション（CMN_STRING_REGEX_IGNORE_CASE, CMN_STRING_REGEX_BYTESの論理和。なしの場合は0）
+ * @return コンパイル済み正規表現。構文エラー、メモリ不足の場合はNULL。使用後はCmnStringRegex_Freeで解放すること。
+ */
+CmnStringRegex* CmnStringRegex_Compile(const char *pattern, int flags)
+{
+	CmnStringRegex *re;
+	CMNLOG_TRACE_START();
+
+	re = CmnStringRegex_CompileSet(&pattern, 1, flags);
+
+	CMNLOG_TRACE_END();
+	return re;
+}
+
+/**
+ * @brief 複数の正規表現の一括コンパイル
+ *
+ *  複数のパターンを1つのオートマトンにコンパイルする。<br>
+ *  CmnStringRegex_MatchId/CmnStringRegex_SearchIdで、入力を1回走査するだけで一致したパターンの番号がわかる。
+ *
+ * @param patterns 正規表現のパターンの配列
+ * @param count パターンの数
+ * @param flags コンパイルオプション（CMN_STRING_REGEX_IGNORE_CASE, CMN_STRING_REGEX_BYTESの論理和。なしの場合は0）
+ * @return コンパイル済み正規表現。構文エラー、メモリ不足の場合はNULL。使用後はCmnStringRegex_Freeで解放すること。
+ */
+CmnStringRegex* CmnStringRegex_CompileSet(const char *const *patterns, int count, int flags)
+{
+	Parser ps;
+	CmnStringRegex *re;
+	CmnStringBuffer *prefix = NULL;
+	int *roots = NULL;
+	int i;
+	CMNLOG_TRACE_START();
+
+	memset(&ps, 0, sizeof(ps));
+	ps.flags = flags;
+
+	re = calloc(1, sizeof(CmnStringRegex));
+	roots = malloc(sizeof(int) * (count > 0 ? count : 1));
+	if (re == NULL || roots == NULL) {
+		goto ERROR;
+	}
+	re->flags = flags;
+
+	/* 構文解析 */
+	for (i = 0; i < count; i++) {
+		ps.p = (const unsigned char *)patterns[i];
+		ps.end = ps.p + strlen(patterns[i]);
+		ps.depth = 0;
+		roots[i] = parseAlt(&ps);
+		if (roots[i] >= 0 && ps.p < ps.end) {
+			ps.error = "unmatched ')'";
+			roots[i] = -1;
+		}
+		if (roots[i] < 0) {
+			CMNLOG_WARN("regex compile error. %s, pattern=%s, pos=%d",
+					ps.error ? ps.error : "out of memory", patterns[i], (int)(ps.p - (const unsigned char *)patterns[i]));
+			goto ERROR;
+		}
+	}
+
+	/* NFA生成（パターンごとの受理状態を選択で連結する） */
+	re->nfaStart = -1;
+	for (i = count - 1; i >= 0; i--) {
+		int accept = newState(re, NFA_MATCH, -1, i);
+		int start = (accept < 0) ? -1 : compileNode(re, &ps, roots[i], accept);
+		if (start < 0) {
+			CMNLOG_WARN("regex compile error. %s, pattern=%s", "too many states", patterns[i]);
+			goto ERROR;
+		}
+		re->nfaStart = (re->nfaStart < 0) ? start : newState(re, NFA_SPLIT, start, re->nfaStart);
+		if (re->nfaStart < 0) {
+			goto ERROR;
+		}
+	}
+	if (re->nfaStart < 0) {
+		/* パターンが0個の場合は何にも一致しない（空集合を読む状態のみ） */
+		re->nfaStart = newState(re, NFA_SET, newState(re, NFA_MATCH, -1, 0), -1);
+		if (re->nfaStart < 0) {
+			goto ERROR;
+		}
+	}
+
+	/* 作業領域 */
+	re->stack = malloc(sizeof(int) * (re->nfaCount * 2 + 1));
+	re->mark = calloc(re->nfaCount, sizeof(int));
+	re->work = malloc(sizeof(int) * re->nfaCount * 2);
+	if (re->stack == NULL || re->mark == NULL || re->work == NULL) {
+		goto ERROR;
+	}
+
+	buildByteClass(re);
+
+	/* 先頭の固定文字列（パターンが1個の場合のみ） */
+	if (count == 1) {
+		int complete = True;
+		prefix = CmnStringBuffer_Create("");
+		if (prefix == NULL) {
+			goto ERROR;
+		}
+		extractPrefix(re, &ps, roots[0], prefix, &complete);
+		if (prefix->length > 0) {
+			re->prefix = CmnString_StrCopyNew(prefix->string);
+			if (re->prefix == NULL) {
+				goto ERROR;
+			}
+			re->prefixLen = prefix->length;
+		}
+		CmnStringBuffer_Free(prefix);
+		prefix = NULL;
+	}
+
+	free(ps.nodes);
+	free(roots);
+	CMNLOG_TRACE_END();
+	return re;
+
+ERROR:
+	if (prefix != NULL) {
+		CmnStringBuffer_Free(prefix);
+	}
+	free(ps.nodes);
+	free(roots);
+	if (re != NULL) {
+		CmnStringRegex_Free(re);
+	}
+	CMNLOG_TRACE_END();
+	return NULL;
+}
+
+/**
+ * @brief 部分一致の照合
+ *
+ *  文字列のどこかにパターンに一致する部分があるかを判定する（grepと同等）。
+ *
+ * @param re コンパイル済み正規表現
+ * @param str 照合する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 一致:True, 不一致:False, エラー（メモリ不足）:-1
+ */
+int CmnStringRegex_Search(CmnStringRegex *re, const char *str, size_t len)
+{
+	int id = CmnStringRegex_SearchId(re, str, len);
+	return (id == -2) ? -1 : (id >= 0);
+}
+
+/**
+ * @brief 完全一致の照合
+ *
+ *  文字列全体がパターンに一致するかを判定する。
+ *
+ * @param re コンパイル済み正規表現
+ * @param str 照合する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 一致:True, 不一致:False, エラー（メモリ不足）:-1
+ */
+int CmnStringRegex_Match(CmnStringRegex *re, const char *str, size_t len)
+{
+	int id = CmnStringRegex_MatchId(re, str, len);
+	return (id == -2) ? -1 : (id >= 0);
+}
+
+/**
+ * @brief 部分一致の照合（パターン番号取得）
+ *
+ *  文字列のどこかに一致する部分があるパターンの番号を返す。<br>
+ *  最初に一致が確定した位置で照合を終了し、その位置で一致したパターンのうち最小の番号を返す。
+ *
+ * @param re コンパイル済み正規表現
+ * @param str 照合する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 一致したパターンの番号（CmnStringRegex_Compileの場合は0）, 不一致:-1, エラー（メモリ不足）:-2
+ */
+int CmnStringRegex_SearchId(CmnStringRegex *re, const char *str, size_t len)
+{
+	Dfa *dfa = &re->search;
+	const unsigned char *p = (const unsigned char *)str;
+	const unsigned char *end = p + len;
+	int cur;
+
+	if (dfa->states == NULL && dfaInit(re, dfa, True) != 0) {
+		return -2;
+	}
+	cur = dfa->start;
+
+	while (True) {
+		if (dfa->states[cur].flags & DFA_MATCH) {
+			return dfa->states[cur].matchId;
+		}
+		/* 照合開始前の状態では、先頭の固定文字列が出現する位置まで読み飛ばす */
+		if (cur == dfa->restart && re->prefix != NULL) {
+			p = (const unsigned char *)findPrefix(re, (const char *)p, (const char *)end);
+			if (p == NULL) {
+				return -1;
+			}
+		}
+		if (p >= end) {
+			break;
+		}
+		{
+			int next = dfa->states[cur].next[re->classMap[*p]];
+			if (next < 0) {
+				next = dfaNext(re, dfa, cur, re->classMap[*p]);
+				if (next < 0) {
+					return -2;
+				}
+			}
+			cur = next;
+		}
+		p++;
+	}
+
+	return (dfa->states[cur].flags & DFA_MATCH_AT_END) ? dfa->states[cur].matchIdAtEnd : -1;
+}
+
+/**
+ * @brief 完全一致の照合（パターン番号取得）
+ *
+ *  文字列全体が一致するパターンの番号を返す。複数のパターンに一致する場合は最小の番号を返す。
+ *
+ * @param re コンパイル済み正規表現
+ * @param str 照合する文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @return 一致したパターンの番号（CmnStringRegex_Compileの場合は0）, 不一致:-1, エラー（メモリ不足）:-2
+ */
+int CmnStringRegex_MatchId(CmnStringRegex *re, const char *str, size_t len)
+{
+	Dfa *dfa = &re->match;
+	const unsigned char *p = (const unsigned char *)str;
+	const unsigned char *end = p + len;
+	int cur;
+
+	if (dfa->states == NULL && dfaInit(re, dfa, False) != 0) {
+		return -2;
+	}
+	cur = dfa->start;
+
+	for (; p < end; p++) {
+		int next = dfa->states[cur].next[re->classMap[*p]];
+		if (next < 0) {
+			next = dfaNext(re, dfa, cur, re->classMap[*p]);
+			if (next < 0) {
+				return -2;
+			}
+		}
+		cur = next;
+		if (dfa->states[cur].flags & DFA_DEAD) {
+			return -1;
+		}
+	}
+
+	if (dfa->states[cur].flags & DFA_MATCH_AT_END) {
+		return dfa->states[cur].matchIdAtEnd;
+	}
+	return -1;
+}
+
+/**
+ * @brief コンパイル済み正規表現の解放
+ *
+ * @param re コンパイル済み正規表現
+ */
+void CmnStringRegex_Free(CmnStringRegex *re)
+{
+	CMNLOG_TRACE_START();
+	if (re == NULL) {
+		CMNLOG_TRACE_END();
+		return;
+	}
+	dfaFree(&re->search);
+	dfaFree(&re->match);
+	free(re->nfa);
+	free(re->prefix);
+	free(re->stack);
+	free(re->mark);
+	free(re->work);
+	free(re);
+	CMNLOG_TRACE_END();
+}
+
+/* ========================================================================
+ * 構文解析
+ * ======================================================================== */
+
+/** ノード追加 */
+static int newNode(Parser *ps, NodeType type)
+{
+	Node *node;
+	if (ps->nodeCount == ps->nodeCap) {
+		int cap = (ps->nodeCap == 0) ? 64 : ps->nodeCap * 2;
+		Node *tmp = realloc(ps->nodes, sizeof(Node) * cap);
+		if (tmp == NULL) {
+			return -1;
+		}
+		ps->nodes = tmp;
+		ps->nodeCap = cap;
+	}
+	node = &ps->nodes[ps->nodeCount];
+	memset(node, 0, sizeof(Node));
+	node->type = type;
+	node->left = node->right = -1;
+	return ps->nodeCount++;
+}
+
+/** 連接・選択ノード作成 */
+static int joinNode(Parser *ps, NodeType type, int left, int right)
+{
+	int node;
+	if (left < 0 || right < 0) {
+		return -1;
+	}
+	node = newNode(ps, type);
+	if (node >= 0) {
+		ps->nodes[node].left = left;
+		ps->nodes[node].right = right;
+	}
+	return node;
+}
+
+/** 選択（a|b） */
+static int parseAlt(Parser *ps)
+{
+	int node = parseConcat(ps);
+	while (node >= 0 && ps->p < ps->end && *ps->p == '|') {
+		ps->p++;
+		node = joinNode(ps, NODE_ALT, node, parseConcat(ps));
+	}
+	return node;
+}
+
+/** 連接（ab） */
+static int parseConcat(Parser *ps)
+{
+	int node;
+	if (ps->p >= ps->end || *ps->p == '|' || *ps->p == ')') {
+		return newNode(ps, NODE_EMPTY);
+	}
+	node = parseRepeat(ps);
+	while (node >= 0 && ps->p < ps->end && *ps->p != '|' && *ps->p != ')') {
+		node = joinNode(ps, NODE_CONCAT, node, parseRepeat(ps));
+	}
+	return node;
+}
+
+/** 繰り返し（a* a+ a? a{n,m}） */
+static int parseRepeat(Parser *ps)
+{
+	int node = parseAtom(ps);
+
+	while (node >= 0 && ps->p < ps->end) {
+		int min, max, rep;
+		unsigned char c = *ps->p;
+
+		if (c == '*') {
+			min = 0; max = -1;
+			ps->p++;
+		}
+		else if (c == '+') {
+			min = 1; max = -1;
+			ps->p++;
+		}
+		else if (c == '?') {
+			min = 0; max = 1;
+			ps->p++;
+		}
+		else if (c == '{') {
+			const unsigned char *save = ps->p;
+			ps->p++;
+			if (parseNumber(ps, &min) != 0) {
+				/* 数値でない'{'は文字として扱う */
+				ps->p = save;
+				break;
+			}
+			max = min;
+			if (ps->p < ps->end && *ps->p == ',') {
+				ps->p++;
+				max = -1;
+				if (ps->p < ps->end && *ps->p != '}' && parseNumber(ps, &max) != 0) {
+					ps->error = "invalid repeat count";
+					return -1;
+				}
+			}
+			if (ps->p >= ps->end || *ps->p != '}' || (max >= 0 && max < min) || 1000 < min || 1000 < max) {
+				ps->error = "invalid repeat count";
+				return -1;
+			}
+			ps->p++;
+		}
+		else {
+			break;
+		}
+
+		/* 最短一致指定は一致判定の結果に影響しないため読み捨てる */
+		if (ps->p < ps->end && *ps->p == '?') {
+			ps->p++;
+		}
+
+		rep = newNode(ps, NODE_REPEAT);
+		if (rep < 0) {
+			return -1;
+		}
+		ps->nodes[rep].left = node;
+		ps->nodes[rep].min = min;
+		ps->nodes[rep].max = max;
+		node = rep;
+	}
+	return node;
+}
+
+/** 10進数の読み込み */
+static int parseNumber(Parser *ps, int *value)
+{
+	int n = 0;
+	if (ps->p >= ps->end || *ps->p < '0' || '9' < *ps->p) {
+		return -1;
+	}
+	while (ps->p < ps->end && '0' <= *ps->p && *ps->p <= '9') {
+		if (n < 100000) {
+			n = n * 10 + (*ps->p - '0');
+		}
+		ps->p++;
+	}
+	*value = n;
+	return 0;
+}
+
+/** 基本要素（文字、.、[...]、(...)、^、$） */
+static int parseAtom(Parser *ps)
+{
+	unsigned char c = *ps->p;
+	int node;
+
+	switch (c) {
+	case '(':
+		ps->p++;
+		if (NEST_MAX <= ++ps->depth) {
+			ps->error = "too deep nesting";
+			return -1;
+		}
+		if (ps->end - ps->p >= 2 && ps->p[0] == '?' && ps->p[1] == ':') {
+			ps->p += 2;
+		}
+		node = parseAlt(ps);
+		if (node < 0) {
+			return -1;
+		}
+		if (ps->p >= ps->end || *ps->p != ')') {
+			ps->error = "missing ')'";
+			return -1;
+		}
+		ps->p++;
+		ps->depth--;
+		return node;
+	case '*':
+	case '+':
+	case '?':
+		ps->error = "nothing to repeat";
+		return -1;
+	case '^':
+		ps->p++;
+		return newNode(ps, NODE_BOL);
+	case '$':
+		ps->p++;
+		return newNode(ps, NODE_EOL);
+	case '.':
+		{
+			Range ranges[1];
+			int count = 0;
+			ps->p++;
+			addRange(ps, ranges, &count, '\n', '\n');
+			return classNode(ps, ranges, count, True);
+		}
+	case '[':
+		ps->p++;
+		return parseClass(ps);
+	case '\\':
+		ps->p++;
+		if (ps->p >= ps->end) {
+			ps->error = "trailing '\\'";
+			return -1;
+		}
+		c = *ps->p;
+		{
+			Range ranges[4];
+			int count = 0;
+			int ret = parseEscapeClass(ps, c, ranges, &count);
+			if (ret != 0) {
+				ps->p++;
+				return classNode(ps, ranges, count, ret < 0);
+			}
+		}
+		{
+			int ch = parseEscapeChar(ps, c);
+			Range range;
+			if (ch < 0) {
+				return -1;
+			}
+			range.lo = range.hi = (unsigned int)ch;
+			return classNode(ps, &range, 1, False);
+		}
+	default:
+		{
+			Range range;
+			range.lo = range.hi = parseChar(ps);
+			return classNode(ps, &range, 1, False);
+		}
+	}
+}
+
+/**
+ * @brief 文字クラスのエスケープ（\\d \\w \\s 等）
+ * @return 肯定のクラス:1, 否定のクラス:-1, クラスでない:0
+ */
+static int parseEscapeClass(Parser *ps, int c, Range *ranges, int *count)
+{
+	int negate = (c == 'D' || c == 'W' || c == 'S') ? -1 : 1;
+	switch (c) {
+	case 'd':
+	case 'D':
+		addRange(ps, ranges, count, '0', '9');
+		return negate;
+	case 'w':
+	case 'W':
+		addRange(ps, ranges, count, '0', '9');
+		addRange(ps, ranges, count, 'A', 'Z');
+		addRange(ps, ranges, count, '_', '_');
+		addRange(ps, ranges, count, 'a', 'z');
+		return negate;
+	case 's':
+	case 'S':
+		addRange(ps, ranges, count, '\t', '\r');
+		addRange(ps, ranges, count, ' ', ' ');
+		return negate;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief 1文字のエスケープ（\\t \\n \\xHH 記号 等）
+ *
+ *  ps->pはエスケープ文字（'\\'の次）を指していること。読み終えた位置まで進める。
+ *
+ * @return 文字コード, エラー:-1
+ */
+static int parseEscapeChar(Parser *ps, int c)
+{
+	ps->p++;
+	switch (c) {
+	case 't': return '\t';
+	case 'n': return '\n';
+	case 'r': return '\r';
+	case 'f': return '\f';
+	case 'v': return '\v';
+	case '0': return '\0';
+	case 'x':
+		{
+			int v = 0;
+			int i;
+			for (i = 0; i < 2; i++) {
+				int h;
+				if (ps->p >= ps->end) {
+					ps->error = "invalid \\x escape";
+					return -1;
+				}
+				h = *ps->p;
+				if ('0' <= h && h <= '9') h -= '0';
+				else if ('a' <= h && h <= 'f') h -= 'a' - 10;
+				else if ('A' <= h && h <= 'F') h -= 'A' - 10;
+				else {
+					ps->error = "invalid \\x escape";
+					return -1;
+				}
+				v = v * 16 + h;
+				ps->p++;
+			}
+			return v;
+		}
+	default:
+		if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9')) {
+			ps->p--;
+			ps->error = "unsupported escape";
+			return -1;
+		}
+		if (0x80 <= c && !(ps->flags & CMN_STRING_REGEX_BYTES)) {
+			/* エスケープされたマルチバイト文字 */
+			ps->p--;
+			return (int)parseChar(ps);
+		}
+		return c;
+	}
+}
+
+/**
+ * @brief 1文字の読み込み
+ *
+ *  UTF-8の場合はマルチバイト文字を1文字として読み込み、コードポイントを返す。
+ *  不正なUTF-8の場合、およびCMN_STRING_REGEX_BYTES指定時は1バイトを返す。
+ */
+static unsigned int parseChar(Parser *ps)
+{
+	const unsigned char *p = ps->p;
+	size_t len;
+
+	if (*p < 0x80 || (ps->flags & CMN_STRING_REGEX_BYTES)) {
+		ps->p++;
+		return *p;
+	}
+	len = CmnString_Utf8ValidLength((const char *)p, (size_t)(ps->end - p) < 4 ? (size_t)(ps->end - p) : 4);
+	if (len >= 2 && *p < 0xE0) {
+		ps->p += 2;
+		return ((p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+	}
+	if (len >= 3 && *p < 0xF0) {
+		ps->p += 3;
+		return ((p[0] & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+	}
+	if (len >= 4) {
+		ps->p += 4;
+		return ((p[0] & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+	}
+	/* 不正なバイトは、そのバイトのみに一致させる（文字として扱わない） */
+	ps->p++;
+	return 0x80000000U | *p;
+}
+
+/** 文字クラス（[...]） */
+static int parseClass(Parser *ps)
+{
+	Range ranges[CLASS_RANGE_MAX];
+	int count = 0;
+	int negate = False;
+	int first = True;
+
+	if (ps->p < ps->end && *ps->p == '^') {
+		negate = True;
+		ps->p++;
+	}
+
+	while (True) {
+		unsigned int lo, hi;
+		if (ps->p >= ps->end) {
+			ps->error = "missing ']'";
+			return -1;
+		}
+		/* 先頭の']'は文字として扱う */
+		if (*ps->p == ']' && !first) {
+			ps->p++;
+			break;
+		}
+		first = False;
+
+		if (*ps->p == '\\') {
+			int ch, ret;
+			ps->p++;
+			if (ps->p >= ps->end) {
+				ps->error = "missing ']'";
+				return -1;
+			}
+			ret = parseEscapeClass(ps, *ps->p, ranges, &count);
+			if (ret > 0) {
+				ps->p++;
+				continue;
+			}
+			if (ret < 0) {
+				ps->error = "negated escape in class is not supported";
+				return -1;
+			}
+			ch = parseEscapeChar(ps, *ps->p);
+			if (ch < 0) {
+				return -1;
+			}
+			lo = (unsigned int)ch;
+		}
+		else {
+			lo = parseChar(ps);
+		}
+
+		hi = lo;
+		if (ps->end - ps->p >= 2 && *ps->p == '-' && ps->p[1] != ']') {
+			ps->p++;
+			if (*ps->p == '\\') {
+				int ch;
+				ps->p++;
+				if (ps->p >= ps->end) {
+					ps->error = "missing ']'";
+					return -1;
+				}
+				ch = parseEscapeChar(ps, *ps->p);
+				if (ch < 0) {
+					return -1;
+				}
+				hi = (unsigned int)ch;
+			}
+			else {
+				hi = parseChar(ps);
+			}
+			if (hi < lo || ((lo | hi) & 0x80000000U)) {
+				ps->error = "invalid class range";
+				return -1;
+			}
+		}
+		if (addRange(ps, ranges, &count, lo, hi) != 0) {
+			return -1;
+		}
+	}
+
+	return classNode(ps, ranges, count, negate);
+}
+
+/** 文字クラスへの範囲追加 */
+static int addRange(Parser *ps, Range *ranges, int *count, unsigned int lo, unsigned int hi)
+{
+	if (CLASS_RANGE_MAX <= *count) {
+		ps->error = "too many class ranges";
+		return -1;
+	}
+	ranges[*count].lo = lo;
+	ranges[*count].hi = hi;
+	(*count)++;
+	return 0;
+}
+
+/** 範囲の比較（qsort用） */
+static int compareRange(const void *a, const void *b)
+{
+	const Range *ra = a, *rb = b;
+	return (ra->lo < rb->lo) ? -1 : (ra->lo > rb->lo);
+}
+
+/**
+ * @brief 文字クラスのノード作成
+ *
+ *  文字の範囲の集合を、1バイトの集合の連接・選択に変換する。
+ *  UTF-8の場合、0x80以上の文字はUTF-8のバイト列の範囲に分解する。
+ */
+static int classNode(Parser *ps, Range *ranges, int count, int negate)
+{
+	Range work[CLASS_RANGE_MAX * 3 + 1];
+	unsigned int raw[8] = { 0 };
+	unsigned int max = (ps->flags & CMN_STRING_REGEX_BYTES) ? 0xFF : UNICODE_MAX;
+	int n = 0, m, i;
+	int node = -1;
+	int ascii;
+
+	for (i = 0; i < count; i++) {
+		/* 不正なUTF-8のバイト（parseCharで上位ビットを立てたもの）は、そのバイトのみに一致させる */
+		if (ranges[i].lo & 0x80000000U) {
+			raw[(ranges[i].lo & 0xFF) >> 5] |= 1U << (ranges[i].lo & 31);
+			continue;
+		}
+		work[n++] = ranges[i];
+		/* 大文字小文字を区別しない場合は、英字の大文字/小文字の範囲を追加 */
+		if (ps->flags & CMN_STRING_REGEX_IGNORE_CASE) {
+			unsigned int lo = ranges[i].lo < 'A' ? 'A' : ranges[i].lo;
+			unsigned int hi = ranges[i].hi > 'Z' ? 'Z' : ranges[i].hi;
+			if (lo <= hi) {
+				work[n].lo = lo + 0x20;
+				work[n++].hi = hi + 0x20;
+			}
+			lo = ranges[i].lo < 'a' ? 'a' : ranges[i].lo;
+			hi = ranges[i].hi > 'z' ? 'z' : ranges[i].hi;
+			if (lo <= hi) {
+				work[n].lo = lo - 0x20;
+				work[n++].hi = hi - 0x20;
+			}
+		}
+	}
+
+	/* 整列して重なりを統合 */
+	qsort(work, n, sizeof(Range), compareRange);
+	m = 0;
+	for (i = 0; i < n; i++) {
+		if (m > 0 && work[i].lo <= work[m - 1].hi + 1) {
+			if (work[m - 1].hi < work[i].hi) {
+				work[m - 1].hi = work[i].hi;
+			}
+		}
+		else {
+			work[m++] = work[i];
+		}
+	}
+	n = m;
+
+	/* 否定の場合は補集合にする */
+	if (negate) {
+		unsigned int next = 0;
+		Range tmp[CLASS_RANGE_MAX * 3 + 2];
+		m = 0;
+		for (i = 0; i < n; i++) {
+			if (next < work[i].lo) {
+				tmp[m].lo = next;
+				tmp[m++].hi = work[i].lo - 1;
+			}
+			next = work[i].hi + 1;
+		}
+		if (next <= max) {
+			tmp[m].lo = next;
+			tmp[m++].hi = max;
+		}
+		memcpy(work, tmp, sizeof(Range) * m);
+		n = m;
+	}
+
+	/* 1バイト文字の部分は1つの集合にまとめる */
+	ascii = newNode(ps, NODE_SET);
+	if (ascii < 0) {
+		return -1;
+	}
+	memcpy(ps->nodes[ascii].set, raw, sizeof(raw));
+	for (i = 0; i < n; i++) {
+		unsigned int c;
+		unsigned int limit = (ps->flags & CMN_STRING_REGEX_BYTES) ? 0xFF : 0x7F;
+		for (c = work[i].lo; c <= work[i].hi && c <= limit; c++) {
+			ps->nodes[ascii].set[c >> 5] |= 1U << (c & 31);
+		}
+	}
+	node = ascii;
+
+	/* マルチバイト文字の部分 */
+	if (!(ps->flags & CMN_STRING_REGEX_BYTES)) {
+		for (i = 0; i < n; i++) {
+			unsigned int lo = work[i].lo < 0x80 ? 0x80 : work[i].lo;
+			if (lo <= work[i].hi) {
+				node = joinNode(ps, NODE_ALT, node, utf8RangeNode(ps, lo, work[i].hi));
+				if (node < 0) {
+					return -1;
+				}
+			}
+		}
+	}
+	return node;
+}
+
+/** 1バイトの範囲の集合ノード作成 */
+static int byteNode(Parser *ps, unsigned int lo, unsigned int hi)
+{
+	int node = newNode(ps, NODE_SET);
+	unsigned int c;
+	if (node < 0) {
+		return -1;
+	}
+	for (c = lo; c <= hi; c++) {
+		ps->nodes[node].set[c >> 5] |= 1U << (c & 31);
+	}
+	return node;
+}
+
+/** コードポイントをUTF-8に変換 */
+static int encodeUtf8(unsigned int c, unsigned char *buf)
+{
+	if (c < 0x800) {
+		buf[0] = (unsigned char)(0xC0 | (c >> 6));
+		buf[1] = (unsigned char)(0x80 | (c & 0x3F));
+		return 2;
+	}
+	if (c < 0x10000) {
+		buf[0] = (unsigned char)(0xE0 | (c >> 12));
+		buf[1] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+		buf[2] = (unsigned char)(0x80 | (c & 0x3F));
+		return 3;
+	}
+	buf[0] = (unsigned char)(0xF0 | (c >> 18));
+	buf[1] = (unsigned char)(0x80 | ((c >> 12) & 0x3F));
+	buf[2] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+	buf[3] = (unsigned char)(0x80 | (c & 0x3F));
+	return 4;
+}
+
+/**
+ * @brief UTF-8の範囲のノード作成
+ *
+ *  コードポイントの範囲（0x80以上）を、各バイトが範囲で表せるUTF-8のバイト列の選択に分解する。
+ */
+static int utf8RangeNode(Parser *ps, unsigned int lo, unsigned int hi)
+{
+	static const unsigned int bounds[] = { 0x7FF, 0xFFFF };
+	unsigned char blo[4], bhi[4];
+	int i, n, node;
+
+	/* サロゲートは除外 */
+	if (lo <= 0xDFFF && 0xD800 <= hi) {
+		if (lo < 0xD800 && 0xDFFF < hi) {
+			return joinNode(ps, NODE_ALT, utf8RangeNode(ps, lo, 0xD7FF), utf8RangeNode(ps, 0xE000, hi));
+		}
+		if (lo < 0xD800) {
+			return utf8RangeNode(ps, lo, 0xD7FF);
+		}
+		if (0xDFFF < hi) {
+			return utf8RangeNode(ps, 0xE000, hi);
+		}
+		return byteNode(ps, 1, 0);	/* 空集合 */
+	}
+
+	/* バイト数が異なる範囲は分割 */
+	for (i = 0; i < 2; i++) {
+		if (lo <= bounds[i] && bounds[i] < hi) {
+			return joinNode(ps, NODE_ALT, utf8RangeNode(ps, lo, bounds[i]), utf8RangeNode(ps, bounds[i] + 1, hi));
+		}
+	}
+
+	/* 下位バイトが全範囲を取らない部分を分割 */
+	n = encodeUtf8(lo, blo);
+	for (i = 1; i < n; i++) {
+		unsigned int m = (1U << (6 * i)) - 1;
+		if ((lo & ~m) != (hi & ~m)) {
+			if ((lo & m) != 0) {
+				return joinNode(ps, NODE_ALT, utf8RangeNode(ps, lo, lo | m), utf8RangeNode(ps, (lo | m) + 1, hi));
+			}
+			if ((hi & m) != m) {
+				return joinNode(ps, NODE_ALT, utf8RangeNode(ps, lo, (hi & ~m) - 1), utf8RangeNode(ps, hi & ~m, hi));
+			}
+		}
+	}
+
+	/* 各バイトの範囲の連接 */
+	encodeUtf8(hi, bhi);
+	node = byteNode(ps, blo[0], bhi[0]);
+	for (i = 1; i < n; i++) {
+		node = joinNode(ps, NODE_CONCAT, node, byteNode(ps, blo[i], bhi[i]));
+	}
+	return node;
+}
+
+/* ========================================================================
+ * NFA生成
+ * ======================================================================== */
+
+/** NFAの状態追加 */
+static int newState(CmnStringRegex *re, int type, int out, int out1)
+{
+	NfaState *st;
+	if ((type != NFA_MATCH && out < 0) || (type == NFA_SPLIT && out1 < 0)) {
+		return -1;
+	}
+	if (re->nfaCount == re->nfaCap) {
+		int cap = (re->nfaCap == 0) ? 64 : re->nfaCap * 2;
+		NfaState *tmp;
+		if (NFA_STATE_MAX < cap) {
+			cap = NFA_STATE_MAX;
+		}
+		if (cap <= re->nfaCount) {
+			return -1;
+		}
+		tmp = realloc(re->nfa, sizeof(NfaState) * cap);
+		if (tmp == NULL) {
+			return -1;
+		}
+		re->nfa = tmp;
+		re->nfaCap = cap;
+	}
+	st = &re->nfa[re->nfaCount];
+	memset(st, 0, sizeof(NfaState));
+	st->type = type;
+	st->out = out;
+	st->out1 = out1;
+	return re->nfaCount++;
+}
+
+/**
+ * @brief 構文木のNFA変換
+ *
+ *  nodeに一致した後にnextへ遷移するNFAを後ろから組み立て、その開始状態を返す。
+ *
+ * @return 開始状態, エラー:-1
+ */
+static int compileNode(CmnStringRegex *re, const Parser *ps, int node, int next)
+{
+	const Node *nd = &ps->nodes[node];
+	int st, i;
+
+	if (next < 0) {
+		return -1;
+	}
+
+	switch (nd->type) {
+	case NODE_SET:
+		st = newState(re, NFA_SET, next, -1);
+		if (st >= 0) {
+			memcpy(re->nfa[st].set, nd->set, sizeof(nd->set));
+		}
+		return st;
+	case NODE_CONCAT:
+		return compileNode(re, ps, nd->left, compileNode(re, ps, nd->right, next));
+	case NODE_ALT:
+		{
+			int left = compileNode(re, ps, nd->left, next);
+			return newState(re, NFA_SPLIT, left, compileNode(re, ps, nd->right, next));
+		}
+	case NODE_REPEAT:
+		st = next;
+		if (nd->max < 0) {
+			/* 無制限：分岐→本体→分岐 のループ */
+			int split = newState(re, NFA_SPLIT, next, next);
+			int body;
+			if (split < 0) {
+				return -1;
+			}
+			body = compileNode(re, ps, nd->left, split);
+			if (body < 0) {
+				return -1;
+			}
+			re->nfa[split].out = body;
+			st = split;
+		}
+		else {
+			/* 省略可能な部分：(a(a)?)? の形に展開 */
+			for (i = nd->min; i < nd->max; i++) {
+				st = newState(re, NFA_SPLIT, compileNode(re, ps, nd->left, st), next);
+				if (st < 0) {
+					return -1;
+				}
+			}
+		}
+		/* 必須の部分 */
+		for (i = 0; i < nd->min; i++) {
+			st = compileNode(re, ps, nd->left, st);
+			if (st < 0) {
+				return -1;
+			}
+		}
+		return st;
+	case NODE_BOL:
+		return newState(re, NFA_BOL, next, -1);
+	case NODE_EOL:
+		return newState(re, NFA_EOL, next, -1);
+	default:
+		return next;
+	}
+}
+
+/**
+ * @brief バイトクラスの作成
+ *
+ *  NFAのどの集合でも区別されないバイトを同じクラスにまとめ、DFAの遷移表を小さくする。
+ */
+static void buildByteClass(CmnStringRegex *re)
+{
+	int i, c;
+	int count = 1;
+
+	memset(re->classMap, 0, sizeof(re->classMap));
+	for (i = 0; i < re->nfaCount; i++) {
+		unsigned char newId[256][2];
+		unsigned char used[256][2];
+		int newCount = 0;
+		if (re->nfa[i].type != NFA_SET) {
+			continue;
+		}
+		/* (現在のクラス, 集合に含まれるか) の組で細分化 */
+		memset(used, 0, sizeof(used));
+		for (c = 0; c < 256; c++) {
+			int in = (re->nfa[i].set[c >> 5] >> (c & 31)) & 1;
+			int cls = re->classMap[c];
+			if (!used[cls][in]) {
+				used[cls][in] = 1;
+				newId[cls][in] = (unsigned char)newCount++;
+			}
+			re->classMap[c] = newId[cls][in];
+		}
+		count = newCount;
+	}
+	for (c = 255; c >= 0; c--) {
+		re->classRep[re->classMap[c]] = (unsigned char)c;
+	}
+	re->classCount = count;
+}
+
+/**
+ * @brief 先頭の固定文字列の抽出
+ *
+ *  パターンの先頭から、1バイトに限定される要素が続く部分を取り出す。
+ *  大文字小文字を区別しない場合は英字の大文字/小文字の組も1文字とみなし、小文字で格納する。
+ */
+static void extractPrefix(CmnStringRegex *re, const Parser *ps, int node, CmnStringBuffer *prefix, int *complete)
+{
+	const Node *nd = &ps->nodes[node];
+
+	if (!*complete) {
+		return;
+	}
+	if (nd->type == NODE_CONCAT) {
+		extractPrefix(re, ps, nd->left, prefix, complete);
+		extractPrefix(re, ps, nd->right, prefix, complete);
+		return;
+	}
+	if (nd->type == NODE_SET) {
+		int c, found = -1, bits = 0;
+		for (c = 0; c < 256; c++) {
+			if ((nd->set[c >> 5] >> (c & 31)) & 1) {
+				bits++;
+				if (found < 0) {
+					found = c;
+				}
+			}
+		}
+		if (bits == 1 && found != '\0') {
+			char ch = (char)found;
+			CmnStringBuffer_AppendN(prefix, &ch, 1);
+			return;
+		}
+		if (bits == 2 && (re->flags & CMN_STRING_REGEX_IGNORE_CASE) && 'A' <= found && found <= 'Z'
+				&& ((nd->set[(found + 0x20) >> 5] >> ((found + 0x20) & 31)) & 1)) {
+			char ch = (char)(found + 0x20);
+			CmnStringBuffer_AppendN(prefix, &ch, 1);
+			return;
+		}
+	}
+	*complete = False;
+}
+
+/** 先頭の固定文字列の検索 */
+static const char* findPrefix(const CmnStringRegex *re, const char *p, const char *end)
+{
+	size_t len = (size_t)(end - p);
+
+	if (len < re->prefixLen) {
+		return NULL;
+	}
+	if (re->flags & CMN_STRING_REGEX_IGNORE_CASE) {
+		return CmnString_FindIgnoreCase(p, len, re->prefix, re->prefixLen);
+	}
+	while (True) {
+		p = memchr(p, re->prefix[0], (size_t)(end - p) - re->prefixLen + 1);
+		if (p == NULL) {
+			return NULL;
+		}
+		if (memcmp(p + 1, re->prefix + 1, re->prefixLen - 1) == 0) {
+			return p;
+		}
+		p++;
+		if ((size_t)(end - p) < re->prefixLen) {
+			return NULL;
+		}
+	}
+}
+
+/* ========================================================================
+ * 遅延DFA
+ * ======================================================================== */
+
+/**
+ * @brief 空遷移の閉包
+ *
+ *  startから空遷移でたどれる状態のうち、バイトを読む状態・受理状態・末尾判定の状態をre->workに追加する。
+ *  re->markGenが同じ間に追加済みの状態は追加しない。
+ */
+static void closure(CmnStringRegex *re, int start, int atStart, int atEnd)
+{
+	int sp = 0;
+	re->stack[sp++] = start;
+
+	while (sp > 0) {
+		int s = re->stack[--sp];
+		const NfaState *st;
+		if (s < 0 || re->mark[s] == re->markGen) {
+			continue;
+		}
+		re->mark[s] = re->markGen;
+		st = &re->nfa[s];
+		switch (st->type) {
+		case NFA_SPLIT:
+			re->stack[sp++] = st->out1;
+			re->stack[sp++] = st->out;
+			break;
+		case NFA_BOL:
+			if (atStart) {
+				re->stack[sp++] = st->out;
+			}
+			break;
+		case NFA_EOL:
+			re->work[re->workCount++] = s;
+			if (atEnd) {
+				re->stack[sp++] = st->out;
+			}
+			break;
+		default:
+			re->work[re->workCount++] = s;
+			break;
+		}
+	}
+}
+
+/** int比較（qsort用） */
+static int compareInt(const void *a, const void *b)
+{
+	int ia = *(const int *)a, ib = *(const int *)b;
+	return (ia < ib) ? -1 : (ia > ib);
+}
+
+/** DFAの初期化（開始状態の生成） */
+static int dfaInit(CmnStringRegex *re, Dfa *dfa, int searchMode)
+{
+	dfa->searchMode = searchMode;
+	dfa->tableSize = 64;
+	dfa->table = calloc(dfa->tableSize, sizeof(int));
+	if (dfa->table == NULL) {
+		return -1;
+	}
+
+	re->markGen++;
+	re->workCount = 0;
+	closure(re, re->nfaStart, True, False);
+	dfa->start = dfaAdd(re, dfa);
+
+	re->markGen++;
+	re->workCount = 0;
+	closure(re, re->nfaStart, False, False);
+	dfa->restart = dfaAdd(re, dfa);
+
+	if (dfa->start < 0 || dfa->restart < 0) {
+		dfaFree(dfa);
+		return -1;
+	}
+	return 0;
+}
+
+/** DFAの解放 */
+static void dfaFree(Dfa *dfa)
+{
+	int i;
+	for (i = 0; i < dfa->count; i++) {
+		free(dfa->states[i].next);
+	}
+	free(dfa->states);
+	free(dfa->table);
+	memset(dfa, 0, sizeof(Dfa));
+}
+
+/**
+ * @brief DFAの状態追加
+ *
+ *  re->workのNFAの状態集合に対応するDFAの状態を返す。未生成の場合は生成する。
+ *
+ * @return 状態番号, エラー:-1
+ */
+static int dfaAdd(CmnStringRegex *re, Dfa *dfa)
+{
+	unsigned long long hash;
+	int mask = dfa->tableSize - 1;
+	int pos, i;
+	DfaState *st;
+	size_t size;
+
+	qsort(re->work, re->workCount, sizeof(int), compareInt);
+	hash = CmnData_Hash(re->work, sizeof(int) * re->workCount);
+
+	/* 生成済みの状態を検索 */
+	for (pos = (int)(hash & mask); dfa->table[pos] != 0; pos = (pos + 1) & mask) {
+		st = &dfa->states[dfa->table[pos] - 1];
+		if (st->count == re->workCount && memcmp(st->list, re->work, sizeof(int) * re->workCount) == 0) {
+			return dfa->table[pos] - 1;
+		}
+	}
+
+	/* 状態を追加（遷移表とNFAの状態の一覧は1つの領域に確保） */
+	if (dfa->count == dfa->cap) {
+		int cap = (dfa->cap == 0) ? 64 : dfa->cap * 2;
+		DfaState *tmp = realloc(dfa->states, sizeof(DfaState) * cap);
+		if (tmp == NULL) {
+			return -1;
+		}
+		dfa->states = tmp;
+		dfa->cap = cap;
+	}
+	st = &dfa->states[dfa->count];
+	size = sizeof(int) * (re->classCount + re->workCount);
+	st->next = malloc(size);
+	if (st->next == NULL) {
+		return -1;
+	}
+	memset(st->next, 0xFF, sizeof(int) * re->classCount);
+	st->list = st->next + re->classCount;
+	memcpy(st->list, re->work, sizeof(int) * re->workCount);
+	st->count = re->workCount;
+	st->flags = 0;
+	st->matchId = st->matchIdAtEnd = -1;
+	dfa->memUsed += size + sizeof(DfaState) + sizeof(int) * 2;
+
+	/* 受理判定 */
+	for (i = 0; i < st->count; i++) {
+		const NfaState *nst = &re->nfa[st->list[i]];
+		if (nst->type == NFA_MATCH && (st->matchId < 0 || nst->out1 < st->matchId)) {
+			st->flags |= DFA_MATCH;
+			st->matchId = nst->out1;
+		}
+	}
+	if (st->count == 0) {
+		st->flags |= DFA_DEAD;
+	}
+
+	/* 末尾での受理判定（末尾判定の状態の先をたどる） */
+	{
+		int n = re->workCount;
+		re->markGen++;
+		for (i = 0; i < n; i++) {
+			if (re->nfa[st->list[i]].type == NFA_EOL || re->nfa[st->list[i]].type == NFA_MATCH) {
+				closure(re, st->list[i], False, True);
+			}
+		}
+		for (i = n; i < re->workCount; i++) {
+			const NfaState *nst = &re->nfa[re->work[i]];
+			if (nst->type == NFA_MATCH && (st->matchIdAtEnd < 0 || nst->out1 < st->matchIdAtEnd)) {
+				st->flags |= DFA_MATCH_AT_END;
+				st->matchIdAtEnd = nst->out1;
+			}
+		}
+		re->workCount = n;
+	}
+
+	/* ハッシュ表に登録（使用率が1/2を超える場合は拡張） */
+	dfa->count++;
+	if (dfa->tableSize < dfa->count * 2) {
+		int newSize = dfa->tableSize * 2;
+		int *table = calloc(newSize, sizeof(int));
+		if (table == NULL) {
+			dfa->count--;
+			free(st->next);
+			return -1;
+		}
+		for (i = 0; i < dfa->count; i++) {
+			unsigned long long h = CmnData_Hash(dfa->states[i].list, sizeof(int) * dfa->states[i].count);
+			for (pos = (int)(h & (newSize - 1)); table[pos] != 0; pos = (pos + 1) & (newSize - 1)) {
+			}
+			table[pos] = i + 1;
+		}
+		free(dfa->table);
+		dfa->table = table;
+		dfa->tableSize = newSize;
+	}
+	else {
+		for (pos = (int)(hash & mask); dfa->table[pos] != 0; pos = (pos + 1) & mask) {
+		}
+		dfa->table[pos] = dfa->count;
+	}
+	return dfa->count - 1;
+}
+
+/**
+ * @brief DFAの遷移先の生成
+ *
+ *  状態curからバイトクラスclsで遷移する先の状態を生成し、遷移表に登録する。<br>
+ *  キャッシュが上限を超えた場合は、すべての状態を破棄してから生成する（curは無効になる）。
+ *
+ * @return 遷移先の状態番号, エラー:-1
+ */
+static int dfaNext(CmnStringRegex *re, Dfa *dfa, int cur, int cls)
+{
+	unsigned int c = re->classRep[cls];
+	const DfaState *st = &dfa->states[cur];
+	int i, next;
+
+	/* 遷移先のNFAの状態集合 */
+	re->markGen++;
+	re->workCount = 0;
+	for (i = 0; i < st->count; i++) {
+		const NfaState *nst = &re->nfa[st->list[i]];
+		if (nst->type == NFA_SET && ((nst->set[c >> 5] >> (c & 31)) & 1)) {
+			closure(re, nst->out, False, False);
+		}
+	}
+	/* 部分一致の場合は次の位置から照合を開始する状態を加える */
+	if (dfa->searchMode) {
+		closure(re, re->nfaStart, False, False);
+	}
+
+	/* キャッシュが上限を超えた場合は破棄（開始状態は作り直す） */
+	if (DFA_CACHE_SIZE < dfa->memUsed) {
+		int *save = malloc(sizeof(int) * (re->workCount + 1));
+		int saveCount = re->workCount;
+		int searchMode = dfa->searchMode;
+		if (save == NULL) {
+			return -1;
+		}
+		memcpy(save, re->work, sizeof(int) * saveCount);
+		dfaFree(dfa);
+		if (dfaInit(re, dfa, searchMode) != 0) {
+			free(save);
+			return -1;
+		}
+		memcpy(re->work, save, sizeof(int) * saveCount);
+		re->workCount = saveCount;
+		free(save);
+		return dfaAdd(re, dfa);
+	}
+
+	next = dfaAdd(re, dfa);
+	if (next >= 0) {
+		dfa->states[cur].next[cls] = next;
+	}
+	return next;
+}
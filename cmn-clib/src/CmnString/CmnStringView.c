@@ -0,0 +1,255 @@
+/** @file *********************************************************************
+ * @brief 文字列ビュー 共通関数
+ *
+ *  文字列の一部を先頭位置と長さ（CmnStringView）で表し、複写や'\0'の書き込みを行わずに扱う共通関数。<br>
+ *  設定ファイル等の1行を、1回の走査でトリム済みのキーと値に分割する用途を想定している。<br>
+ *  空白文字はスペース、タブ、改行（\\r \\n）、\\v、\\fとする（CmnString_Trim等はスペースのみ）。
+ *  SSE2が使用できる場合は、空白文字の読み飛ばしを16バイト単位で行う。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @author H.Kumagai
+ * @date   2026-10-19
+ *****************************************************************************/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"cmnclib/Common.h"
+#include"cmnclib/CmnString.h"
+#include"cmnclib/CmnLog.h"
+#include"../CmnBit.h"
+
+#ifdef CMN_CLIB_USE_SSE2
+  #include<emmintrin.h>
+#endif
+
+/** 空白文字か（' ', '\t', '\n', '\v', '\f', '\r'） */
+#define IS_SPACE(c)  ((c) == ' ' || (unsigned char)((c) - '\t') <= '\r' - '\t')
+
+static const char* skipSpace(const char *p, const char *end);
+static const char* skipSpaceBack(const char *begin, const char *end);
+static const char* findEol(const char *p, const char *end);
+#ifdef CMN_CLIB_USE_SSE2
+static unsigned int spaceMask16(const char *p);
+#endif
+
+/**
+ * @brief 左側トリム（ビュー）
+ *
+ *  文字列の左側の空白文字を除いた部分を取得する。文字列は変更しない。
+ *
+ * @param str 対象文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param view (O) 空白文字を除いた部分
+ * @return viewを返す
+ */
+CmnStringView* CmnString_LTrimView(const char *str, size_t len, CmnStringView *view)
+{
+	const char *begin = skipSpace(str, str + len);
+	view->str = begin;
+	view->len = len - (size_t)(begin - str);
+	return view;
+}
+
+/**
+ * @brief 右側トリム（ビュー）
+ *
+ *  文字列の右側の空白文字を除いた部分を取得する。文字列は変更しない。
+ *
+ * @param str 対象文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param view (O) 空白文字を除いた部分
+ * @return viewを返す
+ */
+CmnStringView* CmnString_RTrimView(const char *str, size_t len, CmnStringView *view)
+{
+	view->str = str;
+	view->len = (size_t)(skipSpaceBack(str, str + len) - str);
+	return view;
+}
+
+/**
+ * @brief トリム（ビュー）
+ *
+ *  文字列の両側の空白文字を除いた部分を取得する。文字列は変更しない。<br>
+ *  両端の空白文字のみを読むため、処理時間は文字列全体の長さによらない。
+ *
+ * @param str 対象文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param view (O) 空白文字を除いた部分
+ * @return viewを返す
+ */
+CmnStringView* CmnString_TrimView(const char *str, size_t len, CmnStringView *view)
+{
+	const char *end = str + len;
+	const char *begin = skipSpace(str, end);
+	end = skipSpaceBack(begin, end);
+	view->str = begin;
+	view->len = (size_t)(end - begin);
+	return view;
+}
+
+/**
+ * @brief キーと値への分割
+ *
+ *  "キー 区切り文字 値"の形式の文字列を、最初の区切り文字で分割し、それぞれ両側の空白文字を除いた部分を取得する。<br>
+ *  区切り文字の検索とトリムを合わせて、文字列を1回走査するのみで分割できる。
+ *
+ * @param str 対象文字列。'\0'で終端している必要はない。
+ * @param len strのバイト数
+ * @param delim 区切り文字
+ * @param key (O) キー
+ * @param value (O) 値
+ * @return 正常:0, 区切り文字がない場合:-1（key, valueは変更しない）
+ */
+int CmnString_SplitKeyValue(const char *str, size_t len, char delim, CmnStringView *key, CmnStringView *value)
+{
+	const char *pos = memchr(str, delim, len);
+	if (pos == NULL) {
+		return -1;
+	}
+	CmnString_TrimView(str, (size_t)(pos - str), key);
+	CmnString_TrimView(pos + 1, len - (size_t)(pos + 1 - str), value);
+	return 0;
+}
+
+/**
+ * @brief 1行の切り出し（ビュー）
+ *
+ *  先頭から最初の改行コードの手前までを1行として取得する。文字列は変更しない。<br>
+ *  改行コードはCmnString_StrEolと同じく、CRLF、LF、CRのいずれも1つの改行として扱う。
+ *  改行コードがない場合は全体を1行とする。<br>
+ *  戻り値の分だけ進めて繰り返し呼び出すことで、メモリ上のテキストを1行ずつ処理できる。
+ *
+ * @param str 対象文字列。'\0'で終端している必要はない。
+ * @param len strの長さ
+ * @param line (O) 改行コードを除いた1行
+ * @return 改行コードを含めた1行のバイト数（次の行の先頭までの長さ）
+ */
+size_t CmnString_LineView(const char *str, size_t len, CmnStringView *line)
+{
+	const char *end = str + len;
+	const char *eol = findEol(str, end);
+
+	line->str = str;
+	line->len = (size_t)(eol - str);
+	if (eol == end) {
+		return len;
+	}
+	if (*eol == '\r' && eol + 1 < end && eol[1] == '\n') {
+		return line->len + 2;
+	}
+	return line->len + 1;
+}
+
+/**
+ * @brief ビューの複写（動的メモリ確保）
+ *
+ *  ビューの示す部分を'\0'で終端した文字列として複写する。
+ *
+ * @param view ビュー
+ * @return 複写した文字列。メモリ不足の場合はNULL。使用後はfreeで解放すること。
+ */
+char* CmnStringView_CopyNew(const CmnStringView *view)
+{
+	char *buf = malloc(view->len + 1);
+	if (buf != NULL) {
+		memcpy(buf, view->str, view->len);
+		buf[view->len] = '\0';
+	}
+	return buf;
+}
+
+/**
+ * @brief ビューと文字列の比較
+ *
+ * @param view ビュー
+ * @param str 比較する文字列
+ * @return 一致:True, 不一致:False
+ */
+int CmnStringView_Equals(const CmnStringView *view, const char *str)
+{
+	return strncmp(view->str, str, view->len) == 0 && str[view->len] == '\0';
+}
+
+/**
+ * @brief 空白文字の読み飛ばし
+ * @return 最初の空白文字以外の位置（すべて空白文字の場合はend）
+ */
+static const char* skipSpace(const char *p, const char *end)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	while (end - p >= 16) {
+		unsigned int mask = ~spaceMask16(p) & 0xFFFF;
+		if (mask != 0) {
+			return p + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && IS_SPACE(*p)) {
+		p++;
+	}
+	return p;
+}
+
+/**
+ * @brief 末尾の空白文字の読み飛ばし
+ * @return 最後の空白文字以外の次の位置（すべて空白文字の場合はbegin）
+ */
+static const char* skipSpaceBack(const char *begin, const char *end)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	while (end - begin >= 16) {
+		unsigned int mask = ~spaceMask16(end - 16) & 0xFFFF;
+		if (mask != 0) {
+			return end - 16 + lastBit(mask) + 1;
+		}
+		end -= 16;
+	}
+#endif
+	while (begin < end && IS_SPACE(end[-1])) {
+		end--;
+	}
+	return end;
+}
+
+/**
+ * @brief 改行コード（CRもしくはLF）の検索
+ * @return 最初に出現したCRもしくはLFの位置。出現しない場合はend。
+ */
+static const char* findEol(const char *p, const char *end)
+{
+#ifdef CMN_CLIB_USE_SSE2
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	while (end - p >= 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+		if (mask != 0) {
+			return p + firstBit(mask);
+		}
+		p += 16;
+	}
+#endif
+	while (p < end && *p != '\r' && *p != '\n') {
+		p++;
+	}
+	return p;
+}
+
+#ifdef CMN_CLIB_USE_SSE2
+/**
+ * @brief 16バイト中の空白文字の位置
+ * @return 空白文字のバイトに対応するビットを立てたマスク
+ */
+static unsigned int spaceMask16(const char *p)
+{
+	__m128i v = _mm_loadu_si128((const __m128i *)p);
+	__m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+	/* '\t'～'\r'は、'\t'を引いた値が（符号なしで）4以下 */
+	__m128i ctrl = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+	ctrl = _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8('\r' - '\t')), ctrl);
+	return (unsigned int)_mm_movemask_epi8(_mm_or_si128(space, ctrl));
+}
+#endif
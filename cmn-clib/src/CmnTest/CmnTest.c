@@ -51,7 +51,7 @@
 #include"cmnclib/CmnLog.h"
 
 #define REPORT_BUF_SIZE_OF_DUMP 1024
-#define REPORT_BUF_SIZE_OF_ONE_CALSE 4096
+#define REPORT_SIZE_OF_OK_CASE 72
 
 static void cutAndCopyDumpText(char *buf, const char *str, size_t bufSize);
 
@@ -100,14 +100,16 @@ void CmnTest_Run(CmnTestPlan *plan, int realtimeReport)
 {
 	CmnTestCase *testCase;
 
-	char reportTmp[REPORT_BUF_SIZE_OF_ONE_CALSE];
+	CmnStringBuffer *report;
+	size_t caseStart;
 	char expectedTmp[REPORT_BUF_SIZE_OF_DUMP];
 	char actualTmp[REPORT_BUF_SIZE_OF_DUMP];
 	int i = 0;
 	CMNLOG_TRACE_START();
 
 	/* レポートの初期化 */
-	plan->report = calloc(plan->caseList->size * REPORT_BUF_SIZE_OF_ONE_CALSE, sizeof(char));
+	report = CmnStringBuffer_Create(NULL);
+	CmnStringBuffer_Reserve(report, plan->caseList->size * REPORT_SIZE_OF_OK_CASE);
 
 	/* テスト開始時間記録 */
 	CmnTimeDateTime_SetNow(&plan->startTime);
@@ -117,10 +119,11 @@ void CmnTest_Run(CmnTestPlan *plan, int realtimeReport)
 		testCase = CmnDataList_Get(plan->caseList, i);
 		testCase->testFunction(testCase);
 
-		/* テスト実行結果作成 */
+		/* テスト実行結果作成（レポートに直接書き込む） */
+		caseStart = report->length;
 		if (testCase->result) {
 			/* Test OK */
-			sprintf(reportTmp,
+			CmnStringBuffer_AppendFormat(report,
 					"File[%-30s] Case[%-30s] OK\n",
 					testCase->testFileName, testCase->testCaseName);
 		}
@@ -128,7 +131,7 @@ void CmnTest_Run(CmnTestPlan *plan, int realtimeReport)
 			/* Test NG */
 			cutAndCopyDumpText(expectedTmp, testCase->expected, REPORT_BUF_SIZE_OF_DUMP);
 			cutAndCopyDumpText(actualTmp, testCase->actual, REPORT_BUF_SIZE_OF_DUMP);
-			sprintf(reportTmp,
+			CmnStringBuffer_AppendFormat(report,
 					"File[%-30s] Case[%-30s] NG\n"
 					"    +- Line    %ld\n"
 					"    +- Expected[%s]\n"
@@ -138,14 +141,16 @@ void CmnTest_Run(CmnTestPlan *plan, int realtimeReport)
 					expectedTmp,
 					actualTmp);
 		}
-		strcat(plan->report, reportTmp);
 
 		/* テスト実行結果出力 */
 		if (realtimeReport) {
-			printf("%s", reportTmp);
+			fputs(report->string + caseStart, stdout);
 		}
 	}
 
+	plan->report = CmnString_StrCopyNew(report->string);
+	CmnStringBuffer_Free(report);
+
 	/* テスト終了時間記録 */
 	CmnTimeDateTime_SetNow(&plan->endTime);
 	CMNLOG_TRACE_END();
@@ -198,10 +203,10 @@ int CmnTest_AssertNumber(CmnTestCase *testCase, long line, long long actual, lon
 		char buf[64];
 		testCase->result = False;
 		testCase->lineOfNg = line;
-		sprintf(buf, "%lld", actual);
-		testCase->actual = CmnString_StrCatNew(buf, "");
-		sprintf(buf, "%lld", expected);
-		testCase->expected = CmnString_StrCatNew(buf, "");
+		CmnString_FormatInt(actual, buf);
+		testCase->actual = CmnString_StrCopyNew(buf);
+		CmnString_FormatInt(expected, buf);
+		testCase->expected = CmnString_StrCopyNew(buf);
 		CMNLOG_TRACE_END();
 		return False;
 	}
@@ -275,43 +280,6 @@ int CmnTest_AssertString(CmnTestCase *testCase, long line, char *actual, char *e
 	return True;
 }
 
-/*===========================================
- * TODO : 共通関数化すること　ここから
- *==========================================*/
-/** HEX変換に使用する文字群 */
-static const char hex_chars[] = "0123456789ABCDEF";
-/**
- * @brief 8bitデータをHEX形式の文字列に変換する.
- * @param buf    (0)   変換後のHEX文字列を格納するバッファ。<br>
- *   最低でも2byteの領域を有すること。
- * @param dat    (I)   変換対象のデータ
- * @author N.Ogasawara
- */
-void tohex8(char *buf, unsigned char dat)
-{
-	int mask = 0x0000000f;
-	int i;
-	for (i = 0; i < 2; i++) {
-		buf[1 - i] = hex_chars[(dat >> (i * 4)) & mask];
-	}
-}
-char* toHexString(void *data, size_t len)
-{
-	int i;
-	char *ret;
-	char *chData = data;
-	ret = malloc((len * 3) + 1);
-	for (i = 0; i < len; i++) {
-		tohex8(&ret[i * 3], chData[i]);
-		ret[(i * 3) + 2] = ' ';
-	}
-	ret[len * 3] = '\0';
-	return ret;
-}
-/*===========================================
- * TODO : 共通関数化すること　ここまで
- *==========================================*/
-
 /*
  * @brief 任意の型のデータを検証する
  * @param testCase テストケース
@@ -333,8 +301,10 @@ int CmnTest_AssertData(CmnTestCase *testCase, long line, void *actual, void *exp
 	if (memcmp(actual, expected, dataLen) != 0) {
 		testCase->result = False;
 		testCase->lineOfNg = line;
-		testCase->actual = toHexString(actual, dataLen);
-		testCase->expected = toHexString(expected, dataLen);
+		testCase->actual = malloc(dataLen * 2 + 1);
+		testCase->expected = malloc(dataLen * 2 + 1);
+		CmnString_HexEncode(actual, dataLen, True, testCase->actual);
+		CmnString_HexEncode(expected, dataLen, True, testCase->expected);
 		CMNLOG_TRACE_END();
 		return False;
 	}
@@ -3,6 +3,8 @@
  * @author H.Kumagai
  *****************************************************************************/
 
+#include <stdlib.h>
+
 #include "cmnclib/Common.h"
 #include "cmnclib/CmnThread.h"
 #include "cmnclib/CmnLog.h"
@@ -10,11 +12,20 @@
 #if IS_PRATFORM_WINDOWS()
 	#include <windows.h>
 	#include <process.h>
+	#include <limits.h>
 #else
 	#include <pthread.h>
+	#include <time.h>
+	#include <errno.h>
 #endif
 
 #if IS_PRATFORM_WINDOWS()
+/* InitOnceExecuteOnceのコールバックから初期化処理を呼び出すラッパ */
+static BOOL CALLBACK callOnceForWin(PINIT_ONCE once, PVOID param, PVOID *context) {
+	((void (*)(void))param)();
+	return TRUE;
+}
+
 /* 呼出規約「__stdcall」を吸収するラッパ */
 static unsigned int __stdcall callMethodForWin(void *arg) {
 	CmnThread *thread = (CmnThread *)arg;
@@ -162,7 +173,8 @@ CmnThreadMutex* CmnThreadMutex_Create()
 	CMNLOG_TRACE_START();
 
 #if IS_PRATFORM_WINDOWS()
-	tmp.mutexId = CreateMutex(NULL, FALSE, L"CmnThreadMutex");
+	/* 名前を付けるとプロセス内外の全てのMutexが同じオブジェクトになるため、名前なしで作成する */
+	tmp.mutexId = CreateMutex(NULL, FALSE, NULL);
 	if (tmp.mutexId == 0) {
 		CMNLOG_TRACE_END();
 		return NULL;
@@ -188,41 +200,35 @@ CmnThreadMutex* CmnThreadMutex_Create()
 /**
  * @brief Mutexロック取得
  *
- *  Mutexロックを取得する
+ *  Mutexロックを取得する<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
  *
  * @return Mutexオブジェクト
  */
 void CmnThreadMutex_Lock(CmnThreadMutex *mutex)
 {
-	CMNLOG_TRACE_START();
-
 #if IS_PRATFORM_WINDOWS()
 	WaitForSingleObject(mutex->mutexId, INFINITE);
 #else
 	pthread_mutex_lock(&(mutex->mutexId));
 #endif
-
-	CMNLOG_TRACE_END();
 }
 
 /**
  * @brief Mutexロック解除
  *
- *  Mutexロックを解除する
+ *  Mutexロックを解除する<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
  *
  * @return Mutexオブジェクト
  */
 void CmnThreadMutex_UnLock(CmnThreadMutex *mutex)
 {
-	CMNLOG_TRACE_START();
-
 #if IS_PRATFORM_WINDOWS()
 	ReleaseMutex(mutex->mutexId);
 #else
 	pthread_mutex_unlock(&(mutex->mutexId));
 #endif
-
-	CMNLOG_TRACE_END();
 }
 
 /**
@@ -246,3 +252,167 @@ void CmnThreadMutex_Free(CmnThreadMutex *mutex)
 	CMNLOG_TRACE_END();
 }
 
+/**
+ * @brief 条件変数作成
+ *
+ *  スレッド間で状態の変化を待ち合わせるための条件変数を作成する。<br>
+ *  待機する側はMutexをロックして状態を確認し、条件を満たすまでCmnThreadCond_Waitで待つ。
+ *  通知する側はMutexをロックして状態を変更し、CmnThreadCond_Signal/CmnThreadCond_Broadcastで通知する。
+ *
+ * @return 条件変数オブジェクト。作成できない場合はNULL。
+ */
+CmnThreadCond* CmnThreadCond_Create()
+{
+	CmnThreadCond *ret;
+#if !IS_PRATFORM_WINDOWS()
+	pthread_condattr_t attr;
+#endif
+	CMNLOG_TRACE_START();
+
+	if ((ret = calloc(1, sizeof(CmnThreadCond))) == NULL) {
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+
+#if IS_PRATFORM_WINDOWS()
+	ret->semaphoreId = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+	if (ret->semaphoreId == NULL) {
+		free(ret);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+#else
+	/* 待つ時間が時刻の変更の影響を受けないように、単調増加の時計を使う */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	if (pthread_cond_init(&(ret->condId), &attr) != 0) {
+		pthread_condattr_destroy(&attr);
+		free(ret);
+		CMNLOG_TRACE_END();
+		return NULL;
+	}
+	pthread_condattr_destroy(&attr);
+#endif
+
+	CMNLOG_TRACE_END();
+	return ret;
+}
+
+/**
+ * @brief 条件変数で待つ
+ *
+ *  mutexのロックを解除して通知を待ち、戻る前に再びロックを取得する（呼び出し時はmutexをロックしていること）。<br>
+ *  通知がなくても戻る場合があるため、呼び出し元は戻った後に状態を確認し、条件を満たさなければ再度待つこと。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @param cond 条件変数オブジェクト
+ * @param mutex 状態を保護するMutexオブジェクト
+ * @param timeout 待つ時間（ミリ秒）。負の場合は通知まで待つ
+ * @return 0:通知された（または待つ時間の前に戻った）、1:待つ時間が過ぎた
+ */
+int CmnThreadCond_Wait(CmnThreadCond *cond, CmnThreadMutex *mutex, long timeout)
+{
+#if IS_PRATFORM_WINDOWS()
+	DWORD ret;
+
+	cond->waiters++;
+	ReleaseMutex(mutex->mutexId);
+	ret = WaitForSingleObject(cond->semaphoreId, (timeout < 0) ? INFINITE : (DWORD)timeout);
+	WaitForSingleObject(mutex->mutexId, INFINITE);
+	cond->waiters--;
+	return (ret == WAIT_TIMEOUT) ? 1 : 0;
+#else
+	struct timespec ts;
+
+	if (timeout < 0) {
+		pthread_cond_wait(&(cond->condId), &(mutex->mutexId));
+		return 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_sec += timeout / 1000;
+	ts.tv_nsec += (timeout % 1000) * 1000000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+	return (pthread_cond_timedwait(&(cond->condId), &(mutex->mutexId), &ts) == ETIMEDOUT) ? 1 : 0;
+#endif
+}
+
+/**
+ * @brief 条件変数で待っているスレッドを1つ起こす
+ *
+ *  状態を保護するMutexをロックした状態で呼び出すこと。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @param cond 条件変数オブジェクト
+ */
+void CmnThreadCond_Signal(CmnThreadCond *cond)
+{
+#if IS_PRATFORM_WINDOWS()
+	if (cond->waiters > 0) {
+		ReleaseSemaphore(cond->semaphoreId, 1, NULL);
+	}
+#else
+	pthread_cond_signal(&(cond->condId));
+#endif
+}
+
+/**
+ * @brief 条件変数で待っている全てのスレッドを起こす
+ *
+ *  状態を保護するMutexをロックした状態で呼び出すこと。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @param cond 条件変数オブジェクト
+ */
+void CmnThreadCond_Broadcast(CmnThreadCond *cond)
+{
+#if IS_PRATFORM_WINDOWS()
+	if (cond->waiters > 0) {
+		ReleaseSemaphore(cond->semaphoreId, cond->waiters, NULL);
+	}
+#else
+	pthread_cond_broadcast(&(cond->condId));
+#endif
+}
+
+/**
+ * @brief 条件変数破棄
+ *
+ *  条件変数を破棄する（待っているスレッドがないこと）
+ *
+ * @param cond 条件変数オブジェクト
+ */
+void CmnThreadCond_Free(CmnThreadCond *cond)
+{
+	CMNLOG_TRACE_START();
+
+#if IS_PRATFORM_WINDOWS()
+	CloseHandle(cond->semaphoreId);
+#else
+	pthread_cond_destroy(&(cond->condId));
+#endif
+
+	free(cond);
+	CMNLOG_TRACE_END();
+}
+
+/**
+ * @brief 初期化処理を一度だけ実行する
+ *
+ *  複数のスレッドから同時に呼び出しても初期化処理は一度だけ実行され、
+ *  どのスレッドも初期化処理の完了後に戻る。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @param once 制御オブジェクト（CMN_THREAD_ONCE_INITで初期化したもの）
+ * @param func 初期化処理
+ */
+void CmnThread_Once(CmnThreadOnce *once, void (*func)(void))
+{
+#if IS_PRATFORM_WINDOWS()
+	InitOnceExecuteOnce(once, callOnceForWin, (PVOID)func, NULL);
+#else
+	pthread_once(once, func);
+#endif
+}
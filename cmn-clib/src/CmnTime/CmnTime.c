@@ -15,6 +15,7 @@
 #include"cmnclib/Common.h"
 #include"cmnclib/CmnTime.h"
 #include"cmnclib/CmnLog.h"
+#include"cmnclib/CmnString.h"
 
 #if IS_PRATFORM_WINDOWS()
 	#include <windows.h>
@@ -68,6 +69,56 @@ static void dateTimeToTm(CmnTimeDateTime *datetime, struct tm *time)
 	CMNLOG_TRACE_END();
 }
 
+/**
+ * @brief ゼロ埋めした数値を書き込む
+ *
+ *  "%0*d"と同じ結果となるよう書き込む。負数の場合のみsprintfで書式化する。
+ *
+ * @param p 書き込み先
+ * @param value 値
+ * @param digit 最小桁数
+ * @return 書き込んだ文字列の末尾（'\0'の位置）
+ */
+static char* putNumber(char *p, int value, size_t digit)
+{
+	if (value < 0) {
+		return p + sprintf(p, "%0*d", (int)digit, value);
+	}
+	return p + CmnString_FormatUIntPad((unsigned int)value, digit, p);
+}
+
+/**
+ * @brief 日付（yyyy mm dd）を区切り文字付きで書き込む
+ * @param p 書き込み先
+ * @param datetime 日時
+ * @param delim 区切り文字（区切らない場合は""）
+ * @return 書き込んだ文字列の末尾（'\0'の位置）
+ */
+static char* putDate(char *p, const CmnTimeDateTime *datetime, const char *delim)
+{
+	p = putNumber(p, datetime->year, 4);
+	if (*delim) *p++ = *delim;
+	p = putNumber(p, datetime->month, 2);
+	if (*delim) *p++ = *delim;
+	return putNumber(p, datetime->dayOfMonth, 2);
+}
+
+/**
+ * @brief 時刻（hh mm ss）を区切り文字付きで書き込む
+ * @param p 書き込み先
+ * @param datetime 日時
+ * @param delim 区切り文字（区切らない場合は""）
+ * @return 書き込んだ文字列の末尾（'\0'の位置）
+ */
+static char* putTime(char *p, const CmnTimeDateTime *datetime, const char *delim)
+{
+	p = putNumber(p, datetime->hour, 2);
+	if (*delim) *p++ = *delim;
+	p = putNumber(p, datetime->minute, 2);
+	if (*delim) *p++ = *delim;
+	return putNumber(p, datetime->second, 2);
+}
+
 /**
  * @brief 現在日時を取得する
  *
@@ -227,8 +278,8 @@ char* CmnTimeDateTime_ToString(const CmnTimeDateTime *datetime, char *buf)
 {
 	CMNLOG_TRACE_START();
 	*buf = '\0';
-	sprintf(buf, "time=%I64d, year=%d, month=%d, day(m)=%d, day(w)=%d, day(y)=%d, hour=%d, min=%d, sec=%d, isdst=%d, timezone=%ld",
-			datetime->time,
+	sprintf(buf, "time=%lld, year=%d, month=%d, day(m)=%d, day(w)=%d, day(y)=%d, hour=%d, min=%d, sec=%d, isdst=%d, timezone=%ld",
+			(long long)datetime->time,
 			datetime->year,
 			datetime->month,
 			datetime->dayOfMonth,
@@ -279,45 +330,41 @@ char* CmnTimeDateTime_ToString(const CmnTimeDateTime *datetime, char *buf)
  */
 char* CmnTime_Format(const CmnTimeDateTime *datetime, const CmnTimeFormatType type, char *buf)
 {
+	char *p = buf;
 	CMNLOG_TRACE_START();
 
 	switch (type) {
 		/* 形式：yyyy/mm/dd hh:mm:ss */
 		case CMN_TIME_FORMAT_ALL:
-			sprintf(buf, "%04d/%02d/%02d %02d:%02d:%02d",
-				datetime->year, datetime->month, datetime->dayOfMonth,
-				datetime->hour, datetime->minute, datetime->second);
+			p = putDate(p, datetime, "/");
+			*p++ = ' ';
+			putTime(p, datetime, ":");
 			break;
 
 		/* 形式：yyyymmddhhmmss */
 		case CMN_TIME_FORMAT_ALL_SHORT:
-			sprintf(buf, "%04d%02d%02d%02d%02d%02d",
-				datetime->year, datetime->month, datetime->dayOfMonth,
-				datetime->hour, datetime->minute, datetime->second);
+			p = putDate(p, datetime, "");
+			putTime(p, datetime, "");
 			break;
 
 		/* 形式：yyyy/mm/dd */
 		case CMN_TIME_FORMAT_DATE:
-			sprintf(buf, "%04d/%02d/%02d",
-				datetime->year, datetime->month, datetime->dayOfMonth);
+			putDate(p, datetime, "/");
 			break;
 
 		/* 形式：yyyymmdd */
 		case CMN_TIME_FORMAT_DATE_SHORT:
-			sprintf(buf, "%04d%02d%02d",
-				datetime->year, datetime->month, datetime->dayOfMonth);
+			putDate(p, datetime, "");
 			break;
 
 		/* 形式：hh:mm:ss */
 		case CMN_TIME_FORMAT_TIME:
-			sprintf(buf, "%02d:%02d:%02d",
-				datetime->hour, datetime->minute, datetime->second);
+			putTime(p, datetime, ":");
 			break;
 
 		/* 形式：hhmmss */
 		case CMN_TIME_FORMAT_TIME_SHORT:
-			sprintf(buf, "%02d%02d%02d",
-				datetime->hour, datetime->minute, datetime->second);
+			putTime(p, datetime, "");
 			break;
 
 		default:
@@ -342,3 +389,22 @@ void CmnTime_Sleep(unsigned long long msec)
 #endif
 	CMNLOG_TRACE_END();
 }
+
+/**
+ * @brief 経過時間（ミリ秒）を取得する
+ *
+ *  システム起動からの経過時間など、時刻の変更の影響を受けない単調増加の時間。時間間隔の計測に使用する。<br>
+ *  呼び出し頻度が高いためトレースログは出力しない。
+ *
+ * @return 経過時間（ミリ秒）
+ */
+unsigned long long CmnTime_GetTickCount(void)
+{
+#if IS_PRATFORM_WINDOWS()
+	return GetTickCount64();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
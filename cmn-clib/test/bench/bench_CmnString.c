@@ -0,0 +1,113 @@
+/** @file
+ * @brief CmnStringライブラリの処理性能を計測するためのベンチマークプログラム
+ * @author H.Kumagai
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmnclib/CmnTest.h"
+#include "cmnclib/CmnString.h"
+
+static void bench_CmnString_Number(CmnTestCase *t)
+{
+	char buf[CMN_STRING_INT_SIZE];
+	long long i;
+	long long sum = 0;
+	long long value;
+	clock_t start;
+	clock_t fastFormat, stdFormat, fastParse, stdParse;
+	const long long count = 1000000;
+
+	start = clock();
+	for (i = 0; i < count; i++) {
+		sum += CmnString_FormatInt(i * 7919, buf);
+	}
+	fastFormat = clock() - start;
+
+	start = clock();
+	for (i = 0; i < count; i++) {
+		sum -= snprintf(buf, sizeof(buf), "%lld", i * 7919);
+	}
+	stdFormat = clock() - start;
+
+	CmnString_FormatInt(123456789012LL, buf);
+	start = clock();
+	for (i = 0; i < count; i++) {
+		CmnString_ParseInt(buf, 12, &value);
+		sum += value;
+	}
+	fastParse = clock() - start;
+
+	start = clock();
+	for (i = 0; i < count; i++) {
+		sum -= strtoll(buf, NULL, 10);
+	}
+	stdParse = clock() - start;
+
+	printf("FormatInt=%ldclocks, snprintf=%ldclocks, ParseInt=%ldclocks, strtoll=%ldclocks\n",
+			(long)fastFormat, (long)stdFormat, (long)fastParse, (long)stdParse);
+	CmnTest_AssertNumber(t, __LINE__, sum, 0);
+}
+
+static void bench_CmnStringRegex(CmnTestCase *t)
+{
+	const size_t lineCount = 1000000;
+	const char *lines[] = {
+		"2026-10-19 12:00:00.123 [INFO ] request accepted id=12345 path=/api/v1/items user=alice\n",
+		"2026-10-19 12:00:00.456 [DEBUG] cache hit key=items:12345 size=2048 elapsed=0.12ms\n",
+		"2026-10-19 12:00:01.789 [ERROR] connection timeout host=db01 retry=3 elapsed=3000ms\n",
+	};
+	CmnStringBuffer *text = CmnStringBuffer_Create("");
+	CmnStringRegex *literal = CmnStringRegex_Compile("timeout host=db\\d+", 0);
+	CmnStringRegex *complex = CmnStringRegex_Compile("\\[(ERROR|WARN )\\].*elapsed=\\d{4,}ms", 0);
+	size_t i, hits1 = 0, hits2 = 0;
+	clock_t start, t1, t2;
+
+	for (i = 0; i < lineCount; i++) {
+		CmnStringBuffer_Append(text, lines[i % 3]);
+	}
+
+	/* 行単位で照合 */
+	start = clock();
+	{
+		const char *p = text->string;
+		const char *end = p + text->length;
+		while (p < end) {
+			const char *eol = memchr(p, '\n', end - p);
+			hits1 += CmnStringRegex_Search(literal, p, eol - p);
+			p = eol + 1;
+		}
+	}
+	t1 = clock() - start;
+
+	start = clock();
+	{
+		const char *p = text->string;
+		const char *end = p + text->length;
+		while (p < end) {
+			const char *eol = memchr(p, '\n', end - p);
+			hits2 += CmnStringRegex_Search(complex, p, eol - p);
+			p = eol + 1;
+		}
+	}
+	t2 = clock() - start;
+
+	printf("CmnStringRegex: %dMB, prefix=%.0fMB/s, dfa=%.0fMB/s\n", (int)(text->length / 1000000),
+			t1 == 0 ? 0.0 : (text->length / 1e6) / ((double)t1 / CLOCKS_PER_SEC),
+			t2 == 0 ? 0.0 : (text->length / 1e6) / ((double)t2 / CLOCKS_PER_SEC));
+	CmnTest_AssertNumber(t, __LINE__, hits1, lineCount / 3);
+	CmnTest_AssertNumber(t, __LINE__, hits2, lineCount / 3);
+
+	CmnStringRegex_Free(literal);
+	CmnStringRegex_Free(complex);
+	CmnStringBuffer_Free(text);
+}
+
+void bench_CmnString_AddBench(CmnTestPlan *plan)
+{
+	CmnTest_AddTestCaseEasy(plan, bench_CmnString_Number);
+	CmnTest_AddTestCaseEasy(plan, bench_CmnStringRegex);
+}
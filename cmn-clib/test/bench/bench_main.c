@@ -0,0 +1,52 @@
+/** @file
+ * @brief 共通ライブラリの処理性能を計測するためのベンチマークプログラム
+ * @author H.Kumagai
+ * @date 2026-10-19
+ *
+ * 単体テスト（test_main）とは別の実行ファイルで、計測結果を標準出力に表示する。
+ * 引数でモジュール名（CmnStringなど）を指定した場合は、指定したモジュールだけを計測する。
+ */
+#include<stdio.h>
+#include<string.h>
+
+#include"cmnclib/CmnTest.h"
+
+extern void bench_CmnFile_AddBench(CmnTestPlan *plan);
+extern void bench_CmnString_AddBench(CmnTestPlan *plan);
+
+static int isTarget(int argc, char **argv, const char *name)
+{
+	int i;
+
+	if (argc <= 1) {
+		return True;
+	}
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], name) == 0) {
+			return True;
+		}
+	}
+	return False;
+}
+
+int main(int argc, char **argv)
+{
+	CmnTestPlan plan;
+
+	printf("### Start benchmark ###\n");
+
+	CmnTest_InitializeTestPlan(&plan);
+
+	/* CmnFile */
+	if (isTarget(argc, argv, "CmnFile")) bench_CmnFile_AddBench(&plan);
+	/* CmnString */
+	if (isTarget(argc, argv, "CmnString")) bench_CmnString_AddBench(&plan);
+
+	CmnTest_Run(&plan, True);
+
+	CmnTest_DestroyTest(&plan);
+
+	printf("### End benchmark ###\n");
+
+	return 0;
+}
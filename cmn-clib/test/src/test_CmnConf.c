@@ -14,7 +14,50 @@ static void test_Xxx(CmnTestCase *testCase)
 	/* TODO */
 }
 
+static void test_CmnConfProperty_Load(CmnTestCase *t)
+{
+	CmnConfProperty *prop = CmnConfProperty_Load("test/resources/property.conf");
+	if (prop == NULL) {
+		CmnTest_AssertNG(t, __LINE__);
+		return;
+	}
+
+	/* 前後の空白、行末のコメント、タブ、CRLFの除去 */
+	CmnTest_AssertString(t, __LINE__, CmnConfProperty_GetValue(prop, "TEST1"), "wahaha");
+	CmnTest_AssertString(t, __LINE__, CmnConfProperty_GetValue(prop, "TEST2"), "ahaha");
+	CmnTest_AssertString(t, __LINE__, CmnConfProperty_GetValue(prop, "TEST3"), "space value");
+	/* 区切り文字がない行は無視 */
+	CmnTest_AssertPointer(t, __LINE__, CmnConfProperty_GetValue(prop, "NOVALUE"), NULL);
+
+	CmnConfProperty_Free(prop);
+}
+
+static void test_CmnConfProperty_GetIntValue(CmnTestCase *t)
+{
+	long long value = -1;
+	CmnConfProperty *prop = CmnConfProperty_Load("test/resources/property.conf");
+	if (prop == NULL) {
+		CmnTest_AssertNG(t, __LINE__);
+		return;
+	}
+
+	CmnTest_AssertNumber(t, __LINE__, CmnConfProperty_GetIntValue(prop, "INT1", &value), 0);
+	CmnTest_AssertNumber(t, __LINE__, value, 1234);
+	CmnTest_AssertNumber(t, __LINE__, CmnConfProperty_GetIntValue(prop, "INT2", &value), 0);
+	CmnTest_AssertNumber(t, __LINE__, value, -56);
+
+	/* 整数でない、存在しない */
+	CmnTest_AssertNumber(t, __LINE__, CmnConfProperty_GetIntValue(prop, "TEST1", &value), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnConfProperty_GetIntValue(prop, "INT3", &value), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnConfProperty_GetIntValue(prop, "NOTHING", &value), -1);
+	CmnTest_AssertNumber(t, __LINE__, value, -56);
+
+	CmnConfProperty_Free(prop);
+}
+
 void test_CmnConf_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_Xxx);
+	CmnTest_AddTestCaseEasy(plan, test_CmnConfProperty_Load);
+	CmnTest_AddTestCaseEasy(plan, test_CmnConfProperty_GetIntValue);
 }
@@ -5,6 +5,7 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cmnclib/CmnTest.h"
 #include "cmnclib/CmnData.h"
@@ -90,9 +91,193 @@ void test_CmnDataStack_normal(CmnTestCase *t)
 	CmnTest_AssertPointer(t, __LINE__, CmnDataStack_Pop(stack), NULL);
 }
 
+/* テスト用の疑似乱数（xorshift64） */
+static unsigned long long nextRandom(unsigned long long *x)
+{
+	*x ^= *x << 13;
+	*x ^= *x >> 7;
+	*x ^= *x << 17;
+	return *x;
+}
+
+static void test_CmnDataHash_stream(CmnTestCase *t)
+{
+	unsigned char data[300];
+	unsigned long long rnd = 88172645463325252ULL;
+	size_t len, split1, split2;
+	int ng = 0;
+	CmnDataHash state;
+	CmnDataHash128 h1, h2;
+	CmnDataBuffer *buf;
+
+	for (len = 0; len < sizeof(data); len++) {
+		data[len] = (unsigned char)nextRandom(&rnd);
+	}
+
+	/* 分割位置によらず一括計算と同じ値になること */
+	for (len = 0; len <= sizeof(data); len++) {
+		for (split1 = 0; split1 <= len; split1 += 7) {
+			split2 = split1 + (len - split1) / 2;
+			CmnDataHash_Init(&state, 12345);
+			CmnDataHash_Update(&state, data, split1);
+			CmnDataHash_Update(&state, data + split1, split2 - split1);
+			CmnDataHash_Update(&state, data + split2, len - split2);
+			CmnDataHash_Final128(&state, &h2);
+			CmnData_Hash128(data, len, 12345, &h1);
+			if (h1.low != h2.low || h1.high != h2.high || CmnDataHash_Final(&state) != CmnData_HashSeed(data, len, 12345)) {
+				ng++;
+			}
+		}
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+
+	/* CmnDataBufferの内容 */
+	buf = CmnDataBuffer_Create(16);
+	CmnDataBuffer_Set(buf, data, 100);
+	CmnDataHash_Init(&state, 0);
+	CmnDataHash_UpdateBuffer(&state, buf);
+	CmnTest_AssertNumber(t, __LINE__, CmnDataHash_Final(&state) == CmnData_Hash(data, 100), True);
+	CmnDataBuffer_Free(buf);
+
+	/* シード、長さ、内容が異なると異なる値になること */
+	CmnTest_AssertNumber(t, __LINE__, CmnData_HashSeed("abc", 3, 1) != CmnData_HashSeed("abc", 3, 2), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnData_Hash("", 0) != CmnData_Hash("\0", 1), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnData_Hash("abc", 3) != CmnData_Hash("abd", 3), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnData_HashRandomSeed() != CmnData_HashRandomSeed(), True);
+}
+
+static void test_CmnDataHash_seedCollision(CmnTestCase *t)
+{
+	/* 先頭の8バイトが混合用の定数P1（リトルエンディアン）の16バイト単位のブロックでも、シードが消えないこと
+	 * （シードが消えると、続く8バイトによらずに同じ値になり、シードによらない衝突を作れてしまう） */
+	const unsigned char p1[8] = { 0xdb, 0x28, 0xb4, 0xa0, 0xd1, 0x7e, 0x03, 0xe7 };
+	unsigned char a[96], b[96];
+	size_t lengths[] = { 16, 32, 96 }, k, i;
+
+	for (k = 0; k < ARRAY_LENGTH(lengths); k++) {
+		memset(a, 0, sizeof(a));
+		for (i = 0; i < lengths[k]; i += 16) {
+			memcpy(a + i, p1, 8);
+		}
+		memcpy(b, a, sizeof(a));
+		b[8] = 1;
+		CmnTest_AssertNumber(t, __LINE__, CmnData_HashSeed(a, lengths[k], 1) != CmnData_HashSeed(a, lengths[k], 2), True);
+		CmnTest_AssertNumber(t, __LINE__, CmnData_HashSeed(a, lengths[k], 1) != CmnData_HashSeed(b, lengths[k], 1), True);
+		CmnTest_AssertNumber(t, __LINE__, CmnData_HashSeed(a, lengths[k], 2) != CmnData_HashSeed(b, lengths[k], 2), True);
+	}
+}
+
+static void test_CmnDataHash_avalanche(CmnTestCase *t)
+{
+	/* 入力の1bitを反転すると、出力の各bitが約50%の確率で反転すること */
+	size_t lengths[] = { 8, 20, 64, 100 };
+	unsigned char data[100];
+	unsigned long long rnd = 2463534242ULL;
+	int sample, bit, out;
+	size_t i, k;
+	const int samples = 64;
+	int ng = 0;
+
+	for (k = 0; k < ARRAY_LENGTH(lengths); k++) {
+		size_t len = lengths[k];
+		int inBits = (int)len * 8;
+		long *outFlip = calloc(128, sizeof(long));
+		long *inFlip = calloc(inBits, sizeof(long));
+		long trials = (long)samples * inBits;
+
+		for (sample = 0; sample < samples; sample++) {
+			CmnDataHash128 h0, h1;
+			for (i = 0; i < len; i++) {
+				data[i] = (unsigned char)nextRandom(&rnd);
+			}
+			CmnData_Hash128(data, len, 0, &h0);
+			for (bit = 0; bit < inBits; bit++) {
+				unsigned long long d[2];
+				data[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+				CmnData_Hash128(data, len, 0, &h1);
+				data[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+				d[0] = h0.low ^ h1.low;
+				d[1] = h0.high ^ h1.high;
+				for (out = 0; out < 128; out++) {
+					if ((d[out / 64] >> (out % 64)) & 1) {
+						outFlip[out]++;
+						inFlip[bit]++;
+					}
+				}
+			}
+		}
+
+		/* 出力bitごとの反転率（試行数が多いため±3%以内） */
+		for (out = 0; out < 128; out++) {
+			double rate = (double)outFlip[out] / trials;
+			if (rate < 0.47 || 0.53 < rate) {
+				printf("len=%d out bit=%d rate=%f\n", (int)len, out, rate);
+				ng++;
+			}
+		}
+		/* 入力bitごとの反転率（±5%以内） */
+		for (bit = 0; bit < inBits; bit++) {
+			double rate = (double)inFlip[bit] / (samples * 128.0);
+			if (rate < 0.45 || 0.55 < rate) {
+				printf("len=%d in bit=%d rate=%f\n", (int)len, bit, rate);
+				ng++;
+			}
+		}
+		free(outFlip);
+		free(inFlip);
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+}
+
+static void test_CmnDataArena(CmnTestCase *t)
+{
+	CmnDataArena *arena = CmnDataArena_Create(1024);
+	char *p1, *p2, *large, *str;
+	int i, ng = 0;
+
+	/* 16バイト境界に、重ならずに確保される */
+	p1 = CmnDataArena_Alloc(arena, 1);
+	p2 = CmnDataArena_Alloc(arena, 17);
+	CmnTest_AssertNumber(t, __LINE__, (size_t)p1 % 16, 0);
+	CmnTest_AssertNumber(t, __LINE__, (size_t)p2 % 16, 0);
+	CmnTest_AssertNumber(t, __LINE__, p2 - p1 >= 16 || p1 - p2 >= 32, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnDataArena_GetTotalSize(arena), 1024);
+
+	/* チャンクサイズの1/4を超える領域は専用のチャンクになり、切り出し中のチャンクは継続して使う */
+	large = CmnDataArena_Alloc(arena, 4000);
+	memset(large, 'L', 4000);
+	CmnTest_AssertNumber(t, __LINE__, CmnDataArena_GetTotalSize(arena), 1024 + 4000);
+	str = CmnDataArena_CopyString(arena, "abcdef", 3);
+	CmnTest_AssertString(t, __LINE__, str, "abc");
+	CmnTest_AssertNumber(t, __LINE__, str - p1 < 1024 && str > p1, True);
+
+	/* チャンクをまたいで大量に確保 */
+	for (i = 0; i < 1000; i++) {
+		int *v = CmnDataArena_Alloc(arena, sizeof(int) * 10);
+		v[0] = i;
+		v[9] = i;
+	}
+	CmnTest_AssertNumber(t, __LINE__, CmnDataArena_GetTotalSize(arena) > 40000, True);
+	for (i = 0; i < 4000; i++) {
+		if (large[i] != 'L') ng++;
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+
+	/* 初期化すると最後のチャンクのみ残る */
+	CmnDataArena_Reset(arena);
+	CmnTest_AssertNumber(t, __LINE__, CmnDataArena_GetTotalSize(arena), 1024);
+	CmnTest_AssertString(t, __LINE__, CmnDataArena_CopyString(arena, "xyz", 3), "xyz");
+
+	CmnDataArena_Free(arena);
+}
+
 void test_CmnData_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_CmnDataBuffer_small);
 	CmnTest_AddTestCaseEasy(plan, test_CmnDataBuffer_large);
 	CmnTest_AddTestCaseEasy(plan, test_CmnDataStack_normal);
+	CmnTest_AddTestCaseEasy(plan, test_CmnDataHash_stream);
+	CmnTest_AddTestCaseEasy(plan, test_CmnDataHash_seedCollision);
+	CmnTest_AddTestCaseEasy(plan, test_CmnDataHash_avalanche);
+	CmnTest_AddTestCaseEasy(plan, test_CmnDataArena);
 }
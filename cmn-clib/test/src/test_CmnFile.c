@@ -6,10 +6,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "cmnclib/CmnTest.h"
 #include "cmnclib/CmnFile.h"
 #include "cmnclib/CmnData.h"
+#include "cmnclib/CmnThread.h"
+#include "cmnclib/CmnTime.h"
+
+#if IS_PRATFORM_LINUX()
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 static void test_CmnFile_ReadAll(CmnTestCase *t)
 {
@@ -48,6 +57,53 @@ static void test_CmnFile_ReadAllText(CmnTestCase *t)
 	free(txt);
 }
 
+static void test_CmnFile_ReadAll_Size(CmnTestCase *t)
+{
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+	CmnStringBuffer *txt = CmnStringBuffer_Create("previous");
+
+	/* 既存のデータの後ろに追加し、領域はファイルサイズ分だけ確保する */
+	CmnDataBuffer_Append(buf, "HEAD", 4);
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_ReadAll("test/resources/CmnFile/ReadAll.txt", buf), buf);
+#if IS_PRATFORM_WINDOWS()
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 4 + 5010);
+#else
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 4 + 4959);
+#endif
+	CmnTest_AssertNumber(t, __LINE__, buf->bufSize, buf->size);
+	CmnTest_AssertData(t, __LINE__, buf->data, "HEADSTART", 9);
+
+	/* 読み込みに失敗した場合はバッファを変更しない */
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_ReadAll("test/resources/CmnFile/NotFound.txt", buf), NULL);
+	CmnTest_AssertData(t, __LINE__, buf->data, "HEADSTART", 9);
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_ReadAllText("test/resources/CmnFile/NotFound.txt", txt), NULL);
+	CmnTest_AssertString(t, __LINE__, txt->string, "previous");
+
+	/* 文字列バッファは元の内容を置き換え、'\0'の分まで含めて一度に確保する */
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_ReadAllText("test/resources/CmnFile/ReadAll.txt", txt), txt);
+	CmnTest_AssertNumber(t, __LINE__, txt->length, buf->size - 4);
+	CmnTest_AssertNumber(t, __LINE__, txt->string[txt->length], '\0');
+	CmnTest_AssertNumber(t, __LINE__, memcmp(txt->string, (char *)buf->data + 4, txt->length), 0);
+
+#if IS_PRATFORM_LINUX()
+	/* サイズが0と報告されるファイルは、領域を拡張しながら終端まで読み込む */
+	buf->size = 0;
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_ReadAll("/proc/self/status", buf), buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size > 0, True);
+	CmnTest_AssertData(t, __LINE__, buf->data, "Name:", 5);
+
+	/* 読み込みの途中で失敗した場合（ディレクトリは開けるが読み込めない）、文字列バッファは空文字列になる */
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_ReadAllText("test/resources/CmnFile", txt), NULL);
+	CmnTest_AssertNumber(t, __LINE__, txt->length, 0);
+	CmnTest_AssertString(t, __LINE__, txt->string, "");
+	CmnStringBuffer_Append(txt, "after");
+	CmnTest_AssertString(t, __LINE__, txt->string, "after");
+#endif
+
+	CmnStringBuffer_Free(txt);
+	CmnDataBuffer_Free(buf);
+}
+
 static void test_CmnFile_Write_AndRemove(CmnTestCase *t)
 {
 	char *file = "test/resources/CmnFile/WriteTest.txt";
@@ -79,6 +135,516 @@ static void test_CmnFile_Write_AndRemove(CmnTestCase *t)
 	}
 }
 
+static void test_CmnFile_WriteHead(CmnTestCase *t)
+{
+	char *file = "test/resources/CmnFile/WriteHead.txt";
+	size_t size = 8 * 1024 * 1024, i;
+	char *data = malloc(size);
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+	CmnDataList *list = CmnDataList_Create();
+	CmnFileInfo *info;
+	int tmpFiles = 0;
+#if IS_PRATFORM_LINUX()
+	char *link = "test/resources/CmnFile/WriteHeadLink.txt";
+	struct stat st;
+#endif
+
+	/* ファイルがない場合は新規作成 */
+	CmnFile_Remove(file);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteHead(file, "head", 4), 0);
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 4);
+	CmnTest_AssertData(t, __LINE__, buf->data, "head", 4);
+
+	/* 大きなファイルの先頭に追加 */
+	for (i = 0; i < size; i++) data[i] = (char)(i % 251);
+	CmnFile_WriteNew(file, data, size);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteHead(file, "0123456789", 10), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteHead(file, "", 0), 0);
+	buf->size = 0;
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, size + 10);
+	CmnTest_AssertData(t, __LINE__, buf->data, "0123456789", 10);
+	CmnTest_AssertNumber(t, __LINE__, memcmp((char *)buf->data + 10, data, size), 0);
+
+	/* 一時ファイルが残っていないこと */
+	CmnFile_List("test/resources/CmnFile", list, CHARSET_UTF8);
+	for (i = 0; i < (size_t)list->size; i++) {
+		info = CmnDataList_Get(list, (int)i);
+		if (strncmp(info->name, "WriteHead.txt.", 14) == 0) tmpFiles++;
+	}
+	CmnTest_AssertNumber(t, __LINE__, tmpFiles, 0);
+
+#if IS_PRATFORM_LINUX()
+	/* シンボリックリンクはそのままで、リンク先のファイルに追加する */
+	CmnFile_WriteNew(file, "body", 4);
+	unlink(link);
+	symlink("WriteHead.txt", link);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteHead(link, "head", 4), 0);
+	CmnTest_AssertNumber(t, __LINE__, lstat(link, &st) == 0 && S_ISLNK(st.st_mode), True);
+	buf->size = 0;
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 8);
+	CmnTest_AssertData(t, __LINE__, buf->data, "headbody", 8);
+	unlink(link);
+#endif
+
+	CmnDataList_Free(list, free);
+	CmnDataBuffer_Free(buf);
+	CmnFile_Remove(file);
+	free(data);
+}
+
+static void test_CmnFile_Copy(CmnTestCase *t)
+{
+	char *src = "test/resources/CmnFile/CopySrc.txt";
+	char *dst = "test/resources/CmnFile/CopyDst.txt";
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+#if IS_PRATFORM_LINUX()
+	struct stat srcStat, dstStat;
+	struct timespec times[2] = { { 1000000000, 123456789 }, { 1000000000, 987654321 } };
+#endif
+
+	/* コピー、上書きしない場合はコピー先があれば失敗 */
+	CmnFile_Remove(dst);
+	CmnFile_WriteNew(src, "copy data", 9);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, 0), 0);
+	CmnFile_ReadAll(dst, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 9);
+	CmnTest_AssertData(t, __LINE__, buf->data, "copy data", 9);
+	CmnFile_WriteNew(src, "new", 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, 0), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, CMN_FILE_COPY_OVERWRITE), 0);
+	buf->size = 0;
+	CmnFile_ReadAll(dst, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 3);
+	CmnTest_AssertData(t, __LINE__, buf->data, "new", 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy("test/resources/CmnFile/nothing.txt", dst, CMN_FILE_COPY_OVERWRITE), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy("test/resources/CmnFile", dst, CMN_FILE_COPY_OVERWRITE), -1);
+
+#if IS_PRATFORM_LINUX()
+	/* パーミッション、日時の保持 */
+	chmod(src, 0640);
+	utimensat(AT_FDCWD, src, times, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, CMN_FILE_COPY_OVERWRITE | CMN_FILE_COPY_PRESERVE), 0);
+	stat(src, &srcStat);
+	stat(dst, &dstStat);
+	CmnTest_AssertNumber(t, __LINE__, dstStat.st_mode & 07777, 0640);
+	CmnTest_AssertNumber(t, __LINE__, dstStat.st_mtim.tv_sec, srcStat.st_mtim.tv_sec);
+	CmnTest_AssertNumber(t, __LINE__, dstStat.st_mtim.tv_nsec, srcStat.st_mtim.tv_nsec);
+	CmnTest_AssertNumber(t, __LINE__, dstStat.st_atim.tv_sec, 1000000000);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, CMN_FILE_COPY_OVERWRITE), 0);
+	stat(dst, &dstStat);
+	CmnTest_AssertNumber(t, __LINE__, dstStat.st_mtim.tv_sec != 1000000000, True);
+
+	/* 保持しない場合、上書きしたコピー先のパーミッションは変えない */
+	chmod(dst, 0600);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, CMN_FILE_COPY_OVERWRITE), 0);
+	stat(dst, &dstStat);
+	CmnTest_AssertNumber(t, __LINE__, dstStat.st_mode & 07777, 0600);
+#endif
+
+	CmnFile_Remove(src);
+	CmnFile_Remove(dst);
+	CmnDataBuffer_Free(buf);
+}
+
+static void test_CmnFile_Copy_Sparse(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *src = "test/resources/CmnFile/SparseSrc.bin";
+	char *dst = "test/resources/CmnFile/SparseDst.bin";
+	long long size = 256LL * 1024 * 1024;
+	struct stat srcStat, dstStat;
+	char data[4096], readBuf[4096];
+	int fd;
+
+	/* 256MBのうち、先頭、中間、末尾の手前に4KBずつデータがあるファイル */
+	memset(data, 'S', sizeof(data));
+	fd = open(src, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	ftruncate(fd, size);
+	pwrite(fd, data, sizeof(data), 0);
+	pwrite(fd, data, sizeof(data), 128 * 1024 * 1024);
+	pwrite(fd, data, sizeof(data), size - 1024 * 1024);
+	close(fd);
+	stat(src, &srcStat);
+	if ((long long)srcStat.st_blocks * 512 >= size) {
+		/* 疎なファイルに対応していないファイルシステム */
+		CmnFile_Remove(src);
+		return;
+	}
+
+	CmnFile_Remove(dst);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Copy(src, dst, 0), 0);
+	stat(dst, &dstStat);
+	CmnTest_AssertNumber(t, __LINE__, (long long)dstStat.st_size, size);
+	CmnTest_AssertNumber(t, __LINE__, (long long)dstStat.st_blocks * 512 < 16 * 1024 * 1024, True);
+	fd = open(dst, O_RDONLY);
+	pread(fd, readBuf, sizeof(readBuf), 128 * 1024 * 1024);
+	CmnTest_AssertData(t, __LINE__, readBuf, data, sizeof(data));
+	pread(fd, readBuf, sizeof(readBuf), size - 1024 * 1024);
+	CmnTest_AssertData(t, __LINE__, readBuf, data, sizeof(data));
+	memset(data, 0, sizeof(data));
+	pread(fd, readBuf, sizeof(readBuf), 64 * 1024 * 1024);
+	CmnTest_AssertData(t, __LINE__, readBuf, data, sizeof(data));
+	close(fd);
+
+	CmnFile_Remove(src);
+	CmnFile_Remove(dst);
+#endif
+}
+
+static void test_CmnFile_Move(CmnTestCase *t)
+{
+	char *src = "test/resources/CmnFile/MoveSrc.txt";
+	char *dst = "test/resources/CmnFile/MoveDst.txt";
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+#if IS_PRATFORM_LINUX()
+	char *otherDev = "/dev/shm/cmnclib_MoveDst.txt";
+	struct stat st1, st2;
+#endif
+
+	/* 同じファイルシステム内の移動、上書きしない場合は移動先があれば失敗 */
+	CmnFile_Remove(dst);
+	CmnFile_WriteNew(src, "move", 4);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Move(src, dst, 0), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Exists(src), False);
+	CmnFile_ReadAll(dst, buf);
+	CmnTest_AssertData(t, __LINE__, buf->data, "move", 4);
+	CmnFile_WriteNew(src, "again", 5);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Move(src, dst, 0), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Exists(src), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Move(src, dst, CMN_FILE_COPY_OVERWRITE), 0);
+	buf->size = 0;
+	CmnFile_ReadAll(dst, buf);
+	CmnTest_AssertData(t, __LINE__, buf->data, "again", 5);
+
+#if IS_PRATFORM_LINUX()
+	/* 別のファイルシステムへの移動（コピーして削除） */
+	if (stat("/dev/shm", &st1) == 0 && stat("test/resources/CmnFile", &st2) == 0 && st1.st_dev != st2.st_dev) {
+		unlink(otherDev);
+		stat(dst, &st2);
+		CmnTest_AssertNumber(t, __LINE__, CmnFile_Move(dst, otherDev, 0), 0);
+		CmnTest_AssertNumber(t, __LINE__, CmnFile_Exists(dst), False);
+		stat(otherDev, &st1);
+		CmnTest_AssertNumber(t, __LINE__, st1.st_mtim.tv_sec, st2.st_mtim.tv_sec);
+		CmnTest_AssertNumber(t, __LINE__, CmnFile_Move(otherDev, dst, 0), 0);
+		buf->size = 0;
+		CmnFile_ReadAll(dst, buf);
+		CmnTest_AssertData(t, __LINE__, buf->data, "again", 5);
+	}
+#endif
+
+	CmnFile_Remove(dst);
+	CmnDataBuffer_Free(buf);
+}
+
+static void test_CmnFile_ReadAtWriteAt(CmnTestCase *t)
+{
+	char *path = "test/resources/CmnFile/ReadAtWriteAt.dat";
+	char buf[256];
+	char zero[90];
+	CmnFileHandle *file;
+#if IS_PRATFORM_LINUX()
+	char infoBuf[CMN_FILE_MAX_PATH * 3];
+	long long largeOffset = 5LL * 1024 * 1024 * 1024;
+	CmnFileInfo info;
+#endif
+
+	memset(zero, 0, sizeof(zero));
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Open("test/resources/CmnFile/nothing/x.dat", CMN_FILE_OPEN_READ) == NULL, True);
+
+	/* 任意の位置への書き込み、間はゼロで埋まる */
+	file = CmnFile_Open(path, CMN_FILE_OPEN_READ | CMN_FILE_OPEN_WRITE | CMN_FILE_OPEN_CREATE | CMN_FILE_OPEN_TRUNCATE);
+	CmnTest_AssertNumber(t, __LINE__, file != NULL, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteAt(file, "head", 4, 0), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteAt(file, "tail", 4, 100), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetSize(file), 104);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, 4, 0), 4);
+	CmnTest_AssertData(t, __LINE__, buf, "head", 4);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, 96, 4), 96);
+	CmnTest_AssertData(t, __LINE__, buf, zero, 90);
+	CmnTest_AssertData(t, __LINE__, buf + 96 - 4, zero, 4);
+
+	/* 終端をまたぐ読み込みは短くなり、終端以降は0 */
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, sizeof(buf), 98), 6);
+	CmnTest_AssertData(t, __LINE__, buf + 2, "tail", 4);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, sizeof(buf), 200), 0);
+
+	/* 上書き */
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteAt(file, "HE", 2, 0), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, 4, 0), 4);
+	CmnTest_AssertData(t, __LINE__, buf, "HEad", 4);
+
+	/* サイズの変更、領域の割り当て */
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Truncate(file, 50), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetSize(file), 50);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, sizeof(buf), 0), 50);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Allocate(file, 0, 4096), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetSize(file), 4096);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, 90, 1000), 90);
+	CmnTest_AssertData(t, __LINE__, buf, zero, 90);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Allocate(file, 0, 100), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetSize(file), 4096);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Sync(file), 0);
+
+#if IS_PRATFORM_LINUX()
+	/* 4GBを超える位置（スパースファイルになるため実際のディスク消費は少ない） */
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteAt(file, "large", 5, largeOffset), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetSize(file), largeOffset + 5);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ReadAt(file, buf, sizeof(buf), largeOffset), 5);
+	CmnTest_AssertData(t, __LINE__, buf, "large", 5);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetFileInfo(path, &info) != NULL, True);
+	CmnTest_AssertNumber(t, __LINE__, info.size, largeOffset + 5);
+	CmnFileInfo_ToString(&info, infoBuf);
+	CmnTest_AssertNumber(t, __LINE__, strstr(infoBuf, "size=5368709125,") != NULL, True);
+#endif
+
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Close(file), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Close(NULL), 0);
+
+	/* 読み込み専用で開いた場合は書き込めない */
+	file = CmnFile_Open(path, CMN_FILE_OPEN_READ);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WriteAt(file, "x", 1, 0), -1);
+	CmnFile_Close(file);
+	CmnFile_Remove(path);
+}
+
+/** 非同期ファイル入出力のテストの完了の集計 */
+typedef struct {
+	int count;
+	int errors;
+	int syncs;
+	long long bytes;
+	int order[16];				/**< 完了した要求のdata（番号）の順番 */
+} AioResult;
+
+static void aioCallback(const CmnFileAioRequest *request, long long result, void *data)
+{
+	AioResult *r = data;
+
+	if (r->count < 16) {
+		r->order[r->count] = (int)(size_t)request->data;
+	}
+	r->count++;
+	if (result < 0) {
+		r->errors++;
+	} else if (request->type == CMN_FILE_AIO_SYNC) {
+		r->syncs++;
+	} else {
+		r->bytes += result;
+	}
+}
+
+static void testCmnFileAio(CmnTestCase *t, int flags)
+{
+	char *path = "test/resources/CmnFile/Aio.dat";
+	CmnFileAioOption option = { 8, 2, 4096, 8, 0 };
+	CmnFileAioRequest requests[10];
+	CmnFileHandle *file, *readOnly;
+	CmnFileAio *aio;
+	AioResult r;
+	char *bufs[9], plain[100];
+	int i;
+
+	option.flags = flags;
+	aio = CmnFileAio_Create(&option);
+	CmnTest_AssertNumber(t, __LINE__, aio != NULL, True);
+	if (flags & CMN_FILE_AIO_THREAD_POOL) {
+		CmnTest_AssertNumber(t, __LINE__, CmnFileAio_IsUring(aio), False);
+	}
+	file = CmnFile_Open(path, CMN_FILE_OPEN_READ | CMN_FILE_OPEN_WRITE | CMN_FILE_OPEN_CREATE | CMN_FILE_OPEN_TRUNCATE);
+
+	/* バッファプール：上限まで取得でき、返すと再度取得できる */
+	for (i = 0; i < 8; i++) {
+		bufs[i] = CmnFileAio_GetBuffer(aio);
+		CmnTest_AssertNumber(t, __LINE__, bufs[i] != NULL, True);
+		CmnTest_AssertNumber(t, __LINE__, (size_t)bufs[i] % 4096, 0);
+	}
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_GetBuffer(aio) == NULL, True);
+	CmnFileAio_ReleaseBuffer(aio, bufs[7]);
+	bufs[8] = CmnFileAio_GetBuffer(aio);
+	CmnTest_AssertNumber(t, __LINE__, bufs[8] == bufs[7], True);
+
+	/* 書き込み4件と同期をまとめて投入 */
+	memset(&r, 0, sizeof(r));
+	for (i = 0; i < 4; i++) {
+		memset(bufs[i], 'a' + i, 4096);
+		requests[i].type = CMN_FILE_AIO_WRITE;
+		requests[i].file = file;
+		requests[i].buf = bufs[i];
+		requests[i].len = 4096;
+		requests[i].offset = (long long)i * 4096;
+		requests[i].data = (void *)(size_t)i;
+	}
+	requests[4].type = CMN_FILE_AIO_SYNC;
+	requests[4].file = file;
+	requests[4].buf = NULL;
+	requests[4].len = 0;
+	requests[4].offset = 0;
+	requests[4].data = (void *)(size_t)4;
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 5), 5);
+	while (CmnFileAio_Poll(aio, -1, aioCallback, &r) > 0) {}
+	CmnTest_AssertNumber(t, __LINE__, r.count, 5);
+	CmnTest_AssertNumber(t, __LINE__, r.errors, 0);
+	CmnTest_AssertNumber(t, __LINE__, r.syncs, 1);
+	CmnTest_AssertNumber(t, __LINE__, r.bytes, 4 * 4096);
+	CmnTest_AssertNumber(t, __LINE__, r.order[4], 4);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_GetSize(file), 4 * 4096);
+
+	/* 読み込み（バッファプール外の領域、終端をまたぐ読み込み、終端以降） */
+	memset(&r, 0, sizeof(r));
+	for (i = 0; i < 4; i++) {
+		requests[i].type = CMN_FILE_AIO_READ;
+		requests[i].buf = bufs[4 + i];
+		requests[i].offset = (long long)(3 - i) * 4096;
+	}
+	requests[4].type = CMN_FILE_AIO_READ;
+	requests[4].buf = plain;
+	requests[4].len = sizeof(plain);
+	requests[4].offset = 4 * 4096 - 10;
+	requests[5] = requests[4];
+	requests[5].offset = 5 * 4096;
+	requests[5].data = (void *)(size_t)5;
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 6), 6);
+	while (CmnFileAio_Poll(aio, -1, aioCallback, &r) > 0) {}
+	CmnTest_AssertNumber(t, __LINE__, r.count, 6);
+	CmnTest_AssertNumber(t, __LINE__, r.bytes, 4 * 4096 + 10);
+	for (i = 0; i < 4; i++) {
+		CmnTest_AssertData(t, __LINE__, bufs[4 + i], bufs[3 - i], 4096);
+	}
+	CmnTest_AssertData(t, __LINE__, plain, "dddddddddd", 10);
+
+	/* 処理中の要求の上限、待つ時間 */
+	for (i = 0; i < 10; i++) {
+		requests[i] = requests[0];
+	}
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 10), 8);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 1), 0);
+	while (CmnFileAio_Poll(aio, 1000, NULL, NULL) > 0) {}
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Poll(aio, 100, NULL, NULL), 0);
+
+	/* 不正な要求、読み込み専用のファイルへの書き込みはエラー */
+	requests[0].type = 99;
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 1), -1);
+	readOnly = CmnFile_Open(path, CMN_FILE_OPEN_READ);
+	memset(&r, 0, sizeof(r));
+	requests[0].type = CMN_FILE_AIO_WRITE;
+	requests[0].file = readOnly;
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 1), 1);
+	while (CmnFileAio_Poll(aio, -1, aioCallback, &r) > 0) {}
+	CmnTest_AssertNumber(t, __LINE__, r.errors, 1);
+
+	/* 処理中の要求があっても解放できる */
+	requests[0].type = CMN_FILE_AIO_READ;
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, requests, 1), 1);
+	for (i = 0; i < 8; i++) {
+		CmnFileAio_ReleaseBuffer(aio, (i == 7) ? bufs[8] : bufs[i]);
+	}
+	CmnFileAio_Free(aio);
+	CmnFile_Close(readOnly);
+	CmnFile_Close(file);
+	CmnFile_Remove(path);
+}
+
+static void test_CmnFileAio(CmnTestCase *t)
+{
+	testCmnFileAio(t, 0);
+	testCmnFileAio(t, CMN_FILE_AIO_THREAD_POOL);
+}
+
+#if IS_PRATFORM_LINUX()
+/** 複数スレッドでの完了の確認用 */
+typedef struct {
+	CmnFileAio *aio;
+	CmnThreadMutex *mutex;
+	int done;
+	int result;
+} AioPollThread;
+
+static void aioPollMethod(CmnThread *thread)
+{
+	AioPollThread *p = thread->data;
+	int result = CmnFileAio_Poll(p->aio, -1, NULL, NULL);
+
+	CmnThreadMutex_Lock(p->mutex);
+	p->done = True;
+	p->result = result;
+	CmnThreadMutex_UnLock(p->mutex);
+}
+
+/* 2つのスレッドが同時に完了を待ち、片方が最後の完了を取り出した場合に、もう片方が待ち続けないこと */
+static void testCmnFileAio_MultiThread(CmnTestCase *t, int flags)
+{
+	char *path = "test/resources/CmnFile/AioFifo";
+	CmnFileAioOption option = { 8, 2, 0, 0, 0 };
+	CmnFileAioRequest request;
+	AioPollThread polls[2];
+	CmnThread threads[2];
+	CmnThreadMutex *mutex = CmnThreadMutex_Create();
+	CmnFileHandle *fifo;
+	CmnFileAio *aio;
+	char buf[1];
+	int i, writer, done = 0, total = 0, elapsed;
+
+	/* FIFOの読み込みは書き込まれるまで完了しない */
+	unlink(path);
+	mkfifo(path, 0600);
+	fifo = CmnFile_Open(path, CMN_FILE_OPEN_READ | CMN_FILE_OPEN_WRITE);
+	option.flags = flags;
+	aio = CmnFileAio_Create(&option);
+	memset(&request, 0, sizeof(request));
+	request.type = CMN_FILE_AIO_READ;
+	request.file = fifo;
+	request.buf = buf;
+	request.len = 1;
+	CmnTest_AssertNumber(t, __LINE__, CmnFileAio_Submit(aio, &request, 1), 1);
+
+	for (i = 0; i < 2; i++) {
+		polls[i].aio = aio;
+		polls[i].mutex = mutex;
+		polls[i].done = False;
+		polls[i].result = 0;
+		CmnThread_Init(&threads[i], aioPollMethod, &polls[i], NULL);
+		CmnThread_Start(&threads[i]);
+	}
+	CmnTime_Sleep(50);
+	writer = open(path, O_WRONLY | O_NONBLOCK);
+	CmnTest_AssertNumber(t, __LINE__, write(writer, "x", 1), 1);
+
+	for (elapsed = 0; elapsed < 3000 && done < 2; elapsed += 10) {
+		CmnTime_Sleep(10);
+		CmnThreadMutex_Lock(mutex);
+		done = polls[0].done + polls[1].done;
+		total = polls[0].result + polls[1].result;
+		CmnThreadMutex_UnLock(mutex);
+	}
+	CmnTest_AssertNumber(t, __LINE__, done, 2);
+	CmnTest_AssertNumber(t, __LINE__, total, 1);
+	for (i = 0; i < 2; i++) {
+		if (polls[i].done) {
+			CmnThread_Join(&threads[i]);
+		} else {
+			CmnThread_Kill(&threads[i]);
+		}
+	}
+
+	close(writer);
+	CmnFileAio_Free(aio);
+	CmnFile_Close(fifo);
+	CmnThreadMutex_Free(mutex);
+	unlink(path);
+}
+#endif
+
+static void test_CmnFileAio_MultiThread(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	testCmnFileAio_MultiThread(t, 0);
+	testCmnFileAio_MultiThread(t, CMN_FILE_AIO_THREAD_POOL);
+#endif
+}
+
 static void test_CmnFile_List(CmnTestCase *t)
 {
 	int i;
@@ -102,6 +668,234 @@ static void test_CmnFile_List(CmnTestCase *t)
 	CmnDataList_Free(list, free);
 }
 
+/* ディレクトリの走査の結果 */
+typedef struct {
+	int count;
+	int files;
+	int dirs;
+	int links;
+	int maxDepth;
+	long long totalSize;
+	const char *prune;
+	int stopAt;
+	CmnThreadMutex *mutex;			/* 並列走査の場合の排他制御 */
+} WalkResult;
+
+static int walkCallback(const CmnFileWalkEntry *entry, void *data)
+{
+	WalkResult *result = data;
+
+	result->count++;
+	if (entry->type == CMN_FILE_TYPE_FILE) result->files++;
+	if (entry->type == CMN_FILE_TYPE_DIRECTORY) result->dirs++;
+	if (entry->type == CMN_FILE_TYPE_SYMLINK) result->links++;
+	if (entry->depth > result->maxDepth) result->maxDepth = entry->depth;
+	result->totalSize += entry->size;
+	if (strlen(entry->path) != entry->pathLength || strcmp(entry->path + entry->pathLength - strlen(entry->name), entry->name) != 0) {
+		result->count = -10000;
+	}
+	if (result->stopAt > 0 && result->count >= result->stopAt) {
+		return CMN_FILE_WALK_STOP;
+	}
+	if (result->prune != NULL && strcmp(entry->name, result->prune) == 0) {
+		return CMN_FILE_WALK_PRUNE;
+	}
+	return CMN_FILE_WALK_CONTINUE;
+}
+
+/* 並列走査用：複数のスレッドから呼ばれるため排他制御して集計する */
+static int walkCallbackLocked(const CmnFileWalkEntry *entry, void *data)
+{
+	WalkResult *result = data;
+	int ret;
+
+	CmnThreadMutex_Lock(result->mutex);
+	ret = walkCallback(entry, data);
+	CmnThreadMutex_UnLock(result->mutex);
+	return ret;
+}
+
+static void test_CmnFile_Walk(CmnTestCase *t)
+{
+	char *dir = "test/resources/CmnFile/list";
+	WalkResult result;
+
+	/* 全て走査（a.txt, b.txt, dir, dir/dir_a.txt） */
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk(dir, 0, 0, walkCallback, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 4);
+	CmnTest_AssertNumber(t, __LINE__, result.files, 3);
+	CmnTest_AssertNumber(t, __LINE__, result.dirs, 1);
+	CmnTest_AssertNumber(t, __LINE__, result.maxDepth, 2);
+
+	/* 末尾のパス区切り、サイズの取得 */
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk("test/resources/CmnFile/list/", 0, CMN_FILE_WALK_STAT, walkCallback, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 4);
+	CmnTest_AssertNumber(t, __LINE__, result.totalSize > 100, True);
+
+	/* 深さの制限 */
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk(dir, 1, 0, walkCallback, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 3);
+	CmnTest_AssertNumber(t, __LINE__, result.maxDepth, 1);
+
+	/* 配下を走査しない */
+	memset(&result, 0, sizeof(result));
+	result.prune = "dir";
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk(dir, 0, 0, walkCallback, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 3);
+
+	/* 中止 */
+	memset(&result, 0, sizeof(result));
+	result.stopAt = 2;
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk(dir, 0, 0, walkCallback, &result), 1);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 2);
+
+	/* 並列走査 */
+	memset(&result, 0, sizeof(result));
+	result.mutex = CmnThreadMutex_Create();
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WalkParallel(dir, 0, CMN_FILE_WALK_STAT, 4, walkCallbackLocked, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 4);
+	CmnTest_AssertNumber(t, __LINE__, result.files, 3);
+	CmnTest_AssertNumber(t, __LINE__, result.maxDepth, 2);
+	result.count = 0;
+	result.prune = "dir";
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WalkParallel(dir, 0, 0, 4, walkCallbackLocked, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 3);
+	result.count = 0;
+	result.prune = NULL;
+	result.stopAt = 2;
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WalkParallel(dir, 0, 0, 4, walkCallbackLocked, &result), 1);
+	CmnTest_AssertNumber(t, __LINE__, result.count >= 2, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WalkParallel("aaa/bbb/ccc", 0, 0, 4, walkCallbackLocked, &result), -1);
+	CmnThreadMutex_Free(result.mutex);
+
+	/* 存在しないディレクトリ、ディレクトリではないパス */
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk("aaa/bbb/ccc", 0, 0, walkCallback, &result), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk("test/resources/CmnFile/ReadAll.txt", 0, 0, walkCallback, &result), -1);
+
+#if IS_PRATFORM_LINUX()
+	/* シンボリックリンク（親ディレクトリへのリンクによる循環） */
+	mkdir("test/resources/CmnFile/walk", 0755);
+	mkdir("test/resources/CmnFile/walk/sub", 0755);
+	CmnFile_WriteNew("test/resources/CmnFile/walk/sub/file.txt", "12345", 5);
+	symlink("..", "test/resources/CmnFile/walk/sub/loop");
+	symlink("sub/file.txt", "test/resources/CmnFile/walk/link.txt");
+	symlink("nothing", "test/resources/CmnFile/walk/broken");
+
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk("test/resources/CmnFile/walk", 0, 0, walkCallback, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 5);
+	CmnTest_AssertNumber(t, __LINE__, result.links, 3);
+
+	/* たどる場合：sub, sub/file.txt, sub/loop(ディレクトリとして通知するが循環するため走査しない), link.txt(ファイル), broken */
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_Walk("test/resources/CmnFile/walk", 0, CMN_FILE_WALK_FOLLOW_LINKS, walkCallback, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 5);
+	CmnTest_AssertNumber(t, __LINE__, result.dirs, 2);
+	CmnTest_AssertNumber(t, __LINE__, result.files, 2);
+	CmnTest_AssertNumber(t, __LINE__, result.links, 1);
+	CmnTest_AssertNumber(t, __LINE__, result.totalSize >= 10, True);
+
+	/* 並列走査でたどる場合：sub/loop（起点のディレクトリ）は走査済みのため走査しない */
+	memset(&result, 0, sizeof(result));
+	result.mutex = CmnThreadMutex_Create();
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_WalkParallel("test/resources/CmnFile/walk", 0, CMN_FILE_WALK_FOLLOW_LINKS, 3, walkCallbackLocked, &result), 0);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 5);
+	CmnTest_AssertNumber(t, __LINE__, result.dirs, 2);
+	CmnThreadMutex_Free(result.mutex);
+
+	unlink("test/resources/CmnFile/walk/broken");
+	unlink("test/resources/CmnFile/walk/link.txt");
+	unlink("test/resources/CmnFile/walk/sub/loop");
+	unlink("test/resources/CmnFile/walk/sub/file.txt");
+	rmdir("test/resources/CmnFile/walk/sub");
+	rmdir("test/resources/CmnFile/walk");
+#endif
+}
+
+/* 並列走査を途中で中止した場合（各スレッドのキューに走査待ちのディレクトリが残った状態で後始末する） */
+static void test_CmnFile_WalkParallel_Stop(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *root = "test/resources/CmnFile/walkstop";
+	char path[256];
+	int dirs = 40, subs = 4, i, j, n;
+	WalkResult result;
+
+	mkdir(root, 0755);
+	for (i = 0; i < dirs; i++) {
+		sprintf(path, "%s/d%02d", root, i);
+		mkdir(path, 0755);
+		for (j = 0; j < subs; j++) {
+			sprintf(path, "%s/d%02d/s%d", root, i, j);
+			mkdir(path, 0755);
+		}
+	}
+
+	memset(&result, 0, sizeof(result));
+	result.mutex = CmnThreadMutex_Create();
+	for (n = 0; n < 20; n++) {
+		result.count = 0;
+		result.stopAt = 5;
+		CmnTest_AssertNumber(t, __LINE__, CmnFile_WalkParallel(root, 0, 0, 4, walkCallbackLocked, &result), 1);
+		CmnTest_AssertNumber(t, __LINE__, result.count < dirs + dirs * subs, True);
+	}
+	CmnThreadMutex_Free(result.mutex);
+
+	for (i = 0; i < dirs; i++) {
+		for (j = 0; j < subs; j++) {
+			sprintf(path, "%s/d%02d/s%d", root, i, j);
+			rmdir(path);
+		}
+		sprintf(path, "%s/d%02d", root, i);
+		rmdir(path);
+	}
+	rmdir(root);
+#endif
+}
+
+static void test_CmnFileEntryList(CmnTestCase *t)
+{
+	CmnFileEntryList *list = CmnFileEntryList_Create();
+	CmnStringBuffer *buf = CmnStringBuffer_Create("");
+	CmnFileInfo info;
+	int i, dir = -1, file = -1;
+
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ListEntries("test/resources/CmnFile/list/", 0, CMN_FILE_WALK_STAT, list) == list, True);
+	CmnTest_AssertNumber(t, __LINE__, list->size, 4);
+	CmnTest_AssertString(t, __LINE__, (char *)list->root, "test/resources/CmnFile/list");
+	for (i = 0; i < list->size; i++) {
+		if (strcmp(list->entries[i].name, "dir") == 0) dir = i;
+		if (strcmp(list->entries[i].name, "dir_a.txt") == 0) file = i;
+	}
+	CmnTest_AssertNumber(t, __LINE__, dir >= 0 && file > dir, True);
+	CmnTest_AssertNumber(t, __LINE__, list->entries[dir].parent, -1);
+	CmnTest_AssertNumber(t, __LINE__, list->entries[dir].type, CMN_FILE_TYPE_DIRECTORY);
+	CmnTest_AssertNumber(t, __LINE__, list->entries[file].parent, dir);
+	CmnTest_AssertNumber(t, __LINE__, list->entries[file].type, CMN_FILE_TYPE_FILE);
+
+	/* パスの組み立て、CmnFileInfoへの変換 */
+	CmnTest_AssertString(t, __LINE__, CmnFileEntryList_GetPath(list, file, buf)->string, "test/resources/CmnFile/list/dir/dir_a.txt");
+	CmnTest_AssertNumber(t, __LINE__, CmnFileEntryList_ToFileInfo(list, file, &info) == &info, True);
+	CmnTest_AssertString(t, __LINE__, info.parentDir, "test/resources/CmnFile/list/dir");
+	CmnTest_AssertString(t, __LINE__, info.name, "dir_a.txt");
+	CmnTest_AssertNumber(t, __LINE__, info.size, list->entries[file].size);
+	CmnTest_AssertNumber(t, __LINE__, info.isFile, True);
+	CmnTest_AssertNumber(t, __LINE__, info.isDirectory, False);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileEntryList_ToString(list, file, buf) == buf, True);
+	CmnTest_AssertNumber(t, __LINE__, strstr(buf->string, "parentDir=test/resources/CmnFile/list/dir, name=dir_a.txt") != NULL, True);
+
+	/* 深さの制限、存在しないディレクトリ */
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ListEntries("test/resources/CmnFile/list", 1, 0, list) == list, True);
+	CmnTest_AssertNumber(t, __LINE__, list->size, 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFile_ListEntries("test/resources/CmnFile/nothing", 0, 0, list) == NULL, True);
+
+	CmnStringBuffer_Free(buf);
+	CmnFileEntryList_Free(list);
+}
+
 static void test_CmnFile_ToAbsolutePath(CmnTestCase *t)
 {
 	char target[] = "test/resources/CmnFile/ReadAll.txt";
@@ -175,13 +969,694 @@ static void test_CmnFile_GetFileInfo(CmnTestCase *t)
 	}
 }
 
+static void test_CmnFile_Map(CmnTestCase *t)
+{
+	char *file = "test/resources/CmnFile/MapTest.bin";
+	size_t size = 4 * 1024 * 1024 + 123;
+	unsigned char *data = malloc(size);
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+	CmnFileMap *map;
+	FILE *fp;
+	size_t i;
+
+	/* 通常のファイル（ReadAllと同じ内容） */
+	CmnFile_ReadAll("test/resources/CmnFile/ReadAll.txt", buf);
+	map = CmnFile_Map("test/resources/CmnFile/ReadAll.txt", CMN_FILE_MAP_SEQUENTIAL);
+	CmnTest_AssertNumber(t, __LINE__, map != NULL, True);
+	CmnTest_AssertNumber(t, __LINE__, map->size, buf->size);
+	CmnTest_AssertNumber(t, __LINE__, memcmp(map->data, buf->data, buf->size), 0);
+	CmnFile_Unmap(map);
+
+	/* ヒュージページ境界にマップされるサイズ */
+	for (i = 0; i < size; i++) data[i] = (unsigned char)(i * 7 + (i >> 12));
+	CmnFile_WriteNew(file, data, size);
+	map = CmnFile_Map(file, CMN_FILE_MAP_RANDOM | CMN_FILE_MAP_WILLNEED);
+	CmnTest_AssertNumber(t, __LINE__, map->size, size);
+	CmnTest_AssertNumber(t, __LINE__, memcmp(map->data, data, size), 0);
+#if IS_PRATFORM_LINUX()
+	CmnTest_AssertNumber(t, __LINE__, (uintptr_t)map->data % (2 * 1024 * 1024), 0);
+#endif
+	CmnFile_Unmap(map);
+
+	/* 開いているファイル（現在位置に関わらず先頭からマップする） */
+	fp = fopen(file, "rb");
+	fgetc(fp);
+	map = CmnFile_MapStream(fp, CMN_FILE_MAP_SEQUENTIAL);
+	fclose(fp);
+	CmnTest_AssertNumber(t, __LINE__, map->size, size);
+	CmnTest_AssertNumber(t, __LINE__, memcmp(map->data, data, size), 0);
+	CmnFile_Unmap(map);
+
+	/* 空のファイル */
+	CmnFile_WriteNew(file, "", 0);
+	map = CmnFile_Map(file, CMN_FILE_MAP_NORMAL);
+	CmnTest_AssertNumber(t, __LINE__, map->size, 0);
+	CmnTest_AssertString(t, __LINE__, (char *)map->data, "");
+	CmnFile_Unmap(map);
+	CmnFile_Remove(file);
+
+	/* 存在しないファイル */
+	CmnTest_AssertPointer(t, __LINE__, CmnFile_Map("test/resources/CmnFile/NotFound.txt", CMN_FILE_MAP_NORMAL), NULL);
+	CmnFile_Unmap(NULL);
+
+#if IS_PRATFORM_LINUX()
+	/* サイズが0と報告されるファイル（マップできないため読み込む） */
+	map = CmnFile_Map("/proc/self/status", CMN_FILE_MAP_NORMAL);
+	CmnTest_AssertNumber(t, __LINE__, map != NULL && map->size > 0, True);
+	CmnTest_AssertNumber(t, __LINE__, memcmp(map->data, "Name:", 5), 0);
+	CmnFile_Unmap(map);
+#endif
+
+	CmnDataBuffer_Free(buf);
+	free(data);
+}
+
+/* 読み込んだ行がCmnString_StrEolで分割した結果と一致するか検証する */
+static void assertReaderLines(CmnTestCase *t, const char *file, const char *data, size_t blockSize, int flags)
+{
+	CmnFileReader *reader = CmnFileReader_Open(file, blockSize, flags);
+	CmnStringView line;
+	const char *p = data, *eol;
+	char delim[3];
+	long long lines = 0, ng = 0;
+
+	CmnTest_AssertNumber(t, __LINE__, reader != NULL, True);
+	while (*p != '\0') {
+		eol = CmnString_StrEol(p, delim);
+		if (eol == NULL) eol = p + strlen(p);
+		if (CmnFileReader_ReadLine(reader, &line) != 1 || line.len != (size_t)(eol - p) || memcmp(line.str, p, line.len) != 0) {
+			ng++;
+			break;
+		}
+		lines++;
+		p = (*eol == '\0') ? eol : eol + strlen(delim);
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 0);
+	CmnTest_AssertNumber(t, __LINE__, lines > 0, True);
+	CmnFileReader_Free(reader);
+}
+
+static void test_CmnFileReader_ReadLine(CmnTestCase *t)
+{
+	char *file = "test/resources/CmnFile/Reader.txt";
+	CmnFileReader *reader;
+	CmnStringView line;
+	size_t size = 2 * 1024 * 1024, pos = 0, len, i;
+	char *data = malloc(size + 1);
+	unsigned int seed = 12345;
+	static const char *eols[] = { "\n", "\r", "\r\n" };
+
+	/* 小さいファイル：CRLF、LF、CR、空行、改行で終わらない最後の行 */
+	CmnFile_WriteNew(file, "abc\r\ndef\nghi\r\r\njkl", 18);
+	reader = CmnFileReader_Open(file, 0, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+	CmnTest_AssertData(t, __LINE__, (void *)line.str, "abc", 3); CmnTest_AssertNumber(t, __LINE__, line.len, 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+	CmnTest_AssertData(t, __LINE__, (void *)line.str, "def", 3); CmnTest_AssertNumber(t, __LINE__, line.len, 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+	CmnTest_AssertData(t, __LINE__, (void *)line.str, "ghi", 3); CmnTest_AssertNumber(t, __LINE__, line.len, 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+	CmnTest_AssertNumber(t, __LINE__, line.len, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+	CmnTest_AssertData(t, __LINE__, (void *)line.str, "jkl", 3); CmnTest_AssertNumber(t, __LINE__, line.len, 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 0);
+	CmnFileReader_Free(reader);
+
+	/* 空ファイル */
+	CmnFile_WriteNew(file, "", 0);
+	reader = CmnFileReader_Open(file, 0, CMN_FILE_READER_READ_AHEAD);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 0);
+	CmnFileReader_Free(reader);
+
+	/* 存在しないファイル */
+	CmnTest_AssertPointer(t, __LINE__, CmnFileReader_Open("test/resources/CmnFile/NotExists.txt", 0, 0), NULL);
+
+	/* 大きなファイル：ランダムな長さの行と改行コード、ブロックより長い行、ブロック境界をまたぐCRLF */
+	while (pos < size - 300) {
+		seed = seed * 1103515245 + 12345;
+		len = (seed >> 16) % 200;
+		for (i = 0; i < len; i++, pos++) data[pos] = (char)('a' + (pos % 26));
+		len = strlen(eols[(seed >> 8) % 3]);
+		memcpy(data + pos, eols[(seed >> 8) % 3], len);
+		pos += len;
+		if (pos > 300000 && pos < 400000) {
+			for (i = 0; i < 200000; i++) data[pos++] = 'x';
+		}
+	}
+	memcpy(data + 65535, "\r\n", 2);
+	memcpy(data + 131071, "\r\r", 2);
+	data[pos] = '\0';
+	CmnFile_WriteNew(file, data, pos);
+
+	assertReaderLines(t, file, data, 64 * 1024, 0);
+	assertReaderLines(t, file, data, 64 * 1024, CMN_FILE_READER_READ_AHEAD);
+	assertReaderLines(t, file, data, 0, 0);
+	assertReaderLines(t, file, data, 4 * 1024 * 1024, CMN_FILE_READER_READ_AHEAD);
+
+	CmnFile_Remove(file);
+	free(data);
+}
+
+#if IS_PRATFORM_LINUX()
+static void test_CmnFileReader_Pipe(CmnTestCase *t)
+{
+	int fds[2];
+	FILE *in;
+	CmnFileReader *reader;
+	CmnStringView line;
+	int flags;
+
+	/* パイプの書き込み側を開いたまま、書き込まれた行がブロックを待たずに読めること */
+	for (flags = 0; flags <= CMN_FILE_READER_READ_AHEAD; flags += CMN_FILE_READER_READ_AHEAD) {
+		CmnTest_AssertNumber(t, __LINE__, pipe(fds), 0);
+		in = fdopen(fds[0], "rb");
+		reader = CmnFileReader_Create(in, 0, flags);
+		CmnTest_AssertNumber(t, __LINE__, write(fds[1], "first\nsec", 9), 9);
+		CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+		CmnTest_AssertData(t, __LINE__, (void *)line.str, "first", 5); CmnTest_AssertNumber(t, __LINE__, line.len, 5);
+		CmnTest_AssertNumber(t, __LINE__, write(fds[1], "ond\n", 4), 4);
+		CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 1);
+		CmnTest_AssertData(t, __LINE__, (void *)line.str, "second", 6); CmnTest_AssertNumber(t, __LINE__, line.len, 6);
+		close(fds[1]);
+		CmnTest_AssertNumber(t, __LINE__, CmnFileReader_ReadLine(reader, &line), 0);
+		CmnFileReader_Free(reader);
+		fclose(in);
+	}
+}
+#endif
+
+/** 監視のイベントの記録 */
+typedef struct {
+	int count;
+	char paths[16][256];
+	int events[16];
+	int isDirectory[16];
+	CmnThreadMutex *mutex;
+} WatchResult;
+
+static void watchCallback(const CmnFileWatchEvent *event, void *data)
+{
+	WatchResult *result = data;
+
+	if (result->mutex != NULL) CmnThreadMutex_Lock(result->mutex);
+	if (result->count < 16) {
+		strcpy(result->paths[result->count], event->path);
+		result->events[result->count] = event->events;
+		result->isDirectory[result->count] = event->isDirectory;
+	}
+	result->count++;
+	if (result->mutex != NULL) CmnThreadMutex_UnLock(result->mutex);
+}
+
+/** 記録したイベントからパスが一致するものを探す（見つからない場合は0） */
+static int findWatchEvent(WatchResult *result, const char *path)
+{
+	int i;
+	for (i = 0; i < result->count && i < 16; i++) {
+		if (strcmp(result->paths[i], path) == 0) return result->events[i];
+	}
+	return 0;
+}
+
+static void test_CmnFileWatch(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *dir = "test/resources/CmnFile/watch";
+	CmnFileWatch *watch;
+	WatchResult result;
+
+	mkdir(dir, 0755);
+
+	/* 作成と続けての変更は1件にまとめる */
+	watch = CmnFileWatch_Open(dir, CMN_FILE_WATCH_RECURSIVE, 50);
+	CmnTest_AssertNumber(t, __LINE__, watch != NULL, True);
+	CmnFile_WriteNew("test/resources/CmnFile/watch/a.txt", "abc", 3);
+	CmnFile_WriteTail("test/resources/CmnFile/watch/a.txt", "def", 3);
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result), 1);
+	CmnTest_AssertString(t, __LINE__, result.paths[0], "test/resources/CmnFile/watch/a.txt");
+	CmnTest_AssertNumber(t, __LINE__, result.events[0], CMN_FILE_WATCH_CREATE | CMN_FILE_WATCH_MODIFY);
+
+	/* 作成したディレクトリ配下も監視する（監視の登録前に作成したファイルも通知する） */
+	mkdir("test/resources/CmnFile/watch/sub", 0755);
+	CmnFile_WriteNew("test/resources/CmnFile/watch/sub/b.txt", "b", 1);
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result) > 0, True);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, "test/resources/CmnFile/watch/sub"), CMN_FILE_WATCH_CREATE);
+	CmnTest_AssertNumber(t, __LINE__, result.isDirectory[0], True);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, "test/resources/CmnFile/watch/sub/b.txt") & CMN_FILE_WATCH_CREATE, CMN_FILE_WATCH_CREATE);
+	CmnFile_WriteTail("test/resources/CmnFile/watch/sub/b.txt", "c", 1);
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result), 1);
+	CmnTest_AssertString(t, __LINE__, result.paths[0], "test/resources/CmnFile/watch/sub/b.txt");
+	CmnTest_AssertNumber(t, __LINE__, result.events[0], CMN_FILE_WATCH_MODIFY);
+
+	/* 削除、変更がない場合はタイムアウト */
+	CmnFile_Remove("test/resources/CmnFile/watch/sub/b.txt");
+	rmdir("test/resources/CmnFile/watch/sub");
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result), 2);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, "test/resources/CmnFile/watch/sub/b.txt"), CMN_FILE_WATCH_DELETE);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, "test/resources/CmnFile/watch/sub"), CMN_FILE_WATCH_DELETE);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 100, watchCallback, &result), 0);
+	CmnFileWatch_Close(watch);
+
+	/* ファイルの監視（他のファイルは通知しない。リネームでの置き換えも検出する） */
+	watch = CmnFileWatch_Open("test/resources/CmnFile/watch/a.txt", 0, 0);
+	CmnTest_AssertNumber(t, __LINE__, watch != NULL, True);
+	CmnFile_WriteNew("test/resources/CmnFile/watch/other.txt", "x", 1);
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 100, watchCallback, &result), 0);
+	rename("test/resources/CmnFile/watch/other.txt", "test/resources/CmnFile/watch/a.txt");
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result), 1);
+	CmnTest_AssertString(t, __LINE__, result.paths[0], "test/resources/CmnFile/watch/a.txt");
+	CmnTest_AssertNumber(t, __LINE__, result.events[0], CMN_FILE_WATCH_CREATE);
+	CmnFileWatch_Close(watch);
+
+	/* 専用スレッドでの通知 */
+	watch = CmnFileWatch_Open(dir, 0, 10);
+	memset(&result, 0, sizeof(result));
+	result.mutex = CmnThreadMutex_Create();
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Start(watch, watchCallback, &result), 0);
+	CmnFile_WriteTail("test/resources/CmnFile/watch/a.txt", "x", 1);
+	CmnTime_Sleep(300);
+	CmnFileWatch_Close(watch);
+	CmnThreadMutex_Free(result.mutex);
+	CmnTest_AssertNumber(t, __LINE__, result.count, 1);
+	CmnTest_AssertNumber(t, __LINE__, result.events[0], CMN_FILE_WATCH_MODIFY);
+
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Open("test/resources/CmnFile/nothing/a.txt", 0, 0) == NULL, True);
+	CmnFile_Remove("test/resources/CmnFile/watch/a.txt");
+	rmdir(dir);
+#endif
+}
+
+static void test_CmnFileWatch_Overflow(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *dir = "test/resources/CmnFile/watchoverflow";
+	CmnFileWatch *watch;
+	WatchResult result;
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+	int maxEvents = 16384, i, fd1, fd2;
+
+	if (CmnFile_ReadAll("/proc/sys/fs/inotify/max_queued_events", buf) != NULL) {
+		CmnDataBuffer_Append(buf, "", 1);
+		maxEvents = atoi(buf->data);
+	}
+	mkdir(dir, 0755);
+	watch = CmnFileWatch_Open(dir, CMN_FILE_WATCH_RECURSIVE, 0);
+	fd1 = open("test/resources/CmnFile/watchoverflow/1.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	fd2 = open("test/resources/CmnFile/watchoverflow/2.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	/* 交互に書き込んで（連続する同じイベントはカーネルがまとめるため）キューをあふれさせる */
+	for (i = 0; i < maxEvents; i++) {
+		if (write(fd1, "x", 1) != 1 || write(fd2, "x", 1) != 1) break;
+	}
+	close(fd1);
+	close(fd2);
+
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result) > 0, True);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, dir), CMN_FILE_WATCH_RESCAN);
+	CmnTest_AssertNumber(t, __LINE__, result.count <= 4, True);
+
+	/* あふれた後も監視を続ける */
+	CmnFile_WriteNew("test/resources/CmnFile/watchoverflow/3.txt", "x", 1);
+	memset(&result, 0, sizeof(result));
+	while (CmnFileWatch_Read(watch, 100, watchCallback, &result) > 0);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, "test/resources/CmnFile/watchoverflow/3.txt") & CMN_FILE_WATCH_CREATE, CMN_FILE_WATCH_CREATE);
+
+	CmnFileWatch_Close(watch);
+	CmnFile_Remove("test/resources/CmnFile/watchoverflow/1.txt");
+	CmnFile_Remove("test/resources/CmnFile/watchoverflow/2.txt");
+	CmnFile_Remove("test/resources/CmnFile/watchoverflow/3.txt");
+	rmdir(dir);
+	CmnDataBuffer_Free(buf);
+#endif
+}
+
+static void test_CmnFileWatch_AddFailure(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *dir = "test/resources/CmnFile/watchfailure";
+	CmnFileWatch *watch;
+	WatchResult result;
+
+	mkdir(dir, 0755);
+	watch = CmnFileWatch_Open(dir, CMN_FILE_WATCH_RECURSIVE, 0);
+
+	/* 作成されたディレクトリの監視を登録できない場合（イベントを読み込む前にファイルに置き換える）は再走査を通知し、残りのイベントも通知する */
+	mkdir("test/resources/CmnFile/watchfailure/sub", 0755);
+	rmdir("test/resources/CmnFile/watchfailure/sub");
+	CmnFile_WriteNew("test/resources/CmnFile/watchfailure/sub", "x", 1);
+	CmnFile_WriteNew("test/resources/CmnFile/watchfailure/b.txt", "b", 1);
+	memset(&result, 0, sizeof(result));
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWatch_Read(watch, 1000, watchCallback, &result) > 0, True);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, dir) & CMN_FILE_WATCH_RESCAN, CMN_FILE_WATCH_RESCAN);
+	CmnTest_AssertNumber(t, __LINE__, findWatchEvent(&result, "test/resources/CmnFile/watchfailure/b.txt") & CMN_FILE_WATCH_CREATE, CMN_FILE_WATCH_CREATE);
+	CmnFileWatch_Close(watch);
+
+	CmnFile_Remove("test/resources/CmnFile/watchfailure/sub");
+	CmnFile_Remove("test/resources/CmnFile/watchfailure/b.txt");
+	rmdir(dir);
+#endif
+}
+
+static void test_CmnFileCache(CmnTestCase *t)
+{
+	char *file = "test/resources/CmnFile/cache.txt";
+	CmnFileCacheOption option = { 0, 0, 0 };
+	CmnFileCache *cache;
+	const CmnFileCacheEntry *entry1, *entry2, *entry3;
+	CmnFileCacheStats stats;
+
+	/* 2回目はキャッシュした内容を返す */
+	CmnFile_WriteNew(file, "abcdef", 6);
+	cache = CmnFileCache_Create(&option);
+	entry1 = CmnFileCache_Get(cache, file);
+	CmnTest_AssertNumber(t, __LINE__, entry1 != NULL, True);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 6);
+	CmnTest_AssertData(t, __LINE__, (void *)entry1->data, "abcdef", 6);
+	CmnTest_AssertNumber(t, __LINE__, entry1->path[0] == '/' || entry1->path[1] == ':', True);
+	entry2 = CmnFileCache_Get(cache, file);
+	CmnTest_AssertNumber(t, __LINE__, entry2 == entry1, True);
+	CmnFileCache_Release(cache, entry2);
+
+	/* 変更されたら読み込み直す（参照中の変更前の内容はそのまま） */
+	CmnFile_WriteNew(file, "ABCDEFGH", 8);
+	entry2 = CmnFileCache_Get(cache, file);
+	CmnTest_AssertNumber(t, __LINE__, entry2->size, 8);
+	CmnTest_AssertData(t, __LINE__, (void *)entry2->data, "ABCDEFGH", 8);
+	CmnTest_AssertData(t, __LINE__, (void *)entry1->data, "abcdef", 6);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Release(cache, entry2);
+	CmnFileCache_GetStats(cache, &stats);
+	CmnTest_AssertNumber(t, __LINE__, (int)stats.hits, 1);
+	CmnTest_AssertNumber(t, __LINE__, (int)stats.misses, 2);
+	CmnTest_AssertNumber(t, __LINE__, stats.count, 1);
+	CmnTest_AssertNumber(t, __LINE__, stats.size, 8);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileCache_Get(cache, "test/resources/CmnFile/nothing.txt") == NULL, True);
+	CmnFileCache_Free(cache);
+
+	/* 確認の間隔内は変更を検出しない */
+	option.revalidateInterval = 60000;
+	cache = CmnFileCache_Create(&option);
+	CmnFileCache_Release(cache, CmnFileCache_Get(cache, file));
+	CmnFile_WriteNew(file, "12", 2);
+	entry1 = CmnFileCache_Get(cache, file);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 8);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Free(cache);
+
+	/* 合計サイズの上限を超えたら、参照中でない最も長く使われていない内容から削除する */
+	option.maxSize = 20;
+	option.revalidateInterval = 0;
+	CmnFile_WriteNew("test/resources/CmnFile/cache1.txt", "1111111111", 10);
+	CmnFile_WriteNew("test/resources/CmnFile/cache2.txt", "2222222222", 10);
+	CmnFile_WriteNew("test/resources/CmnFile/cache3.txt", "3333333333", 10);
+	cache = CmnFileCache_Create(&option);
+	entry1 = CmnFileCache_Get(cache, "test/resources/CmnFile/cache1.txt");
+	CmnFileCache_Release(cache, CmnFileCache_Get(cache, "test/resources/CmnFile/cache2.txt"));
+	entry3 = CmnFileCache_Get(cache, "test/resources/CmnFile/cache3.txt");
+	CmnFileCache_GetStats(cache, &stats);
+	CmnTest_AssertNumber(t, __LINE__, (int)stats.evictions, 1);
+	CmnTest_AssertNumber(t, __LINE__, stats.count, 2);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileCache_Get(cache, "test/resources/CmnFile/cache1.txt") == entry1, True);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Release(cache, entry3);
+
+	/* 上限より大きいファイルはキャッシュしない */
+	CmnFile_WriteNew(file, "0123456789012345678901234567890", 31);
+	entry1 = CmnFileCache_Get(cache, file);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 31);
+	CmnFileCache_GetStats(cache, &stats);
+	CmnTest_AssertNumber(t, __LINE__, stats.size <= 20, True);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Free(cache);
+
+	CmnFile_Remove("test/resources/CmnFile/cache1.txt");
+	CmnFile_Remove("test/resources/CmnFile/cache2.txt");
+	CmnFile_Remove("test/resources/CmnFile/cache3.txt");
+	CmnFile_Remove(file);
+}
+
+static void test_CmnFileCache_Watch(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *dir = "test/resources/CmnFile/cachewatch";
+	char *file = "test/resources/CmnFile/cachewatch/a.txt";
+	CmnFileCacheOption option = { 0, 60000, CMN_FILE_CACHE_MAP };
+	CmnFileCache *cache;
+	const CmnFileCacheEntry *entry;
+	int i;
+
+	mkdir(dir, 0755);
+	CmnFile_WriteNew(file, "old", 3);
+	cache = CmnFileCache_Create(&option);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileCache_Watch(cache, dir), 0);
+	CmnFileCache_Release(cache, CmnFileCache_Get(cache, file));
+
+	/* 確認の間隔内でも監視のイベントで無効にする */
+	CmnFile_WriteNew("test/resources/CmnFile/cachewatch/a.tmp", "new!", 4);
+	rename("test/resources/CmnFile/cachewatch/a.tmp", file);
+	for (i = 0; i < 200; i++) {
+		entry = CmnFileCache_Get(cache, file);
+		if (entry->size == 4) break;
+		CmnFileCache_Release(cache, entry);
+		CmnTime_Sleep(10);
+	}
+	CmnTest_AssertNumber(t, __LINE__, entry->size, 4);
+	CmnTest_AssertData(t, __LINE__, (void *)entry->data, "new!", 4);
+	CmnFileCache_Release(cache, entry);
+
+	CmnFileCache_Free(cache);
+	CmnFile_Remove(file);
+	rmdir(dir);
+#endif
+}
+
+static void test_CmnFileCache_WatchLink(CmnTestCase *t)
+{
+#if IS_PRATFORM_LINUX()
+	char *dir = "test/resources/CmnFile/cachewatch";
+	char *outside = "test/resources/CmnFile/cachewatch_outside.txt";
+	char *symLink = "test/resources/CmnFile/cachewatch/symlink.txt";
+	char *hardLink = "test/resources/CmnFile/cachewatch/hardlink.txt";
+	char *file = "test/resources/CmnFile/cachewatch/a.txt";
+	CmnFileCacheOption option = { 0, 0, 0 };
+	CmnFileCache *cache;
+	const CmnFileCacheEntry *entry1, *entry2;
+
+	mkdir(dir, 0755);
+	CmnFile_WriteNew(file, "abc", 3);
+	CmnFile_WriteNew(outside, "old", 3);
+	unlink(symLink);
+	unlink(hardLink);
+	symlink("../cachewatch_outside.txt", symLink);
+	link(outside, hardLink);
+	cache = CmnFileCache_Create(&option);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileCache_Watch(cache, "test/resources/CmnFile/../CmnFile/cachewatch/"), 0);
+
+	/* 同じファイルを指すパスは正規化して同じ内容を返す */
+	entry1 = CmnFileCache_Get(cache, file);
+	entry2 = CmnFileCache_Get(cache, "test/resources/CmnFile/cachewatch/./../cachewatch//a.txt");
+	CmnTest_AssertNumber(t, __LINE__, entry2 == entry1, True);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Release(cache, entry2);
+
+	/* 監視の外から変更できるシンボリックリンク、ハードリンクは監視のイベントに頼らずに確認する */
+	CmnFileCache_Release(cache, CmnFileCache_Get(cache, symLink));
+	CmnFileCache_Release(cache, CmnFileCache_Get(cache, hardLink));
+	CmnFile_WriteNew(outside, "new!", 4);
+	entry1 = CmnFileCache_Get(cache, symLink);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 4);
+	CmnTest_AssertData(t, __LINE__, (void *)entry1->data, "new!", 4);
+	CmnTest_AssertString(t, __LINE__, (char *)entry1->path + strlen(entry1->path) - strlen("cachewatch_outside.txt"), "cachewatch_outside.txt");
+	CmnFileCache_Release(cache, entry1);
+	entry1 = CmnFileCache_Get(cache, hardLink);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 4);
+	CmnTest_AssertData(t, __LINE__, (void *)entry1->data, "new!", 4);
+	CmnFileCache_Release(cache, entry1);
+
+	/* シンボリックリンクの向き先の変更も、確認の間隔で検出する */
+	unlink(symLink);
+	symlink("a.txt", symLink);
+	entry1 = CmnFileCache_Get(cache, symLink);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 3);
+	CmnTest_AssertData(t, __LINE__, (void *)entry1->data, "abc", 3);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Free(cache);
+
+	/* 確認の間隔内は、前回正規化したパスの内容を返す */
+	option.revalidateInterval = 60000;
+	cache = CmnFileCache_Create(&option);
+	CmnFileCache_Release(cache, CmnFileCache_Get(cache, symLink));
+	unlink(symLink);
+	symlink("../cachewatch_outside.txt", symLink);
+	entry1 = CmnFileCache_Get(cache, symLink);
+	CmnTest_AssertNumber(t, __LINE__, entry1->size, 3);
+	CmnFileCache_Release(cache, entry1);
+	CmnFileCache_Free(cache);
+	unlink(symLink);
+	unlink(hardLink);
+	CmnFile_Remove(outside);
+	CmnFile_Remove(file);
+	rmdir(dir);
+#endif
+}
+
+static void test_CmnFileWriter_Write(CmnTestCase *t)
+{
+	char *file = "test/resources/CmnFile/Writer.txt";
+	CmnFileWriterOption option = { 16, 0, CMN_FILE_WRITER_SYNC_NONE };
+	CmnFileWriter *writer;
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+	char big[100];
+
+	/* バッファ内、バッファが一杯、バッファより大きいデータ */
+	memset(big, 'z', sizeof(big));
+	writer = CmnFileWriter_Open(file, 0, &option);
+	CmnTest_AssertNumber(t, __LINE__, writer != NULL, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Write(writer, "abcdefgh", 8), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Write(writer, "ijklmnop", 8), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Write(writer, big, sizeof(big)), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Write(writer, "END", 3), 0);
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 116);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Close(writer), 0);
+	buf->size = 0;
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 119);
+	CmnTest_AssertData(t, __LINE__, buf->data, "abcdefghijklmnopzz", 18);
+	CmnTest_AssertData(t, __LINE__, (char *)buf->data + 116, "END", 3);
+
+	/* 追記、同期あり */
+	option.sync = CMN_FILE_WRITER_SYNC_FLUSH;
+	writer = CmnFileWriter_Open(file, CMN_FILE_WRITER_APPEND, &option);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Write(writer, "+1", 2), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Commit(writer), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Close(writer), 0);
+	buf->size = 0;
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 121);
+	CmnTest_AssertData(t, __LINE__, (char *)buf->data + 116, "END+1", 5);
+
+	/* 時間によるフラッシュ */
+	option.bufferSize = 0;
+	option.flushInterval = 50;
+	option.sync = CMN_FILE_WRITER_SYNC_NONE;
+	writer = CmnFileWriter_Open(file, 0, &option);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Write(writer, "timer", 5), 0);
+	CmnTime_Sleep(300);
+	buf->size = 0;
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, 5);
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Close(writer), 0);
+
+	/* 開けないファイル */
+	CmnTest_AssertPointer(t, __LINE__, CmnFileWriter_Open("test/resources/CmnFile/NotExists/Writer.txt", 0, NULL), NULL);
+
+	CmnFile_Remove(file);
+	CmnDataBuffer_Free(buf);
+}
+
+#define WRITER_THREADS 4
+#define WRITER_RECORDS 5000
+
+typedef struct {
+	CmnFileWriter *writer;
+	int id;
+} WriterThreadData;
+
+static void writerThreadMethod(CmnThread *thread)
+{
+	WriterThreadData *data = thread->data;
+	char record[16];
+	int i;
+
+	for (i = 0; i < WRITER_RECORDS; i++) {
+		sprintf(record, "T%d:%06d\n", data->id, i);
+		CmnFileWriter_Write(data->writer, record, 10);
+		if (i % 100 == 99) {
+			CmnFileWriter_Commit(data->writer);
+		}
+	}
+}
+
+static void test_CmnFileWriter_MultiThread(CmnTestCase *t)
+{
+	char *file = "test/resources/CmnFile/WriterThread.txt";
+	CmnFileWriterOption option = { 4096, 0, CMN_FILE_WRITER_SYNC_GROUP };
+	CmnFileWriter *writer = CmnFileWriter_Open(file, 0, &option);
+	CmnThread threads[WRITER_THREADS];
+	WriterThreadData data[WRITER_THREADS];
+	CmnDataBuffer *buf = CmnDataBuffer_Create(0);
+	int next[WRITER_THREADS] = { 0 };
+	int i, id, seq, ng = 0;
+	char *p;
+
+	for (i = 0; i < WRITER_THREADS; i++) {
+		data[i].writer = writer;
+		data[i].id = i;
+		CmnThread_Init(&threads[i], writerThreadMethod, &data[i], NULL);
+		CmnThread_Start(&threads[i]);
+	}
+	for (i = 0; i < WRITER_THREADS; i++) {
+		CmnThread_Join(&threads[i]);
+	}
+	CmnTest_AssertNumber(t, __LINE__, CmnFileWriter_Close(writer), 0);
+
+	/* レコードが混ざらず、スレッドごとに順番通りに書き込まれていること */
+	CmnFile_ReadAll(file, buf);
+	CmnTest_AssertNumber(t, __LINE__, buf->size, WRITER_THREADS * WRITER_RECORDS * 10);
+	for (p = buf->data; p < (char *)buf->data + buf->size; p += 10) {
+		if (sscanf(p, "T%d:%6d", &id, &seq) != 2 || id < 0 || id >= WRITER_THREADS || seq != next[id] || p[9] != '\n') {
+			ng++;
+			break;
+		}
+		next[id]++;
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+
+	CmnFile_Remove(file);
+	CmnDataBuffer_Free(buf);
+}
+
 void test_CmnFile_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_ReadAll);
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_ReadAllText);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_ReadAll_Size);
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Write_AndRemove);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_WriteHead);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Copy);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Copy_Sparse);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Move);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_ReadAtWriteAt);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileAio);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileAio_MultiThread);
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_List);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Walk);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_WalkParallel_Stop);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileEntryList);
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_ToAbsolutePath);
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Exists);
 	CmnTest_AddTestCaseEasy(plan, test_CmnFile_GetFileInfo);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFile_Map);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileReader_ReadLine);
+#if IS_PRATFORM_LINUX()
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileReader_Pipe);
+#endif
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileWatch);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileWatch_Overflow);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileWatch_AddFailure);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileCache);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileCache_Watch);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileCache_WatchLink);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileWriter_Write);
+	CmnTest_AddTestCaseEasy(plan, test_CmnFileWriter_MultiThread);
 }
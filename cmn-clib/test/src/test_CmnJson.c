@@ -0,0 +1,317 @@
+/** @file
+ * @brief CmnJsonライブラリの動作を確認するためのテストプログラム
+ * @author H.Kumagai
+ * @date 2026-10-19
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "cmnclib/CmnTest.h"
+#include "cmnclib/CmnJson.h"
+
+/* --- イベントを文字列として記録するハンドラ --- */
+static int recNull(void *ctx) { return CmnStringBuffer_Append(ctx, "z "); }
+static int recBool(void *ctx, int value) { return CmnStringBuffer_Append(ctx, value ? "t " : "f "); }
+static int recNumber(void *ctx, const char *str, size_t len)
+{
+	CmnStringBuffer_Append(ctx, "n:");
+	CmnStringBuffer_AppendN(ctx, str, len);
+	return CmnStringBuffer_Append(ctx, " ");
+}
+static int recString(void *ctx, const char *str, size_t len)
+{
+	CmnStringBuffer_Append(ctx, "s:");
+	CmnStringBuffer_AppendN(ctx, str, len);
+	return CmnStringBuffer_Append(ctx, " ");
+}
+static int recKey(void *ctx, const char *str, size_t len)
+{
+	CmnStringBuffer_Append(ctx, "k:");
+	CmnStringBuffer_AppendN(ctx, str, len);
+	return CmnStringBuffer_Append(ctx, " ");
+}
+static int recStartObject(void *ctx) { return CmnStringBuffer_Append(ctx, "{ "); }
+static int recEndObject(void *ctx) { return CmnStringBuffer_Append(ctx, "} "); }
+static int recStartArray(void *ctx) { return CmnStringBuffer_Append(ctx, "[ "); }
+static int recEndArray(void *ctx) { return CmnStringBuffer_Append(ctx, "] "); }
+static const CmnJsonHandler recHandler = {
+	recNull, recBool, recNumber, recString, recKey,
+	recStartObject, recEndObject, recStartArray, recEndArray
+};
+
+/** jsonをchunkバイトずつ渡して解析し、イベントの記録を返す（エラーの場合は"ERROR"） */
+static CmnStringBuffer* parseEvents(const char *json, size_t chunk)
+{
+	CmnStringBuffer *events = CmnStringBuffer_Create(NULL);
+	CmnJsonParser *parser = CmnJsonParser_Create(&recHandler, events);
+	size_t len = strlen(json);
+	size_t pos;
+	int ret = 0;
+
+	for (pos = 0; pos < len && ret == 0; pos += chunk) {
+		ret = CmnJsonParser_Feed(parser, json + pos, (len - pos < chunk) ? len - pos : chunk);
+	}
+	if (ret != 0 || CmnJsonParser_Finish(parser) != 0) {
+		CmnStringBuffer_Set(events, "ERROR");
+	}
+	CmnJsonParser_Free(parser);
+	return events;
+}
+
+static void test_CmnJsonParser_events(CmnTestCase *t)
+{
+	const char *json = " {\"name\" : \"cmn-clib\", \"list\":[1, -2.5e+3, 0, true, false, null, \"\"],\r\n"
+			"\t\"nest\":{\"a\":{}, \"b\":[]}, \"long string value over 16 bytes\":12345678901234567890} ";
+	const char *expect = "{ k:name s:cmn-clib k:list [ n:1 n:-2.5e+3 n:0 t f z s: ] "
+			"k:nest { k:a { } k:b [ ] } k:long string value over 16 bytes n:12345678901234567890 } ";
+	CmnStringBuffer *events;
+	size_t chunk;
+
+	/* 一括、および1～17バイトずつに区切って渡しても結果が同じ */
+	for (chunk = 1; chunk <= 17; chunk++) {
+		events = parseEvents(json, (chunk == 17) ? strlen(json) : chunk);
+		CmnTest_AssertString(t, __LINE__, events->string, (char *)expect);
+		CmnStringBuffer_Free(events);
+	}
+
+	/* 最上位が値のみの文書 */
+	events = parseEvents("123", 1);
+	CmnTest_AssertString(t, __LINE__, events->string, "n:123 ");
+	CmnStringBuffer_Free(events);
+	events = parseEvents(" true ", 2);
+	CmnTest_AssertString(t, __LINE__, events->string, "t ");
+	CmnStringBuffer_Free(events);
+	events = parseEvents("\"abc\"", 2);
+	CmnTest_AssertString(t, __LINE__, events->string, "s:abc ");
+	CmnStringBuffer_Free(events);
+}
+
+static void test_CmnJsonParser_escape(CmnTestCase *t)
+{
+	const char *json = "[\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\", \"\\u0041\\u00e9\\u3042\\ud83d\\ude00\", \"\\\\\"]";
+	const char *expect = "[ s:a\"b\\c/d\b\f\n\r\t s:A\xC3\xA9\xE3\x81\x82\xF0\x9F\x98\x80 s:\\ ] ";
+	CmnStringBuffer *events;
+	size_t chunk;
+
+	/* エスケープの途中（'\'の直後、\\uXXXXの途中）で区切った場合も同じ結果となる */
+	for (chunk = 1; chunk <= 8; chunk++) {
+		events = parseEvents(json, (chunk == 8) ? strlen(json) : chunk);
+		CmnTest_AssertString(t, __LINE__, events->string, (char *)expect);
+		CmnStringBuffer_Free(events);
+	}
+}
+
+static void test_CmnJsonParser_error(CmnTestCase *t)
+{
+	static const char *invalid[] = {
+		"", "  ", "[", "[1,]", "{\"a\" 1}", "{\"a\":1,}", "{1:2}", "[1 2]", "[}", "{]", "{}x", "1 2",
+		"01", "-", "1.", ".5", "1e", "+1", "0x10", "tru", "nul", "True", "[nan]",
+		"\"abc", "\"\\x\"", "\"\\u12\"", "\"\\ud800\"", "\"\\udc00\"", "\"a\tb\"", "\"a\nb\"",
+	};
+	CmnJsonHandler handler;
+	CmnJsonParser *parser;
+	CmnStringBuffer *events;
+	char deep[CMN_JSON_MAX_DEPTH + 2];
+	size_t offset = 0;
+	int i;
+
+	for (i = 0; i < (int)(sizeof(invalid) / sizeof(invalid[0])); i++) {
+		events = parseEvents(invalid[i], strlen(invalid[i]) + 1);
+		CmnTest_AssertString(t, __LINE__, events->string, "ERROR");
+		CmnStringBuffer_Free(events);
+		events = parseEvents(invalid[i], 1);
+		CmnTest_AssertString(t, __LINE__, events->string, "ERROR");
+		CmnStringBuffer_Free(events);
+	}
+
+	/* 入れ子の上限 */
+	memset(deep, '[', sizeof(deep) - 1);
+	deep[sizeof(deep) - 1] = '\0';
+	events = parseEvents(deep, sizeof(deep));
+	CmnTest_AssertString(t, __LINE__, events->string, "ERROR");
+	CmnStringBuffer_Free(events);
+
+	/* エラー位置は入力データ全体の先頭からのバイト数 */
+	memset(&handler, 0, sizeof(handler));
+	parser = CmnJsonParser_Create(&handler, NULL);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Feed(parser, "[1, 2", 5), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Feed(parser, ", x]", 4), -1);
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonParser_GetError(parser, &offset), "unexpected character");
+	CmnTest_AssertNumber(t, __LINE__, offset, 7);
+	/* エラー後は解析できない。初期化すると再度解析できる */
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Feed(parser, "]", 1), -1);
+	CmnJsonParser_Reset(parser);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Feed(parser, "[]", 2), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Finish(parser), 0);
+	CmnTest_AssertPointer(t, __LINE__, (void *)CmnJsonParser_GetError(parser, NULL), NULL);
+	CmnJsonParser_Free(parser);
+}
+
+static int abortOnString(void *ctx, const char *str, size_t len)
+{
+	(*(int *)ctx)++;
+	return (len == 4 && memcmp(str, "stop", 4) == 0) ? -1 : 0;
+}
+
+static void test_CmnJsonParser_abort(CmnTestCase *t)
+{
+	CmnJsonHandler handler;
+	CmnJsonParser *parser;
+	int count = 0;
+
+	memset(&handler, 0, sizeof(handler));
+	handler.onString = abortOnString;
+	parser = CmnJsonParser_Create(&handler, &count);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Feed(parser, "[\"a\", \"stop\", \"b\"]", 18), -1);
+	CmnTest_AssertNumber(t, __LINE__, count, 2);
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonParser_GetError(parser, NULL), "aborted by handler");
+	CmnJsonParser_Free(parser);
+}
+
+static void test_CmnJson_Parse(CmnTestCase *t)
+{
+	const char *json = "{\"id\":42, \"pi\":3.25, \"big\":1e400, \"ok\":true, \"none\":null,"
+			" \"name\":\"na\\u00efve\", \"tags\":[\"x\", \"y\", [\"z\"]], \"obj\":{\"k\":\"v\"}}";
+	CmnDataArena *arena = CmnDataArena_Create(0);
+	CmnJsonValue *root, *v;
+
+	root = CmnJson_Parse(json, strlen(json), arena);
+	CmnTest_AssertNumber(t, __LINE__, root->type, CMN_JSON_OBJECT);
+	CmnTest_AssertNumber(t, __LINE__, root->count, 8);
+
+	v = CmnJsonValue_Get(root, "id");
+	CmnTest_AssertNumber(t, __LINE__, v->type, CMN_JSON_NUMBER);
+	CmnTest_AssertNumber(t, __LINE__, (long long)v->number, 42);
+	CmnTest_AssertString(t, __LINE__, (char *)v->str, "42");
+	CmnTest_AssertString(t, __LINE__, (char *)v->key, "id");
+	v = CmnJsonValue_Get(root, "pi");
+	CmnTest_AssertNumber(t, __LINE__, v->number == 3.25, True);
+	v = CmnJsonValue_Get(root, "big");
+	CmnTest_AssertNumber(t, __LINE__, v->number > 1e308, True);
+	v = CmnJsonValue_Get(root, "ok");
+	CmnTest_AssertNumber(t, __LINE__, v->type, CMN_JSON_BOOL);
+	CmnTest_AssertNumber(t, __LINE__, v->boolean, True);
+	v = CmnJsonValue_Get(root, "none");
+	CmnTest_AssertNumber(t, __LINE__, v->type, CMN_JSON_NULL);
+	v = CmnJsonValue_Get(root, "name");
+	CmnTest_AssertString(t, __LINE__, (char *)v->str, "na\xC3\xAFve");
+	CmnTest_AssertNumber(t, __LINE__, v->len, 6);
+
+	v = CmnJsonValue_Get(root, "tags");
+	CmnTest_AssertNumber(t, __LINE__, v->type, CMN_JSON_ARRAY);
+	CmnTest_AssertNumber(t, __LINE__, v->count, 3);
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonValue_GetAt(v, 1)->str, "y");
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonValue_GetAt(CmnJsonValue_GetAt(v, 2), 0)->str, "z");
+	CmnTest_AssertPointer(t, __LINE__, CmnJsonValue_GetAt(v, 3), NULL);
+	CmnTest_AssertPointer(t, __LINE__, CmnJsonValue_GetAt(CmnJsonValue_GetAt(v, 0), 0), NULL);
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonValue_Get(CmnJsonValue_Get(root, "obj"), "k")->str, "v");
+	CmnTest_AssertPointer(t, __LINE__, CmnJsonValue_Get(root, "nothing"), NULL);
+	CmnTest_AssertPointer(t, __LINE__, CmnJsonValue_Get(v, "x"), NULL);
+
+	/* 構文エラー */
+	CmnTest_AssertPointer(t, __LINE__, CmnJson_Parse("{\"a\":", 5, arena), NULL);
+
+	CmnDataArena_Free(arena);
+}
+
+static void test_CmnJsonParser_dom(CmnTestCase *t)
+{
+	const char *json = "[{\"a\":\"first\"}, {\"a\":\"second \\\"quoted\\\"\"}]";
+	CmnDataArena *arena = CmnDataArena_Create(256);
+	CmnJsonParser *parser = CmnJsonParser_CreateDom(arena);
+	CmnJsonValue *root;
+	size_t i;
+
+	/* 1バイトずつ渡しても、入力データと独立したDOMが構築される。完結するまではルートを取得できない */
+	for (i = 0; json[i] != '\0'; i++) {
+		char c = json[i];
+		CmnTest_AssertPointer(t, __LINE__, CmnJsonParser_GetRoot(parser), NULL);
+		CmnJsonParser_Feed(parser, &c, 1);
+	}
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Finish(parser), 0);
+	root = CmnJsonParser_GetRoot(parser);
+	CmnTest_AssertNumber(t, __LINE__, root->count, 2);
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonValue_Get(CmnJsonValue_GetAt(root, 0), "a")->str, "first");
+	CmnTest_AssertString(t, __LINE__, (char *)CmnJsonValue_Get(CmnJsonValue_GetAt(root, 1), "a")->str, "second \"quoted\"");
+
+	/* 初期化して次の文書を解析 */
+	CmnJsonParser_Reset(parser);
+	CmnJsonParser_Feed(parser, "false", 5);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_Finish(parser), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonParser_GetRoot(parser)->type, CMN_JSON_BOOL);
+	CmnJsonParser_Free(parser);
+	CmnTest_AssertNumber(t, __LINE__, root->count, 2);
+
+	CmnDataArena_Free(arena);
+}
+
+static void test_CmnJsonWriter(CmnTestCase *t)
+{
+	CmnStringBuffer *buf = CmnStringBuffer_Create("prefix:");
+	CmnJsonWriter writer;
+
+	CmnJsonWriter_Init(&writer, buf);
+	CmnJsonWriter_StartObject(&writer);
+	CmnJsonWriter_Key(&writer, "str");
+	CmnJsonWriter_String(&writer, "a\"b\\c\n\x01\xE3\x81\x82");
+	CmnJsonWriter_Key(&writer, "list");
+	CmnJsonWriter_StartArray(&writer);
+	CmnJsonWriter_Int(&writer, -123);
+	CmnJsonWriter_Double(&writer, 0.1);
+	CmnJsonWriter_Double(&writer, HUGE_VAL);
+	CmnJsonWriter_Bool(&writer, True);
+	CmnJsonWriter_Bool(&writer, False);
+	CmnJsonWriter_Null(&writer);
+	CmnJsonWriter_StartObject(&writer);
+	CmnJsonWriter_EndObject(&writer);
+	CmnJsonWriter_StartArray(&writer);
+	CmnJsonWriter_EndArray(&writer);
+	CmnJsonWriter_EndArray(&writer);
+	CmnJsonWriter_KeyN(&writer, "empty_", 5);
+	CmnJsonWriter_StringN(&writer, "xyz", 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonWriter_EndObject(&writer), 0);
+	CmnTest_AssertString(t, __LINE__, buf->string,
+			"prefix:{\"str\":\"a\\\"b\\\\c\\n\\u0001\xE3\x81\x82\",\"list\":[-123,0.1,null,true,false,null,{},[]],\"empty\":\"\"}");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, strlen(buf->string));
+
+	/* 対応しない終了はエラー */
+	CmnTest_AssertNumber(t, __LINE__, CmnJsonWriter_EndArray(&writer), -1);
+
+	CmnStringBuffer_Free(buf);
+}
+
+static void test_CmnJson_Write(CmnTestCase *t)
+{
+	const char *json = "{\"a\":[1,2.50,-3e+2,\"x\\ty\"],\"b\":{\"c\":null,\"d\":true},\"\\u00e9\":\"\"}";
+	CmnDataArena *arena = CmnDataArena_Create(0);
+	CmnStringBuffer *buf = CmnStringBuffer_Create(NULL);
+	CmnStringBuffer *buf2 = CmnStringBuffer_Create(NULL);
+	CmnJsonValue *root = CmnJson_Parse(json, strlen(json), arena);
+
+	/* 数値は元の表現のまま、文字列は必要な文字のみエスケープして書き込む */
+	CmnTest_AssertNumber(t, __LINE__, CmnJson_Write(root, buf), 0);
+	CmnTest_AssertString(t, __LINE__, buf->string, "{\"a\":[1,2.50,-3e+2,\"x\\ty\"],\"b\":{\"c\":null,\"d\":true},\"\xC3\xA9\":\"\"}");
+
+	/* 書き込んだ結果を再度解析して書き込むと同じ結果になる */
+	root = CmnJson_Parse(buf->string, buf->length, arena);
+	CmnJson_Write(root, buf2);
+	CmnTest_AssertString(t, __LINE__, buf2->string, buf->string);
+
+	CmnStringBuffer_Free(buf2);
+	CmnStringBuffer_Free(buf);
+	CmnDataArena_Free(arena);
+}
+
+void test_CmnJson_AddCase(CmnTestPlan *plan)
+{
+	CmnTest_AddTestCaseEasy(plan, test_CmnJsonParser_events);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJsonParser_escape);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJsonParser_error);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJsonParser_abort);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJson_Parse);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJsonParser_dom);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJsonWriter);
+	CmnTest_AddTestCaseEasy(plan, test_CmnJson_Write);
+}
@@ -5,6 +5,7 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cmnclib/CmnTest.h"
 #include "cmnclib/CmnLog.h"
@@ -15,7 +16,53 @@ static void test_CmnLogEx(CmnTestCase *testCase)
 	CmnLogEx_Put(logex, CMN_LOG_LEVEL_DEBUG, "test[%s] val[%s]", "AAA", "BBB");
 }
 
+static void test_CmnLogEx_PutByCode(CmnTestCase *t)
+{
+	const char *msgFile = "test_CmnLog_message.conf";
+	const char *logFile = "test_CmnLog_format.log";
+	char longText[2048];
+	char line[4096];
+	CmnLogEx *logex;
+	FILE *fp;
+
+	fp = fopen(msgFile, "w");
+	fprintf(fp, "# comment\nC001, count=%%05d name=%%s rate=%%.1f%%%%\nC002, long[%%s]\n");
+	fclose(fp);
+	remove(logFile);
+
+	logex = CmnLogEx_Create(logFile, CMN_LOG_LEVEL_INFO, msgFile);
+	CmnTest_AssertNumber(t, __LINE__, logex != NULL, True);
+	if (logex == NULL) return;
+
+	/* 事前解析済みのメッセージ文で書式化されること */
+	CmnLogEx_PutByCode(logex, CMN_LOG_LEVEL_INFO, "C001", 42, "abc", 99.5);
+	CmnLogEx_PutByCode(logex, CMN_LOG_LEVEL_DEBUG, "C001", 1, "skip", 0.0);
+	/* 1行のバッファに収まらない長いメッセージ */
+	memset(longText, 'x', sizeof(longText) - 1);
+	longText[sizeof(longText) - 1] = '\0';
+	CmnLogEx_PutByCode(logex, CMN_LOG_LEVEL_ERROR, "C002", longText);
+	CmnLogEx_Put(logex, CMN_LOG_LEVEL_WARN, "direct %s %d", "msg", -1);
+	CmnLogEx_Free(logex);
+
+	fp = fopen(logFile, "r");
+	CmnTest_AssertNumber(t, __LINE__, fp != NULL, True);
+	if (fp == NULL) return;
+	fgets(line, sizeof(line), fp);
+	CmnTest_AssertString(t, __LINE__, line + 19, " [ INFO] count=00042 name=abc rate=99.5%\n");
+	fgets(line, sizeof(line), fp);
+	CmnTest_AssertNumber(t, __LINE__, (long long)strlen(line), 19 + 9 + 6 + (sizeof(longText) - 1) + 1);
+	CmnTest_AssertNumber(t, __LINE__, strncmp(line + 19, " [ERROR] long[xxx", 17), 0);
+	fgets(line, sizeof(line), fp);
+	CmnTest_AssertString(t, __LINE__, line + 19, " [ WARN] direct msg -1\n");
+	CmnTest_AssertPointer(t, __LINE__, fgets(line, sizeof(line), fp), NULL);
+	fclose(fp);
+
+	remove(logFile);
+	remove(msgFile);
+}
+
 void test_CmnLog_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_CmnLogEx);
+	CmnTest_AddTestCaseEasy(plan, test_CmnLogEx_PutByCode);
 }
@@ -5,6 +5,8 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "cmnclib/CmnTest.h"
 #include "cmnclib/CmnString.h"
@@ -14,10 +16,14 @@ static void test_CmnString_RTrim(CmnTestCase *t)
 	char nonSpace[]    = "Hello world";
 	char singleSpace[] = " Hello world ";
 	char multiSpace[]  = "  Hello world  ";
+	char empty[]       = "";
+	char allSpace[]    = "   ";
 
 	CmnTest_AssertString(t, __LINE__, CmnString_RTrim(nonSpace),    "Hello world");
 	CmnTest_AssertString(t, __LINE__, CmnString_RTrim(singleSpace), " Hello world");
 	CmnTest_AssertString(t, __LINE__, CmnString_RTrim(multiSpace),  "  Hello world");
+	CmnTest_AssertString(t, __LINE__, CmnString_RTrim(empty),       "");
+	CmnTest_AssertString(t, __LINE__, CmnString_RTrim(allSpace),    "");
 }
 
 static void test_CmnString_LTrim(CmnTestCase *t)
@@ -36,11 +42,95 @@ static void test_CmnString_Trim(CmnTestCase *t)
 	char nonSpace[]    = "Hello world";
 	char singleSpace[] = " Hello world ";
 	char multiSpace[]  = "  Hello world  ";
+	char allSpace[]    = "   ";
 
 	/* Trim */
 	CmnTest_AssertString(t, __LINE__, CmnString_Trim(nonSpace),    "Hello world");
 	CmnTest_AssertString(t, __LINE__, CmnString_Trim(singleSpace), "Hello world");
 	CmnTest_AssertString(t, __LINE__, CmnString_Trim(multiSpace),  "Hello world");
+	CmnTest_AssertString(t, __LINE__, CmnString_Trim(allSpace),    "");
+}
+
+static void test_CmnString_TrimView(CmnTestCase *t)
+{
+	const char *str = " \t Hello world \r\n";
+	char padded[80];
+	CmnStringView view;
+	char *copy;
+
+	CmnString_TrimView(str, strlen(str), &view);
+	CmnTest_AssertPointer(t, __LINE__, (void *)view.str, (void *)(str + 3));
+	CmnTest_AssertNumber(t, __LINE__, view.len, 11);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&view, "Hello world"), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&view, "Hello worl"), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&view, "Hello world!"), False);
+	CmnString_LTrimView(str, strlen(str), &view);
+	CmnTest_AssertNumber(t, __LINE__, view.len, 14);
+	CmnString_RTrimView(str, strlen(str), &view);
+	CmnTest_AssertNumber(t, __LINE__, view.len, 14);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_TrimView(" \n ", 3, &view)->len, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_TrimView("", 0, &view)->len, 0);
+	/* 長さ指定（末尾の'\0'以外の位置まで） */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_TrimView(" ab cd", 3, &view)->len, 2);
+
+	/* 16バイトを超える空白 */
+	memset(padded, ' ', sizeof(padded));
+	memcpy(padded + 37, "x\ty", 3);
+	CmnString_TrimView(padded, sizeof(padded), &view);
+	CmnTest_AssertPointer(t, __LINE__, (void *)view.str, (void *)(padded + 37));
+	CmnTest_AssertNumber(t, __LINE__, view.len, 3);
+	copy = CmnStringView_CopyNew(&view);
+	CmnTest_AssertString(t, __LINE__, copy, "x\ty");
+	free(copy);
+	memset(padded, '\t', sizeof(padded));
+	CmnTest_AssertNumber(t, __LINE__, CmnString_TrimView(padded, sizeof(padded), &view)->len, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_RTrimView(padded, sizeof(padded), &view)->len, 0);
+}
+
+static void test_CmnString_SplitKeyValue(CmnTestCase *t)
+{
+	const char *line = "  app.timeout =  30 sec \n";
+	CmnStringView key, value;
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_SplitKeyValue(line, strlen(line), '=', &key, &value), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&key, "app.timeout"), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&value, "30 sec"), True);
+	/* 最初の区切り文字で分割 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_SplitKeyValue("a=b=c", 5, '=', &key, &value), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&key, "a"), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&value, "b=c"), True);
+	/* 空のキー、値 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_SplitKeyValue(" = ", 3, '=', &key, &value), 0);
+	CmnTest_AssertNumber(t, __LINE__, key.len + value.len, 0);
+	/* 区切り文字なし */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_SplitKeyValue("abc", 3, '=', &key, &value), -1);
+	/* 長さの範囲外の区切り文字は見ない */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_SplitKeyValue("abc=d", 3, '=', &key, &value), -1);
+}
+
+static void test_CmnString_LineView(CmnTestCase *t)
+{
+	/* CRLF、LF、CR、空行、改行なしの最終行（SSE2の16バイト単位の検索を超える長さの行を含む） */
+	const char *text = "first\r\nsecond\nthird\r\rlong line over sixteen bytes\rlast";
+	const char *expected[] = { "first", "second", "third", "", "long line over sixteen bytes", "last" };
+	const char *p = text;
+	const char *end = text + strlen(text);
+	CmnStringView line;
+	int count = 0;
+
+	while (p < end && count < 6) {
+		p += CmnString_LineView(p, end - p, &line);
+		CmnTest_AssertNumber(t, __LINE__, CmnStringView_Equals(&line, expected[count]), True);
+		count++;
+	}
+	CmnTest_AssertNumber(t, __LINE__, count, 6);
+	CmnTest_AssertPointer(t, __LINE__, (void *)p, (void *)end);
+
+	/* 長さの範囲外の改行コードは見ない（CRの直後のLFが範囲外の場合はCRだけを改行とする） */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_LineView("abc\r\n", 4, &line), 4);
+	CmnTest_AssertNumber(t, __LINE__, line.len, 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_LineView("abc\n", 2, &line), 2);
+	CmnTest_AssertNumber(t, __LINE__, line.len, 2);
 }
 
 static void test_CmnString_Replace(CmnTestCase *t)
@@ -260,7 +350,13 @@ static void test_CmnString_Lpad(CmnTestCase *t)
 
 static void test_CmnString_Rpad(CmnTestCase *t)
 {
-	/* TODO テスト実施すること */
+	char buf[64];
+	memset(buf, 'x', sizeof(buf));
+	CmnTest_AssertString(t, __LINE__, CmnString_Rpad(buf, "1", ' ', 0), "1");
+	CmnTest_AssertString(t, __LINE__, CmnString_Rpad(buf, "1", ' ', 1), "1");
+	CmnTest_AssertString(t, __LINE__, CmnString_Rpad(buf, "1", ' ', 3), "1  ");
+	CmnTest_AssertString(t, __LINE__, CmnString_Rpad(buf, "abc", '.', 2), "abc");
+	CmnTest_AssertString(t, __LINE__, CmnString_Rpad(buf, buf, '-', 5), "abc--");
 }
 
 static void test_CmnString_StartWith(CmnTestCase *t)
@@ -271,6 +367,8 @@ static void test_CmnString_StartWith(CmnTestCase *t)
 	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWith(".abc.txt", "a"), 0);
 	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWith(".abc.txt", ".aa"), 0);
 	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWith(".abc.txt", "txt"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWith(".abc.txt", ".abc.txt.bak"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWith(".abc.txt", ""), 1);
 }
 
 static void test_CmnString_EndWith(CmnTestCase *t)
@@ -281,6 +379,7 @@ static void test_CmnString_EndWith(CmnTestCase *t)
 	CmnTest_AssertNumber(t, __LINE__, CmnString_EndWith(".abc.txt", "x"), 0);
 	CmnTest_AssertNumber(t, __LINE__, CmnString_EndWith(".abc.txt", ".tx"), 0);
 	CmnTest_AssertNumber(t, __LINE__, CmnString_EndWith(".abc.txt", "txx"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_EndWith("txt", ".abc.txt"), 0);
 }
 
 static void test_CmnString_IndexOf(CmnTestCase *t)
@@ -349,11 +448,1039 @@ static void test_CmnStringBuffer(CmnTestCase *t)
 	CmnTest_AssertString(t, __LINE__, buf->string, "12345678");
 	CmnTest_AssertNumber(t, __LINE__, buf->length, 8);
 }
+
+static void test_CmnStringBuffer_AppendN(CmnTestCase *t)
+{
+	CmnStringBuffer *buf = CmnStringBuffer_Create("abc");
+
+	CmnStringBuffer_AppendN(buf, "defXXX", 3);
+	CmnTest_AssertString(t, __LINE__, buf->string, "abcdef");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 6);
+
+	/* 自分自身の一部を追加 */
+	CmnStringBuffer_AppendN(buf, buf->string + 1, 4);
+	CmnTest_AssertString(t, __LINE__, buf->string, "abcdefbcde");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 10);
+
+	CmnStringBuffer_AppendN(buf, "", 0);
+	CmnTest_AssertString(t, __LINE__, buf->string, "abcdefbcde");
+
+	CmnStringBuffer_Free(buf);
+}
+
+static void test_CmnStringBuffer_AppendFormat(CmnTestCase *t)
+{
+	int i;
+	char expected[8192] = "";
+	CmnStringBuffer *buf = CmnStringBuffer_Create("");
+
+	CmnStringBuffer_AppendFormat(buf, "%s=%d", "abc", 123);
+	CmnTest_AssertString(t, __LINE__, buf->string, "abc=123");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 7);
+
+	/* 空き領域を超える書式化（領域拡張して再書式化） */
+	CmnStringBuffer_Set(buf, "");
+	for (i = 0; i < 1000; i++) {
+		sprintf(expected + strlen(expected), "[%05d]", i);
+	}
+	CmnStringBuffer_AppendFormat(buf, "%s", expected);
+	CmnTest_AssertString(t, __LINE__, buf->string, expected);
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 7000);
+
+	CmnStringBuffer_AppendFormat(buf, "%c%c", 'x', 'y');
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 7002);
+	CmnTest_AssertString(t, __LINE__, buf->string + 7000, "xy");
+
+	CmnStringBuffer_Free(buf);
+}
+
+static void test_CmnStringBuffer_InsertAndErase(CmnTestCase *t)
+{
+	CmnStringBuffer *buf = CmnStringBuffer_Create("123456");
+
+	/* 挿入 */
+	CmnStringBuffer_Insert(buf, 0, "ab", 2);
+	CmnTest_AssertString(t, __LINE__, buf->string, "ab123456");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 8);
+	CmnStringBuffer_Insert(buf, 4, "XYZ", 1);
+	CmnTest_AssertString(t, __LINE__, buf->string, "ab12X3456");
+	CmnStringBuffer_Insert(buf, 100, "cd", 2);
+	CmnTest_AssertString(t, __LINE__, buf->string, "ab12X3456cd");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 11);
+
+	/* 自分自身の一部を挿入（挿入位置をまたぐ） */
+	CmnStringBuffer_Set(buf, "abcdef");
+	CmnStringBuffer_Insert(buf, 3, buf->string + 1, 4);
+	CmnTest_AssertString(t, __LINE__, buf->string, "abcbcdedef");
+
+	/* 削除 */
+	CmnStringBuffer_Set(buf, "abcdef");
+	CmnStringBuffer_Erase(buf, 1, 2);
+	CmnTest_AssertString(t, __LINE__, buf->string, "adef");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 4);
+	CmnStringBuffer_Erase(buf, 2, 100);
+	CmnTest_AssertString(t, __LINE__, buf->string, "ad");
+	CmnStringBuffer_Erase(buf, 5, 1);
+	CmnTest_AssertString(t, __LINE__, buf->string, "ad");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 2);
+
+	/* 削除後の追加 */
+	CmnStringBuffer_Append(buf, "xyz");
+	CmnTest_AssertString(t, __LINE__, buf->string, "adxyz");
+
+	CmnStringBuffer_Free(buf);
+}
+
+static void test_CmnStringBuffer_Reserve(CmnTestCase *t)
+{
+	char *before;
+	CmnStringBuffer *buf = CmnStringBuffer_Create("abc");
+
+	CmnStringBuffer_Reserve(buf, 10000);
+	CmnTest_AssertString(t, __LINE__, buf->string, "abc");
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 3);
+
+	/* 予約済みの領域内では再確保されない */
+	before = buf->string;
+	while (buf->length < 10000) {
+		CmnStringBuffer_AppendN(buf, "0123456789", buf->length + 10 <= 10000 ? 10 : 10000 - buf->length);
+	}
+	CmnTest_AssertPointer(t, __LINE__, buf->string, before);
+	CmnTest_AssertNumber(t, __LINE__, buf->length, 10000);
+
+	CmnStringBuffer_Free(buf);
+}
+
+static void test_CmnString_FormatInt(CmnTestCase *t)
+{
+	char buf[CMN_STRING_INT_SIZE];
+	char expected[64];
+	long long values[] = { 0, 1, -1, 9, 10, 99, 100, 12345, -12345, 1000000007, 9223372036854775807LL, -9223372036854775807LL - 1 };
+	int i;
+
+	for (i = 0; i < ARRAY_LENGTH(values); i++) {
+		sprintf(expected, "%lld", values[i]);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_FormatInt(values[i], buf), strlen(expected));
+		CmnTest_AssertString(t, __LINE__, buf, expected);
+	}
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_FormatUInt(18446744073709551615ULL, buf), 20);
+	CmnTest_AssertString(t, __LINE__, buf, "18446744073709551615");
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_FormatUIntPad(7, 2, buf), 2);
+	CmnTest_AssertString(t, __LINE__, buf, "07");
+	CmnTest_AssertNumber(t, __LINE__, CmnString_FormatUIntPad(2026, 2, buf), 4);
+	CmnTest_AssertString(t, __LINE__, buf, "2026");
+	CmnTest_AssertNumber(t, __LINE__, CmnString_FormatUIntPad(0, 4, buf), 4);
+	CmnTest_AssertString(t, __LINE__, buf, "0000");
+}
+
+static void test_CmnString_FormatDouble(CmnTestCase *t)
+{
+	char buf[CMN_STRING_DOUBLE_SIZE];
+	double values[] = { 0.1, 0.3, 1.0 / 3.0, 2.0 / 3.0, 123.456, -0.5, 1e100, 1e-300, 5e-324, 1.7976931348623157e308, 1e15, 123456789012345678.0 };
+	int i;
+
+	CmnString_FormatDouble(0.1, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "0.1");
+	CmnString_FormatDouble(3.0, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "3");
+	CmnString_FormatDouble(-2.5, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "-2.5");
+	CmnString_FormatDouble(1e100, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "1e+100");
+	CmnString_FormatDouble(-0.0, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "-0");
+
+	/* 読み戻すと同じ値になること */
+	for (i = 0; i < ARRAY_LENGTH(values); i++) {
+		double back = 0;
+		size_t len = CmnString_FormatDouble(values[i], buf);
+		CmnTest_AssertNumber(t, __LINE__, len, strlen(buf));
+		CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble(buf, len, &back), CMN_STRING_PARSE_OK);
+		CmnTest_AssertNumber(t, __LINE__, back == values[i], True);
+	}
+}
+
+static void test_CmnString_ParseInt(CmnTestCase *t)
+{
+	long long value = 0;
+	unsigned long long uvalue = 0;
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("123", 3, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value, 123);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("-45", 3, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value, -45);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("+7xyz", 2, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value, 7);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("9223372036854775807", 19, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value, 9223372036854775807LL);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("-9223372036854775808", 20, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value, -9223372036854775807LL - 1);
+
+	/* エラー（値は変更されない） */
+	value = 99;
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("9223372036854775808", 19, &value), CMN_STRING_PARSE_ERROR_OVERFLOW);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("-9223372036854775809", 20, &value), CMN_STRING_PARSE_ERROR_OVERFLOW);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("", 0, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("-", 1, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt(" 1", 2, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseInt("12a", 3, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, value, 99);
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseUInt("18446744073709551615", 20, &uvalue), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, uvalue == 18446744073709551615ULL, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseUInt("18446744073709551616", 20, &uvalue), CMN_STRING_PARSE_ERROR_OVERFLOW);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseUInt("000000000000000000000001", 24, &uvalue), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, uvalue, 1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseUInt("-1", 2, &uvalue), CMN_STRING_PARSE_ERROR_FORMAT);
+}
+
+static void test_CmnString_ParseDouble(CmnTestCase *t)
+{
+	double value = 0;
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("12.5", 4, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == 12.5, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("-.5", 3, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == -0.5, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("1e-3", 4, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == 1e-3, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("0.1", 3, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == 0.1, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("3.", 2, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == 3.0, True);
+	/* 高速変換できない値（strtod） */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("2.2250738585072014e-308", 23, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == 2.2250738585072014e-308, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("12345678901234567890123", 23, &value), CMN_STRING_PARSE_OK);
+	CmnTest_AssertNumber(t, __LINE__, value == 12345678901234567890123.0, True);
+
+	/* エラー */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("1e999", 5, &value), CMN_STRING_PARSE_ERROR_OVERFLOW);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble(".", 1, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("1e", 2, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("inf", 3, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_ParseDouble("1.5 ", 4, &value), CMN_STRING_PARSE_ERROR_FORMAT);
+}
+
+static void test_CmnString_Utf8Valid(CmnTestCase *t)
+{
+	/* "日本語ABC" */
+	const char *utf8 = "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E" "ABC";
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsAscii("0123456789abcdefghijklmnopqrstuvwxyz", 36), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_AsciiLength("0123456789abcdefghijklmn\x80xyz", 28), 24);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8(utf8, strlen(utf8)), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xF0\x9F\x98\x80", 4), True);
+
+	/* 途中で切れた文字 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Utf8ValidLength(utf8, 4), 3);
+	/* 冗長表現 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xC0\xAF", 2), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xE0\x80\xAF", 3), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xF0\x80\x80\xAF", 4), False);
+	/* サロゲート、範囲外 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xED\xA0\x80", 3), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xF4\x90\x80\x80", 4), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsUtf8("\xFF", 1), False);
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_DetectCharset("abc", 3), CHARSET_ASCII);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_DetectCharset(utf8, strlen(utf8)), CHARSET_UTF8);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_DetectCharset("\x93\xFA\x96\x7B\x8C\xEA", 6), CHARSET_SHIFT_JIS);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsSjis("\x93\xFA\x96\x7B\x8C\xEA\xB1", 7), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IsSjis("\x93", 1), False);
+}
+
+static void test_CmnStringBuffer_AppendSjisToUtf8(CmnTestCase *t)
+{
+	CmnStringBuffer *buf = CmnStringBuffer_Create("[");
+
+	/* "日本語", "ｱｲｳ", "テスト①㈱", "表"（第2バイトが'\'） */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBuffer_AppendSjisToUtf8(buf, "\x93\xFA\x96\x7B\x8C\xEA" "abc" "\xB1\xB2\xB3", 12), 0);
+	CmnTest_AssertString(t, __LINE__, buf->string, "[\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E" "abc" "\xEF\xBD\xB1\xEF\xBD\xB2\xEF\xBD\xB3");
+	CmnStringBuffer_Set(buf, "");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBuffer_AppendSjisToUtf8(buf, "\x83\x65\x83\x58\x83\x67\x87\x40\x87\x8A\x95\x5C", 12), 0);
+	CmnTest_AssertString(t, __LINE__, buf->string, "\xE3\x83\x86\xE3\x82\xB9\xE3\x83\x88\xE2\x91\xA0\xE3\x88\xB1\xE8\xA1\xA8");
+
+	/* 不正なバイトは置き換え */
+	CmnStringBuffer_Set(buf, "");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBuffer_AppendSjisToUtf8(buf, "a\x80" "b\x93", 4), 2);
+	CmnTest_AssertString(t, __LINE__, buf->string, "a" CMN_STRING_REPLACEMENT_UTF8 "b" CMN_STRING_REPLACEMENT_UTF8);
+	CmnTest_AssertNumber(t, __LINE__, buf->length, strlen(buf->string));
+
+	CmnStringBuffer_Free(buf);
+}
+
+static void test_CmnStringBuffer_AppendUtf8ToSjis(CmnTestCase *t)
+{
+	CmnStringBuffer *buf = CmnStringBuffer_Create("");
+	CmnStringBuffer *back = CmnStringBuffer_Create("");
+	char sjis[] = "\x93\xFA\x96\x7B\x8C\xEA" "abc" "\xB1\xB2\xB3" "\x83\x65\x83\x58\x83\x67\x87\x40\x87\x8A\x95\x5C";
+
+	/* Shift_JIS → UTF-8 → Shift_JIS で元に戻ること */
+	CmnStringBuffer_AppendSjisToUtf8(buf, sjis, strlen(sjis));
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBuffer_AppendUtf8ToSjis(back, buf->string, buf->length), 0);
+	CmnTest_AssertString(t, __LINE__, back->string, sjis);
+
+	/* Shift_JISにない文字（絵文字）、不正なバイト */
+	CmnStringBuffer_Set(back, "");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBuffer_AppendUtf8ToSjis(back, "x\xF0\x9F\x98\x80y\xC3", 7), 2);
+	CmnTest_AssertString(t, __LINE__, back->string, "x?y?");
+
+	/* ASCIIへの変換 */
+	CmnStringBuffer_Set(back, "");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBuffer_AppendConvert(back, sjis, strlen(sjis), CHARSET_SHIFT_JIS, CHARSET_ASCII), 12);
+	CmnTest_AssertString(t, __LINE__, back->string, "???abc?????????");
+
+	CmnStringBuffer_Free(buf);
+	CmnStringBuffer_Free(back);
+}
+
+static void test_CmnString_CompareIgnoreCase(CmnTestCase *t)
+{
+	const char *longA = "Content-Type: Application/JSON; Charset=UTF-8";
+	const char *longB = "content-type: application/json; charset=utf-8";
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("Content-Length", "content-length"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase(longA, longB), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("abc", "ABD") < 0, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("abc", "AB") > 0, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("", "") , 0);
+	/* 記号（'@'と'`'、'['と'{'）や0x80以上のバイトは同一視しない */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("@[", "`{") != 0, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("0123456789abcdef\xC1", "0123456789ABCDEF\xE1") != 0, True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_CompareIgnoreCase("0123456789abcdefX", "0123456789ABCDEFy") < 0, True);
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_EqualsIgnoreCaseN(longA, longB, strlen(longA)), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_EqualsIgnoreCaseN("HOSTx", "hosty", 4), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_EqualsIgnoreCaseN("HOSTx", "hosty", 5), False);
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWithIgnoreCase("Content-Type", "CONTENT-"), 1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_StartWithIgnoreCase("Con", "CONTENT-"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_EndWithIgnoreCase("index.HTML", ".html"), 1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_EndWithIgnoreCase("html", ".html"), 0);
+}
+
+static void test_CmnString_IndexOfIgnoreCase(CmnTestCase *t)
+{
+	const char *text = "The quick brown fox jumps over the lazy dog. THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG.";
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, "QUICK"), 4);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, "dog. the"), 40);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, "LAZY DOG."), 35);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, "z"), 37);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, "cat"), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, ""), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase("ab", "abc"), -1);
+	/* 末尾の一致 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase(text, "lazy dog."), 35);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_IndexOfIgnoreCase("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxAbC", "aBc"), 40);
+	CmnTest_AssertPointer(t, __LINE__, (void *)CmnString_FindIgnoreCase(text, 3, "the", 3), (void *)text);
+	CmnTest_AssertPointer(t, __LINE__, (void *)CmnString_FindIgnoreCase(text, 2, "the", 3), NULL);
+}
+
+static void test_CmnString_HashIgnoreCase(CmnTestCase *t)
+{
+	char upper[1000];
+	char lower[1000];
+	int i;
+
+	for (i = 0; i < (int)sizeof(upper); i++) {
+		upper[i] = (char)('A' + (i % 26));
+		lower[i] = (char)('a' + (i % 26));
+	}
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HashIgnoreCase("Content-Type") == CmnString_HashIgnoreCase("CONTENT-TYPE"), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HashIgnoreCase("Content-Type") == CmnString_Hash("content-type"), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HashIgnoreCase("Content-Type") != CmnString_HashIgnoreCase("Content-Typf"), True);
+	/* 作業領域より長い文字列 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HashIgnoreCaseN(upper, sizeof(upper), 7) == CmnData_HashSeed(lower, sizeof(lower), 7), True);
+}
+
+/* 正規表現の部分一致の結果 */
+static int regexSearch(const char *pattern, int flags, const char *str)
+{
+	int ret;
+	CmnStringRegex *re = CmnStringRegex_Compile(pattern, flags);
+	if (re == NULL) {
+		return -9;
+	}
+	ret = CmnStringRegex_Search(re, str, strlen(str));
+	CmnStringRegex_Free(re);
+	return ret;
+}
+
+/* 正規表現の完全一致の結果 */
+static int regexMatch(const char *pattern, int flags, const char *str)
+{
+	int ret;
+	CmnStringRegex *re = CmnStringRegex_Compile(pattern, flags);
+	if (re == NULL) {
+		return -9;
+	}
+	ret = CmnStringRegex_Match(re, str, strlen(str));
+	CmnStringRegex_Free(re);
+	return ret;
+}
+
+static void test_CmnStringRegex_Syntax(CmnTestCase *t)
+{
+	/* 文字、連接、選択、繰り返し */
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("abc", 0, "abc"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("abc", 0, "abcd"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a|bc|", 0, "bc"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a|bc|", 0, ""), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("ab*c", 0, "ac"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("ab*c", 0, "abbbc"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("ab+c", 0, "ac"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("ab?c", 0, "abbc"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("(ab)+", 0, "ababab"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("(?:ab)+", 0, "ababa"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a{3}", 0, "aaa"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a{3}", 0, "aaaa"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a{2,3}", 0, "a"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a{2,3}", 0, "aaa"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a{2,}", 0, "aaaaaa"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a{,2}", 0, "a{,2}"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("(a|b)*?c", 0, "abbac"), True);
+
+	/* 文字クラス、エスケープ */
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[a-c]+", 0, "abccba"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[^a-c]+", 0, "xyz"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[^a-c]+", 0, "xaz"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[]a]+", 0, "]a]"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[a-]+", 0, "-a"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("\\d{4}-\\d\\d", 0, "2026-10"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[\\d.]+", 0, "3.14"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("\\w+\\s\\W", 0, "ab_9 !"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a\\.b\\x41\\t", 0, "a.bA\t"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("a.b", 0, "a\nb"), False);
+
+	/* UTF-8、大文字小文字 */
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("\xE6\x97\xA5.\xE8\xAA\x9E", 0, "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[\xE3\x81\x81-\xE3\x82\x93]+", 0, "\xE3\x81\x82\xE3\x81\x84"), True);	/* [ぁ-ん]+ あい */
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[^\xE3\x81\x82]", 0, "\xE3\x81\x84"), True);		/* [^あ] い */
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("[^\xE3\x81\x82]", 0, "\xE3\x81\x82"), False);		/* [^あ] あ */
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("\xE6\x97\xA5+", 0, "\xE6\x97\xA5\xE6\x97\xA5"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("...", CMN_STRING_REGEX_BYTES, "\xE6\x97\xA5"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexMatch("content-[a-z]+", CMN_STRING_REGEX_IGNORE_CASE, "Content-TYPE"), True);
+
+	/* アンカー */
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("^abc", 0, "abcdef"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("^abc", 0, "xabc"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("def$", 0, "abcdef"), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("abc$", 0, "abcdef"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("^$", 0, ""), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("^$", 0, "a"), False);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("x|^a", 0, "ba"), False);
+
+	/* 構文エラー */
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("(abc", 0, ""), -9);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("abc)", 0, ""), -9);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("*a", 0, ""), -9);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("[abc", 0, ""), -9);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("a{3,2}", 0, ""), -9);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("(a)\\1", 0, ""), -9);
+}
+
+static void test_CmnStringRegex_Search(CmnTestCase *t)
+{
+	const char *log = "2026-10-19 12:00:00 [ERROR] connection timeout (host=db01)";
+	const char *patterns[] = { "timeout", "^ERROR", "\\[ERROR\\].*host=db\\d+", "\\[warn\\]" };
+	CmnStringRegex *re;
+
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("timeout", 0, log), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("^ERROR", 0, log), False);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("\\[ERROR\\].*host=db\\d+", 0, log), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("\\[error\\]", 0, log), False);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("\\[error\\]", CMN_STRING_REGEX_IGNORE_CASE, log), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("TIMEOUT \\(", CMN_STRING_REGEX_IGNORE_CASE, log), True);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("timeouts", 0, log), False);
+	CmnTest_AssertNumber(t, __LINE__, regexSearch("", 0, log), True);
+
+	/* 病的なパターンでも線形時間で終わること（バックトラック方式では指数時間） */
+	{
+		char subject[201];
+		memset(subject, 'a', 200);
+		subject[200] = '\0';
+		CmnTest_AssertNumber(t, __LINE__, regexMatch("(a*)*b", 0, subject), False);
+		CmnTest_AssertNumber(t, __LINE__, regexMatch("(a|a)*b", 0, subject), False);
+		CmnTest_AssertNumber(t, __LINE__, regexSearch("a{20}a{0,20}$", 0, subject), True);
+	}
+
+	/* 複数パターン */
+	re = CmnStringRegex_CompileSet(patterns, ARRAY_LENGTH(patterns), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_SearchId(re, log, strlen(log)), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_SearchId(re, "timeout", 7), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_SearchId(re, "[warn] x", 8), 3);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_SearchId(re, "ERROR", 5), 1);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_SearchId(re, "none", 4), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_MatchId(re, "ERROR", 5), 1);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringRegex_MatchId(re, "ERROR ", 6), -1);
+	CmnStringRegex_Free(re);
+}
+
+static void test_CmnStringRegex_Cache(CmnTestCase *t)
+{
+	/* DFAの状態数が多いパターン（末尾から20文字目が'a'）でキャッシュの破棄と再生成が起きても正しく照合できること */
+	CmnStringRegex *re = CmnStringRegex_Compile("a[ab]{19}$", 0);
+	unsigned long long rnd = 12345;
+	char subject[64];
+	int i, j, ng = 0;
+
+	for (i = 0; i < 20000; i++) {
+		for (j = 0; j < 40; j++) {
+			rnd = rnd * 6364136223846793005ULL + 1442695040888963407ULL;
+			subject[j] = (rnd >> 40) & 1 ? 'a' : 'b';
+		}
+		if (CmnStringRegex_Search(re, subject, 40) != (subject[20] == 'a')) {
+			ng++;
+		}
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+	CmnStringRegex_Free(re);
+}
+
+static void test_CmnString_Glob(CmnTestCase *t)
+{
+	char sjis[] = "\x95\x5C.txt";	/* "表.txt"（2バイト目が'\\'） */
+
+	/* * ? */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.log", "app.log", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.log", "app.log.1", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*", "", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("", "", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("", "a", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("app.*.timeout", "app.db.timeout", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("app.*.timeout", "app.timeout", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("file?.txt", "file1.txt", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("file?.txt", "file10.txt", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("?.txt", "\xE3\x81\x82.txt", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("?.txt", "\xE3\x81\x82.txt", CMN_STRING_GLOB_BYTES), False);
+	/* 正規表現の記号は文字として扱う */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("a+b(1)|$^.c", "a+b(1)|$^.c", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("a.c", "abc", 0), False);
+	/* [...] */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("log[0-9].txt", "log5.txt", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("log[0-9].txt", "logx.txt", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("log[!0-9].txt", "logx.txt", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("log[^0-9].txt", "log5.txt", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("[]]", "]", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("[!]]", "]", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("[a-]", "-", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("[\\^x]", "^", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("[ab", "[ab", 0), True);
+	/* {...} */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.{c,h,cpp}", "main.cpp", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.{c,h,cpp}", "main.hpp", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("{a,b{1,2}}x", "b2x", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("{a,b{1,2}}x", "bx", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("a{,.bak}", "a", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("a{b,c", "a{b,c", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("a,b}", "a,b}", 0), True);
+	/* エスケープ */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("\\*.txt", "*.txt", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("\\*.txt", "a.txt", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("\\{a,b\\}", "{a,b}", 0), True);
+	/* オプション */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.LOG", "app.log", 0), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.LOG", "app.log", CMN_STRING_GLOB_IGNORE_CASE), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.txt", sjis, CMN_STRING_GLOB_BYTES), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob(sjis, sjis, CMN_STRING_GLOB_BYTES), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.txt", "dir/a.txt", 0), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*.txt", "dir/a.txt", CMN_STRING_GLOB_PATHNAME), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("*/?.txt", "dir/a.txt", CMN_STRING_GLOB_PATHNAME), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("dir[!x]a.txt", "dir/a.txt", CMN_STRING_GLOB_PATHNAME), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("**/*.txt", "a.txt", CMN_STRING_GLOB_PATHNAME), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("**/*.txt", "a/b/c.txt", CMN_STRING_GLOB_PATHNAME), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("src/**/test_*.c", "src/test_a.c", CMN_STRING_GLOB_PATHNAME), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("src/**/test_*.c", "src/x/y/test_a.c", CMN_STRING_GLOB_PATHNAME), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("src/**/test_*.c", "srcx/test_a.c", CMN_STRING_GLOB_PATHNAME), False);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("src/**", "src/x/y.c", CMN_STRING_GLOB_PATHNAME), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Glob("src/a**", "src/ab/c", CMN_STRING_GLOB_PATHNAME), False);
+}
+
+static void test_CmnStringGlob_Set(CmnTestCase *t)
+{
+	const char *patterns[] = { "*.log", "app.*.timeout", "*.{c,h}", "*" };
+	CmnStringGlob *glob = CmnStringGlob_CompileSet(patterns, ARRAY_LENGTH(patterns) - 1, 0);
+	CmnStringGlob *any;
+	char subject[64];
+
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_MatchId(glob, "error.log"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_MatchId(glob, "app.db.timeout"), 1);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_MatchId(glob, "main.h"), 2);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_MatchId(glob, "README"), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_Match(glob, "main.c"), True);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_Match(glob, "main.o"), False);
+	CmnStringGlob_Free(glob);
+
+	/* 複数に一致する場合は最小の番号 */
+	glob = CmnStringGlob_CompileSet(patterns + 2, 2, 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_MatchId(glob, "a.c"), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_MatchId(glob, "a.o"), 1);
+	CmnStringGlob_Free(glob);
+
+	/* バックトラックで指数時間になるパターンでも線形時間で照合できる */
+	memset(subject, 'a', sizeof(subject) - 1);
+	subject[sizeof(subject) - 1] = '\0';
+	any = CmnStringGlob_Compile("*a*a*a*a*a*a*a*a*a*a*b", 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringGlob_Match(any, subject), False);
+	CmnStringGlob_Free(any);
+}
+
+/* CSVの1行を"|"で連結した文字列（列の値の確認用） */
+static char* csvJoin(const CmnStringView *fields, int count, char *buf)
+{
+	int i;
+	buf[0] = '\0';
+	for (i = 0; i < count; i++) {
+		if (i > 0) {
+			strcat(buf, "|");
+		}
+		strncat(buf, fields[i].str, fields[i].len);
+	}
+	return buf;
+}
+
+static void test_CmnStringCsv_Next(CmnTestCase *t)
+{
+	const char *data =
+		"id,name,memo\r\n"
+		"1,alice,\"hello, world\"\r\n"
+		"\r\n"
+		"2,\"bob \"\"B\"\"\",\"line1\nline2\"\n"
+		"3,,\n"
+		"4,x\"y,\"\"\n"
+		"5";
+	const CmnStringView *fields;
+	CmnStringCsv *csv = CmnStringCsv_Create(data, strlen(data), ',');
+	char buf[256];
+
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 3);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 3, buf), "id|name|memo");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 3);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 3, buf), "1|alice|hello, world");
+	/* 空行は読み飛ばす、""のエスケープ、"内の改行 */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 3);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 3, buf), "2|bob \"B\"|line1\nline2");
+	/* 空の列 */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 3);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 3, buf), "3||");
+	/* 途中の"は文字として扱う */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 3);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 3, buf), "4|x\"y|");
+	/* 末尾に改行がない行 */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 1);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 1, buf), "5");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 0);
+	CmnStringCsv_Free(csv);
+
+	/* TSV */
+	csv = CmnStringCsv_Create("a\tb,c\t\"d\te\"\n", 12, '\t');
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 3);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 3, buf), "a|b,c|d\te");
+	CmnStringCsv_Free(csv);
+
+	/* "が閉じていない */
+	csv = CmnStringCsv_Create("1,\"abc\n2,def\n", 13, ',');
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), -1);
+	CmnStringCsv_Free(csv);
+}
+
+static void test_CmnStringCsv_SetColumns(CmnTestCase *t)
+{
+	const char *data =
+		"a0,a1,a2,a3,a4\n"
+		"b0,\"b\"\"1\",b2,\"b,3\",\"b\n4\"\n"
+		"c0\n";
+	const int columns[] = { 3, 1 };
+	const int duplicate[] = { 1, 1 };
+	const CmnStringView *fields;
+	CmnStringCsv *csv = CmnStringCsv_Create(data, strlen(data), ',');
+	char buf[256];
+
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_SetColumns(csv, duplicate, 2), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_SetColumns(csv, columns, 2), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 2);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 2, buf), "a3|a1");
+	/* 不要な列の"内の改行は行末ではない */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 2);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 2, buf), "b,3|b\"1");
+	/* 列が足りない場合は空文字列 */
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 2);
+	CmnTest_AssertString(t, __LINE__, csvJoin(fields, 2, buf), "|");
+	CmnTest_AssertNumber(t, __LINE__, CmnStringCsv_Next(csv, &fields), 0);
+	CmnStringCsv_Free(csv);
+}
+
+static void test_CmnStringCsv_CreateFromFile(CmnTestCase *t)
+{
+	CmnStringBuffer *data = CmnStringBuffer_Create("");
+	CmnStringCsv *memCsv, *fileCsv;
+	const CmnStringView *memFields, *fileFields;
+	FILE *fp = tmpfile();
+	int i, rows = 0, diff = 0;
+	char buf1[512], buf2[512];
+
+	if (fp == NULL) {
+		CmnTest_AssertNG(t, __LINE__);
+		return;
+	}
+
+	/* 読み込み単位（64KB）の境界をまたぐ行、""、"内の改行、1行がバッファより長い行を含むデータ */
+	for (i = 0; i < 20000; i++) {
+		CmnStringBuffer_AppendFormat(data, "%d,name%d,\"memo \"\"%d\"\"\nnext\",%s\r\n", i, i, i, (i % 7 == 0) ? "" : "x");
+		if (i == 10000) {
+			CmnStringBuffer_Append(data, "\"");
+			while (data->length < 400000) {
+				CmnStringBuffer_Append(data, "long,long\n");
+			}
+			CmnStringBuffer_Append(data, "\"\n");
+		}
+	}
+	fwrite(data->string, 1, data->length, fp);
+	rewind(fp);
+
+	memCsv = CmnStringCsv_Create(data->string, data->length, ',');
+	fileCsv = CmnStringCsv_CreateFromFile(fp, ',');
+	while (True) {
+		int n1 = CmnStringCsv_Next(memCsv, &memFields);
+		int n2 = CmnStringCsv_Next(fileCsv, &fileFields);
+		if (n1 != n2) {
+			diff++;
+			break;
+		}
+		if (n1 <= 0) {
+			break;
+		}
+		if (n1 == 4 && strcmp(csvJoin(memFields, n1, buf1), csvJoin(fileFields, n2, buf2)) != 0) {
+			diff++;
+		}
+		rows++;
+	}
+	CmnTest_AssertNumber(t, __LINE__, rows, 20001);
+	CmnTest_AssertNumber(t, __LINE__, diff, 0);
+
+	CmnStringCsv_Free(memCsv);
+	CmnStringCsv_Free(fileCsv);
+	CmnStringBuffer_Free(data);
+	fclose(fp);
+}
+
+static void test_CmnString_Hex(CmnTestCase *t)
+{
+	unsigned char data[256];
+	unsigned char decoded[256];
+	char hex[513];
+	size_t len, outLen = 0;
+	int i, ng = 0;
+
+	for (i = 0; i < 256; i++) data[i] = (unsigned char)i;
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexEncode("\x01\xAB\xff", 3, True, hex), 6);
+	CmnTest_AssertString(t, __LINE__, hex, "01ABFF");
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexEncode("\x01\xAB\xff", 3, False, hex), 6);
+	CmnTest_AssertString(t, __LINE__, hex, "01abff");
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexEncode("", 0, True, hex), 0);
+	CmnTest_AssertString(t, __LINE__, hex, "");
+
+	/* SIMDの境界をまたぐ長さで往復変換 */
+	for (len = 0; len <= 256; len++) {
+		size_t encLen = CmnString_HexEncode(data + (256 - len), len, len % 2, hex);
+		if (encLen != len * 2 || CmnString_HexDecode(hex, encLen, decoded, &outLen) != 0
+				|| outLen != len || memcmp(decoded, data + (256 - len), len) != 0) {
+			ng++;
+		}
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+
+	/* 不正な文字、奇数の長さ（SIMDで処理する位置、端数の位置のそれぞれ） */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexDecode("0g", 2, decoded, NULL), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexDecode("abc", 3, decoded, NULL), -1);
+	memset(hex, '0', 64);
+	hex[20] = ':';
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexDecode(hex, 64, decoded, NULL), -1);
+	hex[20] = 'G';
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexDecode(hex, 64, decoded, NULL), -1);
+	hex[20] = 'F';
+	CmnTest_AssertNumber(t, __LINE__, CmnString_HexDecode(hex, 64, decoded, NULL), 0);
+}
+
+static void test_CmnString_Base64(CmnTestCase *t)
+{
+	/* RFC 4648のテストベクタ */
+	static const char *plain[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+	static const char *standard[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+	static const char *url[] = { "", "Zg", "Zm8", "Zm9v", "Zm9vYg", "Zm9vYmE", "Zm9vYmFy" };
+	char buf[64];
+	char decoded[64];
+	size_t len, outLen = 0;
+	int i;
+
+	for (i = 0; i < 7; i++) {
+		len = strlen(plain[i]);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64EncodedSize(len, CMN_STRING_BASE64_STANDARD), strlen(standard[i]));
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Encode(plain[i], len, CMN_STRING_BASE64_STANDARD, buf), strlen(standard[i]));
+		CmnTest_AssertString(t, __LINE__, buf, (char *)standard[i]);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64EncodedSize(len, CMN_STRING_BASE64_URL), strlen(url[i]));
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Encode(plain[i], len, CMN_STRING_BASE64_URL, buf), strlen(url[i]));
+		CmnTest_AssertString(t, __LINE__, buf, (char *)url[i]);
+
+		/* パディングの有無によらず逆変換できる */
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64DecodedSize(standard[i], strlen(standard[i])), len);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode(standard[i], strlen(standard[i]), decoded, &outLen), 0);
+		CmnTest_AssertNumber(t, __LINE__, outLen, len);
+		CmnTest_AssertData(t, __LINE__, decoded, (void *)plain[i], len);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64DecodedSize(url[i], strlen(url[i])), len);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode(url[i], strlen(url[i]), decoded, &outLen), 0);
+		CmnTest_AssertNumber(t, __LINE__, outLen, len);
+		CmnTest_AssertData(t, __LINE__, decoded, (void *)plain[i], len);
+	}
+
+	/* 62、63番目の文字 */
+	CmnString_Base64Encode("\xFB\xFF\xBF", 3, CMN_STRING_BASE64_STANDARD, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "+/+/");
+	CmnString_Base64Encode("\xFB\xFF\xBF", 3, CMN_STRING_BASE64_URL, buf);
+	CmnTest_AssertString(t, __LINE__, buf, "-_-_");
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("-_+/", 4, decoded, &outLen), 0);
+	CmnTest_AssertData(t, __LINE__, decoded, "\xFB\xFF\xBF", 3);
+
+	/* 不正な文字、長さ */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("Zm9", 3, decoded, NULL), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("Z", 1, decoded, NULL), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("Zm9=", 4, decoded, NULL), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("Zm=", 3, decoded, NULL), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("Zm9v\nYmFy", 9, decoded, NULL), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("Zm=v", 4, decoded, NULL), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode("====", 4, decoded, NULL), -1);
+}
+
+static void test_CmnStringBase64_Stream(CmnTestCase *t)
+{
+	size_t size = 10000;
+	unsigned char *data = malloc(size);
+	char *whole = malloc(CmnString_Base64EncodedSize(size, CMN_STRING_BASE64_STANDARD) + 1);
+	char *stream = malloc(CmnString_Base64EncodedSize(size, CMN_STRING_BASE64_STANDARD) + 8);
+	unsigned char *decoded = malloc(size + 8);
+	CmnStringBase64 state;
+	size_t wholeLen, pos, len, outLen, outPos;
+	size_t chunk;
+	int mode, ng = 0;
+	const char *invalid[] = { "=", "==", "Zg=", "Z", "Zm9vY", "Zm9v=", "Zm9v==", "Zg===", "Zm=v" };
+
+	srand(36);
+	for (pos = 0; pos < size; pos++) data[pos] = (unsigned char)rand();
+
+	for (mode = CMN_STRING_BASE64_STANDARD; mode <= CMN_STRING_BASE64_URL; mode++) {
+		wholeLen = CmnString_Base64Encode(data, size, mode, whole);
+		for (chunk = 1; chunk <= 9; chunk++) {
+			/* 区切って変換しても一括変換と同じ結果になる */
+			len = 0;
+			CmnStringBase64_Init(&state, mode);
+			for (pos = 0; pos < size; pos += chunk) {
+				len += CmnStringBase64_Encode(&state, data + pos, (size - pos < chunk) ? size - pos : chunk, stream + len);
+			}
+			len += CmnStringBase64_EncodeFinal(&state, stream + len);
+			if (len != wholeLen || memcmp(stream, whole, len) != 0) ng++;
+
+			/* 区切って逆変換（パディングの途中で区切られる場合を含む） */
+			outPos = 0;
+			CmnStringBase64_Init(&state, mode);
+			for (pos = 0; pos < wholeLen; pos += chunk) {
+				if (CmnStringBase64_Decode(&state, whole + pos, (wholeLen - pos < chunk) ? wholeLen - pos : chunk, decoded + outPos, &outLen) != 0) ng++;
+				outPos += outLen;
+			}
+			if (CmnStringBase64_DecodeFinal(&state, decoded + outPos, &outLen) != 0) ng++;
+			outPos += outLen;
+			if (outPos != size || memcmp(decoded, data, size) != 0) ng++;
+		}
+	}
+	CmnTest_AssertNumber(t, __LINE__, ng, 0);
+
+	/* パディングの後のデータはエラー */
+	CmnStringBase64_Init(&state, CMN_STRING_BASE64_STANDARD);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBase64_Decode(&state, "Zg=", 3, decoded, &outLen), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBase64_Decode(&state, "=", 1, decoded, &outLen), 0);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBase64_DecodeFinal(&state, decoded, &outLen), 0);
+	CmnTest_AssertNumber(t, __LINE__, outLen, 1);
+	CmnTest_AssertNumber(t, __LINE__, decoded[0], 'f');
+	CmnStringBase64_Init(&state, CMN_STRING_BASE64_STANDARD);
+	CmnTest_AssertNumber(t, __LINE__, CmnStringBase64_Decode(&state, "Zg==Zg==", 8, decoded, &outLen), -1);
+
+	/* 長さ、パディングが不正な入力は一括変換と同じくエラー（1文字ずつ区切った場合も） */
+	for (pos = 0; pos < sizeof(invalid) / sizeof(invalid[0]); pos++) {
+		len = strlen(invalid[pos]);
+		CmnTest_AssertNumber(t, __LINE__, CmnString_Base64Decode(invalid[pos], len, decoded, NULL), -1);
+		for (chunk = 1; chunk <= len; chunk = (chunk == len) ? len + 1 : len) {
+			int ret = 0;
+			size_t i;
+			CmnStringBase64_Init(&state, CMN_STRING_BASE64_STANDARD);
+			for (i = 0; i < len && ret == 0; i += chunk) {
+				ret = CmnStringBase64_Decode(&state, invalid[pos] + i, (len - i < chunk) ? len - i : chunk, decoded, &outLen);
+			}
+			if (ret == 0) {
+				ret = CmnStringBase64_DecodeFinal(&state, decoded, &outLen);
+			}
+			CmnTest_AssertNumber(t, __LINE__, ret, -1);
+		}
+	}
+
+	free(decoded);
+	free(stream);
+	free(whole);
+	free(data);
+}
+
+static void test_CmnString_Percent(CmnTestCase *t)
+{
+	const char *str = "a b&c=d/\xC3\xA9~_.-+%Z";
+	char buf[128];
+	char decoded[128];
+	size_t outLen = 0;
+	CmnStringBuffer *sb;
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentEncodedSize(str, strlen(str), CMN_STRING_PERCENT_URI), 33);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentEncode(str, strlen(str), CMN_STRING_PERCENT_URI, buf), 33);
+	CmnTest_AssertString(t, __LINE__, buf, "a%20b%26c%3Dd%2F%C3%A9~_.-%2B%25Z");
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentEncodedSize(str, strlen(str), CMN_STRING_PERCENT_FORM), 31);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentEncode(str, strlen(str), CMN_STRING_PERCENT_FORM, buf), 31);
+	CmnTest_AssertString(t, __LINE__, buf, "a+b%26c%3Dd%2F%C3%A9~_.-%2B%25Z");
+
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentDecode(buf, strlen(buf), CMN_STRING_PERCENT_FORM, decoded, &outLen), 0);
+	CmnTest_AssertNumber(t, __LINE__, outLen, strlen(str));
+	CmnTest_AssertData(t, __LINE__, decoded, (void *)str, outLen);
+	/* URIの場合は'+'を変換しない。16進数の小文字も受け付ける */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentDecode("a+b%2f%2F", 9, CMN_STRING_PERCENT_URI, decoded, &outLen), 0);
+	CmnTest_AssertData(t, __LINE__, decoded, "a+b//", 5);
+	CmnTest_AssertNumber(t, __LINE__, outLen, 5);
+	/* 不正な% */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentDecode("a%4", 3, CMN_STRING_PERCENT_URI, decoded, NULL), -1);
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentDecode("a%G0", 4, CMN_STRING_PERCENT_URI, decoded, NULL), -1);
+
+	/* 16バイト以上の非予約文字の連続 */
+	CmnTest_AssertNumber(t, __LINE__, CmnString_PercentEncode("abcdefghijklmnopqrstuvwxyz0123456789 ", 37, CMN_STRING_PERCENT_URI, buf), 39);
+	CmnTest_AssertString(t, __LINE__, buf, "abcdefghijklmnopqrstuvwxyz0123456789%20");
+
+	/* 文字列バッファへの追加 */
+	sb = CmnStringBuffer_Create("q=");
+	CmnStringBuffer_AppendPercent(sb, "x y", 3, CMN_STRING_PERCENT_FORM);
+	CmnStringBuffer_Append(sb, "&h=");
+	CmnStringBuffer_AppendHex(sb, "\x12\xEF", 2, False);
+	CmnStringBuffer_Append(sb, "&b=");
+	CmnStringBuffer_AppendBase64(sb, "foob", 4, CMN_STRING_BASE64_URL);
+	CmnTest_AssertString(t, __LINE__, sb->string, "q=x+y&h=12ef&b=Zm9vYg");
+	CmnTest_AssertNumber(t, __LINE__, sb->length, strlen(sb->string));
+	CmnStringBuffer_Free(sb);
+}
+
+static void test_CmnString_Format(CmnTestCase *t)
+{
+	char expected[256];
+	char actual[256];
+	const char *unknown = "100%";
+	CmnStringFormat *fmt;
+	size_t len;
+	int n;
+
+	/* snprintfと同じ結果になること */
+#define CHECK_FORMAT(...) \
+	n = snprintf(expected, sizeof(expected), __VA_ARGS__); \
+	len = CmnString_Format(actual, sizeof(actual), __VA_ARGS__); \
+	CmnTest_AssertString(t, __LINE__, actual, expected); \
+	CmnTest_AssertNumber(t, __LINE__, (long long)len, n)
+
+	CHECK_FORMAT("plain text");
+	CHECK_FORMAT("%d %i %d %d", 0, 123, -456, -2147483647 - 1);
+	CHECK_FORMAT("%u %x %X %o", 4294967295U, 0xdeadbeefU, 0xabcU, 8U);
+	CHECK_FORMAT("%ld %lu %lld %llu", -1L, 123456789UL, -9223372036854775807LL - 1, 18446744073709551615ULL);
+	CHECK_FORMAT("%hd %hu %hhd %hhu", (short)-12345, (unsigned short)65535, (signed char)-128, (unsigned char)255);
+	CHECK_FORMAT("%zu %zd %jd %td", (size_t)1234567, (size_t)42, (intmax_t)-7, (ptrdiff_t)-8);
+	CHECK_FORMAT("[%5d] [%-5d] [%05d] [%+d] [% d] [%+05d]", 42, 42, 42, 42, 42, -42);
+	CHECK_FORMAT("[%.3d] [%8.3d] [%-8.3d] [%.0d] [%.0x]", 7, -7, 7, 0, 0U);
+	CHECK_FORMAT("[%#x] [%#X] [%#o] [%#o] [%#.3o] [%#x] [%#08x]", 255U, 255U, 8U, 0U, 8U, 0U, 255U);
+	CHECK_FORMAT("[%*d] [%-*d] [%*d] [%.*d] [%.*d]", 6, 1, 6, 2, -6, 3, 4, 5, -1, 6);
+	CHECK_FORMAT("[%s] [%10s] [%-10s] [%.2s] [%.*s] [%5.1s]", "abc", "abc", "abc", "abc", 4, "abcdefg", "xyz");
+	CHECK_FORMAT("[%c] [%3c] [%-3c]", 'a', 'b', 'c');
+	CHECK_FORMAT("100%%");
+	CHECK_FORMAT("%f %.2f %10.3f %-10.1f| %e %E %g %G", 3.14159, 2.5, -1.0 / 3, 0.25, 12345.678, 0.000123, 1e20, 1e-5);
+	CHECK_FORMAT("%+.0f %#.0f %08.2f %Lf %a", 2.5, 3.0, -1.5, (long double)1.25, 1.0);
+	CHECK_FORMAT("%p %p", (void *)t, (void *)NULL);
+	CHECK_FORMAT("日本語%s、%d件", "テスト", 3);
+	CHECK_FORMAT("mixed %s=%d (%x) %.1f%% %c", "key", -1, 0x1fU, 99.5, '!');
+#undef CHECK_FORMAT
+
+	/* NULL文字列（コンパイル時の書式検査の対象外となる事前解析済みの書式で確認） */
+	fmt = CmnStringFormat_Compile("[%s]");
+	CmnStringFormat_Format(fmt, actual, sizeof(actual), (char *)NULL);
+	CmnTest_AssertString(t, __LINE__, actual, "[(null)]");
+	CmnStringFormat_Free(fmt);
+
+	/* 解釈できない変換指定はそのまま出力（コンパイル時の書式検査を避けるため変数で渡す） */
+	CmnString_Format(actual, sizeof(actual), unknown, 1);
+	CmnTest_AssertString(t, __LINE__, actual, "100%");
+}
+
+static void test_CmnString_FormatTruncate(CmnTestCase *t)
+{
+	char buf[8];
+
+	/* 収まる分だけ格納して'\0'で終端し、必要な文字数を返す */
+	CmnTest_AssertNumber(t, __LINE__, (long long)CmnString_Format(buf, sizeof(buf), "%s-%d", "abcdef", 12345), 12);
+	CmnTest_AssertString(t, __LINE__, buf, "abcdef-");
+	CmnTest_AssertNumber(t, __LINE__, (long long)CmnString_Format(buf, 4, "%08x", 0xabU), 8);
+	CmnTest_AssertString(t, __LINE__, buf, "000");
+	CmnTest_AssertNumber(t, __LINE__, (long long)CmnString_Format(buf, 5, "x%.3f", 1.0), 6);
+	CmnTest_AssertString(t, __LINE__, buf, "x1.0");
+	CmnTest_AssertNumber(t, __LINE__, (long long)CmnString_Format(buf, 1, "%d", 1), 1);
+	CmnTest_AssertString(t, __LINE__, buf, "");
+
+	/* サイズ0の場合は何も書き込まない */
+	buf[0] = 'Z';
+	CmnTest_AssertNumber(t, __LINE__, (long long)CmnString_Format(buf, 0, "%s%f", "abc", 1.5), 11);
+	CmnTest_AssertNumber(t, __LINE__, buf[0], 'Z');
+}
+
+static void test_CmnStringFormat_Compile(CmnTestCase *t)
+{
+	static const char *format = "[%s] id=%05d%% rate=%.2f %x%y %-4c|%*s| 100%";
+	char expected[256];
+	char actual[256];
+	CmnStringFormat *fmt;
+	size_t len;
+
+	fmt = CmnStringFormat_Compile(format);
+	CmnTest_AssertNumber(t, __LINE__, fmt != NULL, True);
+
+	/* 書式化のたびに解析する場合と同じ結果になること（繰り返し使用できること） */
+	len = CmnStringFormat_Format(fmt, actual, sizeof(actual), "abc", 42, 12.345, 0xffU, 'z', 6, "pad");
+	CmnString_Format(expected, sizeof(expected), "[%s] id=%05d%% rate=%.2f %x%%y %-4c|%*s| 100%%", "abc", 42, 12.345, 0xffU, 'z', 6, "pad");
+	CmnTest_AssertString(t, __LINE__, actual, expected);
+	CmnTest_AssertNumber(t, __LINE__, (long long)len, (long long)strlen(expected));
+
+	len = CmnStringFormat_Format(fmt, actual, 10, "x", -1, 0.0, 0U, 'y', 1, "");
+	CmnTest_AssertString(t, __LINE__, actual, "[x] id=-0");
+	CmnTest_AssertNumber(t, __LINE__, (long long)len, (long long)strlen("[x] id=-0001% rate=0.00 0%y y   | | 100%"));
+
+	CmnStringFormat_Free(fmt);
+
+	/* 変換指定のない書式 */
+	fmt = CmnStringFormat_Compile("");
+	CmnTest_AssertNumber(t, __LINE__, (long long)CmnStringFormat_Format(fmt, actual, sizeof(actual)), 0);
+	CmnTest_AssertString(t, __LINE__, actual, "");
+	CmnStringFormat_Free(fmt);
+	CmnStringFormat_Free(NULL);
+}
+
 void test_CmnString_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_RTrim);
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_LTrim);
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_Trim);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_TrimView);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_SplitKeyValue);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_LineView);
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_Replace);
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_ReplaceNew);
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_StrcatNew);
@@ -368,4 +1495,33 @@ void test_CmnString_AddCase(CmnTestPlan *plan)
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_LastIndexOf);
 	CmnTest_AddTestCaseEasy(plan, test_CmnString_List);
 	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer_AppendN);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer_AppendFormat);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer_InsertAndErase);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer_Reserve);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_FormatInt);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_FormatDouble);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_ParseInt);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_ParseDouble);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_Utf8Valid);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer_AppendSjisToUtf8);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBuffer_AppendUtf8ToSjis);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_CompareIgnoreCase);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_IndexOfIgnoreCase);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_HashIgnoreCase);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringRegex_Syntax);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringRegex_Search);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringRegex_Cache);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_Glob);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringGlob_Set);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringCsv_Next);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringCsv_SetColumns);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringCsv_CreateFromFile);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_Hex);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_Base64);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringBase64_Stream);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_Percent);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_Format);
+	CmnTest_AddTestCaseEasy(plan, test_CmnString_FormatTruncate);
+	CmnTest_AddTestCaseEasy(plan, test_CmnStringFormat_Compile);
 }
@@ -88,8 +88,102 @@ static void test_CmnThread_Mutex(CmnTestCase *t)
 	}
 }
 
+/** 条件変数のテスト用データ */
+typedef struct {
+	CmnThreadCond *cond;
+	int count;
+} CondData;
+
+static void methodCond(CmnThread *thread)
+{
+	CondData *data = thread->data;
+
+	CmnThreadMutex_Lock(thread->mutex);
+	while (data->count == 0) {
+		CmnThreadCond_Wait(data->cond, thread->mutex, -1);
+	}
+	data->count--;
+	CmnThreadMutex_UnLock(thread->mutex);
+}
+
+static void test_CmnThread_Cond(CmnTestCase *t)
+{
+	CmnThread threads[3];
+	CmnThreadMutex *mutex;
+	CondData data;
+	unsigned long long start;
+	int i;
+
+	mutex = CmnThreadMutex_Create();
+	data.cond = CmnThreadCond_Create();
+	data.count = 0;
+
+	/* 通知がない場合は待つ時間が過ぎて1を返す */
+	start = CmnTime_GetTickCount();
+	CmnThreadMutex_Lock(mutex);
+	CmnTest_AssertNumber(t, __LINE__, CmnThreadCond_Wait(data.cond, mutex, 50), 1);
+	CmnThreadMutex_UnLock(mutex);
+	CmnTest_AssertNumber(t, __LINE__, CmnTime_GetTickCount() - start >= 40, True);
+
+	/* 待っている全てのスレッドが起きて、状態を確認できる */
+	for (i = 0; i < 3; i++) {
+		CmnThread_Init(&threads[i], methodCond, &data, mutex);
+		CmnThread_Start(&threads[i]);
+	}
+	CmnTime_Sleep(50);
+	CmnThreadMutex_Lock(mutex);
+	data.count = 3;
+	CmnThreadCond_Broadcast(data.cond);
+	CmnThreadMutex_UnLock(mutex);
+	for (i = 0; i < 3; i++) {
+		CmnThread_Join(&threads[i]);
+	}
+	CmnTest_AssertNumber(t, __LINE__, data.count, 0);
+
+	CmnThreadCond_Free(data.cond);
+	CmnThreadMutex_Free(mutex);
+}
+
+static CmnThreadOnce onceControl = CMN_THREAD_ONCE_INIT;
+static int onceCount = 0;
+
+static void onceInit(void)
+{
+	CmnTime_Sleep(50);
+	onceCount++;
+}
+
+static void methodOnce(CmnThread *thread)
+{
+	int *done = thread->data;
+
+	CmnThread_Once(&onceControl, onceInit);
+	*done = onceCount;
+}
+
+static void test_CmnThread_Once(CmnTestCase *t)
+{
+	CmnThread threads[4];
+	int done[4] = { 0 };
+	int i;
+
+	/* 同時に呼び出しても初期化は一度だけ。どのスレッドも初期化の完了後に戻る */
+	for (i = 0; i < 4; i++) {
+		CmnThread_Init(&threads[i], methodOnce, &done[i], NULL);
+		CmnThread_Start(&threads[i]);
+	}
+	for (i = 0; i < 4; i++) {
+		CmnThread_Join(&threads[i]);
+		CmnTest_AssertNumber(t, __LINE__, done[i], 1);
+	}
+	CmnThread_Once(&onceControl, onceInit);
+	CmnTest_AssertNumber(t, __LINE__, onceCount, 1);
+}
+
 void test_CmnThread_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_CmnThread_Normal);
 	CmnTest_AddTestCaseEasy(plan, test_CmnThread_Mutex);
+	CmnTest_AddTestCaseEasy(plan, test_CmnThread_Cond);
+	CmnTest_AddTestCaseEasy(plan, test_CmnThread_Once);
 }
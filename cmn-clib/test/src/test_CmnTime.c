@@ -16,8 +16,8 @@ static void test_CmnTime_DateTimeSetNow(CmnTestCase *t)
 	CmnTimeDateTime_SetNow(&datetime);
 
 	/* 目視確認 */
-	printf("time=%I64d, year=%d, month=%d, day(m)=%d, day(w)=%d, day(y)=%d, hour=%d, min=%d, sec=%d, isdst=%d, timezone=%ld\n",
-			datetime.time,
+	printf("time=%lld, year=%d, month=%d, day(m)=%d, day(w)=%d, day(y)=%d, hour=%d, min=%d, sec=%d, isdst=%d, timezone=%ld\n",
+			(long long)datetime.time,
 			datetime.year,
 			datetime.month,
 			datetime.dayOfMonth,
@@ -64,8 +64,18 @@ static void test_CmnTime_DateTimeSetAndAdd(CmnTestCase *t)
 	CmnTest_AssertNumber(t, __LINE__, datetime.second, 36);
 }
 
+static void test_CmnTime_GetTickCount(CmnTestCase *t)
+{
+	unsigned long long start = CmnTime_GetTickCount(), elapsed;
+
+	CmnTime_Sleep(50);
+	elapsed = CmnTime_GetTickCount() - start;
+	CmnTest_AssertNumber(t, __LINE__, elapsed >= 45 && elapsed < 1000, True);
+}
+
 void test_CmnTime_AddCase(CmnTestPlan *plan)
 {
 	CmnTest_AddTestCaseEasy(plan, test_CmnTime_DateTimeSetNow);
 	CmnTest_AddTestCaseEasy(plan, test_CmnTime_DateTimeSetAndAdd);
+	CmnTest_AddTestCaseEasy(plan, test_CmnTime_GetTickCount);
 }
@@ -14,6 +14,7 @@
 extern void test_CmnConf_AddCase(CmnTestPlan *plan);
 extern void test_CmnData_AddCase(CmnTestPlan *plan);
 extern void test_CmnFile_AddCase(CmnTestPlan *plan);
+extern void test_CmnJson_AddCase(CmnTestPlan *plan);
 extern void test_CmnLog_AddCase(CmnTestPlan *plan);
 extern void test_CmnString_AddCase(CmnTestPlan *plan);
 extern void test_CmnTime_AddCase(CmnTestPlan *plan);
@@ -23,6 +24,22 @@ extern void test_CmnNet_AddCase(CmnTestPlan *plan);
   extern void test_CmnWin32_AddCase(CmnTestPlan *plan);
 #endif
 
+/* 引数でモジュール名（CmnFileなど）を指定した場合は、指定したモジュールのテストだけを実行する */
+static int isTarget(int argc, char **argv, const char *name)
+{
+	int i;
+
+	if (argc <= 1) {
+		return True;
+	}
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], name) == 0) {
+			return True;
+		}
+	}
+	return False;
+}
+
 int main(int argc, char **argv)
 {
 	CmnTestPlan plan;
@@ -40,24 +57,26 @@ int main(int argc, char **argv)
 	CmnTest_InitializeTestPlan(&plan);
 
 	/* CmnConf */
-	test_CmnConf_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnConf")) test_CmnConf_AddCase(&plan);
 	/* CmnData */
-	test_CmnData_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnData")) test_CmnData_AddCase(&plan);
 	/* CmnFile */
-	test_CmnFile_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnFile")) test_CmnFile_AddCase(&plan);
+	/* CmnJson */
+	if (isTarget(argc, argv, "CmnJson")) test_CmnJson_AddCase(&plan);
 	/* CmnLog */
-	test_CmnLog_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnLog")) test_CmnLog_AddCase(&plan);
 	/* CmnString */
-	test_CmnString_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnString")) test_CmnString_AddCase(&plan);
 	/* CmnTime */
-	test_CmnTime_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnTime")) test_CmnTime_AddCase(&plan);
 	/* CmnThread */
-	test_CmnThread_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnThread")) test_CmnThread_AddCase(&plan);
 	/* CmnNet */
-	test_CmnNet_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnNet")) test_CmnNet_AddCase(&plan);
 	/* CmnWin32 */
 	#if IS_PRATFORM_WINDOWS()
-	test_CmnWin32_AddCase(&plan);
+	if (isTarget(argc, argv, "CmnWin32")) test_CmnWin32_AddCase(&plan);
 	#endif
 
 	CmnTest_Run(&plan, True);
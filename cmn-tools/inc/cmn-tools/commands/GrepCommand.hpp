@@ -22,7 +22,8 @@ grep keyword [file-name...]
 <<< option >>>
   keyword
         oB̏ɈvȂs͖B
-        keyword͐K\iC++W regex_matchjƂĉ߂B
+        keyword͐K\icmn-clib CmnStringRegexjƂĉ߂B
+        QƂ͎gpłȂB
 
   file-name
         񌟍Ώۂ̃t@CBw\B
@@ -32,7 +33,7 @@ grep keyword [file-name...]
 	int execute(std::vector<std::string>& args);
 
 private:
-	void output(const char *lineStr, const std::string &keyword, const std::string &fileName, int line);
+	void output(const char *lineStr, size_t len, CmnStringRegex *regex, const std::string &fileName, int line);
 
 };
 
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <regex>
 
 #include "cmn-tools/Command.hpp"
 #include "cmn-tools/CommandException.hpp"
@@ -18,50 +17,64 @@ namespace command {
 			throw CommandException(this->name(), __FILE__, __LINE__, "keyword required.");
 		}
 
-		CmnStringBuffer *buf = CmnStringBuffer_Create("");
+		// K\1񂾂RpCASs̏ƍɎgpiShift_JIS悤oCgPʂŏƍj
+		CmnStringRegex *regex = CmnStringRegex_Compile(args[0].c_str(), CMN_STRING_REGEX_BYTES);
+		if (regex == NULL) {
+			throw CommandException(this->name(), __FILE__, __LINE__, "Invalid keyword, keyword=" + args[0]);
+		}
 
 		// t@Cw肠
 		if (args.size() >= 2) {
 			for (int i = 1; i < args.size(); i++) {
-				// t@Cǂݍ
-				if (CmnFile_ReadAllText(args[i].c_str(), buf) == NULL) {
+				// t@CɃ}bvARs[ɍsPʂŏƍ
+				CmnFileMap *map = CmnFile_Map(args[i].c_str(), CMN_FILE_MAP_SEQUENTIAL);
+				if (map == NULL) {
+					CmnStringRegex_Free(regex);
 					throw CommandException(this->name(), __FILE__, __LINE__, "Failed read file, file=" + args[i]);
 				}
 
-				// sPʂɕ
-				CmnStringList *list = CmnStringList_Create();
-				if (CmnString_SplitLine(list, buf->string) == NULL) {
-					throw CommandException(this->name(), __FILE__, __LINE__, "Out of memory.");
-				}
-
-				// tB^Oo
-				for (int line = 0; line < list->size; line++) {
-					output(CmnStringList_Get(list, line), args[0], args[i], line + 1);
+				// sR[h͕W͂ƓCRLFELFECR̂1̉sƂĈ
+				const char *p = map->data;
+				const char *end = map->data + map->size;
+				CmnStringView lineView;
+				for (int line = 1; p < end; line++) {
+					p += CmnString_LineView(p, end - p, &lineView);
+					output(lineView.str, lineView.len, regex, args[i], line);
 				}
-				CmnStringList_Free(list);
+				CmnFile_Unmap(map);
 			}
 		}
 		// t@CwȂiW͂Cvbgj
 		else {
-			// W͂ǂݍ
-			std::string cinBuf;
-			while (std::getline(std::cin, cinBuf)) {
-				output(cinBuf.c_str(), args[0], "", 0);
+			// W͂ubNPʂœǂݍ݁AsƂ̃Rs[ȂŏƍipCvE[͓͂ǂݍށj
+			CmnFileReader *reader = CmnFileReader_Create(stdin, 0, CMN_FILE_READER_READ_AHEAD);
+			if (reader == NULL) {
+				CmnStringRegex_Free(regex);
+				throw CommandException(this->name(), __FILE__, __LINE__, "Failed read stdin");
 			}
+			CmnStringView lineView;
+			while (CmnFileReader_ReadLine(reader, &lineView) == 1) {
+				output(lineView.str, lineView.len, regex, "", 0);
+			}
+			CmnFileReader_Free(reader);
 		}
 
+		CmnStringRegex_Free(regex);
 		return 0;
 	}
 
-	void GrepCommand::output(const char *lineStr, const std::string &keyword, const std::string &fileName, int line) {
-		std::cmatch cmatch;
-		if (std::regex_search(lineStr, cmatch, std::regex(keyword))) {
+	void GrepCommand::output(const char *lineStr, size_t len, CmnStringRegex *regex, const std::string &fileName, int line) {
+		if (CmnStringRegex_Search(regex, lineStr, len) == True) {
 			// t@CEso
 			if (!fileName.empty()) {
 				std::cout << fileName << "(" << line << "):";
 			}
-			// Ώۍso
-			std::cout << lineStr << std::endl;
+			// Ώۍsóis'\0'ŏI[ĂȂߒw肷j
+			std::cout.write(lineStr, len) << '\n';
+			// Ẃitail -f̏o͓j͈vsɕ\
+			if (fileName.empty()) {
+				std::cout.flush();
+			}
 		}
 	}
 